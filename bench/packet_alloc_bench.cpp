@@ -0,0 +1,185 @@
+#include "ghostline/audit.hpp"
+#include "ghostline/labels.hpp"
+#include "ghostline/packet_arena.hpp"
+#include "ghostline/plugin.hpp"
+#include "net/stream_buffer.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+/*
+ * Per-packet allocation benchmark
+ *
+ * Drives framed packets through the same steps the transport core takes for
+ * each one (frame, build candidate, decide, audit, queue, send) and counts
+ * heap allocations made on the calling thread. The audit writer thread's
+ * own allocations are not counted.
+ *
+ * Run it from builds with and without -DGHOSTLINE_PACKET_ARENA=ON to compare.
+ * Usage: ghostline_packet_bench [packets]
+ */
+
+namespace {
+
+thread_local bool t_counting = false;
+std::size_t g_allocations = 0;
+std::size_t g_allocated_bytes = 0;
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    if (t_counting) {
+        ++g_allocations;
+        g_allocated_bytes += size;
+    }
+    if (void* block = std::malloc(size == 0 ? 1 : size)) return block;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* block) noexcept {
+    std::free(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept {
+    std::free(block);
+}
+
+namespace {
+
+struct Scenario {
+    const char* name;
+    MutationConfig config;
+    std::uint16_t upstream_port;
+    ByteVec packet;
+};
+
+ByteVec bytes_from_ascii(const std::string& text) {
+    return ByteVec(text.begin(), text.end());
+}
+
+ByteVec mqtt_publish(const std::string& topic, const std::string& payload) {
+    ByteVec packet;
+    packet.push_back(0x30);
+    packet.push_back(static_cast<byte>(2 + topic.size() + payload.size()));
+    packet.push_back(static_cast<byte>((topic.size() >> 8) & 0xff));
+    packet.push_back(static_cast<byte>(topic.size() & 0xff));
+    packet.insert(packet.end(), topic.begin(), topic.end());
+    packet.insert(packet.end(), payload.begin(), payload.end());
+    return packet;
+}
+
+void record(AuditTrail& audit, const FlowContext& flow, const std::string& plugin, AuditEventType type, const char* message, ByteView original, ByteView modified) {
+    AuditEvent& event = audit.next_event();
+    event.type = type;
+    event.flow_id = flow.flow_id;
+    event.plugin_name = plugin;
+    event.message = message;
+    event.original_bytes = original;
+    event.modified_bytes = modified;
+    event.flags = flow.flags;
+    event.sequence = flow.event_sequence;
+    audit.record_event(event);
+}
+
+// One packet through frame, candidate, decision, audit and the out queue.
+void run_packet(const ProtocolPlugin& plugin, FlowContext& flow, PacketArena& arena, AuditTrail& audit, StreamBuffer& pending, ChunkQueue& outq, ByteView packet) {
+    ++flow.event_sequence;
+    pending.append(packet);
+    const FramingResult framed = plugin.frame(flow, Direction::ClientToServer, pending.view());
+    if (framed.disposition != FramingDisposition::FramedPacket) {
+        outq.push(pending.take_all());
+        outq.consume(outq.bytes());
+        return;
+    }
+    record(audit, flow, plugin.name(), AuditEventType::FramedPacket, framed.detail.c_str(), framed.frame_bytes, ByteView());
+
+    Candidate& candidate = arena.next_candidate();
+    plugin.build_candidate(flow, Direction::ClientToServer, framed.frame_bytes, &framed, candidate);
+    candidate.trigger_sequence = ++flow.trigger_sequence;
+    candidate.candidate_sequence = ++flow.candidate_sequence;
+    CandidateDecision& decision = arena.next_decision();
+    plugin.decide(flow, Direction::ClientToServer, candidate, decision);
+
+    audit.record_candidate(flow, Direction::ClientToServer, candidate, decision);
+    const bool modified = decision.release == CandidateRelease::ReleaseModified;
+    record(audit,
+           flow,
+           plugin.name(),
+           modified ? AuditEventType::CandidateReleaseModified : AuditEventType::CandidateReleaseOriginal,
+           validation_detail(decision),
+           candidate.original_bytes,
+           modified ? candidate.modified_bytes() : ByteView());
+
+    outq.push(modified ? candidate.modified_bytes() : candidate.original_bytes);
+    pending.consume(framed.consumed_bytes);
+    outq.consume(outq.bytes());
+}
+
+void run_scenario(const Scenario& scenario, std::size_t packets) {
+    PluginRegistry registry(scenario.config);
+    FlowContext flow;
+    flow.flow_id = 1;
+    const ProtocolPlugin* plugin = registry.match(flow, Direction::ClientToServer, scenario.upstream_port, scenario.packet);
+    if (plugin == nullptr) {
+        std::fprintf(stderr, "%s: no plugin matched\n", scenario.name);
+        return;
+    }
+    flow.active_plugin = plugin->name();
+
+    AuditTrail audit("/dev/null", "/dev/null", "", "", "");
+    PacketArena arena;
+    StreamBuffer pending;
+    ChunkQueue outq;
+
+    // Warm up so steady-state reuse is what gets measured.
+    for (std::size_t i = 0; i < 64; ++i) run_packet(*plugin, flow, arena, audit, pending, outq, scenario.packet);
+
+    g_allocations = 0;
+    g_allocated_bytes = 0;
+    t_counting = true;
+    for (std::size_t i = 0; i < packets; ++i) run_packet(*plugin, flow, arena, audit, pending, outq, scenario.packet);
+    t_counting = false;
+    audit.flush();
+
+    // Wall time is left out on purpose: it is bound by the audit writer
+    // draining to /dev/null, not by the packet path.
+    std::printf("%-20s packets=%zu allocs/packet=%.2f bytes/packet=%.0f\n",
+                scenario.name,
+                packets,
+                static_cast<double>(g_allocations) / static_cast<double>(packets),
+                static_cast<double>(g_allocated_bytes) / static_cast<double>(packets));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t packets = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+    std::printf("packet arena: %s\n", PacketArena::kReuse ? "on" : "off");
+
+    Scenario raw_miss;
+    raw_miss.name = "raw-live-no-match";
+    raw_miss.config.raw_live_mode = true;
+    raw_miss.config.raw_find_text = "zzzz";
+    raw_miss.config.replacement_text = "yyyy";
+    raw_miss.config.raw_chunk_bytes = 512;
+    raw_miss.upstream_port = 9000;
+    raw_miss.packet = ByteVec(512, 0x41);
+
+    Scenario raw_hit = raw_miss;
+    raw_hit.name = "raw-live-rewrite";
+    raw_hit.packet = bytes_from_ascii("zzzz");
+    raw_hit.packet.resize(512, 0x41);
+
+    Scenario mqtt;
+    mqtt.name = "mqtt-publish-rewrite";
+    mqtt.config.replacement_text = "patched-payload";
+    mqtt.upstream_port = 1883;
+    mqtt.packet = mqtt_publish("sensors/temperature", "reading=21.5");
+
+    run_scenario(raw_miss, packets);
+    run_scenario(raw_hit, packets);
+    run_scenario(mqtt, packets);
+    return 0;
+}
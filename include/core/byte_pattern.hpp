@@ -0,0 +1,62 @@
+#pragma once
+
+#include "core/types.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+ * BytePattern
+ *
+ * Precompiled single-needle matcher for marker and find/replace scans.
+ *
+ * Search strategy:
+ *  - one-byte needles go straight to memchr
+ *  - on x86 the haystack is filtered 16 (SSE2) or 32 (AVX2) positions at a
+ *    time by comparing the needle's first and last byte, and only surviving
+ *    positions are verified with memcmp
+ *  - elsewhere, and for the tail the vector loop cannot cover, a Horspool
+ *    skip table is used
+ *
+ * The engine is picked once per process from the CPU's features. find()
+ * takes a start offset so callers can resume a scan without revisiting
+ * bytes already ruled out; resume_offset() computes that offset.
+ */
+
+enum class ByteScanEngine {
+    Horspool,
+    Sse2,
+    Avx2,
+};
+
+class BytePattern {
+public:
+    BytePattern() = default;
+    explicit BytePattern(ByteView needle);
+
+    const ByteVec& bytes() const { return needle_; }
+    std::size_t size() const { return needle_.size(); }
+    bool empty() const { return needle_.empty(); }
+
+    // Position of the first match at or after `offset`, or std::string::npos.
+    std::size_t find(ByteView haystack, std::size_t offset = 0) const;
+    std::size_t find(ByteView haystack, std::size_t offset, ByteScanEngine engine) const;
+
+    // First offset a later find() must still examine once `haystack` has
+    // been searched without a match and may only grow at its end.
+    std::size_t resume_offset(ByteView haystack) const {
+        return haystack.size() >= needle_.size() ? haystack.size() - needle_.size() + 1 : 0;
+    }
+
+private:
+    std::size_t find_horspool(ByteView haystack, std::size_t offset) const;
+
+    ByteVec needle_;
+    // Horspool shifts saturate at 255; a shorter shift is always safe.
+    std::array<std::uint8_t, 256> shift_{};
+};
+
+ByteScanEngine active_byte_scan_engine();
+bool byte_scan_engine_supported(ByteScanEngine engine);
+const char* byte_scan_engine_name(ByteScanEngine engine);
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "core/types.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * MultiPattern
+ *
+ * Aho-Corasick automaton over a fixed set of byte patterns, compiled once and
+ * shared read-only by every flow. Transitions are stored densely (256 next
+ * states per state) with failure links folded in, so a scan is one table
+ * lookup per haystack byte no matter how many patterns are loaded.
+ *
+ * Matching semantics:
+ *  - find_leftmost() returns the match with the smallest start offset,
+ *    preferring the longest pattern at that offset
+ *  - identical patterns report the lowest pattern index
+ *  - empty patterns are kept for index stability but never match
+ */
+
+struct PatternMatch {
+    std::size_t start = std::string::npos;
+    std::size_t length = 0;
+    std::uint32_t pattern = 0;
+
+    bool found() const { return start != std::string::npos; }
+    std::size_t end() const { return start + length; }
+};
+
+class MultiPattern {
+public:
+    MultiPattern() = default;
+    explicit MultiPattern(const std::vector<ByteVec>& patterns);
+
+    bool empty() const { return max_length_ == 0; }
+    std::size_t pattern_count() const { return pattern_count_; }
+    std::size_t state_count() const { return depth_.size(); }
+    std::size_t max_length() const { return max_length_; }
+
+    PatternMatch find_leftmost(ByteView haystack, std::size_t offset = 0) const;
+
+    // Leftmost-longest, non-overlapping matches in haystack order.
+    void find_non_overlapping(ByteView haystack, std::vector<PatternMatch>& out) const;
+
+    // Length of the longest suffix of haystack that is a prefix of some
+    // pattern, i.e. the bytes a later append could still turn into a match.
+    std::size_t partial_suffix(ByteView haystack) const;
+
+private:
+    static constexpr std::int32_t kNone = -1;
+
+    std::vector<std::int32_t> next_;
+    std::vector<std::int32_t> output_;
+    std::vector<std::int32_t> output_link_;
+    std::vector<std::uint32_t> depth_;
+    std::size_t pattern_count_ = 0;
+    std::size_t max_length_ = 0;
+};
@@ -1,7 +1,47 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <vector>
 
 using byte = std::uint8_t;
 using ByteVec = std::vector<byte>;
+
+/*
+ * ByteView
+ *
+ * Non-owning, read-only span over contiguous bytes. Converts implicitly from
+ * ByteVec so plugin and framing code can inspect transport buffers in place.
+ * A view is only valid until the underlying buffer is appended to or consumed.
+ */
+class ByteView {
+public:
+    ByteView() = default;
+    ByteView(const byte* data, std::size_t size) : data_(data), size_(size) {}
+    ByteView(const ByteVec& bytes) : data_(bytes.data()), size_(bytes.size()) {}
+
+    const byte* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    const byte* begin() const { return data_; }
+    const byte* end() const { return data_ + size_; }
+    byte operator[](std::size_t index) const { return data_[index]; }
+
+    ByteView subview(std::size_t offset, std::size_t count) const {
+        if (offset > size_) offset = size_;
+        if (count > size_ - offset) count = size_ - offset;
+        return ByteView(data_ + offset, count);
+    }
+
+    bool equals(ByteView other) const {
+        return size_ == other.size_ && (size_ == 0 || data_ == other.data_ || std::memcmp(data_, other.data_, size_) == 0);
+    }
+
+    ByteVec to_vec() const { return ByteVec(data_, data_ + size_); }
+
+private:
+    const byte* data_ = nullptr;
+    std::size_t size_ = 0;
+};
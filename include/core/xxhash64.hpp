@@ -0,0 +1,14 @@
+#pragma once
+
+#include "core/types.hpp"
+#include <cstdint>
+
+/*
+ * xxhash64
+ *
+ * XXH64 over a byte view, as specified by the xxHash reference. Used where
+ * the audit trail records a payload's fingerprint instead of its bytes, so
+ * the value matches `xxhsum -H64` on the same content.
+ */
+
+std::uint64_t xxhash64(ByteView data, std::uint64_t seed = 0);
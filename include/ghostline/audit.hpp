@@ -1,7 +1,14 @@
 #pragma once
 
+#include "ghostline/audit_writer.hpp"
+#include "ghostline/capture_policy.hpp"
 #include "ghostline/model.hpp"
+#include "ghostline/packet_arena.hpp"
+#include "ghostline/review_journal.hpp"
+#include <memory>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 class AuditTrail {
 public:
@@ -9,17 +16,62 @@ public:
                const std::string& action_log_path,
                const std::string& audit_json_path,
                const std::string& action_json_path,
-               const std::string& review_queue_dir);
+               const std::string& review_queue_dir,
+               const AuditWriterOptions& options = AuditWriterOptions(),
+               const std::string& audit_binary_path = std::string());
+    ~AuditTrail();
 
-    void record_event(const AuditEvent& event);
+    AuditTrail(const AuditTrail&) = delete;
+    AuditTrail& operator=(const AuditTrail&) = delete;
+
+    // Scratch event for the caller to fill and pass to record_event(); valid
+    // until the next call on this trail.
+    AuditEvent& next_event() { return scratch_.next_event(); }
+    // `capture_full` keeps every payload byte whatever the plugin's capture
+    // policy; queue pressure under the summary policy still sheds them.
+    void record_event(const AuditEvent& event, bool capture_full = false);
     void record_candidate(const FlowContext& flow, Direction direction, const Candidate& candidate, const CandidateDecision& decision);
     void record_observe_transition(const FlowContext& flow, Direction direction, const std::string& reason);
     void save_action_item(const ActionItem& item);
+    void set_capture_policies(const CapturePolicySet& policies);
+
+    // Blocks until every queued line and review item is on disk.
+    void flush();
+    AuditWriterStats stats() const;
+    std::size_t queued_bytes() const { return writer_.queued_bytes(); }
+    // Records queued for the writer thread.
+    std::size_t backlog() const { return writer_.backlog(); }
 
 private:
+    CaptureForm capture_form(const AuditEvent& event, bool capture_full, std::size_t& head_bytes);
+
     std::string audit_log_path_;
     std::string action_log_path_;
     std::string audit_json_path_;
     std::string action_json_path_;
     std::string review_queue_dir_;
+    std::string audit_binary_path_;
+    // Opened on the writer thread by the first saved item; declared before
+    // writer_ so it outlives the writer's queued tasks.
+    std::shared_ptr<ReviewJournal> review_journal_;
+
+    AuditWriter writer_;
+    PacketArena scratch_;
+    int audit_log_stream_ = -1;
+    int action_log_stream_ = -1;
+    int audit_json_stream_ = -1;
+    int action_json_stream_ = -1;
+    int audit_binary_stream_ = -1;
+
+    CapturePolicySet capture_;
+    bool capture_all_full_ = true;
+    // Events seen per policy for sample:<n>; slot 0 is the fallback.
+    std::vector<std::uint64_t> sample_counters_ = std::vector<std::uint64_t>(1, 0);
 };
+
+// The text log line and JSONL object for one event, without the newline.
+// Payloads come from `payload`, not the event's views, so the binary
+// exporter can render records whose bytes were trimmed or never stored.
+std::size_t audit_line_reserve(const AuditEvent& event, const PayloadCapture& payload);
+void append_audit_line(std::string& line, const AuditEvent& event, const PayloadCapture& payload);
+void append_audit_json(std::string& json, const AuditEvent& event, const PayloadCapture& payload);
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "ghostline/capture_policy.hpp"
+#include "ghostline/model.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+ * Binary audit records
+ *
+ * Compact, append-only alternative to the text and JSONL audit streams
+ * (--audit-binary). Each event is one self-delimiting record:
+ *
+ *   "GLA1" | u32 body length | body
+ *
+ * and the body holds, little-endian:
+ *
+ *   u64 ts, u64 seq, u64 trigger seq, u64 candidate seq, u32 flow,
+ *   u8 type, u8 direction, u8 stage, u8 capture form,
+ *   u8 flag count, u8 flags[count],
+ *   u16 plugin length, plugin, u32 message length, message,
+ *   u32 original length, u32 modified length,
+ *
+ * followed by what the capture form (capture_policy.hpp) kept:
+ *
+ *   Full     original bytes, modified bytes
+ *   Lengths  nothing
+ *   Head     u32 kept original, u32 kept modified, those leading bytes
+ *   Hash     u64 original XXH64, u64 modified XXH64
+ *
+ * Payloads are stored raw, once, instead of hex-encoded into two streams.
+ * There is no file header, so several workers can append whole records to
+ * the same path. IDs and label text are not stored; export_audit_binary()
+ * renders them with the same code the live text and JSONL sinks use.
+ */
+
+constexpr char kAuditRecordTag[4] = {'G', 'L', 'A', '1'};
+constexpr std::size_t kAuditRecordHeaderBytes = 8;
+
+// Appends one encoded record for `event` with its payloads as captured.
+void append_audit_record(std::string& out, const AuditEvent& event, const PayloadCapture& payload);
+
+enum class AuditRecordStatus {
+    Ok,
+    End,        // no bytes left at `offset`
+    Truncated,  // a record starts at `offset` but its body runs past the data
+    Corrupt,    // bad tag, field outside its enum, or lengths that do not add up
+};
+
+struct DecodedAuditRecord {
+    AuditEvent event;
+    // Views point into the decoded buffer.
+    PayloadCapture payload;
+};
+
+// Decodes the record at `offset` and advances `offset` past it on success.
+AuditRecordStatus decode_audit_record(ByteView data, std::size_t& offset, DecodedAuditRecord& record);
+
+struct AuditExportResult {
+    std::uint64_t records = 0;
+    AuditRecordStatus status = AuditRecordStatus::End;
+    std::string segment;         // file decoding stopped in
+    std::size_t stopped_at = 0;  // byte offset within `segment`
+};
+
+// Memory-maps `binary_path`, after its rotated segments oldest first (see
+// log_rotation.hpp), and rewrites the records in the text and JSONL layouts;
+// an empty output path skips that layout. Output files are truncated first.
+// Throws std::runtime_error when a file cannot be opened.
+AuditExportResult export_audit_binary(const std::string& binary_path, const std::string& text_path, const std::string& json_path);
+
+const char* audit_record_status_name(AuditRecordStatus status);
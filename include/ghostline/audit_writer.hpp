@@ -0,0 +1,130 @@
+#pragma once
+
+#include "ghostline/log_rotation.hpp"
+#include "ghostline/spsc_queue.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class AuditQueuePolicy {
+    Block,
+    Drop,
+    Summary,
+};
+
+struct AuditWriterOptions {
+    std::size_t queue_capacity = 8192;
+    std::size_t batch_bytes = 64 * 1024;
+    std::uint32_t flush_interval_ms = 50;
+    AuditQueuePolicy full_policy = AuditQueuePolicy::Block;
+    LogRotationOptions rotation;
+};
+
+struct AuditWriterStats {
+    std::uint64_t enqueued = 0;
+    std::uint64_t dropped = 0;
+    std::uint64_t summarized = 0;
+    std::uint64_t write_calls = 0;
+    std::uint64_t written_bytes = 0;
+    std::uint64_t errors = 0;
+};
+
+/*
+ * AuditWriter
+ *
+ * Dedicated disk thread for one AuditTrail. The owning relay thread is the
+ * only producer: it hands over fully formatted lines through a bounded
+ * SpscQueue and never touches a file descriptor. The writer thread keeps one
+ * O_APPEND fd per stream open for its whole lifetime and group-commits each
+ * stream when its buffer reaches batch_bytes or flush_interval_ms elapses.
+ * Only whole lines (or binary records) are written, so several writers may
+ * share a path. With rotation enabled each batch goes through the path's
+ * shared LogRotator (log_rotation.hpp), so rotation also falls between
+ * batches.
+ */
+class AuditWriter {
+public:
+    explicit AuditWriter(const AuditWriterOptions& options);
+    ~AuditWriter();
+
+    AuditWriter(const AuditWriter&) = delete;
+    AuditWriter& operator=(const AuditWriter&) = delete;
+
+    // Must be called before the first push. Returns -1 for an empty path.
+    int open_stream(const std::string& path);
+
+    // Queue a line (without trailing newline). Honors the full-queue policy
+    // except Summary, which the caller applies through under_pressure().
+    bool push_line(int stream, std::string&& line);
+    // Queue bytes that are written exactly as given (binary records).
+    bool push_record(int stream, std::string&& bytes);
+
+    // Run arbitrary disk work (review item files) on the writer thread.
+    bool post(std::function<void()> task);
+
+    // True once the backlog passes the Summary policy's soft limit.
+    bool under_pressure() const;
+    void note_summarized();
+
+    std::size_t backlog() const { return queue_.size(); }
+    // Bytes of line text queued and not yet taken by the writer thread.
+    std::size_t queued_bytes() const { return queued_bytes_.load(std::memory_order_relaxed); }
+    const AuditWriterOptions& options() const { return options_; }
+    AuditWriterStats stats() const;
+
+    // Blocks until everything queued so far has been written.
+    void flush();
+
+private:
+    struct Record {
+        int stream = -1;
+        std::string text;
+        std::function<void()> task;
+        std::uint64_t barrier = 0;
+    };
+
+    struct Stream {
+        std::string path;
+        int fd = -1;
+        std::string buffer;
+        std::shared_ptr<LogRotator> rotator;
+        std::uint64_t generation = 0;
+    };
+
+    bool enqueue(Record&& record);
+    void run();
+    void write_stream(Stream& stream);
+
+    AuditWriterOptions options_;
+    SpscQueue<Record> queue_;
+    std::vector<Stream> streams_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable flushed_;
+    std::atomic<bool> idle_{false};
+    std::atomic<bool> stop_{false};
+    std::uint64_t barrier_requested_ = 0;
+    std::uint64_t barrier_completed_ = 0;
+
+    std::atomic<std::uint64_t> enqueued_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::atomic<std::uint64_t> summarized_{0};
+    std::atomic<std::uint64_t> write_calls_{0};
+    std::atomic<std::uint64_t> written_bytes_{0};
+    std::atomic<std::uint64_t> errors_{0};
+    std::atomic<std::size_t> queued_bytes_{0};
+
+    std::thread thread_;
+};
+
+bool parse_audit_queue_policy(const std::string& name, AuditQueuePolicy& policy);
+const char* audit_queue_policy_name(AuditQueuePolicy policy);
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "core/types.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * Audit payload capture
+ *
+ * How much of an event's original and modified bytes the audit trail keeps,
+ * chosen per plugin:
+ *
+ *   full        every byte, hex-encoded (the default)
+ *   head:<n>    the first n bytes of each payload plus the full lengths
+ *   sample:<n>  every byte of every nth event with a payload; lengths only
+ *               for the rest
+ *   hash        the XXH64 of each payload plus the full lengths
+ *
+ * Candidates that raise an action item are always captured in full so the
+ * review queue sees the exact bytes.
+ */
+
+enum class CaptureMode {
+    Full,
+    Head,
+    Sample,
+    Hash,
+};
+
+struct CapturePolicy {
+    CaptureMode mode = CaptureMode::Full;
+    std::size_t head_bytes = 0;
+    std::uint32_t sample_every = 1;
+};
+
+// Parses "full", "head:<n>", "sample:<n>" or "hash".
+bool parse_capture_policy(const std::string& text, CapturePolicy& policy);
+std::string capture_policy_name(const CapturePolicy& policy);
+
+struct CapturePolicySet {
+    CapturePolicy fallback;
+    std::vector<std::string> plugins;
+    std::vector<CapturePolicy> policies;
+
+    // Index into `policies`, or -1 for the fallback.
+    int find(const std::string& plugin_name) const;
+    bool all_full() const;
+};
+
+// Adds "[plugin=]policy"; without a plugin the spec sets the fallback. A
+// later spec for the same plugin replaces the earlier one. Throws
+// std::runtime_error on a malformed spec.
+void add_capture_spec(CapturePolicySet& set, const std::string& spec);
+
+// What one event's payloads were reduced to before rendering.
+enum class CaptureForm : std::uint8_t {
+    Full = 0,
+    Lengths = 1,
+    Head = 2,
+    Hash = 3,
+};
+
+struct PayloadCapture {
+    CaptureForm form = CaptureForm::Full;
+    // The bytes to write out: whole payloads for Full, prefixes for Head.
+    ByteView original;
+    ByteView modified;
+    std::size_t original_len = 0;
+    std::size_t modified_len = 0;
+    std::uint64_t original_hash = 0;
+    std::uint64_t modified_hash = 0;
+};
+
+// Reduces the two payloads to `form`; `head_bytes` only applies to Head.
+PayloadCapture capture_payload(CaptureForm form, ByteView original, ByteView modified, std::size_t head_bytes = 0);
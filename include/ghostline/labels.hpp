@@ -0,0 +1,40 @@
+#pragma once
+
+#include "ghostline/model.hpp"
+#include <cstdint>
+#include <string>
+
+/*
+ * Labels
+ *
+ * Static text for every enum-coded field the packet path carries, and the
+ * formatters that turn numeric ID parts back into the IDs written to the
+ * audit trail. Nothing here allocates except the format_* helpers.
+ */
+
+const char* direction_name(Direction direction);  // "client_to_server"
+const char* direction_code(Direction direction);  // "c2s", as used in IDs
+const char* flag_name(FlowFlag flag);
+const char* stage_name(WorkflowStage stage);
+const char* audit_event_type_name(AuditEventType type);
+
+const char* validation_label(ValidationCode code);
+const char* validation_detail(ValidationCode code);
+const char* fallback_reason(ValidationCode code);
+// The decision's note when set, otherwise the table detail for its code.
+const char* validation_detail(const CandidateDecision& decision);
+
+const char* review_reason(ReviewCode code);
+const char* action_title(ReviewCode code);
+const char* action_detail(ReviewCode code);
+
+// "trigger-<flow>-<dir>-<plugin>-<sequence>" and the "candidate-" form.
+void append_trigger_id(std::string& out, std::uint32_t flow_id, Direction direction, const std::string& plugin_name, std::uint64_t sequence);
+void append_candidate_id(std::string& out, std::uint32_t flow_id, Direction direction, const std::string& plugin_name, std::uint64_t sequence);
+// The audit event_id for `event`: "<candidate id>-result" for candidate
+// events, "event-<flow>-observe-transition" for observe transitions, and
+// "event-<flow>-<dir>-<sequence>-<type>" otherwise.
+void append_event_id(std::string& out, const AuditEvent& event);
+
+std::string format_trigger_id(std::uint32_t flow_id, Direction direction, const std::string& plugin_name, std::uint64_t sequence);
+std::string format_candidate_id(std::uint32_t flow_id, Direction direction, const std::string& plugin_name, std::uint64_t sequence);
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+ * Log rotation
+ *
+ * Audit and action streams roll over to numbered segments once the active
+ * file would pass max_bytes or has been open for max_age_s:
+ *
+ *   ghostline_audit.log            active segment, always appended to
+ *   ghostline_audit.log.000007     rotated, not yet compressed
+ *   ghostline_audit.log.000006.gz  rotated and compressed
+ *
+ * Indexes only grow, so listing segments by index and then the active file
+ * reads the stream in write order. Rotation happens on the audit writer
+ * thread between whole batches, so lines and binary records never straddle
+ * a segment boundary. Compression and keep-N pruning run on one shared
+ * maintenance thread so a slow disk never holds up an audit writer.
+ */
+
+enum class LogCompression {
+    None,
+    Gzip,
+};
+
+struct LogRotationOptions {
+    std::uint64_t max_bytes = 0;   // 0 = no size limit
+    std::uint32_t max_age_s = 0;   // 0 = no age limit
+    std::uint32_t keep = 0;        // rotated segments kept; 0 = keep all
+    LogCompression compression = LogCompression::None;
+
+    bool enabled() const { return max_bytes != 0 || max_age_s != 0; }
+};
+
+bool parse_log_compression(const std::string& name, LogCompression& compression);
+const char* log_compression_name(LogCompression compression);
+// Gzip needs a build with zlib (GHOSTLINE_HAVE_ZLIB).
+bool log_compression_available(LogCompression compression);
+
+/*
+ * LogRotator
+ *
+ * Rotation state for one path, shared by every AuditWriter in the process
+ * that appends to it (one per worker). A writer holds lock() around
+ * prepare_write(), its write() and note_written(); prepare_write() rotates
+ * when due and reopens the writer's fd if any writer has rotated since.
+ * Several processes appending to the same path are not coordinated.
+ */
+class LogRotator {
+public:
+    static std::shared_ptr<LogRotator> for_path(const std::string& path, const LogRotationOptions& options);
+
+    LogRotator(const std::string& path, const LogRotationOptions& options);
+
+    LogRotator(const LogRotator&) = delete;
+    LogRotator& operator=(const LogRotator&) = delete;
+
+    std::unique_lock<std::mutex> lock() { return std::unique_lock<std::mutex>(mutex_); }
+    std::uint64_t generation() const { return generation_; }
+    // Call with lock() held, before writing `size` bytes through `fd`.
+    void prepare_write(int& fd, std::uint64_t& generation, std::size_t size);
+    void note_written(std::size_t size) { size_ += size; }
+
+private:
+    void rotate();
+
+    std::string path_;
+    LogRotationOptions options_;
+    std::mutex mutex_;
+    std::uint64_t generation_ = 0;
+    std::uint64_t size_ = 0;
+    std::uint64_t opened_at_ms_ = 0;
+    std::uint64_t last_index_ = 0;
+};
+
+// "<path>.<index>" with the index zero-padded to six digits.
+std::string log_segment_path(const std::string& path, std::uint64_t index);
+// Rotated segments of `path` oldest first, then `path` itself if it exists.
+std::vector<std::string> list_log_segments(const std::string& path);
+// Appends one segment's bytes to `out`, inflating .gz segments. Throws
+// std::runtime_error when the segment cannot be read.
+void read_log_segment(const std::string& segment, std::string& out);
+// Every segment of `path` concatenated in write order.
+std::string read_log_stream(const std::string& path);
+
+// Blocks until queued compression and pruning have finished.
+void wait_for_log_maintenance();
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * LogLineIndex
+ *
+ * Line offsets for an audit or action stream (JSONL or text) and its rotated
+ * segments, so a viewer can show a multi-gigabyte log without holding it:
+ * the index costs 8 bytes per line and line() reads one line back with
+ * pread. Empty lines are skipped.
+ *
+ * refresh() indexes bytes appended since the last call and follows rotation
+ * (see log_rotation.hpp): once the active file is renamed away it is read to
+ * its end and kept as a sealed segment, segments rotated after it before this
+ * refresh are indexed next, and then the new active file is picked up.
+ * A trailing line without its newline waits for the next refresh.
+ * Compressed segments are inflated once into an unlinked temporary file and
+ * indexed like plain ones.
+ *
+ * watch() sets up an inotify watch on the log's directory (Linux only) and
+ * returns a descriptor that turns readable when the log may have changed;
+ * callers drain_watch() and refresh(). Elsewhere it returns -1 and callers
+ * poll refresh() on a timer instead.
+ */
+class LogLineIndex {
+public:
+    // Indexes every existing segment of `path`. Throws std::runtime_error when
+    // `path` has no segments or one cannot be read.
+    explicit LogLineIndex(const std::string& path);
+    ~LogLineIndex();
+
+    LogLineIndex(const LogLineIndex&) = delete;
+    LogLineIndex& operator=(const LogLineIndex&) = delete;
+
+    // Returns the number of lines added.
+    std::size_t refresh();
+    std::size_t size() const { return lines_; }
+    // Line `index` without its newline. Throws std::out_of_range past size().
+    std::string line(std::size_t index) const;
+
+    int watch();
+    void drain_watch();
+
+    const std::string& path() const { return path_; }
+
+private:
+    struct Segment {
+        int fd = -1;
+        std::uint64_t indexed_bytes = 0;
+        std::vector<std::uint64_t> starts;
+    };
+
+    void add_segment(int fd);
+    bool open_active();
+    std::size_t index_segment(Segment& segment);
+
+    std::string path_;
+    std::vector<Segment> segments_;
+    // First global line number of each segment, for line() lookups.
+    std::vector<std::size_t> first_line_;
+    std::size_t lines_ = 0;
+    bool active_open_ = false;
+    std::uint64_t active_inode_ = 0;
+    // Rotation index of the newest segment indexed; the active file becomes
+    // the one after it.
+    std::uint64_t last_segment_index_ = 0;
+    int watch_fd_ = -1;
+};
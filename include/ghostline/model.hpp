@@ -3,6 +3,7 @@
 #include "core/types.hpp"
 #include <cstdint>
 #include <string>
+#include <utility>
 #include <vector>
 
 enum class Direction {
@@ -39,6 +40,76 @@ enum class WorkflowStage {
     ActionCreated,
 };
 
+// Why a decision released what it did. Codes stay numeric through the
+// packet path; their label, detail and fallback text come from the table in
+// labels.cpp and are rendered only by the audit sink.
+enum class ValidationCode : std::uint16_t {
+    None,
+    RawLiveDirectionFilter,
+    RawLiveNoMatch,
+    RawLiveSizeBlocked,
+    RawLiveValidated,
+    RawLiveSizeMutated,
+    ByteWindowDirectionFilter,
+    ByteWindowNoOp,
+    ByteWindowSizeBlocked,
+    ByteWindowPidDriftRisk,
+    ByteWindowAllowSizeMutated,
+    ByteWindowValidated,
+    ObservationOnly,
+    MqttControlObserveOnly,
+    MqttDirectionFilter,
+    MqttOpaquePayload,
+    MqttNoOp,
+    MqttReframeInvalid,
+    MqttSizeBlocked,
+    MqttPidDriftRisk,
+    MqttPublishValidated,
+    MqttPublishReframed,
+};
+
+// Review reason and action item text attached to a decision.
+enum class ReviewCode : std::uint16_t {
+    None,
+    RawLiveSizeBlocked,
+    RawLiveThreshold,
+    RawLiveSizeChange,
+    ByteWindowSizeBlocked,
+    ByteWindowPidDriftRisk,
+    ByteWindowThreshold,
+    MqttOpaquePayload,
+    MqttReframeInvalid,
+    MqttSizeBlocked,
+    MqttPidDriftRisk,
+    MqttThreshold,
+};
+
+enum class AuditEventType : std::uint16_t {
+    Unknown,
+    PluginDetect,
+    FramedPacket,
+    Candidate,
+    CandidateReleaseOriginal,
+    CandidateReleaseModified,
+    FramingBufferCeiling,
+    FramingFailed,
+    FramingPassThrough,
+    HoldDeadlineFlush,
+    ReadCloseFlushOriginal,
+    SplicePassthrough,
+    BackpressurePause,
+    BackpressureResume,
+    BackpressureGlobalPause,
+    BackpressureGlobalResume,
+    MemoryBudgetEnforced,
+    MemoryBudgetReleaseOriginal,
+    ObserveTransition,
+    FlowIoStats,
+    WorkerIoStats,
+    WorkerMemoryStats,
+    RulesReloaded,
+};
+
 struct FlowContext {
     std::uint32_t flow_id = 0;
     std::int64_t pid_hint = -1;
@@ -54,12 +125,18 @@ struct FlowContext {
 };
 
 struct Candidate {
-    std::string trigger_id;
-    std::string candidate_id;
+    // Per-flow sequence numbers; the trigger and candidate IDs are rendered
+    // from them together with the flow, direction and plugin name.
+    std::uint64_t trigger_sequence = 0;
+    std::uint64_t candidate_sequence = 0;
     std::string plugin_name;
     std::string trigger_label;
-    ByteVec original_bytes;
-    ByteVec modified_bytes;
+    // View of the framed bytes, normally still in the flow's receive buffer;
+    // valid until the transport consumes them.
+    ByteView original_bytes;
+    // Owned copy, made only when a plugin actually rewrites the bytes.
+    ByteVec mutated_bytes;
+    bool mutated = false;
     std::size_t header_size = 0;
     std::size_t footer_size = 0;
     std::size_t payload_offset = 0;
@@ -73,6 +150,19 @@ struct Candidate {
     std::string review_label;
     WorkflowStage workflow_stage = WorkflowStage::CandidateBuilt;
     std::string note;
+
+    ByteView modified_bytes() const { return mutated ? ByteView(mutated_bytes) : original_bytes; }
+    void set_modified(ByteVec bytes) {
+        mutated_bytes = std::move(bytes);
+        mutated = true;
+    }
+    // Starts an in-place rewrite, reusing whatever capacity mutated_bytes
+    // still has from an earlier packet.
+    ByteVec& modify() {
+        mutated_bytes.clear();
+        mutated = true;
+        return mutated_bytes;
+    }
 };
 
 struct CandidateDecision {
@@ -81,14 +171,11 @@ struct CandidateDecision {
     bool observe_only = false;
     bool create_action_item = false;
     bool review_required = false;
-    std::string validation_label;
-    std::string validation_detail;
-    std::string fallback_reason;
-    std::string trigger_id;
-    std::string candidate_id;
-    std::string review_reason;
-    std::string action_title;
-    std::string action_detail;
+    ValidationCode validation = ValidationCode::None;
+    ReviewCode review = ReviewCode::None;
+    // Replaces the table's validation detail when it is only known at run
+    // time; empty on the hot path.
+    std::string validation_note;
     WorkflowStage workflow_stage = WorkflowStage::CandidateReviewed;
 };
 
@@ -112,17 +199,20 @@ struct ActionItem {
     std::uint64_t created_at_ns = 0;
 };
 
+// The event, trigger and candidate IDs are not stored; the audit sink renders
+// them from the type, flow, direction, sequence and candidate sequences.
 struct AuditEvent {
-    std::string event_id;
-    std::string trigger_id;
-    std::string candidate_id;
+    AuditEventType type = AuditEventType::Unknown;
+    std::uint64_t trigger_sequence = 0;
+    std::uint64_t candidate_sequence = 0;
     std::uint32_t flow_id = 0;
     Direction direction = Direction::ClientToServer;
     std::string plugin_name;
-    std::string event_type;
     std::string message;
-    ByteVec original_bytes;
-    ByteVec modified_bytes;
+    // Views into the candidate or receive buffer; record_event() serializes
+    // them before returning.
+    ByteView original_bytes;
+    ByteView modified_bytes;
     std::vector<FlowFlag> flags;
     WorkflowStage workflow_stage = WorkflowStage::Observe;
     std::uint64_t sequence = 0;
@@ -2,6 +2,7 @@
 
 #include "ghostline/model.hpp"
 #include "ghostline/pid_search.hpp"
+#include "ghostline/review_journal.hpp"
 
 #include <string>
 #include <vector>
@@ -12,7 +13,7 @@ struct TargetProfile {
     std::vector<ProcessSocketEntry> matches;
 };
 
-std::string bytes_to_hex_string(const ByteVec& bytes);
+std::string bytes_to_hex_string(ByteView bytes);
 
 void save_target_profile(const std::string& path, const TargetProfile& profile);
 TargetProfile load_target_profile(const std::string& path);
@@ -21,9 +22,17 @@ std::string target_profile_to_json(const TargetProfile& profile);
 std::vector<TargetProfile> default_protocol_target_profiles();
 std::vector<std::string> seed_protocol_target_profiles(const std::string& directory);
 
+// One action item as a single JSON line, newline included, and back.
+std::string action_item_to_json(const ActionItem& item);
+ActionItem parse_action_item_json(const std::string& text);
+
+// The review queue lives in the journal under `queue_dir` (review_journal.hpp).
 void save_review_item(const std::string& queue_dir, const ActionItem& item);
+// Reads one <action_id>.json file in the layout queues used before the journal.
 ActionItem load_review_item(const std::string& path);
+bool find_review_item(const std::string& queue_dir, const std::string& action_id, ActionItem& item);
 std::vector<ActionItem> list_review_items(const std::string& queue_dir);
+ReviewPage list_review_page(const std::string& queue_dir, const ReviewFilter& filter, std::size_t offset, std::size_t limit);
 void update_review_item(const std::string& queue_dir,
                         const std::string& action_id,
                         const std::string& status,
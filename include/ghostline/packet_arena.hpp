@@ -0,0 +1,43 @@
+#pragma once
+
+#include "ghostline/model.hpp"
+
+/*
+ * PacketArena
+ *
+ * Scratch Candidate, CandidateDecision and AuditEvent objects for one packet
+ * at a time. Every packet builds all three and drops them before the next,
+ * so an owner that handles packets serially (one flow direction, one audit
+ * trail) hands out the same objects again instead of constructing new ones.
+ *
+ * Built with GHOSTLINE_PACKET_ARENA, next_*() clears the previous packet's
+ * fields in place: strings and byte vectors keep their capacity, so a flow
+ * in steady state fills them without touching the heap. Without it every
+ * call starts from a freshly constructed object, which is what a local
+ * variable would give.
+ *
+ * A reference from next_*() is valid until the next call for the same type.
+ */
+
+class PacketArena {
+public:
+#if defined(GHOSTLINE_PACKET_ARENA)
+    static constexpr bool kReuse = true;
+#else
+    static constexpr bool kReuse = false;
+#endif
+
+    Candidate& next_candidate();
+    CandidateDecision& next_decision();
+    AuditEvent& next_event();
+
+private:
+    Candidate candidate_;
+    CandidateDecision decision_;
+    AuditEvent event_;
+};
+
+// Restore default field values but keep every buffer's capacity.
+void reset_for_reuse(Candidate& candidate);
+void reset_for_reuse(CandidateDecision& decision);
+void reset_for_reuse(AuditEvent& event);
@@ -1,7 +1,13 @@
 #pragma once
 
+#include <array>
+#include <condition_variable>
 #include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <sys/socket.h>
+#include <thread>
 #include <vector>
 
 struct TcpSocketEntry {
@@ -31,8 +37,90 @@ struct PidSearchQuery {
     bool established_only = false;
 };
 
+// One row of /proc/net/tcp or /proc/net/tcp6; `socket` has no fd yet.
+struct ProcTcpSocket {
+    std::uint64_t inode = 0;
+    TcpSocketEntry socket;
+};
+
 std::vector<ProcessSocketEntry> parse_lsof_tcp_listing(const std::string& text);
+// Rows are rendered the way lsof -F prints them ("127.0.0.1:1883",
+// "[::1]:5000->[::1]:1883", "*:1883" for a wildcard listener).
+std::vector<ProcTcpSocket> parse_proc_net_tcp(const std::string& text, bool ipv6);
+// Linux backend: joins /proc/net/tcp{,6} to the socket links under
+// /proc/<pid>/fd without forking lsof. `proc_root` exists for tests.
+std::vector<ProcessSocketEntry> query_proc_tcp_processes(const PidSearchQuery& query, const std::string& proc_root = "/proc");
 std::vector<ProcessSocketEntry> filter_process_sockets(const std::vector<ProcessSocketEntry>& entries,
                                                        const PidSearchQuery& query);
+// /proc on Linux, lsof elsewhere or when /proc/net/tcp is unreadable.
 std::vector<ProcessSocketEntry> query_tcp_processes(const PidSearchQuery& query);
 std::string process_sockets_to_json(const std::vector<ProcessSocketEntry>& entries);
+
+// Both ends of one TCP connection as seen by the socket at `local`.
+// IPv4-mapped IPv6 addresses are stored as IPv4, so a dual-stack listener's
+// view of a peer matches the peer's own IPv4 socket.
+struct SocketTuple {
+    std::uint8_t family = 0;  // 4 or 6
+    std::array<std::uint8_t, 16> local{};
+    std::array<std::uint8_t, 16> remote{};
+    std::uint16_t local_port = 0;
+    std::uint16_t remote_port = 0;
+};
+
+bool make_socket_tuple(const sockaddr_storage& local, const sockaddr_storage& remote, SocketTuple& tuple);
+
+/*
+ * SocketIndex
+ *
+ * Persistent in-memory view of the host's TCP sockets and their owning
+ * processes, for repeated searches and per-flow PID hints. A background
+ * thread re-dumps every TCP socket through NETLINK_SOCK_DIAG each
+ * refresh_ms and walks /proc/<pid>/fd only for sockets whose owner it has
+ * not resolved yet, trying processes that already own sockets first and
+ * skipping processes of other users. query() and owner_of() read the
+ * latest snapshot and never touch the kernel; an owner_of() miss asks the
+ * thread for an early refresh.
+ *
+ * Linux only: elsewhere start() returns false and query() falls back to
+ * query_tcp_processes().
+ */
+class SocketIndex {
+public:
+    explicit SocketIndex(const std::string& proc_root = "/proc");
+    ~SocketIndex();
+
+    SocketIndex(const SocketIndex&) = delete;
+    SocketIndex& operator=(const SocketIndex&) = delete;
+
+    // Takes a first snapshot, then refreshes in the background. Returns
+    // false when sock_diag is unavailable.
+    bool start(std::uint32_t refresh_ms);
+    void stop();
+    // One synchronous dump; false when sock_diag is unavailable.
+    bool refresh();
+
+    std::vector<ProcessSocketEntry> query(const PidSearchQuery& query) const;
+    // PID owning the socket `tuple` describes, or -1.
+    std::int64_t owner_of(const SocketTuple& tuple);
+    std::uint64_t refreshes() const;
+
+private:
+    struct Snapshot;
+
+    std::shared_ptr<const Snapshot> snapshot() const;
+    void run();
+
+    std::string proc_root_;
+    std::uint32_t refresh_ms_ = 1000;
+
+    mutable std::mutex mutex_;
+    std::shared_ptr<const Snapshot> snapshot_;
+    std::uint64_t refreshes_ = 0;
+
+    // Serializes refresh() between the thread and direct callers.
+    std::mutex refresh_mutex_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+    bool refresh_requested_ = false;
+    std::thread thread_;
+};
@@ -1,14 +1,42 @@
 #pragma once
 
+#include "core/byte_pattern.hpp"
+#include "core/multi_pattern.hpp"
 #include "ghostline/model.hpp"
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
-struct WindowRule {
+// One raw-live find/replace pair.
+struct SubstitutionRule {
+    ByteVec find;
+    ByteVec replacement;
+};
+
+// One byte-window start/end marker pair and the payload written between them.
+struct MarkerWindowRule {
     ByteVec start_marker;
     ByteVec end_marker;
+    std::string replacement_text;
+};
+
+struct CompiledWindow {
+    BytePattern start_marker;
+    BytePattern end_marker;
+    ByteVec replacement;
+};
+
+// Every window rule of a plugin, compiled once at registry construction.
+// start_markers pattern i is windows[i].start_marker.
+struct WindowRuleSet {
+    std::vector<CompiledWindow> windows;
+    MultiPattern start_markers;
+};
+
+struct WindowRule {
+    const WindowRuleSet* rules = nullptr;
     bool rewrite_u32_prefix = false;
 };
 
@@ -17,10 +45,17 @@ struct MutationConfig {
     ByteVec end_marker;
     std::string replacement_text;
     std::string raw_find_text;
+    // Extra rules on top of the single start/end and find/replace pairs above.
+    std::vector<SubstitutionRule> substitutions;
+    std::vector<MarkerWindowRule> window_rules;
     bool allow_size_mutation = true;
     bool rewrite_u32_prefix = false;
     bool raw_live_mode = false;
     std::size_t raw_chunk_bytes = 1024;
+    // Streaming raw-live: forward everything but a possible partial match
+    // right away and flush the held tail after raw_flush_ms of silence.
+    bool raw_stream_mode = false;
+    std::uint32_t raw_flush_ms = 50;
     bool mutate_client_to_server = true;
     bool mutate_server_to_client = true;
     std::size_t raw_review_threshold_bytes = 0;
@@ -37,36 +72,78 @@ enum class FramingDisposition {
 
 struct FramingResult {
     FramingDisposition disposition = FramingDisposition::PassThrough;
-    ByteVec frame_bytes;
+    // View into the buffer passed to frame()/flush_held().
+    ByteView frame_bytes;
     std::size_t consumed_bytes = 0;
     std::string packet_type;
     std::string detail;
     bool candidate_mutation_allowed = false;
     bool structural_risk = false;
+    // With NeedMoreBytes: bytes before this offset cannot start a frame
+    // boundary, so the next frame() call may resume scanning here.
+    std::size_t resume_offset = 0;
+    // With NeedMoreBytes: call flush_held() if no new bytes arrive within
+    // this many milliseconds (0 holds until more bytes or read-close).
+    std::uint32_t hold_deadline_ms = 0;
 };
 
+// Interned plugin identity: the plugin's index in its PluginRegistry.
+using PluginId = std::uint16_t;
+constexpr PluginId kNoPluginId = 0xffff;
+
 class ProtocolPlugin {
 public:
     virtual ~ProtocolPlugin() = default;
 
-    virtual std::string name() const = 0;
-    virtual bool matches(const FlowContext& flow, Direction direction, std::uint16_t upstream_port, const ByteVec& buffer) const = 0;
+    virtual const std::string& name() const = 0;
+    virtual bool matches(const FlowContext& flow, Direction direction, std::uint16_t upstream_port, ByteView buffer) const = 0;
     virtual bool uses_protocol_framing() const { return false; }
-    virtual FramingResult frame(const FlowContext&, Direction, const ByteVec&) const { return FramingResult(); }
+    // resume_offset is the previous NeedMoreBytes result's resume_offset for
+    // the same, only-appended-to buffer, or 0.
+    virtual FramingResult frame(const FlowContext&, Direction, ByteView, std::size_t resume_offset = 0) const {
+        (void)resume_offset;
+        return FramingResult();
+    }
+    // Final framing of bytes a plugin was holding, on a hold deadline or
+    // read-close. Anything but FramedPacket releases them unchanged.
+    virtual FramingResult flush_held(const FlowContext&, Direction, ByteView) const { return FramingResult(); }
     virtual bool configure_window(const FlowContext& flow, Direction direction, WindowRule& rule) const = 0;
-    virtual Candidate build_candidate(const FlowContext& flow, Direction direction, const ByteVec& window, const FramingResult* framed = nullptr) const = 0;
-    virtual CandidateDecision decide(const FlowContext& flow, Direction direction, Candidate& candidate) const = 0;
+    // Fill a default-initialized candidate / decision. The transport passes
+    // reused scratch objects (see PacketArena), so only assign fields.
+    virtual void build_candidate(const FlowContext& flow, Direction direction, ByteView window, const FramingResult* framed, Candidate& candidate) const = 0;
+    virtual void decide(const FlowContext& flow, Direction direction, Candidate& candidate, CandidateDecision& decision) const = 0;
     virtual std::string audit_label() const = 0;
+
+    Candidate build_candidate(const FlowContext& flow, Direction direction, ByteView window, const FramingResult* framed = nullptr) const {
+        Candidate candidate;
+        build_candidate(flow, direction, window, framed, candidate);
+        return candidate;
+    }
+
+    CandidateDecision decide(const FlowContext& flow, Direction direction, Candidate& candidate) const {
+        CandidateDecision decision;
+        decide(flow, direction, candidate, decision);
+        return decision;
+    }
+
+    PluginId id() const { return id_; }
+
+private:
+    friend class PluginRegistry;
+    PluginId id_ = kNoPluginId;
 };
 
 class PluginRegistry {
 public:
     explicit PluginRegistry(const MutationConfig& config);
 
-    const ProtocolPlugin* match(const FlowContext& flow, Direction direction, std::uint16_t upstream_port, const ByteVec& buffer) const;
+    const ProtocolPlugin* match(const FlowContext& flow, Direction direction, std::uint16_t upstream_port, ByteView buffer) const;
     const ProtocolPlugin* find_by_name(const std::string& name) const;
+    const ProtocolPlugin* get(PluginId id) const { return id < plugins_.size() ? plugins_[id].get() : nullptr; }
+    PluginId id_of(const std::string& name) const;
     const std::vector<std::unique_ptr<ProtocolPlugin>>& plugins() const { return plugins_; }
 
 private:
     std::vector<std::unique_ptr<ProtocolPlugin>> plugins_;
+    std::unordered_map<std::string, PluginId> ids_by_name_;
 };
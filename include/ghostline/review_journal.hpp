@@ -0,0 +1,105 @@
+#pragma once
+
+#include "ghostline/model.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+/*
+ * Review journal
+ *
+ * The review queue directory holds one append-only file,
+ *
+ *   <queue_dir>/review_journal.jsonl
+ *
+ * with one action item JSON object per line. Saving, approving, rejecting
+ * and replaying all append the item's new state; the last line for an
+ * action_id wins. Opening the journal reads it once, front to back, and
+ * keeps an in-memory index of where each item's latest line starts plus its
+ * status and plugin, so lookups and filtered pages only read the lines they
+ * return.
+ *
+ * Superseded lines are dropped by compact(), which rewrites the live lines
+ * to a temporary file and renames it over the journal; puts compact on their
+ * own once superseded lines outnumber live ones. Queue directories from
+ * before the journal (one <action_id>.json per item) are imported on open
+ * and the per-item files removed once the journal holds them.
+ *
+ * Other processes may append to the same journal (the proxy saves items
+ * while the CLI approves them): appends and compaction hold an flock on the
+ * journal, and every call first picks up lines appended elsewhere and
+ * reopens the file if it was compacted underneath.
+ */
+
+struct ReviewFilter {
+    std::string status;  // empty = any
+    std::string plugin;  // empty = any
+};
+
+struct ReviewPage {
+    std::vector<ActionItem> items;  // ordered by action_id
+    std::size_t total = 0;          // items matching the filter
+};
+
+class ReviewJournal {
+public:
+    // One journal per directory per process, shared by every audit writer.
+    static std::shared_ptr<ReviewJournal> for_dir(const std::string& queue_dir);
+
+    // Creates `queue_dir` if needed, imports legacy per-item files and
+    // indexes the journal. Throws std::runtime_error on I/O failure.
+    explicit ReviewJournal(const std::string& queue_dir);
+    ~ReviewJournal();
+
+    ReviewJournal(const ReviewJournal&) = delete;
+    ReviewJournal& operator=(const ReviewJournal&) = delete;
+
+    void put(const ActionItem& item);
+    bool get(const std::string& action_id, ActionItem& item);
+    // Items matching `filter` from position `offset`; limit 0 = no limit.
+    ReviewPage page(const ReviewFilter& filter, std::size_t offset, std::size_t limit);
+    void compact();
+
+    std::size_t live_items();
+    std::size_t superseded_lines();
+    const std::string& path() const { return path_; }
+
+private:
+    struct Entry {
+        std::uint64_t offset = 0;
+        std::uint32_t length = 0;
+        std::string status;
+        std::string plugin;
+    };
+
+    void open_locked();
+    // Runs `fn` under an flock on the journal (LOCK_SH or LOCK_EX) with the
+    // index caught up on lines other processes appended.
+    void with_journal_lock(int operation, const std::function<void()>& fn);
+    void index_from(std::uint64_t offset);
+    void index_line(const std::string& line, std::uint64_t offset);
+    void unindex(const std::string& action_id);
+    void append_locked(const ActionItem& item);
+    void compact_locked();
+    void import_legacy_locked();
+    ActionItem read_entry(const Entry& entry) const;
+
+    std::string dir_;
+    std::string path_;
+    std::mutex mutex_;
+    int fd_ = -1;
+    std::uint64_t inode_ = 0;
+    std::uint64_t indexed_bytes_ = 0;
+    std::size_t superseded_ = 0;
+    bool reopen_ = false;
+    std::map<std::string, Entry> entries_;
+    std::map<std::string, std::set<std::string>> by_status_;
+    std::map<std::string, std::set<std::string>> by_plugin_;
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+ * Rules loader
+ *
+ * Reads a --rules file and turns it into the CLI flags it stands for, in
+ * process. The rules then go through the same flag parser as the command
+ * line, and flags given after them still win. Three formats are accepted,
+ * chosen by the file suffix:
+ *
+ *   .json .tf.json .hcl.json   a JSON rules object
+ *   .jinja .jinja2 .j2         JSON with {{ name }} placeholders filled
+ *                              from --rules-var name=value
+ *   .tf .tfvars .hcl           flat `key = value` lines; values are quoted
+ *                              strings, true/false or integers, and # and
+ *                              // start comments
+ *
+ * Malformed input, a missing template variable or an unknown suffix throws
+ * std::runtime_error.
+ */
+
+struct RuleValue {
+    enum class Kind {
+        Null,
+        Bool,
+        Number,
+        String,
+        Array,
+        Object,
+    };
+
+    Kind kind = Kind::Null;
+    bool boolean = false;
+    // String contents, or a number as written in the file.
+    std::string text;
+    std::vector<RuleValue> items;
+    // In file order; a repeated key keeps its first position and last value.
+    std::vector<std::pair<std::string, RuleValue>> members;
+
+    const RuleValue* find(const std::string& key) const;
+    // Python truthiness, which the rule keys have always followed.
+    bool truthy() const;
+    // The value as one CLI argument. Throws for arrays and objects.
+    std::string as_arg() const;
+};
+
+RuleValue parse_rules_json(const std::string& text);
+RuleValue parse_rules_hcl(const std::string& text);
+// Replaces each {{ name }} with its variable. Throws on a missing one.
+std::string render_rules_template(const std::string& text, const std::map<std::string, std::string>& variables);
+
+// `vars` holds the --rules-var name=value entries.
+RuleValue load_rule_data(const std::string& path, const std::vector<std::string>& vars);
+std::vector<std::string> rules_to_args(const RuleValue& data);
+std::vector<std::string> resolve_rules_args(const std::string& path, const std::vector<std::string>& vars);
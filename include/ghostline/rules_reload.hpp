@@ -0,0 +1,89 @@
+#pragma once
+
+#include "ghostline/plugin.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/*
+ * Rules reload
+ *
+ * PluginRegistryCell holds the compiled mutation rules every worker shares
+ * and lets a reload replace them while flows stay up. A replacement registry
+ * is built and compiled off the relay threads, then published with a pointer
+ * swap and a generation bump. Workers compare the generation once per event
+ * loop round, a single atomic load, and only take the cell's lock to fetch
+ * the registry after it moved. Each flow direction keeps a reference to the
+ * registry its plugin came from and moves to the current one at its next
+ * frame boundary, so a frame or window being assembled finishes under the
+ * rules it started with. An old registry is freed once its last holder lets
+ * go; publishing never waits for readers.
+ *
+ * RulesWatcher runs reloads on its own thread. It wakes when its trigger
+ * descriptor turns readable (the transport passes a SIGHUP self-pipe) or
+ * when the watched rules file changes: on Linux through an inotify watch on
+ * the file's directory, so editors that save by renaming are seen too, and
+ * elsewhere by checking the file once a second. A rebuild that throws keeps
+ * the current rules.
+ */
+
+class PluginRegistryCell {
+public:
+    explicit PluginRegistryCell(std::shared_ptr<const PluginRegistry> registry);
+
+    PluginRegistryCell(const PluginRegistryCell&) = delete;
+    PluginRegistryCell& operator=(const PluginRegistryCell&) = delete;
+
+    // Starts at 1 and goes up by one per publish().
+    std::uint64_t generation() const { return generation_.load(std::memory_order_acquire); }
+    // The current registry and, in `generation`, the generation it belongs to.
+    std::shared_ptr<const PluginRegistry> load(std::uint64_t& generation) const;
+    // Returns the new generation.
+    std::uint64_t publish(std::shared_ptr<const PluginRegistry> registry);
+
+private:
+    mutable std::mutex mutex_;
+    std::shared_ptr<const PluginRegistry> registry_;
+    std::atomic<std::uint64_t> generation_{1};
+};
+
+class RulesWatcher {
+public:
+    // Builds the replacement registry on the watcher thread; throws to keep
+    // the current one.
+    using Rebuild = std::function<std::shared_ptr<const PluginRegistry>()>;
+
+    RulesWatcher(PluginRegistryCell& cell, Rebuild rebuild);
+    ~RulesWatcher();
+
+    RulesWatcher(const RulesWatcher&) = delete;
+    RulesWatcher& operator=(const RulesWatcher&) = delete;
+
+    // Either may be left out: an empty `rules_path` reloads on the trigger
+    // only, a `trigger_fd` of -1 on file changes only. The watcher drains
+    // the trigger descriptor. Returns false when the thread cannot start.
+    bool start(const std::string& rules_path, int trigger_fd);
+    void stop();
+    // One rebuild and publish on the calling thread. Returns false with the
+    // reason in `error` when the rebuild throws.
+    bool reload(std::string& error);
+
+private:
+    void run();
+    bool file_changed();
+
+    PluginRegistryCell& cell_;
+    Rebuild rebuild_;
+    std::string rules_path_;
+    int trigger_fd_ = -1;
+    int stop_pipe_[2] = {-1, -1};
+    int watch_fd_ = -1;
+    // mtime, size and inode of the rules file as last loaded.
+    std::string file_stamp_;
+    std::thread thread_;
+};
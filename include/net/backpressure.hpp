@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+
+/*
+ * Backpressure
+ *
+ * Hysteresis gate for pausing reads while too many bytes are queued toward a
+ * slow consumer. Reads pause once the queue reaches the high-water mark and
+ * resume only after it drains to the low-water mark, so a consumer sitting
+ * near one threshold does not flap the event registration.
+ *
+ * A high-water mark of 0 disables the gate.
+ */
+
+struct WaterMarks {
+    std::size_t high = 0;
+    std::size_t low = 0;
+
+    bool enabled() const { return high != 0; }
+};
+
+class BackpressureGate {
+public:
+    bool paused() const {
+        return paused_;
+    }
+
+    // Re-evaluates the gate for `queued` bytes; true when it changed state.
+    bool update(std::size_t queued, const WaterMarks& marks) {
+        const bool paused = paused_ ? marks.enabled() && queued > marks.low
+                                    : marks.enabled() && queued >= marks.high;
+        if (paused == paused_) return false;
+        paused_ = paused;
+        return true;
+    }
+
+private:
+    bool paused_ = false;
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * EventBackend
+ *
+ * Readiness multiplexer behind the transport core. Registrations are
+ * persistent: callers add an fd once, adjust its interest only when it
+ * changes, and remove it before close(). Each fd carries an opaque token
+ * that is handed back with every readiness event, so the core never has
+ * to map fds back to flows.
+ *
+ * Every backend reports level-style semantics to the caller. The
+ * edge-triggered epoll backend relies on the core draining recv/send/accept
+ * until EAGAIN and on EPOLL_CTL_MOD re-arming readiness when interest
+ * changes.
+ */
+
+enum class EventBackendKind {
+    Auto,
+    Poll,
+    Epoll,
+    EpollEdge,
+    IoUring,
+};
+
+constexpr std::uint32_t kInterestRead = 1U << 0U;
+constexpr std::uint32_t kInterestWrite = 1U << 1U;
+
+struct IoEvent {
+    std::uint64_t token = 0;
+    bool readable = false;
+    bool writable = false;
+    bool error = false;
+};
+
+class EventBackend {
+public:
+    virtual ~EventBackend() = default;
+
+    virtual const char* name() const = 0;
+    virtual bool add(int fd, std::uint64_t token, std::uint32_t interest) = 0;
+    virtual bool modify(int fd, std::uint64_t token, std::uint32_t interest) = 0;
+    virtual void remove(int fd) = 0;
+
+    // Blocks up to timeout_ms (-1 waits forever). Returns the number of
+    // events written to `events`, or -1 with errno set.
+    virtual int wait(std::vector<IoEvent>& events, int timeout_ms) = 0;
+};
+
+bool parse_event_backend(const std::string& name, EventBackendKind& kind);
+const char* event_backend_name(EventBackendKind kind);
+bool event_backend_available(EventBackendKind kind);
+std::unique_ptr<EventBackend> make_event_backend(EventBackendKind kind, std::string& error);
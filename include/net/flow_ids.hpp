@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+/*
+ * Flow ids
+ *
+ * Each worker hands out first, first + stride, first + 2 * stride, ... so
+ * ids stay unique across shards. The sequence wraps back to `first` before
+ * the 32-bit id would overflow, which keeps every id in the worker's own
+ * residue class and never yields 0: id 0's event tokens are the listen and
+ * shutdown descriptors. After a wrap, ids still held by a long-lived flow
+ * are skipped.
+ */
+class FlowIdSequence {
+public:
+    FlowIdSequence(std::uint32_t first, std::uint32_t stride)
+        : stride_(stride == 0 ? 1 : stride), first_(first == 0 ? stride_ : first), next_(first_) {}
+
+    // `live` is the worker's flow table, keyed by flow id.
+    template <typename FlowMap>
+    std::uint32_t take(const FlowMap& live) {
+        std::uint32_t id = advance();
+        while (live.count(id) != 0) id = advance();
+        return id;
+    }
+
+private:
+    std::uint32_t advance() {
+        const std::uint32_t id = next_;
+        next_ = next_ > std::numeric_limits<std::uint32_t>::max() - stride_ ? first_ : next_ + stride_;
+        return id;
+    }
+
+    std::uint32_t stride_;
+    std::uint32_t first_;
+    std::uint32_t next_;
+};
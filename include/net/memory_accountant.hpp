@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+/*
+ * MemoryAccountant
+ *
+ * Process-wide tally of the bytes the relay path holds in user space, split
+ * by what holds them. Each owner (a flow, or a worker for its audit backlog)
+ * keeps a MemoryCharge and reports its current size per category; only the
+ * difference reaches the shared totals, so reporting is cheap and the totals
+ * cannot drift as long as every owner releases its charge when it goes away.
+ *
+ * Totals are relaxed atomics shared by every worker. The budget is only
+ * reported here; the transport core decides what to do when it is exceeded.
+ */
+
+enum class MemoryCategory {
+    Pending,
+    OutQueue,
+    Candidate,
+    Audit,
+};
+
+constexpr std::size_t kMemoryCategoryCount = 4;
+
+struct MemoryCharge {
+    std::array<std::size_t, kMemoryCategoryCount> bytes{};
+
+    std::size_t total() const;
+};
+
+class MemoryAccountant {
+public:
+    explicit MemoryAccountant(std::size_t budget_bytes = 0);
+
+    MemoryAccountant(const MemoryAccountant&) = delete;
+    MemoryAccountant& operator=(const MemoryAccountant&) = delete;
+
+    // Sets the owner's charge for `category` to `bytes`.
+    void set(MemoryCharge& charge, MemoryCategory category, std::size_t bytes);
+    // Drops everything the owner is charged for.
+    void release(MemoryCharge& charge);
+
+    std::size_t total() const { return total_.load(std::memory_order_relaxed); }
+    std::size_t total(MemoryCategory category) const;
+    std::size_t peak() const { return peak_.load(std::memory_order_relaxed); }
+    std::size_t budget() const { return budget_; }
+    // A budget of 0 is unlimited.
+    bool over_budget() const { return budget_ != 0 && total() > budget_; }
+
+    std::string summary() const;
+
+private:
+    std::size_t budget_ = 0;
+    std::array<std::atomic<std::size_t>, kMemoryCategoryCount> totals_;
+    std::atomic<std::size_t> total_{0};
+    std::atomic<std::size_t> peak_{0};
+};
+
+const char* memory_category_name(MemoryCategory category);
@@ -2,9 +2,12 @@
 
 #include "ghostline/audit.hpp"
 #include "ghostline/plugin.hpp"
+#include "net/event_backend.hpp"
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <string>
+#include <vector>
 
 struct ProxyConfig {
     std::string listen_host = "127.0.0.1";
@@ -16,15 +19,35 @@ struct ProxyConfig {
     std::size_t max_chunk = 64 * 1024;
     std::size_t max_inspect_bytes = 64 * 1024;
     std::size_t max_plugin_buffer_bytes = 256 * 1024;
+    EventBackendKind event_backend = EventBackendKind::Auto;
+    unsigned workers = 1;
+    std::size_t zerocopy_min_bytes = 0;
+    bool splice_passthrough = true;
+    // Reads from a source pause once this many bytes are queued toward its
+    // peer (flow) or across every flow in the process (global), and resume
+    // at the low mark. A high mark of 0 disables that limit.
+    std::size_t flow_high_water_bytes = 4 * 1024 * 1024;
+    std::size_t flow_low_water_bytes = 1024 * 1024;
+    std::size_t global_high_water_bytes = 256 * 1024 * 1024;
+    std::size_t global_low_water_bytes = 128 * 1024 * 1024;
+    // Bytes the relay may hold in user space across every flow (pending,
+    // out queues, rewritten candidates, audit backlog). Past it the largest
+    // flows are forced to observe-only passthrough. 0 disables the budget.
+    std::size_t memory_budget_bytes = 512 * 1024 * 1024;
 
     std::string start_marker_hex;
     std::string end_marker_hex;
     std::string replacement_text;
     std::string raw_find_text;
+    // "find=replace" text pairs and "starthex:endhex[:replacement]" specs.
+    std::vector<std::string> substitution_specs;
+    std::vector<std::string> window_rule_specs;
     bool allow_size_mutation = true;
     bool rewrite_u32_prefix = false;
     bool raw_live_mode = false;
     std::size_t raw_chunk_bytes = 1024;
+    bool raw_stream_mode = false;
+    std::uint32_t raw_flush_ms = 50;
     bool mutate_client_to_server = true;
     bool mutate_server_to_client = true;
     std::size_t raw_review_threshold_bytes = 0;
@@ -36,7 +59,35 @@ struct ProxyConfig {
     std::string action_log_path = "ghostline_actions.log";
     std::string audit_json_path;
     std::string action_json_path;
+    // When set, audit events go here as binary records instead of the text
+    // and JSONL streams (see audit_binary.hpp).
+    std::string audit_binary_path;
+    // Per-plugin payload capture for audit events (--capture).
+    CapturePolicySet capture_policies;
     std::string review_queue_dir = "ghostline_review_queue";
+    std::size_t audit_queue_capacity = 8192;
+    std::size_t audit_batch_bytes = 64 * 1024;
+    std::uint32_t audit_flush_ms = 50;
+    AuditQueuePolicy audit_queue_policy = AuditQueuePolicy::Block;
+    // Audit and action log rotation (log_rotation.hpp); off while both
+    // limits are 0.
+    std::uint64_t audit_rotate_bytes = 0;
+    std::uint32_t audit_rotate_age_s = 0;
+    std::uint32_t audit_keep_segments = 0;
+    LogCompression audit_compression = LogCompression::None;
+    // Keep a sock_diag socket index (pid_search.hpp) and tag each accepted
+    // flow with the local PID that opened it, when there is one.
+    bool pid_index = false;
+    std::uint32_t pid_index_refresh_ms = 1000;
+    // Mutation rules hot reload (rules_reload.hpp), on SIGHUP or a change
+    // to rules_path. reload_rules returns the config rebuilt from the
+    // current rules and throws when it cannot; only the settings that make
+    // up MutationConfig are taken from it. Off while reload_rules is empty.
+    std::string rules_path;
+    std::function<ProxyConfig()> reload_rules;
+    // Prometheus metrics endpoint (relay_metrics.hpp): host:port or
+    // unix:<path>. Empty = off.
+    std::string metrics_endpoint;
 };
 
 int run_transport_core(const ProxyConfig& cfg);
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "ghostline/model.hpp"
+#include "net/memory_accountant.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Relay metrics
+ *
+ * Live counters for the transport core, rendered in the Prometheus text
+ * format and served by MetricsServer on a local TCP port or Unix socket.
+ *
+ * Every worker owns one WorkerMetrics block and is its only writer, so an
+ * update is a relaxed load and store of the worker's own cache line: no
+ * lock, no read-modify-write, nothing shared with other workers. A scrape
+ * reads every block with relaxed loads and sums them, so a scrape sees each
+ * counter at most one update behind and never slows the relay path.
+ * Queue depths come from the MemoryAccountant, which already keeps them as
+ * relaxed process-wide totals.
+ */
+
+constexpr std::size_t kValidationCodeCount = static_cast<std::size_t>(ValidationCode::MqttPublishReframed) + 1;
+
+struct alignas(64) WorkerMetrics {
+    std::atomic<std::uint64_t> active_flows{0};
+    // Bytes written toward each peer, sent or spliced; index by Direction.
+    std::array<std::atomic<std::uint64_t>, 2> relayed_bytes{};
+    std::array<std::atomic<std::uint64_t>, kValidationCodeCount> candidates{};
+    std::atomic<std::uint64_t> released_modified{0};
+    std::atomic<std::uint64_t> released_original{0};
+    std::atomic<std::uint64_t> observe_transitions{0};
+    std::atomic<std::uint64_t> framing_failures{0};
+    std::atomic<std::uint64_t> framing_buffer_ceilings{0};
+    // The worker's audit writer: records queued and lines dropped so far.
+    std::atomic<std::uint64_t> audit_backlog{0};
+    std::atomic<std::uint64_t> audit_dropped{0};
+    std::atomic<std::uint64_t> rules_generation{0};
+
+    // Single-writer updates; only the owning worker may call these.
+    static void add(std::atomic<std::uint64_t>& counter, std::uint64_t amount) {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+    static void set(std::atomic<std::uint64_t>& gauge, std::uint64_t value) {
+        gauge.store(value, std::memory_order_relaxed);
+    }
+};
+
+class RelayMetrics {
+public:
+    RelayMetrics(unsigned workers, const MemoryAccountant* memory);
+
+    RelayMetrics(const RelayMetrics&) = delete;
+    RelayMetrics& operator=(const RelayMetrics&) = delete;
+
+    WorkerMetrics& worker(unsigned index) { return *workers_[index]; }
+    unsigned workers() const { return static_cast<unsigned>(workers_.size()); }
+
+    // Prometheus text exposition format, version 0.0.4.
+    std::string render() const;
+
+private:
+    std::vector<std::unique_ptr<WorkerMetrics>> workers_;
+    const MemoryAccountant* memory_ = nullptr;
+};
+
+class MetricsServer {
+public:
+    explicit MetricsServer(const RelayMetrics& metrics);
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    // `endpoint` is host:port, or unix:<path> for a Unix socket (an existing
+    // socket file at the path is replaced). Serves GET /metrics over HTTP/1.0
+    // from its own thread. Returns false with the reason in `error`.
+    bool start(const std::string& endpoint, std::string& error);
+    void stop();
+    // The bound TCP port (useful with port 0), or 0 for a Unix socket.
+    std::uint16_t port() const { return port_; }
+
+private:
+    void run();
+    void serve(int client_fd);
+
+    const RelayMetrics& metrics_;
+    int listen_fd_ = -1;
+    int stop_pipe_[2] = {-1, -1};
+    std::uint16_t port_ = 0;
+    std::string unix_path_;
+    std::thread thread_;
+};
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "net/stream_buffer.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <sys/socket.h>
+#include <vector>
+
+/*
+ * Socket write path
+ *
+ * flush_chunks() drains a ChunkQueue with one sendmsg() per call across up to
+ * IOV_MAX queued chunks and accounts for partial writes by advancing the
+ * queue's front offset. Chunks of at least zerocopy_min_bytes are sent on
+ * their own with MSG_ZEROCOPY when the socket has SO_ZEROCOPY enabled; their
+ * storage is parked in ZeroCopyState until the kernel reports completion on
+ * the socket error queue (reap_zerocopy_completions).
+ *
+ * Passthrough flows skip user space entirely on Linux: splice_into_pipe()
+ * moves socket bytes into a per-direction pipe and splice_from_pipe() moves
+ * them on to the destination socket.
+ */
+
+struct IoCounters {
+    std::uint64_t send_calls = 0;
+    std::uint64_t sent_bytes = 0;
+    std::uint64_t would_block = 0;
+    std::uint64_t zerocopy_sends = 0;
+    std::uint64_t zerocopy_completions = 0;
+    std::uint64_t zerocopy_copied = 0;
+    std::uint64_t splice_calls = 0;
+    std::uint64_t spliced_bytes = 0;
+
+    void add(const IoCounters& other);
+    std::string summary() const;
+};
+
+struct ZeroCopyBuffer {
+    std::uint32_t last_sequence = 0;
+    ByteVec bytes;
+};
+
+struct ZeroCopyState {
+    bool enabled = false;
+    std::uint32_t next_sequence = 0;
+    std::deque<ZeroCopyBuffer> in_flight;
+};
+
+enum class FlushStatus {
+    Drained,
+    WouldBlock,
+    Failed,
+};
+
+struct SplicePipe {
+    int read_fd = -1;
+    int write_fd = -1;
+    std::size_t bytes = 0;
+    std::size_t capacity = 0;
+
+    bool open() const { return read_fd >= 0; }
+    bool full() const { return bytes >= capacity; }
+};
+
+enum class SpliceStatus {
+    Moved,
+    WouldBlock,
+    EndOfStream,
+    Failed,
+};
+
+// Flags for every send() and sendmsg(): MSG_NOSIGNAL where the platform has
+// it; elsewhere configure_send_socket() sets SO_NOSIGPIPE on the socket.
+#if defined(MSG_NOSIGNAL)
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif
+
+// Sets per-socket send options: SO_NOSIGPIPE where MSG_NOSIGNAL is missing,
+// and SO_ZEROCOPY when requested. Returns whether zero-copy is active.
+bool configure_send_socket(int fd, bool want_zerocopy);
+
+FlushStatus flush_chunks(int fd, ChunkQueue& queue, std::size_t zerocopy_min_bytes, ZeroCopyState& zerocopy, IoCounters& counters);
+
+// Drains MSG_ZEROCOPY completions from the socket error queue and releases
+// every buffer the kernel no longer references.
+void reap_zerocopy_completions(int fd, ZeroCopyState& zerocopy, IoCounters& counters);
+
+// Sockets closed while the kernel may still read their zero-copy buffers.
+// bury() takes the socket out of the caller's hands but keeps it open, with
+// its buffers, until reap() sees the last completion. A socket whose
+// completions have not all arrived after `linger_ms` is reset with
+// SO_LINGER 0, which discards what the kernel still queued, and only then
+// are its buffers freed. Sockets with nothing in flight close at once.
+class ZeroCopyGraveyard {
+public:
+    explicit ZeroCopyGraveyard(std::uint64_t linger_ms = 10000) : linger_ms_(linger_ms) {}
+    ~ZeroCopyGraveyard() { close_all(0); }
+
+    ZeroCopyGraveyard(const ZeroCopyGraveyard&) = delete;
+    ZeroCopyGraveyard& operator=(const ZeroCopyGraveyard&) = delete;
+
+    // Completions reaped later are added to `counters`, which must outlive
+    // the graveyard.
+    void bury(int fd, ZeroCopyState& zerocopy, IoCounters& counters);
+    void reap();
+    // Waits up to `wait_ms` for outstanding completions, then resets the rest.
+    void close_all(int wait_ms);
+    bool empty() const { return graves_.empty(); }
+    std::size_t size() const { return graves_.size(); }
+
+private:
+    struct Grave {
+        int fd = -1;
+        std::uint64_t deadline_ms = 0;
+        IoCounters* counters = nullptr;
+        ZeroCopyState zerocopy;
+    };
+
+    std::uint64_t linger_ms_;
+    std::vector<Grave> graves_;
+};
+
+bool zerocopy_supported();
+
+bool splice_supported();
+bool open_splice_pipe(SplicePipe& pipe);
+void close_splice_pipe(SplicePipe& pipe);
+
+// Fills the pipe from a socket until it is full or the socket would block.
+SpliceStatus splice_into_pipe(int fd, SplicePipe& pipe, IoCounters& counters);
+
+// Drains the pipe into a socket; Drained once the pipe is empty.
+FlushStatus splice_from_pipe(SplicePipe& pipe, int fd, IoCounters& counters);
@@ -4,19 +4,25 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <deque>
+#include <utility>
+#include <vector>
 #include <arpa/inet.h>
 
 /*
  * StreamBuffer
  *
  * Purpose:
- *  - Accumulate arbitrary TCP stream bytes
+ *  - Accumulate arbitrary TCP stream bytes between recv() and framing
  *  - Support peeking / consuming without corruption
- *  - Used ONLY between recv() and FrameExtractor
+ *  - Hand plugins one contiguous view of everything still buffered
  *
  * Invariants:
- *  - Data is always in network byte order
- *  - No framing logic here (that belongs in FrameExtractor)
+ *  - Live bytes are storage_[head_, storage_.size())
+ *  - consume() only advances head_; the dead prefix is reclaimed on append
+ *    once it is at least as large as the live region, so every byte is
+ *    moved at most once on average
+ *  - No framing logic here (that belongs in the plugin or FrameExtractor)
  */
 
 class StreamBuffer {
@@ -25,48 +31,213 @@ public:
 
     // Append raw bytes from recv()
     void append(const byte* data, size_t len) {
-        buf_.insert(buf_.end(), data, data + len);
+        if (len == 0) return;
+        if (head_ != 0 && head_ >= size()) compact();
+        storage_.insert(storage_.end(), data, data + len);
+    }
+
+    void append(ByteView bytes) {
+        append(bytes.data(), bytes.size());
     }
 
     // Current buffered byte count
     size_t size() const {
-        return buf_.size();
+        return storage_.size() - head_;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    const byte* data() const {
+        return storage_.data() + head_;
+    }
+
+    // Contiguous view of every buffered byte; invalidated by append/consume
+    ByteView view() const {
+        return ByteView(data(), size());
     }
 
     // Peek a network-order uint32 without consuming
     bool peek_u32(uint32_t& out) const {
-        if (buf_.size() < sizeof(uint32_t))
+        if (size() < sizeof(uint32_t))
             return false;
 
         uint32_t tmp;
-        std::memcpy(&tmp, buf_.data(), sizeof(uint32_t));
+        std::memcpy(&tmp, data(), sizeof(uint32_t));
         out = ntohl(tmp);
         return true;
     }
 
     // Check if N bytes are available
     bool can_read(size_t n) const {
-        return buf_.size() >= n;
+        return size() >= n;
     }
 
     // Consume N bytes (caller must ensure availability)
     void consume(size_t n) {
-        buf_.erase(buf_.begin(), buf_.begin() + n);
+        head_ += n;
+        if (head_ >= storage_.size()) clear();
     }
 
     // Take N bytes and consume them
     ByteVec take(size_t n) {
-        ByteVec out(buf_.begin(), buf_.begin() + n);
+        ByteVec out(data(), data() + n);
         consume(n);
         return out;
     }
 
-    // Clear buffer completely
+    // Move every buffered byte out, leaving the buffer empty
+    ByteVec take_all() {
+        ByteVec out;
+        if (head_ == 0) {
+            out.swap(storage_);
+        } else {
+            out.assign(data(), data() + size());
+        }
+        clear();
+        return out;
+    }
+
+    // Clear buffer completely (keeps capacity)
     void clear() {
-        buf_.clear();
+        storage_.clear();
+        head_ = 0;
     }
 
 private:
-    ByteVec buf_;
+    void compact() {
+        const size_t live = size();
+        if (live != 0) std::memmove(storage_.data(), data(), live);
+        storage_.resize(live);
+        head_ = 0;
+    }
+
+    ByteVec storage_;
+    size_t head_ = 0;
 };
 
+/*
+ * ChunkQueue
+ *
+ * FIFO of outbound byte chunks with a read offset into the front chunk, so a
+ * partial send() advances an index instead of erasing from the front. Small
+ * appends are coalesced into the tail chunk to keep the chunk count (and the
+ * number of send calls) low.
+ *
+ * Built with GHOSTLINE_PACKET_ARENA, chunks that are fully sent keep their
+ * storage on a short spare list and back the next chunk that is copied in,
+ * so a steady relay stops allocating a vector per chunk.
+ */
+
+class ChunkQueue {
+public:
+    static constexpr size_t kCoalesceBytes = 16 * 1024;
+#if defined(GHOSTLINE_PACKET_ARENA)
+    static constexpr size_t kSpareChunks = 2;
+#else
+    static constexpr size_t kSpareChunks = 0;
+#endif
+    // Larger chunks are freed rather than kept as spares.
+    static constexpr size_t kSpareChunkCapacity = 64 * 1024;
+
+    bool empty() const {
+        return chunks_.empty();
+    }
+
+    // Total unsent bytes across every chunk
+    size_t bytes() const {
+        return bytes_;
+    }
+
+    size_t chunk_count() const {
+        return chunks_.size();
+    }
+
+    void push(ByteView bytes) {
+        if (bytes.empty()) return;
+        if (!chunks_.empty() && chunks_.back().size() + bytes.size() <= kCoalesceBytes) {
+            ByteVec& tail = chunks_.back();
+            tail.insert(tail.end(), bytes.begin(), bytes.end());
+        } else if (!spare_.empty()) {
+            chunks_.push_back(std::move(spare_.back()));
+            spare_.pop_back();
+            chunks_.back().assign(bytes.begin(), bytes.end());
+        } else {
+            chunks_.push_back(bytes.to_vec());
+        }
+        bytes_ += bytes.size();
+    }
+
+    void push(ByteVec&& bytes) {
+        if (bytes.empty()) return;
+        if (!chunks_.empty() && chunks_.back().size() + bytes.size() <= kCoalesceBytes) {
+            push(ByteView(bytes));
+            return;
+        }
+        bytes_ += bytes.size();
+        chunks_.push_back(std::move(bytes));
+    }
+
+    // Unsent remainder of the front chunk
+    ByteView front() const {
+        const ByteVec& chunk = chunks_.front();
+        return ByteView(chunk.data() + front_offset_, chunk.size() - front_offset_);
+    }
+
+    // Unsent remainder of the index-th chunk
+    ByteView chunk(size_t index) const {
+        const ByteVec& selected = chunks_[index];
+        const size_t offset = index == 0 ? front_offset_ : 0;
+        return ByteView(selected.data() + offset, selected.size() - offset);
+    }
+
+    // Full size of the front chunk, including bytes already sent
+    size_t front_chunk_size() const {
+        return chunks_.front().size();
+    }
+
+    // Drop N sent bytes from the front, possibly spanning several chunks.
+    // Fully sent chunks are moved into `retired` when the caller must keep
+    // their storage alive (zero-copy sends).
+    void consume(size_t n, std::deque<ByteVec>* retired = nullptr) {
+        bytes_ -= n;
+        while (n > 0) {
+            const size_t remaining = chunks_.front().size() - front_offset_;
+            if (n < remaining) {
+                front_offset_ += n;
+                return;
+            }
+            n -= remaining;
+            if (retired != nullptr) {
+                retired->push_back(std::move(chunks_.front()));
+            } else {
+                recycle(chunks_.front());
+            }
+            chunks_.pop_front();
+            front_offset_ = 0;
+        }
+    }
+
+    void clear() {
+        chunks_.clear();
+        front_offset_ = 0;
+        bytes_ = 0;
+    }
+
+    size_t spare_count() const {
+        return spare_.size();
+    }
+
+private:
+    void recycle(ByteVec& chunk) {
+        if (spare_.size() >= kSpareChunks || chunk.capacity() > kSpareChunkCapacity) return;
+        chunk.clear();
+        spare_.push_back(std::move(chunk));
+    }
+
+    std::deque<ByteVec> chunks_;
+    std::vector<ByteVec> spare_;
+    size_t front_offset_ = 0;
+    size_t bytes_ = 0;
+};
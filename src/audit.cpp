@@ -1,87 +1,91 @@
 #include "ghostline/audit.hpp"
+#include "ghostline/audit_binary.hpp"
+#include "ghostline/labels.hpp"
 #include "ghostline/operator_state.hpp"
 
 #include <chrono>
-#include <fstream>
-#include <iomanip>
 #include <sstream>
 
 namespace {
 
-std::string direction_name(Direction direction) {
-    return direction == Direction::ClientToServer ? "client_to_server" : "server_to_client";
-}
+// Event lines are built by appending to one string reserved up front, so a
+// line costs a single allocation however many fields it carries.
+constexpr std::size_t kEventLineOverhead = 256;
 
-std::string flag_name(FlowFlag flag) {
-    switch (flag) {
-        case FlowFlag::ObserveOnly: return "observe-only";
-        case FlowFlag::AllowSizeMutated: return "allow-size-mutated";
-        case FlowFlag::PidDriftRisk: return "pid-drift-risk";
+void append_hex(std::string& out, ByteView bytes) {
+    static const char kDigits[] = "0123456789abcdef";
+    const std::size_t start = out.size();
+    out.resize(start + bytes.size() * 2);
+    for (std::size_t i = 0; i < bytes.size(); ++i) {
+        out[start + i * 2] = kDigits[bytes[i] >> 4];
+        out[start + i * 2 + 1] = kDigits[bytes[i] & 0x0f];
     }
-    return "unknown";
 }
 
-std::string stage_name(WorkflowStage stage) {
-    switch (stage) {
-        case WorkflowStage::Observe: return "observe";
-        case WorkflowStage::Triggered: return "triggered";
-        case WorkflowStage::Framed: return "framed";
-        case WorkflowStage::CandidateBuilt: return "candidate-built";
-        case WorkflowStage::CandidateReviewed: return "candidate-reviewed";
-        case WorkflowStage::ReleasedOriginal: return "released-original";
-        case WorkflowStage::ReleasedModified: return "released-modified";
-        case WorkflowStage::ObserveTransition: return "observe-transition";
-        case WorkflowStage::ActionCreated: return "action-created";
-    }
-    return "unknown";
+void append_number(std::string& out, std::uint64_t value) {
+    char digits[20];
+    std::size_t count = 0;
+    do {
+        digits[count++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (count != 0) out.push_back(digits[--count]);
 }
 
-std::string bytes_to_hex(const ByteVec& bytes) {
-    std::ostringstream out;
-    out << std::hex << std::setfill('0');
-    for (ByteVec::size_type i = 0; i < bytes.size(); ++i) {
-        out << std::setw(2) << static_cast<unsigned>(bytes[i]);
-    }
-    return out.str();
+// Fixed-width lowercase hex, as xxhsum prints it.
+void append_hash(std::string& out, std::uint64_t value) {
+    static const char kDigits[] = "0123456789abcdef";
+    for (int shift = 60; shift >= 0; shift -= 4) out.push_back(kDigits[(value >> shift) & 0x0f]);
 }
 
-std::string format_flags(const std::vector<FlowFlag>& flags) {
-    std::ostringstream out;
+void append_flags(std::string& out, const std::vector<FlowFlag>& flags) {
     for (std::size_t i = 0; i < flags.size(); ++i) {
-        if (i != 0) out << ",";
-        out << flag_name(flags[i]);
+        if (i != 0) out.push_back(',');
+        out.append(flag_name(flags[i]));
     }
-    return out.str();
 }
 
-std::string json_escape(const std::string& value) {
-    std::ostringstream out;
+void append_json_escaped(std::string& out, const std::string& value) {
     for (char ch : value) {
         switch (ch) {
-            case '\\': out << "\\\\"; break;
-            case '"': out << "\\\""; break;
-            case '\n': out << "\\n"; break;
-            case '\r': out << "\\r"; break;
-            case '\t': out << "\\t"; break;
-            default: out << ch; break;
+            case '\\': out.append("\\\\"); break;
+            case '"': out.append("\\\""); break;
+            case '\n': out.append("\\n"); break;
+            case '\r': out.append("\\r"); break;
+            case '\t': out.append("\\t"); break;
+            default: out.push_back(ch); break;
         }
     }
-    return out.str();
 }
 
-std::string direction_json(Direction direction) {
-    return direction == Direction::ClientToServer ? "client_to_server" : "server_to_client";
+void append_json_string(std::string& out, const char* key, const std::string& value) {
+    out.append(",\"").append(key).append("\":\"");
+    append_json_escaped(out, value);
+    out.push_back('"');
+}
+
+// IDs are rendered straight into the JSON line; only a plugin name with
+// characters that need escaping sends them through a second pass.
+void escape_json_tail(std::string& out, std::size_t start) {
+    if (out.find_first_of("\\\"\n\r\t", start) == std::string::npos) return;
+    const std::string raw = out.substr(start);
+    out.resize(start);
+    append_json_escaped(out, raw);
 }
 
-std::string flags_to_json(const std::vector<FlowFlag>& flags) {
-    std::ostringstream out;
-    out << "[";
+std::string json_escape(const std::string& value) {
+    std::string out;
+    append_json_escaped(out, value);
+    return out;
+}
+
+void append_flags_json(std::string& out, const std::vector<FlowFlag>& flags) {
+    out.push_back('[');
     for (std::size_t i = 0; i < flags.size(); ++i) {
-        if (i != 0) out << ",";
-        out << "\"" << flag_name(flags[i]) << "\"";
+        if (i != 0) out.push_back(',');
+        out.append("\"").append(flag_name(flags[i])).append("\"");
     }
-    out << "]";
-    return out.str();
+    out.push_back(']');
 }
 
 std::uint64_t now_ns() {
@@ -89,95 +93,240 @@ std::uint64_t now_ns() {
     return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
 }
 
-void append_line(const std::string& path, const std::string& line) {
-    std::ofstream out(path.c_str(), std::ios::app);
-    out << line << "\n";
+} // namespace
+
+std::size_t audit_line_reserve(const AuditEvent& event, const PayloadCapture& payload) {
+    const std::size_t hex_bytes = 2 * (payload.original.size() + payload.modified.size());
+    // Each ID is a short prefix, the plugin name and two numbers.
+    return kEventLineOverhead + 3 * event.plugin_name.size() + event.message.size() + hex_bytes;
 }
 
-} // namespace
+void append_audit_line(std::string& line, const AuditEvent& event, const PayloadCapture& payload) {
+    line.append("ts=");
+    append_number(line, event.timestamp_ns);
+    line.append(" event_id=");
+    append_event_id(line, event);
+    line.append(" trigger_id=");
+    if (event.trigger_sequence != 0) append_trigger_id(line, event.flow_id, event.direction, event.plugin_name, event.trigger_sequence);
+    line.append(" candidate_id=");
+    if (event.candidate_sequence != 0) append_candidate_id(line, event.flow_id, event.direction, event.plugin_name, event.candidate_sequence);
+    line.append(" flow=");
+    append_number(line, event.flow_id);
+    line.append(" seq=");
+    append_number(line, event.sequence);
+    line.append(" dir=").append(direction_name(event.direction));
+    line.append(" plugin=").append(event.plugin_name);
+    line.append(" type=").append(audit_event_type_name(event.type));
+    line.append(" stage=").append(stage_name(event.workflow_stage));
+    line.append(" flags=");
+    append_flags(line, event.flags);
+    line.append(" message=\"").append(event.message).append("\"");
+    if (payload.form == CaptureForm::Full || payload.form == CaptureForm::Head) {
+        line.append(" original=");
+        append_hex(line, payload.original);
+        line.append(" modified=");
+        append_hex(line, payload.modified);
+    } else if (payload.form == CaptureForm::Hash) {
+        line.append(" original_xxh64=");
+        append_hash(line, payload.original_hash);
+        line.append(" modified_xxh64=");
+        append_hash(line, payload.modified_hash);
+    }
+    if (payload.form != CaptureForm::Full) {
+        line.append(" original_len=");
+        append_number(line, payload.original_len);
+        line.append(" modified_len=");
+        append_number(line, payload.modified_len);
+    }
+}
+
+void append_audit_json(std::string& json, const AuditEvent& event, const PayloadCapture& payload) {
+    json.append("{\"ts\":");
+    append_number(json, event.timestamp_ns);
+    json.append(",\"event_id\":\"");
+    std::size_t start = json.size();
+    append_event_id(json, event);
+    escape_json_tail(json, start);
+    json.append("\",\"trigger_id\":\"");
+    start = json.size();
+    if (event.trigger_sequence != 0) append_trigger_id(json, event.flow_id, event.direction, event.plugin_name, event.trigger_sequence);
+    escape_json_tail(json, start);
+    json.append("\",\"candidate_id\":\"");
+    start = json.size();
+    if (event.candidate_sequence != 0) append_candidate_id(json, event.flow_id, event.direction, event.plugin_name, event.candidate_sequence);
+    escape_json_tail(json, start);
+    json.append("\",\"flow\":");
+    append_number(json, event.flow_id);
+    json.append(",\"seq\":");
+    append_number(json, event.sequence);
+    json.append(",\"dir\":\"").append(direction_name(event.direction)).append("\"");
+    append_json_string(json, "plugin", event.plugin_name);
+    json.append(",\"type\":\"").append(audit_event_type_name(event.type)).append("\"");
+    json.append(",\"stage\":\"").append(stage_name(event.workflow_stage)).append("\"");
+    json.append(",\"flags\":");
+    append_flags_json(json, event.flags);
+    append_json_string(json, "message", event.message);
+    if (payload.form == CaptureForm::Full || payload.form == CaptureForm::Head) {
+        json.append(",\"original\":\"");
+        append_hex(json, payload.original);
+        json.append("\",\"modified\":\"");
+        append_hex(json, payload.modified);
+        json.append("\"");
+    } else if (payload.form == CaptureForm::Hash) {
+        json.append(",\"original_xxh64\":\"");
+        append_hash(json, payload.original_hash);
+        json.append("\",\"modified_xxh64\":\"");
+        append_hash(json, payload.modified_hash);
+        json.append("\"");
+    }
+    if (payload.form != CaptureForm::Full) {
+        json.append(",\"original_len\":");
+        append_number(json, payload.original_len);
+        json.append(",\"modified_len\":");
+        append_number(json, payload.modified_len);
+    }
+    json.push_back('}');
+}
 
 AuditTrail::AuditTrail(const std::string& audit_log_path,
                        const std::string& action_log_path,
                        const std::string& audit_json_path,
                        const std::string& action_json_path,
-                       const std::string& review_queue_dir)
+                       const std::string& review_queue_dir,
+                       const AuditWriterOptions& options,
+                       const std::string& audit_binary_path)
     : audit_log_path_(audit_log_path),
       action_log_path_(action_log_path),
       audit_json_path_(audit_json_path),
       action_json_path_(action_json_path),
-      review_queue_dir_(review_queue_dir) {}
+      review_queue_dir_(review_queue_dir),
+      audit_binary_path_(audit_binary_path),
+      writer_(options) {
+    // Binary records replace the text and JSONL event streams; action items
+    // keep their own streams either way.
+    if (audit_binary_path_.empty()) {
+        audit_log_stream_ = writer_.open_stream(audit_log_path_);
+        audit_json_stream_ = writer_.open_stream(audit_json_path_);
+    } else {
+        audit_binary_stream_ = writer_.open_stream(audit_binary_path_);
+    }
+    action_log_stream_ = writer_.open_stream(action_log_path_);
+    action_json_stream_ = writer_.open_stream(action_json_path_);
+}
 
-void AuditTrail::record_event(const AuditEvent& event) {
-    std::ostringstream line;
-    line << "ts=" << event.timestamp_ns
-         << " event_id=" << event.event_id
-         << " trigger_id=" << event.trigger_id
-         << " candidate_id=" << event.candidate_id
-         << " flow=" << event.flow_id
-         << " seq=" << event.sequence
-         << " dir=" << direction_name(event.direction)
-         << " plugin=" << event.plugin_name
-         << " type=" << event.event_type
-         << " stage=" << stage_name(event.workflow_stage)
-         << " flags=" << format_flags(event.flags)
-         << " message=\"" << event.message << "\""
-         << " original=" << bytes_to_hex(event.original_bytes)
-         << " modified=" << bytes_to_hex(event.modified_bytes);
-    append_line(audit_log_path_, line.str());
-
-    if (!audit_json_path_.empty()) {
-        std::ostringstream json;
-        json << "{"
-             << "\"ts\":" << event.timestamp_ns
-             << ",\"event_id\":\"" << json_escape(event.event_id) << "\""
-             << ",\"trigger_id\":\"" << json_escape(event.trigger_id) << "\""
-             << ",\"candidate_id\":\"" << json_escape(event.candidate_id) << "\""
-             << ",\"flow\":" << event.flow_id
-             << ",\"seq\":" << event.sequence
-             << ",\"dir\":\"" << direction_json(event.direction) << "\""
-             << ",\"plugin\":\"" << json_escape(event.plugin_name) << "\""
-             << ",\"type\":\"" << json_escape(event.event_type) << "\""
-             << ",\"stage\":\"" << stage_name(event.workflow_stage) << "\""
-             << ",\"flags\":" << flags_to_json(event.flags)
-             << ",\"message\":\"" << json_escape(event.message) << "\""
-             << ",\"original\":\"" << bytes_to_hex(event.original_bytes) << "\""
-             << ",\"modified\":\"" << bytes_to_hex(event.modified_bytes) << "\""
-             << "}";
-        append_line(audit_json_path_, json.str());
+AuditTrail::~AuditTrail() {
+    const AuditWriterStats totals = writer_.stats();
+    if (totals.dropped != 0 || totals.summarized != 0) {
+        std::ostringstream line;
+        line << "ts=" << now_ns()
+             << " type=audit-backpressure"
+             << " policy=" << audit_queue_policy_name(writer_.options().full_policy)
+             << " dropped=" << totals.dropped
+             << " summarized=" << totals.summarized;
+        writer_.push_line(audit_log_stream_, line.str());
+    }
+}
+
+void AuditTrail::flush() {
+    writer_.flush();
+}
+
+AuditWriterStats AuditTrail::stats() const {
+    return writer_.stats();
+}
+
+void AuditTrail::set_capture_policies(const CapturePolicySet& policies) {
+    capture_ = policies;
+    capture_all_full_ = capture_.all_full();
+    sample_counters_.assign(capture_.policies.size() + 1, 0);
+}
+
+CaptureForm AuditTrail::capture_form(const AuditEvent& event, bool capture_full, std::size_t& head_bytes) {
+    // Under the summary policy a saturated queue sheds the payloads, which
+    // dominate record size, instead of whole events.
+    if (writer_.under_pressure()) {
+        writer_.note_summarized();
+        return CaptureForm::Lengths;
+    }
+    if (capture_full || capture_all_full_) return CaptureForm::Full;
+    if (event.original_bytes.empty() && event.modified_bytes.empty()) return CaptureForm::Full;
+
+    const int index = capture_.find(event.plugin_name);
+    const CapturePolicy& policy = index < 0 ? capture_.fallback : capture_.policies[static_cast<std::size_t>(index)];
+    switch (policy.mode) {
+        case CaptureMode::Full:
+            return CaptureForm::Full;
+        case CaptureMode::Head:
+            head_bytes = policy.head_bytes;
+            return CaptureForm::Head;
+        case CaptureMode::Sample: {
+            std::uint64_t& seen = sample_counters_[static_cast<std::size_t>(index + 1)];
+            return seen++ % policy.sample_every == 0 ? CaptureForm::Full : CaptureForm::Lengths;
+        }
+        case CaptureMode::Hash:
+            return CaptureForm::Hash;
+    }
+    return CaptureForm::Full;
+}
+
+void AuditTrail::record_event(const AuditEvent& event, bool capture_full) {
+    std::size_t head_bytes = 0;
+    const CaptureForm form = capture_form(event, capture_full, head_bytes);
+    const PayloadCapture payload = capture_payload(form, event.original_bytes, event.modified_bytes, head_bytes);
+
+    if (audit_binary_stream_ >= 0) {
+        std::string record;
+        append_audit_record(record, event, payload);
+        writer_.push_record(audit_binary_stream_, std::move(record));
+        return;
+    }
+
+    const std::size_t reserve = audit_line_reserve(event, payload);
+    if (audit_log_stream_ >= 0) {
+        std::string line;
+        line.reserve(reserve);
+        append_audit_line(line, event, payload);
+        writer_.push_line(audit_log_stream_, std::move(line));
+    }
+
+    if (audit_json_stream_ >= 0) {
+        std::string json;
+        json.reserve(reserve);
+        append_audit_json(json, event, payload);
+        writer_.push_line(audit_json_stream_, std::move(json));
     }
 }
 
 void AuditTrail::record_candidate(const FlowContext& flow, Direction direction, const Candidate& candidate, const CandidateDecision& decision) {
-    AuditEvent event;
-    event.event_id = candidate.candidate_id.empty() ? "" : candidate.candidate_id + "-result";
+    AuditEvent& event = next_event();
+    event.type = AuditEventType::Candidate;
+    event.trigger_sequence = candidate.trigger_sequence;
+    event.candidate_sequence = candidate.candidate_sequence;
     event.flow_id = flow.flow_id;
     event.direction = direction;
     event.plugin_name = candidate.plugin_name;
-    event.event_type = "candidate";
-    event.message = candidate.note
-        + " validation=" + decision.validation_label
-        + " detail=" + decision.validation_detail
-        + " fallback=" + decision.fallback_reason;
-    event.trigger_id = candidate.trigger_id;
-    event.candidate_id = candidate.candidate_id;
+    event.message.assign(candidate.note);
+    event.message.append(" validation=").append(validation_label(decision.validation));
+    event.message.append(" detail=").append(validation_detail(decision));
+    event.message.append(" fallback=").append(fallback_reason(decision.validation));
     event.original_bytes = candidate.original_bytes;
-    event.modified_bytes = candidate.modified_bytes;
+    event.modified_bytes = candidate.modified_bytes();
     event.flags = flow.flags;
     event.workflow_stage = decision.release == CandidateRelease::ReleaseModified
         ? WorkflowStage::ReleasedModified
         : WorkflowStage::ReleasedOriginal;
     event.sequence = flow.event_sequence;
     event.timestamp_ns = now_ns();
-    record_event(event);
+    // Review works from these bytes, so no capture policy trims them.
+    record_event(event, decision.create_action_item);
 }
 
 void AuditTrail::record_observe_transition(const FlowContext& flow, Direction direction, const std::string& reason) {
-    AuditEvent event;
-    event.event_id = "event-" + std::to_string(flow.flow_id) + "-observe-transition";
+    AuditEvent& event = next_event();
+    event.type = AuditEventType::ObserveTransition;
     event.flow_id = flow.flow_id;
     event.direction = direction;
     event.plugin_name = flow.active_plugin;
-    event.event_type = "observe-transition";
     event.message = reason;
     event.flags = flow.flags;
     event.workflow_stage = WorkflowStage::ObserveTransition;
@@ -197,9 +346,9 @@ void AuditTrail::save_action_item(const ActionItem& item) {
          << " stage=" << stage_name(item.workflow_stage)
          << " title=\"" << item.title << "\""
          << " detail=\"" << item.detail << "\"";
-    append_line(action_log_path_, line.str());
+    writer_.push_line(action_log_stream_, line.str());
 
-    if (!action_json_path_.empty()) {
+    if (action_json_stream_ >= 0) {
         std::ostringstream json;
         json << "{"
              << "\"ts\":" << item.created_at_ns
@@ -212,10 +361,13 @@ void AuditTrail::save_action_item(const ActionItem& item) {
              << ",\"title\":\"" << json_escape(item.title) << "\""
              << ",\"detail\":\"" << json_escape(item.detail) << "\""
              << "}";
-        append_line(action_json_path_, json.str());
+        writer_.push_line(action_json_stream_, json.str());
     }
 
     if (!review_queue_dir_.empty()) {
-        save_review_item(review_queue_dir_, item);
+        writer_.post([this, item]() {
+            if (!review_journal_) review_journal_ = ReviewJournal::for_dir(review_queue_dir_);
+            review_journal_->put(item);
+        });
     }
 }
@@ -0,0 +1,321 @@
+#include "ghostline/audit_binary.hpp"
+#include "ghostline/audit.hpp"
+#include "ghostline/log_rotation.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Fixed-size body fields ahead of the flag list.
+constexpr std::size_t kFixedBodyBytes = 8 + 8 + 8 + 8 + 4 + 1 + 1 + 1 + 1 + 1;
+// Exported lines are handed to write() in batches of about this size.
+constexpr std::size_t kExportBatchBytes = 1 << 20;
+
+void put_u8(std::string& out, std::uint8_t value) {
+    out.push_back(static_cast<char>(value));
+}
+
+void put_le(std::string& out, std::uint64_t value, std::size_t width) {
+    for (std::size_t i = 0; i < width; ++i) out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+}
+
+void put_bytes(std::string& out, const void* data, std::size_t size) {
+    if (size != 0) out.append(static_cast<const char*>(data), size);
+}
+
+// Bounds-checked little-endian reader over one record body.
+class BodyReader {
+public:
+    explicit BodyReader(ByteView body) : body_(body) {}
+
+    bool u8(std::uint8_t& value) {
+        if (remaining() < 1) return false;
+        value = body_[offset_++];
+        return true;
+    }
+
+    bool le(std::uint64_t& value, std::size_t width) {
+        if (remaining() < width) return false;
+        value = 0;
+        for (std::size_t i = 0; i < width; ++i) value |= static_cast<std::uint64_t>(body_[offset_ + i]) << (8 * i);
+        offset_ += width;
+        return true;
+    }
+
+    bool view(std::size_t size, ByteView& value) {
+        if (remaining() < size) return false;
+        value = body_.subview(offset_, size);
+        offset_ += size;
+        return true;
+    }
+
+    bool text(std::size_t size, std::string& value) {
+        ByteView bytes;
+        if (!view(size, bytes)) return false;
+        value.assign(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+        return true;
+    }
+
+    std::size_t remaining() const { return body_.size() - offset_; }
+
+private:
+    ByteView body_;
+    std::size_t offset_ = 0;
+};
+
+bool decode_body(ByteView body, DecodedAuditRecord& record) {
+    BodyReader in(body);
+    AuditEvent& event = record.event;
+    std::uint64_t ts = 0;
+    std::uint64_t sequence = 0;
+    std::uint64_t trigger_sequence = 0;
+    std::uint64_t candidate_sequence = 0;
+    std::uint64_t flow_id = 0;
+    std::uint8_t type = 0;
+    std::uint8_t direction = 0;
+    std::uint8_t stage = 0;
+    std::uint8_t form = 0;
+    std::uint8_t flag_count = 0;
+    if (!in.le(ts, 8) || !in.le(sequence, 8) || !in.le(trigger_sequence, 8) || !in.le(candidate_sequence, 8) || !in.le(flow_id, 4)) return false;
+    if (!in.u8(type) || !in.u8(direction) || !in.u8(stage) || !in.u8(form) || !in.u8(flag_count)) return false;
+    if (type > static_cast<std::uint8_t>(AuditEventType::RulesReloaded)) return false;
+    if (direction > static_cast<std::uint8_t>(Direction::ServerToClient)) return false;
+    if (stage > static_cast<std::uint8_t>(WorkflowStage::ActionCreated)) return false;
+    if (form > static_cast<std::uint8_t>(CaptureForm::Hash)) return false;
+
+    event.timestamp_ns = ts;
+    event.sequence = sequence;
+    event.trigger_sequence = trigger_sequence;
+    event.candidate_sequence = candidate_sequence;
+    event.flow_id = static_cast<std::uint32_t>(flow_id);
+    event.type = static_cast<AuditEventType>(type);
+    event.direction = static_cast<Direction>(direction);
+    event.workflow_stage = static_cast<WorkflowStage>(stage);
+
+    event.flags.clear();
+    for (std::uint8_t i = 0; i < flag_count; ++i) {
+        std::uint8_t flag = 0;
+        if (!in.u8(flag) || flag > static_cast<std::uint8_t>(FlowFlag::PidDriftRisk)) return false;
+        event.flags.push_back(static_cast<FlowFlag>(flag));
+    }
+
+    std::uint64_t plugin_len = 0;
+    std::uint64_t message_len = 0;
+    std::uint64_t original_len = 0;
+    std::uint64_t modified_len = 0;
+    if (!in.le(plugin_len, 2) || !in.text(plugin_len, event.plugin_name)) return false;
+    if (!in.le(message_len, 4) || !in.text(message_len, event.message)) return false;
+    if (!in.le(original_len, 4) || !in.le(modified_len, 4)) return false;
+    PayloadCapture& payload = record.payload;
+    payload = PayloadCapture();
+    payload.form = static_cast<CaptureForm>(form);
+    payload.original_len = original_len;
+    payload.modified_len = modified_len;
+
+    std::uint64_t kept_original = original_len;
+    std::uint64_t kept_modified = modified_len;
+    switch (payload.form) {
+        case CaptureForm::Head:
+            if (!in.le(kept_original, 4) || !in.le(kept_modified, 4)) return false;
+            if (kept_original > original_len || kept_modified > modified_len) return false;
+            [[fallthrough]];
+        case CaptureForm::Full:
+            if (!in.view(kept_original, payload.original) || !in.view(kept_modified, payload.modified)) return false;
+            break;
+        case CaptureForm::Hash:
+            if (!in.le(payload.original_hash, 8) || !in.le(payload.modified_hash, 8)) return false;
+            break;
+        case CaptureForm::Lengths:
+            break;
+    }
+    event.original_bytes = payload.original;
+    event.modified_bytes = payload.modified;
+    return in.remaining() == 0;
+}
+
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd_ < 0) throw std::runtime_error("failed to open binary audit file " + path + ": " + std::strerror(errno));
+        struct stat info {};
+        if (::fstat(fd_, &info) != 0) throw std::runtime_error("failed to stat binary audit file " + path);
+        size_ = static_cast<std::size_t>(info.st_size);
+        if (size_ == 0) return;
+        void* mapped = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+        if (mapped == MAP_FAILED) throw std::runtime_error("failed to map binary audit file " + path + ": " + std::strerror(errno));
+        data_ = static_cast<const byte*>(mapped);
+        ::madvise(mapped, size_, MADV_SEQUENTIAL);
+    }
+
+    ~MappedFile() {
+        if (data_ != nullptr) ::munmap(const_cast<byte*>(data_), size_);
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ByteView view() const { return ByteView(data_, size_); }
+
+private:
+    int fd_ = -1;
+    const byte* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+// Truncating output file that is written in large batches.
+class ExportSink {
+public:
+    explicit ExportSink(const std::string& path) {
+        if (path.empty()) return;
+        fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd_ < 0) throw std::runtime_error("failed to open export output " + path + ": " + std::strerror(errno));
+        buffer_.reserve(kExportBatchBytes + kExportBatchBytes / 4);
+    }
+
+    ~ExportSink() {
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    ExportSink(const ExportSink&) = delete;
+    ExportSink& operator=(const ExportSink&) = delete;
+
+    bool open() const { return fd_ >= 0; }
+    std::string& buffer() { return buffer_; }
+
+    void end_line() {
+        buffer_.push_back('\n');
+        if (buffer_.size() >= kExportBatchBytes) write_out();
+    }
+
+    void write_out() {
+        std::size_t written = 0;
+        while (fd_ >= 0 && written < buffer_.size()) {
+            const ssize_t n = ::write(fd_, buffer_.data() + written, buffer_.size() - written);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) throw std::runtime_error(std::string("failed to write export output: ") + std::strerror(errno));
+            written += static_cast<std::size_t>(n);
+        }
+        buffer_.clear();
+    }
+
+private:
+    int fd_ = -1;
+    std::string buffer_;
+};
+
+} // namespace
+
+void append_audit_record(std::string& out, const AuditEvent& event, const PayloadCapture& payload) {
+    std::size_t tail = payload.original.size() + payload.modified.size();
+    if (payload.form == CaptureForm::Head || payload.form == CaptureForm::Hash) tail += payload.form == CaptureForm::Head ? 8 : 16;
+    const std::size_t body = kFixedBodyBytes + event.flags.size() + 2 + event.plugin_name.size() + 4 + event.message.size() + 8 + tail;
+    out.reserve(out.size() + kAuditRecordHeaderBytes + body);
+
+    put_bytes(out, kAuditRecordTag, sizeof(kAuditRecordTag));
+    put_le(out, body, 4);
+    put_le(out, event.timestamp_ns, 8);
+    put_le(out, event.sequence, 8);
+    put_le(out, event.trigger_sequence, 8);
+    put_le(out, event.candidate_sequence, 8);
+    put_le(out, event.flow_id, 4);
+    put_u8(out, static_cast<std::uint8_t>(event.type));
+    put_u8(out, static_cast<std::uint8_t>(event.direction));
+    put_u8(out, static_cast<std::uint8_t>(event.workflow_stage));
+    put_u8(out, static_cast<std::uint8_t>(payload.form));
+    put_u8(out, static_cast<std::uint8_t>(event.flags.size()));
+    for (std::size_t i = 0; i < event.flags.size(); ++i) put_u8(out, static_cast<std::uint8_t>(event.flags[i]));
+    put_le(out, event.plugin_name.size(), 2);
+    put_bytes(out, event.plugin_name.data(), event.plugin_name.size());
+    put_le(out, event.message.size(), 4);
+    put_bytes(out, event.message.data(), event.message.size());
+    put_le(out, payload.original_len, 4);
+    put_le(out, payload.modified_len, 4);
+    if (payload.form == CaptureForm::Head) {
+        put_le(out, payload.original.size(), 4);
+        put_le(out, payload.modified.size(), 4);
+    }
+    if (payload.form == CaptureForm::Hash) {
+        put_le(out, payload.original_hash, 8);
+        put_le(out, payload.modified_hash, 8);
+    }
+    put_bytes(out, payload.original.data(), payload.original.size());
+    put_bytes(out, payload.modified.data(), payload.modified.size());
+}
+
+AuditRecordStatus decode_audit_record(ByteView data, std::size_t& offset, DecodedAuditRecord& record) {
+    if (offset >= data.size()) return AuditRecordStatus::End;
+    const std::size_t available = data.size() - offset;
+    if (available < kAuditRecordHeaderBytes) return AuditRecordStatus::Truncated;
+    if (std::memcmp(data.data() + offset, kAuditRecordTag, sizeof(kAuditRecordTag)) != 0) return AuditRecordStatus::Corrupt;
+
+    std::size_t body_len = 0;
+    for (std::size_t i = 0; i < 4; ++i) body_len |= static_cast<std::size_t>(data[offset + 4 + i]) << (8 * i);
+    if (available - kAuditRecordHeaderBytes < body_len) return AuditRecordStatus::Truncated;
+    if (!decode_body(data.subview(offset + kAuditRecordHeaderBytes, body_len), record)) return AuditRecordStatus::Corrupt;
+    offset += kAuditRecordHeaderBytes + body_len;
+    return AuditRecordStatus::Ok;
+}
+
+AuditExportResult export_audit_binary(const std::string& binary_path, const std::string& text_path, const std::string& json_path) {
+    std::vector<std::string> segments = list_log_segments(binary_path);
+    // A missing path still goes through MappedFile for its error message.
+    if (segments.empty()) segments.push_back(binary_path);
+    ExportSink text(text_path);
+    ExportSink json(json_path);
+
+    AuditExportResult result;
+    DecodedAuditRecord record;
+    for (std::size_t i = 0; i < segments.size() && result.status == AuditRecordStatus::End; ++i) {
+        // Rotation falls between whole batches, so every segment starts on
+        // a record boundary. Compressed segments are inflated into memory.
+        const std::string& segment = segments[i];
+        std::unique_ptr<MappedFile> mapped;
+        std::string inflated;
+        ByteView data;
+        if (segment.size() > 3 && segment.compare(segment.size() - 3, 3, ".gz") == 0) {
+            read_log_segment(segment, inflated);
+            data = ByteView(reinterpret_cast<const byte*>(inflated.data()), inflated.size());
+        } else {
+            mapped.reset(new MappedFile(segment));
+            data = mapped->view();
+        }
+
+        std::size_t offset = 0;
+        while ((result.status = decode_audit_record(data, offset, record)) == AuditRecordStatus::Ok) {
+            const AuditEvent& event = record.event;
+            if (text.open()) {
+                append_audit_line(text.buffer(), event, record.payload);
+                text.end_line();
+            }
+            if (json.open()) {
+                append_audit_json(json.buffer(), event, record.payload);
+                json.end_line();
+            }
+            ++result.records;
+        }
+        result.segment = segment;
+        result.stopped_at = offset;
+    }
+    text.write_out();
+    json.write_out();
+    return result;
+}
+
+const char* audit_record_status_name(AuditRecordStatus status) {
+    switch (status) {
+        case AuditRecordStatus::Ok: return "ok";
+        case AuditRecordStatus::End: return "end";
+        case AuditRecordStatus::Truncated: return "truncated";
+        case AuditRecordStatus::Corrupt: return "corrupt";
+    }
+    return "unknown";
+}
@@ -0,0 +1,239 @@
+#include "ghostline/audit_writer.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+std::uint64_t steady_ms() {
+    using namespace std::chrono;
+    return static_cast<std::uint64_t>(duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+bool write_all(int fd, const char* data, std::size_t size, std::uint64_t& calls) {
+    while (size > 0) {
+        const ssize_t written = ::write(fd, data, size);
+        ++calls;
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+} // namespace
+
+AuditWriter::AuditWriter(const AuditWriterOptions& options)
+    : options_(options), queue_(options.queue_capacity == 0 ? 1 : options.queue_capacity) {}
+
+AuditWriter::~AuditWriter() {
+    if (thread_.joinable()) {
+        stop_.store(true, std::memory_order_release);
+        wake_.notify_one();
+        thread_.join();
+    }
+    for (std::size_t i = 0; i < streams_.size(); ++i) {
+        if (streams_[i].fd >= 0) ::close(streams_[i].fd);
+    }
+}
+
+int AuditWriter::open_stream(const std::string& path) {
+    if (path.empty()) return -1;
+    Stream stream;
+    stream.path = path;
+    stream.fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (stream.fd < 0) {
+        std::fprintf(stderr, "audit writer failed to open %s: %s\n", path.c_str(), std::strerror(errno));
+    }
+    if (options_.rotation.enabled()) {
+        stream.rotator = LogRotator::for_path(path, options_.rotation);
+        stream.generation = stream.rotator->generation();
+    }
+    stream.buffer.reserve(options_.batch_bytes);
+    streams_.push_back(std::move(stream));
+    return static_cast<int>(streams_.size() - 1);
+}
+
+bool AuditWriter::enqueue(Record&& record) {
+    if (!thread_.joinable()) {
+        thread_ = std::thread([this]() { run(); });
+    }
+
+    const bool is_barrier = record.barrier != 0;
+    // Charged before the push so the writer thread never subtracts first.
+    const std::size_t text_bytes = record.text.size();
+    queued_bytes_.fetch_add(text_bytes, std::memory_order_relaxed);
+    bool pushed = queue_.try_push(std::move(record));
+    if (!pushed && (options_.full_policy == AuditQueuePolicy::Block || is_barrier)) {
+        while (!pushed) {
+            wake_.notify_one();
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+            pushed = queue_.try_push(std::move(record));
+        }
+    }
+    if (!pushed) {
+        queued_bytes_.fetch_sub(text_bytes, std::memory_order_relaxed);
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    if (!is_barrier) enqueued_.fetch_add(1, std::memory_order_relaxed);
+    if (idle_.load(std::memory_order_acquire)) wake_.notify_one();
+    return true;
+}
+
+bool AuditWriter::push_line(int stream, std::string&& line) {
+    if (stream < 0) return false;
+    Record record;
+    record.stream = stream;
+    record.text = std::move(line);
+    record.text.push_back('\n');
+    return enqueue(std::move(record));
+}
+
+bool AuditWriter::push_record(int stream, std::string&& bytes) {
+    if (stream < 0) return false;
+    Record record;
+    record.stream = stream;
+    record.text = std::move(bytes);
+    return enqueue(std::move(record));
+}
+
+bool AuditWriter::post(std::function<void()> task) {
+    Record record;
+    record.task = std::move(task);
+    return enqueue(std::move(record));
+}
+
+bool AuditWriter::under_pressure() const {
+    return options_.full_policy == AuditQueuePolicy::Summary && queue_.size() * 4 >= queue_.capacity() * 3;
+}
+
+void AuditWriter::note_summarized() {
+    summarized_.fetch_add(1, std::memory_order_relaxed);
+}
+
+AuditWriterStats AuditWriter::stats() const {
+    AuditWriterStats stats;
+    stats.enqueued = enqueued_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+    stats.summarized = summarized_.load(std::memory_order_relaxed);
+    stats.write_calls = write_calls_.load(std::memory_order_relaxed);
+    stats.written_bytes = written_bytes_.load(std::memory_order_relaxed);
+    stats.errors = errors_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void AuditWriter::flush() {
+    if (!thread_.joinable()) return;
+    std::uint64_t target = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        target = ++barrier_requested_;
+    }
+    Record record;
+    record.barrier = target;
+    enqueue(std::move(record));
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    flushed_.wait(lock, [this, target]() { return barrier_completed_ >= target; });
+}
+
+void AuditWriter::write_stream(Stream& stream) {
+    if (stream.buffer.empty()) return;
+    std::unique_lock<std::mutex> rotation_lock;
+    if (stream.rotator) {
+        rotation_lock = stream.rotator->lock();
+        stream.rotator->prepare_write(stream.fd, stream.generation, stream.buffer.size());
+    }
+    if (stream.fd >= 0) {
+        std::uint64_t calls = 0;
+        if (write_all(stream.fd, stream.buffer.data(), stream.buffer.size(), calls)) {
+            written_bytes_.fetch_add(stream.buffer.size(), std::memory_order_relaxed);
+            if (stream.rotator) stream.rotator->note_written(stream.buffer.size());
+        } else {
+            errors_.fetch_add(1, std::memory_order_relaxed);
+        }
+        write_calls_.fetch_add(calls, std::memory_order_relaxed);
+    } else {
+        errors_.fetch_add(1, std::memory_order_relaxed);
+    }
+    stream.buffer.clear();
+}
+
+void AuditWriter::run() {
+    std::uint64_t last_flush_ms = steady_ms();
+    Record record;
+
+    while (true) {
+        bool drained_any = false;
+        while (queue_.try_pop(record)) {
+            drained_any = true;
+            queued_bytes_.fetch_sub(record.text.size(), std::memory_order_relaxed);
+            if (record.stream >= 0 && static_cast<std::size_t>(record.stream) < streams_.size()) {
+                Stream& stream = streams_[static_cast<std::size_t>(record.stream)];
+                stream.buffer.append(record.text);
+                if (stream.buffer.size() >= options_.batch_bytes) write_stream(stream);
+            } else if (record.task) {
+                try {
+                    record.task();
+                } catch (const std::exception& error) {
+                    errors_.fetch_add(1, std::memory_order_relaxed);
+                    std::fprintf(stderr, "audit writer task failed: %s\n", error.what());
+                }
+            } else if (record.barrier != 0) {
+                for (std::size_t i = 0; i < streams_.size(); ++i) write_stream(streams_[i]);
+                last_flush_ms = steady_ms();
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    barrier_completed_ = record.barrier;
+                }
+                flushed_.notify_all();
+            }
+            record = Record();
+        }
+
+        const std::uint64_t now = steady_ms();
+        if (now - last_flush_ms >= options_.flush_interval_ms) {
+            for (std::size_t i = 0; i < streams_.size(); ++i) write_stream(streams_[i]);
+            last_flush_ms = now;
+        }
+
+        if (drained_any) continue;
+        if (stop_.load(std::memory_order_acquire) && queue_.size() == 0) break;
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_.store(true, std::memory_order_release);
+        if (queue_.size() == 0 && !stop_.load(std::memory_order_acquire)) {
+            wake_.wait_for(lock, std::chrono::milliseconds(options_.flush_interval_ms == 0 ? 1 : options_.flush_interval_ms));
+        }
+        idle_.store(false, std::memory_order_release);
+    }
+
+    for (std::size_t i = 0; i < streams_.size(); ++i) write_stream(streams_[i]);
+}
+
+bool parse_audit_queue_policy(const std::string& name, AuditQueuePolicy& policy) {
+    if (name == "block") policy = AuditQueuePolicy::Block;
+    else if (name == "drop") policy = AuditQueuePolicy::Drop;
+    else if (name == "summary") policy = AuditQueuePolicy::Summary;
+    else return false;
+    return true;
+}
+
+const char* audit_queue_policy_name(AuditQueuePolicy policy) {
+    switch (policy) {
+        case AuditQueuePolicy::Block: return "block";
+        case AuditQueuePolicy::Drop: return "drop";
+        case AuditQueuePolicy::Summary: return "summary";
+    }
+    return "unknown";
+}
@@ -4,11 +4,10 @@
 #include <cctype>
 #include <cstring>
 #include <memory>
-#include <sstream>
 
 namespace {
 
-bool starts_with(const ByteVec& bytes, const char* literal) {
+bool starts_with(ByteView bytes, const char* literal) {
     const std::size_t size = std::strlen(literal);
     if (bytes.size() < size) return false;
     for (std::size_t i = 0; i < size; ++i) {
@@ -17,94 +16,232 @@ bool starts_with(const ByteVec& bytes, const char* literal) {
     return true;
 }
 
-bool is_printable_payload(const ByteVec& payload) {
-    for (ByteVec::const_iterator it = payload.begin(); it != payload.end(); ++it) {
+bool is_printable_payload(ByteView payload) {
+    for (const byte* it = payload.begin(); it != payload.end(); ++it) {
         if (*it == '\n' || *it == '\r' || *it == '\t') continue;
         if (!std::isprint(static_cast<unsigned char>(*it))) return false;
     }
     return true;
 }
 
-std::string mutation_note(const Candidate& candidate) {
-    std::ostringstream out;
-    out << "trigger=" << candidate.trigger_label
-        << " packet=" << candidate.packet_type
-        << " size-delta=" << candidate.size_delta;
-    return out.str();
+void set_mutation_note(Candidate& candidate) {
+    candidate.note.assign("trigger=").append(candidate.trigger_label);
+    candidate.note.append(" packet=").append(candidate.packet_type);
+    candidate.note.append(" size-delta=").append(std::to_string(candidate.size_delta));
 }
 
 bool direction_is_mutable(const MutationConfig& config, Direction direction) {
     return direction == Direction::ClientToServer ? config.mutate_client_to_server : config.mutate_server_to_client;
 }
 
-std::size_t find_bytes(const ByteVec& haystack, const ByteVec& needle, std::size_t offset) {
-    if (needle.empty() || haystack.size() < needle.size() || offset > haystack.size() - needle.size()) return std::string::npos;
-    for (std::size_t i = offset; i + needle.size() <= haystack.size(); ++i) {
-        if (std::equal(needle.begin(), needle.end(), haystack.begin() + static_cast<long>(i))) return i;
-    }
-    return std::string::npos;
-}
-
 ByteVec bytes_from_text(const std::string& text) {
     return ByteVec(text.begin(), text.end());
 }
 
-ByteVec replace_all_bytes(const ByteVec& input, const ByteVec& find_bytes_value, const ByteVec& replace_bytes_value, bool& replaced_any) {
-    if (find_bytes_value.empty()) {
-        replaced_any = !input.empty() || !replace_bytes_value.empty();
-        return replace_bytes_value;
+/*
+ * Raw-live find/replace rules. A single rule scans with BytePattern; two or
+ * more share one Aho-Corasick pass and are applied leftmost-longest without
+ * overlap, earlier rules winning ties.
+ */
+class SubstitutionSet {
+public:
+    explicit SubstitutionSet(const MutationConfig& config) {
+        if (!config.raw_find_text.empty()) {
+            add(bytes_from_text(config.raw_find_text), bytes_from_text(config.replacement_text));
+        }
+        for (std::size_t i = 0; i < config.substitutions.size(); ++i) {
+            add(config.substitutions[i].find, config.substitutions[i].replacement);
+        }
+        if (finds_.size() == 1) {
+            single_ = BytePattern(finds_.front());
+        } else if (finds_.size() > 1) {
+            automaton_ = MultiPattern(finds_);
+        }
+        // Without any find rule the configured replacement stands in for the
+        // whole chunk, as it always has.
+        fallback_replacement_ = bytes_from_text(config.replacement_text);
     }
 
-    replaced_any = false;
-    ByteVec output;
-    std::size_t offset = 0;
-    while (offset < input.size()) {
-        const std::size_t found = find_bytes(input, find_bytes_value, offset);
-        if (found == std::string::npos) {
-            output.insert(output.end(), input.begin() + static_cast<long>(offset), input.end());
-            break;
+    bool empty() const { return finds_.empty(); }
+
+    std::size_t max_find_length() const {
+        return finds_.size() == 1 ? single_.size() : automaton_.max_length();
+    }
+
+    void find_matches(ByteView input, std::vector<PatternMatch>& out) const {
+        if (finds_.size() > 1) {
+            automaton_.find_non_overlapping(input, out);
+            return;
+        }
+        if (finds_.empty()) return;
+        std::size_t offset = 0;
+        while (true) {
+            const std::size_t found = single_.find(input, offset);
+            if (found == std::string::npos) return;
+            PatternMatch match;
+            match.start = found;
+            match.length = single_.size();
+            out.push_back(match);
+            offset = found + single_.size();
+        }
+    }
+
+    // Writes the rewritten input to `output` and returns true when anything
+    // was replaced; `output` is left empty otherwise.
+    bool apply(ByteView input, ByteVec& output) const {
+        output.clear();
+        if (finds_.empty()) {
+            output = fallback_replacement_;
+            return !input.empty() || !fallback_replacement_.empty();
         }
 
-        replaced_any = true;
-        output.insert(output.end(), input.begin() + static_cast<long>(offset), input.begin() + static_cast<long>(found));
-        output.insert(output.end(), replace_bytes_value.begin(), replace_bytes_value.end());
-        offset = found + find_bytes_value.size();
+        std::vector<PatternMatch> matches;
+        find_matches(input, matches);
+        if (matches.empty()) return false;
+
+        output.reserve(input.size());
+        std::size_t offset = 0;
+        for (std::size_t i = 0; i < matches.size(); ++i) {
+            const ByteVec& replacement = replacements_[matches[i].pattern];
+            output.insert(output.end(), input.begin() + offset, input.begin() + matches[i].start);
+            output.insert(output.end(), replacement.begin(), replacement.end());
+            offset = matches[i].end();
+        }
+        output.insert(output.end(), input.begin() + offset, input.end());
+        return true;
     }
-    return output;
+
+    // Length of the prefix of `input` that no later byte can change. Only
+    // the longest suffix that could still grow into a match is held back
+    // (never more than max_find_length() - 1 bytes); the cut is stretched
+    // over a match that straddles it. A match starting before the cut is
+    // final because no longer rule starting there could still complete.
+    std::size_t stable_prefix(ByteView input) const {
+        const std::size_t hold = partial_suffix(input);
+        if (input.size() <= hold) return 0;
+        std::size_t cut = input.size() - hold;
+        if (hold == 0) return cut;
+
+        std::vector<PatternMatch> matches;
+        find_matches(input, matches);
+        for (std::size_t i = 0; i < matches.size() && matches[i].start < cut; ++i) {
+            if (matches[i].end() > cut) cut = matches[i].end();
+        }
+        return cut;
+    }
+
+private:
+    std::size_t partial_suffix(ByteView input) const {
+        if (finds_.size() > 1) return automaton_.partial_suffix(input);
+        if (finds_.empty()) return 0;
+        const ByteVec& needle = single_.bytes();
+        for (std::size_t length = std::min(input.size(), needle.size() - 1); length > 0; --length) {
+            if (std::memcmp(input.end() - length, needle.data(), length) == 0) return length;
+        }
+        return 0;
+    }
+
+    void add(const ByteVec& find, const ByteVec& replacement) {
+        if (find.empty()) return;
+        finds_.push_back(find);
+        replacements_.push_back(replacement);
+    }
+
+    std::vector<ByteVec> finds_;
+    std::vector<ByteVec> replacements_;
+    BytePattern single_;
+    MultiPattern automaton_;
+    ByteVec fallback_replacement_;
+};
+
+WindowRuleSet compile_window_rules(const MutationConfig& config) {
+    WindowRuleSet rules;
+    std::vector<ByteVec> starts;
+    std::vector<MarkerWindowRule> declared;
+    MarkerWindowRule primary;
+    primary.start_marker = config.start_marker;
+    primary.end_marker = config.end_marker;
+    primary.replacement_text = config.replacement_text;
+    declared.push_back(primary);
+    declared.insert(declared.end(), config.window_rules.begin(), config.window_rules.end());
+
+    for (std::size_t i = 0; i < declared.size(); ++i) {
+        if (declared[i].start_marker.empty() || declared[i].end_marker.empty()) continue;
+        CompiledWindow window;
+        window.start_marker = BytePattern(declared[i].start_marker);
+        window.end_marker = BytePattern(declared[i].end_marker);
+        window.replacement = bytes_from_text(declared[i].replacement_text);
+        rules.windows.push_back(std::move(window));
+        starts.push_back(declared[i].start_marker);
+    }
+    rules.start_markers = MultiPattern(starts);
+    return rules;
+}
+
+bool ends_with(ByteView bytes, const ByteVec& suffix) {
+    return bytes.size() >= suffix.size() && std::equal(suffix.begin(), suffix.end(), bytes.end() - suffix.size());
+}
+
+bool starts_with(ByteView bytes, const ByteVec& prefix) {
+    return bytes.size() >= prefix.size() && std::equal(prefix.begin(), prefix.end(), bytes.begin());
 }
 
 class RawLivePlugin : public ProtocolPlugin {
 public:
-    explicit RawLivePlugin(const MutationConfig& config) : config_(config) {}
+    explicit RawLivePlugin(const MutationConfig& config)
+        : config_(config),
+          end_pattern_(config.end_marker),
+          substitutions_(config) {}
 
-    std::string name() const override { return "raw-live"; }
+    const std::string& name() const override {
+        static const std::string kName = "raw-live";
+        return kName;
+    }
 
-    bool matches(const FlowContext&, Direction, std::uint16_t, const ByteVec&) const override {
+    bool matches(const FlowContext&, Direction, std::uint16_t, ByteView) const override {
         return config_.raw_live_mode;
     }
 
     bool uses_protocol_framing() const override { return true; }
 
-    FramingResult frame(const FlowContext&, Direction, const ByteVec& buffer) const override {
+    FramingResult frame(const FlowContext&, Direction, ByteView buffer, std::size_t resume_offset) const override {
         FramingResult result;
         if (buffer.empty()) return result;
 
-        if (!config_.end_marker.empty()) {
-            const std::size_t end = find_bytes(buffer, config_.end_marker, 0);
+        if (!end_pattern_.empty()) {
+            const std::size_t end = end_pattern_.find(buffer, resume_offset);
             if (end == std::string::npos) {
                 result.disposition = FramingDisposition::NeedMoreBytes;
                 result.detail = "waiting for raw end marker";
+                result.resume_offset = std::max(resume_offset, end_pattern_.resume_offset(buffer));
                 return result;
             }
             result.disposition = FramingDisposition::FramedPacket;
-            result.consumed_bytes = end + config_.end_marker.size();
-            result.frame_bytes.assign(buffer.begin(), buffer.begin() + static_cast<long>(result.consumed_bytes));
+            result.consumed_bytes = end + end_pattern_.size();
+            result.frame_bytes = buffer.subview(0, result.consumed_bytes);
             result.packet_type = "RAW-WINDOW";
             result.detail = "raw live framed by end marker";
             result.candidate_mutation_allowed = true;
             return result;
         }
 
+        if (streaming()) {
+            const std::size_t stable = substitutions_.stable_prefix(buffer);
+            if (stable == 0) {
+                result.disposition = FramingDisposition::NeedMoreBytes;
+                result.detail = "holding raw stream tail";
+                result.hold_deadline_ms = config_.raw_flush_ms;
+                return result;
+            }
+            result.disposition = FramingDisposition::FramedPacket;
+            result.consumed_bytes = stable;
+            result.frame_bytes = buffer.subview(0, stable);
+            result.packet_type = "RAW-STREAM";
+            result.detail = "raw live stream segment";
+            result.candidate_mutation_allowed = true;
+            return result;
+        }
+
         if (buffer.size() < config_.raw_chunk_bytes) {
             result.disposition = FramingDisposition::NeedMoreBytes;
             result.detail = "waiting for raw chunk bytes";
@@ -113,61 +250,76 @@ public:
 
         result.disposition = FramingDisposition::FramedPacket;
         result.consumed_bytes = config_.raw_chunk_bytes;
-        result.frame_bytes.assign(buffer.begin(), buffer.begin() + static_cast<long>(config_.raw_chunk_bytes));
+        result.frame_bytes = buffer.subview(0, config_.raw_chunk_bytes);
         result.packet_type = "RAW-CHUNK";
         result.detail = "raw live fixed chunk";
         result.candidate_mutation_allowed = true;
         return result;
     }
 
+    // Held bytes are shorter than the longest rule, so only shorter rules can
+    // still match; frame them as the final segment so those apply.
+    FramingResult flush_held(const FlowContext&, Direction, ByteView buffer) const override {
+        FramingResult result;
+        if (!streaming() || buffer.empty()) return result;
+        result.disposition = FramingDisposition::FramedPacket;
+        result.consumed_bytes = buffer.size();
+        result.frame_bytes = buffer;
+        result.packet_type = "RAW-STREAM-TAIL";
+        result.detail = "raw live stream tail flushed";
+        result.candidate_mutation_allowed = true;
+        return result;
+    }
+
     bool configure_window(const FlowContext&, Direction, WindowRule&) const override {
         return false;
     }
 
-    Candidate build_candidate(const FlowContext&, Direction, const ByteVec& window, const FramingResult* framed) const override {
-        Candidate candidate;
+    void build_candidate(const FlowContext&, Direction, ByteView window, const FramingResult* framed, Candidate& candidate) const override {
         candidate.plugin_name = name();
         candidate.trigger_label = "raw-live";
-        candidate.packet_type = framed != nullptr ? framed->packet_type : "RAW";
-        candidate.protocol_note = framed != nullptr ? framed->detail : "raw live candidate";
+        if (framed != nullptr) {
+            candidate.packet_type = framed->packet_type;
+            candidate.protocol_note = framed->detail;
+        } else {
+            candidate.packet_type = "RAW";
+            candidate.protocol_note = "raw live candidate";
+        }
         candidate.original_bytes = window;
-        candidate.modified_bytes = window;
         candidate.payload_offset = 0;
         candidate.payload_size = window.size();
 
-        bool replaced_any = false;
-        const ByteVec find_value = bytes_from_text(config_.raw_find_text);
-        const ByteVec replacement = bytes_from_text(config_.replacement_text);
-        candidate.modified_bytes = replace_all_bytes(window, find_value, replacement, replaced_any);
-        candidate.size_delta = static_cast<long long>(candidate.modified_bytes.size()) - static_cast<long long>(candidate.original_bytes.size());
-        candidate.allow_size_mutated = candidate.size_delta == 0 || config_.allow_size_mutation;
-        candidate.review_label = candidate.size_delta == 0 ? "raw-live-inline" : "raw-live-size-change";
-        candidate.note = mutation_note(candidate);
+        // A stream segment is an arbitrary slice of the flow, so the
+        // whole-chunk replacement used without find rules does not apply.
+        const bool replaced_any = (!streaming() || !substitutions_.empty())
+            && substitutions_.apply(window, candidate.mutated_bytes);
         if (!replaced_any) {
-            candidate.modified_bytes = candidate.original_bytes;
+            candidate.mutated_bytes.clear();
+            candidate.allow_size_mutated = true;
+            candidate.review_label = "raw-live-inline";
             candidate.note = "raw live candidate produced no match";
+            return;
         }
-        return candidate;
+        candidate.mutated = true;
+        candidate.size_delta = static_cast<long long>(candidate.mutated_bytes.size()) - static_cast<long long>(candidate.original_bytes.size());
+        candidate.allow_size_mutated = candidate.size_delta == 0 || config_.allow_size_mutation;
+        candidate.review_label = candidate.size_delta == 0 ? "raw-live-inline" : "raw-live-size-change";
+        set_mutation_note(candidate);
     }
 
-    CandidateDecision decide(const FlowContext&, Direction direction, Candidate& candidate) const override {
-        CandidateDecision decision;
+    void decide(const FlowContext&, Direction direction, Candidate& candidate, CandidateDecision& decision) const override {
         if (!direction_is_mutable(config_, direction)) {
             decision.release = CandidateRelease::ReleaseOriginal;
             decision.outcome = ValidationOutcome::ValidationFallbackOriginal;
-            decision.validation_label = "raw-live-direction-filter";
-            decision.validation_detail = "raw live mutation disabled for this direction";
-            decision.fallback_reason = "raw live direction is observe-only";
-            return decision;
+            decision.validation = ValidationCode::RawLiveDirectionFilter;
+            return;
         }
 
-        if (candidate.modified_bytes == candidate.original_bytes) {
+        if (!candidate.mutated || candidate.modified_bytes().equals(candidate.original_bytes)) {
             decision.release = CandidateRelease::ReleaseOriginal;
             decision.outcome = ValidationOutcome::ValidationFallbackOriginal;
-            decision.validation_label = "raw-live-no-match";
-            decision.validation_detail = "raw live mutation did not find a matching region";
-            decision.fallback_reason = "raw live candidate produced no mutation";
-            return decision;
+            decision.validation = ValidationCode::RawLiveNoMatch;
+            return;
         }
 
         decision.review_required = candidate.size_delta != 0;
@@ -177,110 +329,108 @@ public:
             decision.outcome = ValidationOutcome::ValidationObserveOnly;
             decision.observe_only = true;
             decision.create_action_item = true;
-            decision.validation_label = "raw-live-size-blocked";
-            decision.validation_detail = "operator disabled raw live size mutations";
-            decision.fallback_reason = "raw live size mutation not allowed";
-            decision.review_reason = "size-changing raw live mutation requires review";
-            decision.action_title = "Review raw live mutation";
-            decision.action_detail = "Ghostline preserved original raw bytes because the live mutation changed size and was not allowed.";
-            return decision;
+            decision.validation = ValidationCode::RawLiveSizeBlocked;
+            decision.review = ReviewCode::RawLiveSizeBlocked;
+            return;
         }
 
         candidate.valid = true;
         decision.release = CandidateRelease::ReleaseModified;
         decision.outcome = ValidationOutcome::ValidationPassed;
-        decision.validation_label = candidate.size_delta == 0 ? "raw-live-validated" : "raw-live-size-mutated";
-        decision.validation_detail = candidate.size_delta == 0
-            ? "raw live mutation validated inline"
-            : "raw live mutation validated with a chunk size change";
+        decision.validation = candidate.size_delta == 0 ? ValidationCode::RawLiveValidated : ValidationCode::RawLiveSizeMutated;
         if (config_.raw_review_threshold_bytes > 0 && candidate.payload_size >= config_.raw_review_threshold_bytes) {
             decision.review_required = true;
             decision.create_action_item = true;
-            decision.review_reason = "raw live mutation exceeded configured review threshold";
-            decision.action_title = "Review raw live mutation";
-            decision.action_detail = "Raw live mutation released successfully but crossed the configured review threshold.";
-        } else {
-            decision.review_reason = decision.review_required ? "raw live size mutation should be reviewed in audit trail" : "";
+            decision.review = ReviewCode::RawLiveThreshold;
+        } else if (decision.review_required) {
+            decision.review = ReviewCode::RawLiveSizeChange;
         }
-        return decision;
     }
 
     std::string audit_label() const override { return "raw-live"; }
 
 private:
+    // An end marker keeps its delimited framing even in stream mode.
+    bool streaming() const { return config_.raw_stream_mode && end_pattern_.empty(); }
+
     MutationConfig config_;
+    BytePattern end_pattern_;
+    SubstitutionSet substitutions_;
 };
 
 class ByteWindowPlugin : public ProtocolPlugin {
 public:
-    explicit ByteWindowPlugin(const MutationConfig& config) : config_(config) {}
+    explicit ByteWindowPlugin(const MutationConfig& config)
+        : config_(config), rules_(compile_window_rules(config)) {}
 
-    std::string name() const override { return "byte-window"; }
+    const std::string& name() const override {
+        static const std::string kName = "byte-window";
+        return kName;
+    }
 
-    bool matches(const FlowContext&, Direction, std::uint16_t, const ByteVec&) const override {
-        return !config_.start_marker.empty() && !config_.end_marker.empty();
+    bool matches(const FlowContext&, Direction, std::uint16_t, ByteView) const override {
+        return !rules_.windows.empty();
     }
 
     bool configure_window(const FlowContext&, Direction, WindowRule& rule) const override {
-        rule.start_marker = config_.start_marker;
-        rule.end_marker = config_.end_marker;
+        rule.rules = &rules_;
         rule.rewrite_u32_prefix = config_.rewrite_u32_prefix;
         return true;
     }
 
-    Candidate build_candidate(const FlowContext&, Direction, const ByteVec& window, const FramingResult*) const override {
-        Candidate candidate;
+    void build_candidate(const FlowContext&, Direction, ByteView window, const FramingResult*, Candidate& candidate) const override {
         candidate.plugin_name = name();
         candidate.trigger_label = "byte-pattern";
         candidate.packet_type = "byte-window";
         candidate.original_bytes = window;
-        candidate.modified_bytes = window;
-        candidate.header_size = config_.start_marker.size();
-        candidate.footer_size = config_.end_marker.size();
+
+        const std::size_t rule_index = window_rule_for(window);
+        if (rule_index == rules_.windows.size()) {
+            candidate.note = "byte-window candidate matched no window rule";
+            return;
+        }
+        const CompiledWindow& rule = rules_.windows[rule_index];
+        candidate.header_size = rule.start_marker.size();
+        candidate.footer_size = rule.end_marker.size();
+        if (rules_.windows.size() > 1) candidate.protocol_note = "window-rule=" + std::to_string(rule_index);
 
         if (window.size() >= candidate.header_size + candidate.footer_size) {
-            ByteVec replacement(config_.replacement_text.begin(), config_.replacement_text.end());
-            candidate.modified_bytes.assign(window.begin(), window.begin() + static_cast<long>(candidate.header_size));
-            candidate.modified_bytes.insert(candidate.modified_bytes.end(), replacement.begin(), replacement.end());
-            candidate.modified_bytes.insert(candidate.modified_bytes.end(),
-                                            window.end() - static_cast<long>(candidate.footer_size),
-                                            window.end());
+            const ByteVec& replacement = rule.replacement;
+            ByteVec& modified = candidate.modify();
+            modified.reserve(candidate.header_size + replacement.size() + candidate.footer_size);
+            modified.insert(modified.end(), window.begin(), window.begin() + candidate.header_size);
+            modified.insert(modified.end(), replacement.begin(), replacement.end());
+            modified.insert(modified.end(), window.end() - candidate.footer_size, window.end());
             candidate.payload_offset = candidate.header_size;
             candidate.payload_size = candidate.original_bytes.size() - candidate.header_size - candidate.footer_size;
-            candidate.size_delta = static_cast<long long>(candidate.modified_bytes.size()) - static_cast<long long>(candidate.original_bytes.size());
-
-            if (config_.rewrite_u32_prefix && candidate.modified_bytes.size() >= 4 + candidate.footer_size) {
-                const std::uint32_t body_size = static_cast<std::uint32_t>(candidate.modified_bytes.size() - 4 - candidate.footer_size);
-                candidate.modified_bytes[0] = static_cast<byte>((body_size >> 24) & 0xff);
-                candidate.modified_bytes[1] = static_cast<byte>((body_size >> 16) & 0xff);
-                candidate.modified_bytes[2] = static_cast<byte>((body_size >> 8) & 0xff);
-                candidate.modified_bytes[3] = static_cast<byte>(body_size & 0xff);
+            candidate.size_delta = static_cast<long long>(modified.size()) - static_cast<long long>(candidate.original_bytes.size());
+
+            if (config_.rewrite_u32_prefix && modified.size() >= 4 + candidate.footer_size) {
+                const std::uint32_t body_size = static_cast<std::uint32_t>(modified.size() - 4 - candidate.footer_size);
+                modified[0] = static_cast<byte>((body_size >> 24) & 0xff);
+                modified[1] = static_cast<byte>((body_size >> 16) & 0xff);
+                modified[2] = static_cast<byte>((body_size >> 8) & 0xff);
+                modified[3] = static_cast<byte>(body_size & 0xff);
                 candidate.allow_size_mutated = true;
             }
         }
 
-        candidate.note = mutation_note(candidate);
-        return candidate;
+        set_mutation_note(candidate);
     }
 
-    CandidateDecision decide(const FlowContext&, Direction direction, Candidate& candidate) const override {
-        CandidateDecision decision;
+    void decide(const FlowContext&, Direction direction, Candidate& candidate, CandidateDecision& decision) const override {
         if (!direction_is_mutable(config_, direction)) {
             decision.release = CandidateRelease::ReleaseOriginal;
             decision.outcome = ValidationOutcome::ValidationFallbackOriginal;
-            decision.validation_label = "byte-window-direction-filter";
-            decision.validation_detail = "byte-window mutation disabled for this direction";
-            decision.fallback_reason = "byte-window direction is observe-only";
-            return decision;
+            decision.validation = ValidationCode::ByteWindowDirectionFilter;
+            return;
         }
 
-        if (candidate.modified_bytes.empty() || candidate.modified_bytes == candidate.original_bytes) {
+        if (!candidate.mutated || candidate.mutated_bytes.empty() || candidate.modified_bytes().equals(candidate.original_bytes)) {
             decision.release = CandidateRelease::ReleaseOriginal;
             decision.outcome = ValidationOutcome::ValidationFallbackOriginal;
-            decision.validation_label = "no-op";
-            decision.validation_detail = "byte-window replacement produced no safe delta";
-            decision.fallback_reason = "replacement produced no safe delta";
-            return decision;
+            decision.validation = ValidationCode::ByteWindowNoOp;
+            return;
         }
 
         if (candidate.size_delta != 0 && !config_.allow_size_mutation) {
@@ -289,12 +439,9 @@ public:
             decision.outcome = ValidationOutcome::ValidationObserveOnly;
             decision.observe_only = true;
             decision.create_action_item = true;
-            decision.validation_label = "size-mutation-blocked";
-            decision.validation_detail = "operator disabled size mutations";
-            decision.fallback_reason = "size mutation not allowed";
-            decision.action_title = "Begin framing mutation workflow";
-            decision.action_detail = "Ghostline preserved original bytes because the candidate changed size without allow-size-mutation enabled.";
-            return decision;
+            decision.validation = ValidationCode::ByteWindowSizeBlocked;
+            decision.review = ReviewCode::ByteWindowSizeBlocked;
+            return;
         }
 
         if (candidate.size_delta != 0 && !candidate.allow_size_mutated) {
@@ -303,33 +450,45 @@ public:
             decision.outcome = ValidationOutcome::ValidationObserveOnly;
             decision.observe_only = true;
             decision.create_action_item = true;
-            decision.validation_label = "pid-drift-risk";
-            decision.validation_detail = "size-changing byte-window mutation could not prove a dependent header rewrite";
-            decision.fallback_reason = "size mutation could not be proven safe";
-            decision.action_title = "Begin live mutation workflow";
-            decision.action_detail = "Locate header byte size, compute delta, and mutate dependent fields before retrying.";
-            return decision;
+            decision.validation = ValidationCode::ByteWindowPidDriftRisk;
+            decision.review = ReviewCode::ByteWindowPidDriftRisk;
+            return;
         }
 
         candidate.valid = true;
         decision.release = CandidateRelease::ReleaseModified;
         decision.outcome = ValidationOutcome::ValidationPassed;
-        decision.validation_label = candidate.allow_size_mutated ? "allow-size-mutated" : "validated";
-        decision.validation_detail = "byte-window candidate validated";
+        decision.validation = candidate.allow_size_mutated ? ValidationCode::ByteWindowAllowSizeMutated : ValidationCode::ByteWindowValidated;
         if (config_.byte_window_review_threshold_bytes > 0 && candidate.payload_size >= config_.byte_window_review_threshold_bytes) {
             decision.review_required = true;
             decision.create_action_item = true;
-            decision.review_reason = "byte-window mutation exceeded configured review threshold";
-            decision.action_title = "Review byte-window mutation";
-            decision.action_detail = "Byte-window mutation released successfully but crossed the configured review threshold.";
+            decision.review = ReviewCode::ByteWindowThreshold;
         }
-        return decision;
     }
 
     std::string audit_label() const override { return "byte-window-candidate"; }
 
 private:
+    // The rule whose start marker opens the window, preferring the one the
+    // transport would have picked (leftmost-longest), then any rule whose
+    // markers bracket it. rules_.windows.size() when none does.
+    std::size_t window_rule_for(ByteView window) const {
+        const PatternMatch head = rules_.start_markers.find_leftmost(window);
+        if (head.found() && head.start == 0 && ends_with(window, rules_.windows[head.pattern].end_marker.bytes())) {
+            return head.pattern;
+        }
+        for (std::size_t i = 0; i < rules_.windows.size(); ++i) {
+            const CompiledWindow& rule = rules_.windows[i];
+            if (window.size() >= rule.start_marker.size() + rule.end_marker.size()
+                && starts_with(window, rule.start_marker.bytes()) && ends_with(window, rule.end_marker.bytes())) {
+                return i;
+            }
+        }
+        return rules_.windows.size();
+    }
+
     MutationConfig config_;
+    WindowRuleSet rules_;
 };
 
 class ObservationPlugin : public ProtocolPlugin {
@@ -337,9 +496,9 @@ public:
     ObservationPlugin(std::string plugin_name, std::uint16_t port_hint, std::string signature, std::string label, std::string detail)
         : plugin_name_(plugin_name), port_hint_(port_hint), signature_(signature), label_(label), detail_(detail) {}
 
-    std::string name() const override { return plugin_name_; }
+    const std::string& name() const override { return plugin_name_; }
 
-    bool matches(const FlowContext&, Direction, std::uint16_t upstream_port, const ByteVec& buffer) const override {
+    bool matches(const FlowContext&, Direction, std::uint16_t upstream_port, ByteView buffer) const override {
         return upstream_port == port_hint_ || (!signature_.empty() && starts_with(buffer, signature_.c_str()));
     }
 
@@ -347,26 +506,19 @@ public:
         return false;
     }
 
-    Candidate build_candidate(const FlowContext&, Direction, const ByteVec& window, const FramingResult*) const override {
-        Candidate candidate;
+    void build_candidate(const FlowContext&, Direction, ByteView window, const FramingResult*, Candidate& candidate) const override {
         candidate.plugin_name = plugin_name_;
         candidate.trigger_label = label_;
         candidate.packet_type = label_;
         candidate.original_bytes = window;
-        candidate.modified_bytes = window;
         candidate.protocol_note = detail_;
         candidate.note = detail_;
-        return candidate;
     }
 
-    CandidateDecision decide(const FlowContext&, Direction, Candidate&) const override {
-        CandidateDecision decision;
+    void decide(const FlowContext&, Direction, Candidate&, CandidateDecision& decision) const override {
         decision.release = CandidateRelease::ReleaseOriginal;
         decision.outcome = ValidationOutcome::ValidationFallbackOriginal;
-        decision.validation_label = "observe-only";
-        decision.validation_detail = "protocol plugin provided detection and audit only";
-        decision.fallback_reason = "protocol plugin has detection and audit only in Phase 1";
-        return decision;
+        decision.validation = ValidationCode::ObservationOnly;
     }
 
     std::string audit_label() const override { return label_; }
@@ -394,7 +546,7 @@ struct MqttFrameInfo {
     std::string detail;
 };
 
-bool decode_remaining_length(const ByteVec& frame, std::size_t& value, std::size_t& encoded_size, std::string& error) {
+bool decode_remaining_length(ByteView frame, std::size_t& value, std::size_t& encoded_size, std::string& error) {
     value = 0;
     encoded_size = 0;
     std::size_t multiplier = 1;
@@ -415,15 +567,17 @@ bool decode_remaining_length(const ByteVec& frame, std::size_t& value, std::size
     return false;
 }
 
-ByteVec encode_remaining_length(std::size_t value) {
-    ByteVec out;
+// Appends the variable-length encoding of `value`; returns its byte count.
+std::size_t append_remaining_length(ByteVec& out, std::size_t value) {
+    std::size_t count = 0;
     do {
         byte encoded = static_cast<byte>(value % 128U);
         value /= 128U;
         if (value > 0) encoded = static_cast<byte>(encoded | 0x80U);
         out.push_back(encoded);
-    } while (value > 0 && out.size() < 4);
-    return out;
+        ++count;
+    } while (value > 0 && count < 4);
+    return count;
 }
 
 std::string mqtt_packet_type_name(byte type) {
@@ -438,7 +592,7 @@ std::string mqtt_packet_type_name(byte type) {
     }
 }
 
-MqttFrameInfo parse_mqtt_frame(const ByteVec& frame) {
+MqttFrameInfo parse_mqtt_frame(ByteView frame) {
     MqttFrameInfo info;
     if (frame.size() < 2) {
         info.detail = "need more bytes for mqtt fixed header";
@@ -494,19 +648,22 @@ MqttFrameInfo parse_mqtt_frame(const ByteVec& frame) {
     info.payload_offset = fixed_header_size + variable_header_size;
     info.payload_size = total_size - info.payload_offset;
     info.payload_mutable = true;
-    info.opaque_payload = !is_printable_payload(ByteVec(frame.begin() + static_cast<long>(info.payload_offset),
-                                                       frame.begin() + static_cast<long>(info.total_size)));
+    info.opaque_payload = !is_printable_payload(frame.subview(info.payload_offset, info.total_size - info.payload_offset));
     info.detail = "mqtt publish frame";
     return info;
 }
 
 class MqttPlugin : public ProtocolPlugin {
 public:
-    explicit MqttPlugin(const MutationConfig& config) : config_(config) {}
+    explicit MqttPlugin(const MutationConfig& config)
+        : config_(config), replacement_(bytes_from_text(config.replacement_text)) {}
 
-    std::string name() const override { return "mqtt"; }
+    const std::string& name() const override {
+        static const std::string kName = "mqtt";
+        return kName;
+    }
 
-    bool matches(const FlowContext&, Direction, std::uint16_t upstream_port, const ByteVec& buffer) const override {
+    bool matches(const FlowContext&, Direction, std::uint16_t upstream_port, ByteView buffer) const override {
         if (upstream_port == 1883) return true;
         if (buffer.empty()) return false;
         const byte type = static_cast<byte>((buffer[0] >> 4U) & 0x0fU);
@@ -515,7 +672,7 @@ public:
 
     bool uses_protocol_framing() const override { return true; }
 
-    FramingResult frame(const FlowContext&, Direction, const ByteVec& buffer) const override {
+    FramingResult frame(const FlowContext&, Direction, ByteView buffer, std::size_t) const override {
         FramingResult result;
         if (buffer.empty()) return result;
 
@@ -540,7 +697,7 @@ public:
 
         result.disposition = FramingDisposition::FramedPacket;
         result.consumed_bytes = total_size;
-        result.frame_bytes.assign(buffer.begin(), buffer.begin() + static_cast<long>(total_size));
+        result.frame_bytes = buffer.subview(0, total_size);
 
         const MqttFrameInfo info = parse_mqtt_frame(result.frame_bytes);
         if (!info.valid) {
@@ -561,14 +718,10 @@ public:
         return false;
     }
 
-    Candidate build_candidate(const FlowContext&, Direction, const ByteVec& window, const FramingResult* framed) const override {
-        Candidate candidate;
+    void build_candidate(const FlowContext&, Direction, ByteView window, const FramingResult*, Candidate& candidate) const override {
         candidate.plugin_name = name();
         candidate.trigger_label = "mqtt-fixed-header";
         candidate.original_bytes = window;
-        candidate.modified_bytes = window;
-        candidate.packet_type = framed != nullptr ? framed->packet_type : "CONTROL";
-        candidate.protocol_note = framed != nullptr ? framed->detail : "";
 
         const MqttFrameInfo info = parse_mqtt_frame(window);
         candidate.packet_type = info.packet_type;
@@ -579,99 +732,79 @@ public:
 
         if (!info.valid) {
             candidate.note = "mqtt framing invalid";
-            return candidate;
+            return;
         }
 
         if (info.packet_type != "PUBLISH") {
             candidate.note = "mqtt-framed-observe-only";
-            return candidate;
+            return;
         }
 
         if (config_.replacement_text.empty()) {
             candidate.note = "mqtt publish observed with no replacement text configured";
-            return candidate;
+            return;
         }
 
         if (info.opaque_payload) {
             candidate.note = "mqtt publish payload looked opaque";
-            return candidate;
+            return;
         }
 
-        ByteVec replacement(config_.replacement_text.begin(), config_.replacement_text.end());
-        ByteVec reframed;
+        const ByteVec& replacement = replacement_;
+        ByteVec& reframed = candidate.modify();
         reframed.reserve(window.size() - info.payload_size + replacement.size());
         reframed.push_back(info.first_byte);
 
         const std::size_t new_remaining_length = info.remaining_length - info.payload_size + replacement.size();
-        ByteVec encoded_remaining = encode_remaining_length(new_remaining_length);
-        reframed.insert(reframed.end(), encoded_remaining.begin(), encoded_remaining.end());
+        const std::size_t encoded_remaining = append_remaining_length(reframed, new_remaining_length);
         reframed.insert(reframed.end(),
-                        window.begin() + static_cast<long>(candidate.header_size),
-                        window.begin() + static_cast<long>(info.payload_offset));
+                        window.begin() + candidate.header_size,
+                        window.begin() + info.payload_offset);
         reframed.insert(reframed.end(), replacement.begin(), replacement.end());
 
-        candidate.modified_bytes = reframed;
         candidate.payload_size = info.payload_size;
-        candidate.size_delta = static_cast<long long>(candidate.modified_bytes.size()) - static_cast<long long>(candidate.original_bytes.size());
-        candidate.allow_size_mutated = candidate.size_delta == 0 || !encoded_remaining.empty();
-        candidate.note = mutation_note(candidate);
-        return candidate;
+        candidate.size_delta = static_cast<long long>(reframed.size()) - static_cast<long long>(candidate.original_bytes.size());
+        candidate.allow_size_mutated = candidate.size_delta == 0 || encoded_remaining != 0;
+        set_mutation_note(candidate);
     }
 
-    CandidateDecision decide(const FlowContext&, Direction direction, Candidate& candidate) const override {
-        CandidateDecision decision;
-
+    void decide(const FlowContext&, Direction direction, Candidate& candidate, CandidateDecision& decision) const override {
         if (candidate.packet_type != "PUBLISH") {
             decision.release = CandidateRelease::ReleaseOriginal;
             decision.outcome = ValidationOutcome::ValidationFallbackOriginal;
-            decision.validation_label = "framed-observe-only";
-            decision.validation_detail = "mqtt control packets are framed and audited first";
-            decision.fallback_reason = "mqtt control packet kept on original path";
-            return decision;
+            decision.validation = ValidationCode::MqttControlObserveOnly;
+            return;
         }
 
         if (!direction_is_mutable(config_, direction)) {
             decision.release = CandidateRelease::ReleaseOriginal;
             decision.outcome = ValidationOutcome::ValidationFallbackOriginal;
-            decision.validation_label = "mqtt-direction-filter";
-            decision.validation_detail = "mqtt mutation disabled for this direction";
-            decision.fallback_reason = "mqtt direction is observe-only";
-            return decision;
+            decision.validation = ValidationCode::MqttDirectionFilter;
+            return;
         }
 
-        if (candidate.modified_bytes == candidate.original_bytes) {
+        if (!candidate.mutated || candidate.modified_bytes().equals(candidate.original_bytes)) {
             candidate.pid_drift_risk = candidate.protocol_note == "mqtt publish payload looked opaque";
             decision.release = CandidateRelease::ReleaseOriginal;
             decision.outcome = candidate.pid_drift_risk ? ValidationOutcome::ValidationObserveOnly : ValidationOutcome::ValidationFallbackOriginal;
             decision.observe_only = candidate.pid_drift_risk;
             decision.create_action_item = candidate.pid_drift_risk;
-            decision.validation_label = candidate.pid_drift_risk ? "opaque-publish-payload" : "no-op";
-            decision.validation_detail = candidate.pid_drift_risk
-                ? "mqtt publish payload did not look safely mutable"
-                : "no replacement text or no safe payload delta";
-            decision.fallback_reason = candidate.pid_drift_risk
-                ? "mqtt payload appeared opaque and was kept original"
-                : "mqtt publish produced no safe delta";
-            if (candidate.pid_drift_risk) {
-                decision.action_title = "Begin mqtt live mutation workflow";
-                decision.action_detail = "Inspect MQTT publish payload framing and decide whether a live mutation attempt is safe.";
-            }
-            return decision;
+            decision.validation = candidate.pid_drift_risk ? ValidationCode::MqttOpaquePayload : ValidationCode::MqttNoOp;
+            if (candidate.pid_drift_risk) decision.review = ReviewCode::MqttOpaquePayload;
+            return;
         }
 
-        const MqttFrameInfo reframed = parse_mqtt_frame(candidate.modified_bytes);
+        const MqttFrameInfo reframed = parse_mqtt_frame(candidate.mutated_bytes);
         if (!reframed.valid || reframed.packet_type != "PUBLISH") {
             candidate.pid_drift_risk = true;
             decision.release = CandidateRelease::ReleaseOriginal;
             decision.outcome = ValidationOutcome::ValidationObserveOnly;
             decision.observe_only = true;
             decision.create_action_item = true;
-            decision.validation_label = "mqtt-reframe-invalid";
-            decision.validation_detail = reframed.detail;
-            decision.fallback_reason = "mqtt reframe validation failed";
-            decision.action_title = "Begin mqtt live mutation workflow";
-            decision.action_detail = "Ghostline could not validate the reframed MQTT publish packet and preserved the original bytes.";
-            return decision;
+            decision.validation = ValidationCode::MqttReframeInvalid;
+            decision.review = ReviewCode::MqttReframeInvalid;
+            decision.validation_note = reframed.detail;
+            return;
         }
 
         if (candidate.size_delta != 0 && !config_.allow_size_mutation) {
@@ -680,12 +813,9 @@ public:
             decision.outcome = ValidationOutcome::ValidationObserveOnly;
             decision.observe_only = true;
             decision.create_action_item = true;
-            decision.validation_label = "mqtt-size-mutation-blocked";
-            decision.validation_detail = "operator disabled size-changing mqtt mutations";
-            decision.fallback_reason = "mqtt size mutation not allowed";
-            decision.action_title = "Begin mqtt live mutation workflow";
-            decision.action_detail = "Allow size mutation or keep observing the MQTT flow before attempting another payload rewrite.";
-            return decision;
+            decision.validation = ValidationCode::MqttSizeBlocked;
+            decision.review = ReviewCode::MqttSizeBlocked;
+            return;
         }
 
         if (candidate.size_delta != 0 && !candidate.allow_size_mutated) {
@@ -694,33 +824,27 @@ public:
             decision.outcome = ValidationOutcome::ValidationObserveOnly;
             decision.observe_only = true;
             decision.create_action_item = true;
-            decision.validation_label = "mqtt-pid-drift-risk";
-            decision.validation_detail = "size-changing mqtt publish candidate lacked a safe remaining-length rewrite";
-            decision.fallback_reason = "mqtt size mutation could not be proven safe";
-            decision.action_title = "Begin mqtt live mutation workflow";
-            decision.action_detail = "Revisit MQTT remaining-length and payload framing before replacing this publish packet.";
-            return decision;
+            decision.validation = ValidationCode::MqttPidDriftRisk;
+            decision.review = ReviewCode::MqttPidDriftRisk;
+            return;
         }
 
         candidate.valid = true;
         decision.release = CandidateRelease::ReleaseModified;
         decision.outcome = ValidationOutcome::ValidationPassed;
-        decision.validation_label = candidate.size_delta == 0 ? "mqtt-publish-validated" : "mqtt-publish-reframed";
-        decision.validation_detail = "mqtt publish candidate validated and reframed";
+        decision.validation = candidate.size_delta == 0 ? ValidationCode::MqttPublishValidated : ValidationCode::MqttPublishReframed;
         if (config_.mqtt_review_threshold_bytes > 0 && candidate.payload_size >= config_.mqtt_review_threshold_bytes) {
             decision.review_required = true;
             decision.create_action_item = true;
-            decision.review_reason = "mqtt mutation exceeded configured review threshold";
-            decision.action_title = "Review mqtt mutation";
-            decision.action_detail = "MQTT mutation released successfully but crossed the configured review threshold.";
+            decision.review = ReviewCode::MqttThreshold;
         }
-        return decision;
     }
 
     std::string audit_label() const override { return "mqtt"; }
 
 private:
     MutationConfig config_;
+    ByteVec replacement_;
 };
 
 } // namespace
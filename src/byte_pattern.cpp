@@ -0,0 +1,145 @@
+#include "core/byte_pattern.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define GHOSTLINE_BYTE_SCAN_X86 1
+#endif
+
+namespace {
+
+#if defined(GHOSTLINE_BYTE_SCAN_X86)
+
+bool verify_middle(const byte* candidate, const byte* needle, std::size_t size) {
+    return size <= 2 || std::memcmp(candidate + 1, needle + 1, size - 2) == 0;
+}
+
+// Each scan returns the first match, or the first position it did not cover
+// through `resume` so the caller can finish the tail with Horspool.
+__attribute__((target("sse2")))
+std::size_t scan_sse2(ByteView haystack, const ByteVec& needle, std::size_t offset, std::size_t& resume) {
+    const std::size_t size = needle.size();
+    const byte* data = haystack.data();
+    const __m128i first = _mm_set1_epi8(static_cast<char>(needle.front()));
+    const __m128i last = _mm_set1_epi8(static_cast<char>(needle.back()));
+
+    std::size_t i = offset;
+    for (; i + size - 1 + 16 <= haystack.size(); i += 16) {
+        const __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + size - 1));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(head, first), _mm_cmpeq_epi8(tail, last))));
+        while (mask != 0) {
+            const unsigned bit = static_cast<unsigned>(__builtin_ctz(mask));
+            if (verify_middle(data + i + bit, needle.data(), size)) return i + bit;
+            mask &= mask - 1;
+        }
+    }
+    resume = i;
+    return std::string::npos;
+}
+
+__attribute__((target("avx2")))
+std::size_t scan_avx2(ByteView haystack, const ByteVec& needle, std::size_t offset, std::size_t& resume) {
+    const std::size_t size = needle.size();
+    const byte* data = haystack.data();
+    const __m256i first = _mm256_set1_epi8(static_cast<char>(needle.front()));
+    const __m256i last = _mm256_set1_epi8(static_cast<char>(needle.back()));
+
+    std::size_t i = offset;
+    for (; i + size - 1 + 32 <= haystack.size(); i += 32) {
+        const __m256i head = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        const __m256i tail = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + size - 1));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(head, first), _mm256_cmpeq_epi8(tail, last))));
+        while (mask != 0) {
+            const unsigned bit = static_cast<unsigned>(__builtin_ctz(mask));
+            if (verify_middle(data + i + bit, needle.data(), size)) return i + bit;
+            mask &= mask - 1;
+        }
+    }
+    resume = i;
+    return std::string::npos;
+}
+
+#endif
+
+ByteScanEngine detect_engine() {
+#if defined(GHOSTLINE_BYTE_SCAN_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return ByteScanEngine::Avx2;
+    if (__builtin_cpu_supports("sse2")) return ByteScanEngine::Sse2;
+#endif
+    return ByteScanEngine::Horspool;
+}
+
+} // namespace
+
+BytePattern::BytePattern(ByteView needle) : needle_(needle.to_vec()) {
+    const std::size_t size = needle_.size();
+    shift_.fill(static_cast<std::uint8_t>(std::min<std::size_t>(size == 0 ? 1 : size, 255)));
+    for (std::size_t i = 0; i + 1 < size; ++i) {
+        shift_[needle_[i]] = static_cast<std::uint8_t>(std::min<std::size_t>(size - 1 - i, 255));
+    }
+}
+
+std::size_t BytePattern::find(ByteView haystack, std::size_t offset) const {
+    static const ByteScanEngine engine = active_byte_scan_engine();
+    return find(haystack, offset, engine);
+}
+
+std::size_t BytePattern::find(ByteView haystack, std::size_t offset, ByteScanEngine engine) const {
+    const std::size_t size = needle_.size();
+    if (size == 0 || haystack.size() < size || offset > haystack.size() - size) return std::string::npos;
+
+    if (size == 1) {
+        const void* hit = std::memchr(haystack.data() + offset, needle_[0], haystack.size() - offset);
+        return hit == nullptr ? std::string::npos : static_cast<std::size_t>(static_cast<const byte*>(hit) - haystack.data());
+    }
+
+#if defined(GHOSTLINE_BYTE_SCAN_X86)
+    if (engine != ByteScanEngine::Horspool && byte_scan_engine_supported(engine)) {
+        std::size_t resume = offset;
+        const std::size_t found = engine == ByteScanEngine::Avx2
+            ? scan_avx2(haystack, needle_, offset, resume)
+            : scan_sse2(haystack, needle_, offset, resume);
+        if (found != std::string::npos) return found;
+        offset = resume;
+    }
+#else
+    (void)engine;
+#endif
+    return find_horspool(haystack, offset);
+}
+
+std::size_t BytePattern::find_horspool(ByteView haystack, std::size_t offset) const {
+    const std::size_t size = needle_.size();
+    const byte last = needle_.back();
+    for (std::size_t i = offset; i + size <= haystack.size(); i += shift_[haystack[i + size - 1]]) {
+        if (haystack[i + size - 1] == last && std::memcmp(haystack.data() + i, needle_.data(), size - 1) == 0) return i;
+    }
+    return std::string::npos;
+}
+
+ByteScanEngine active_byte_scan_engine() {
+    static const ByteScanEngine engine = detect_engine();
+    return engine;
+}
+
+bool byte_scan_engine_supported(ByteScanEngine engine) {
+    switch (engine) {
+        case ByteScanEngine::Horspool: return true;
+        case ByteScanEngine::Sse2: return active_byte_scan_engine() != ByteScanEngine::Horspool;
+        case ByteScanEngine::Avx2: return active_byte_scan_engine() == ByteScanEngine::Avx2;
+    }
+    return false;
+}
+
+const char* byte_scan_engine_name(ByteScanEngine engine) {
+    switch (engine) {
+        case ByteScanEngine::Horspool: return "horspool";
+        case ByteScanEngine::Sse2: return "sse2";
+        case ByteScanEngine::Avx2: return "avx2";
+    }
+    return "unknown";
+}
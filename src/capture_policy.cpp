@@ -0,0 +1,112 @@
+#include "ghostline/capture_policy.hpp"
+#include "core/xxhash64.hpp"
+
+#include <stdexcept>
+
+namespace {
+
+bool parse_count(const std::string& text, std::uint64_t& value) {
+    if (text.empty() || text.size() > 12) return false;
+    value = 0;
+    for (char ch : text) {
+        if (ch < '0' || ch > '9') return false;
+        value = value * 10 + static_cast<std::uint64_t>(ch - '0');
+    }
+    return true;
+}
+
+} // namespace
+
+bool parse_capture_policy(const std::string& text, CapturePolicy& policy) {
+    CapturePolicy parsed;
+    const std::size_t colon = text.find(':');
+    const std::string mode = text.substr(0, colon);
+    const std::string argument = colon == std::string::npos ? std::string() : text.substr(colon + 1);
+    std::uint64_t count = 0;
+    if (mode == "full" && colon == std::string::npos) {
+        parsed.mode = CaptureMode::Full;
+    } else if (mode == "hash" && colon == std::string::npos) {
+        parsed.mode = CaptureMode::Hash;
+    } else if (mode == "head" && parse_count(argument, count)) {
+        parsed.mode = CaptureMode::Head;
+        parsed.head_bytes = static_cast<std::size_t>(count);
+    } else if (mode == "sample" && parse_count(argument, count) && count >= 1 && count <= 0xffffffffULL) {
+        parsed.mode = CaptureMode::Sample;
+        parsed.sample_every = static_cast<std::uint32_t>(count);
+    } else {
+        return false;
+    }
+    policy = parsed;
+    return true;
+}
+
+std::string capture_policy_name(const CapturePolicy& policy) {
+    switch (policy.mode) {
+        case CaptureMode::Full: return "full";
+        case CaptureMode::Head: return "head:" + std::to_string(policy.head_bytes);
+        case CaptureMode::Sample: return "sample:" + std::to_string(policy.sample_every);
+        case CaptureMode::Hash: return "hash";
+    }
+    return "full";
+}
+
+int CapturePolicySet::find(const std::string& plugin_name) const {
+    for (std::size_t i = 0; i < plugins.size(); ++i) {
+        if (plugins[i] == plugin_name) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+bool CapturePolicySet::all_full() const {
+    if (fallback.mode != CaptureMode::Full) return false;
+    for (std::size_t i = 0; i < policies.size(); ++i) {
+        if (policies[i].mode != CaptureMode::Full) return false;
+    }
+    return true;
+}
+
+void add_capture_spec(CapturePolicySet& set, const std::string& spec) {
+    const std::size_t equals = spec.find('=');
+    const std::string plugin = equals == std::string::npos ? std::string() : spec.substr(0, equals);
+    const std::string text = equals == std::string::npos ? spec : spec.substr(equals + 1);
+    CapturePolicy policy;
+    if (!parse_capture_policy(text, policy)) {
+        throw std::runtime_error("invalid capture policy: " + spec + " (expected [plugin=]full|head:<n>|sample:<n>|hash)");
+    }
+    if (equals == std::string::npos) {
+        set.fallback = policy;
+        return;
+    }
+    if (plugin.empty()) throw std::runtime_error("invalid capture policy: " + spec + " (empty plugin name)");
+    const int index = set.find(plugin);
+    if (index >= 0) {
+        set.policies[static_cast<std::size_t>(index)] = policy;
+    } else {
+        set.plugins.push_back(plugin);
+        set.policies.push_back(policy);
+    }
+}
+
+PayloadCapture capture_payload(CaptureForm form, ByteView original, ByteView modified, std::size_t head_bytes) {
+    PayloadCapture capture;
+    capture.form = form;
+    capture.original_len = original.size();
+    capture.modified_len = modified.size();
+    switch (form) {
+        case CaptureForm::Full:
+            capture.original = original;
+            capture.modified = modified;
+            break;
+        case CaptureForm::Head:
+            capture.original = original.subview(0, head_bytes);
+            capture.modified = modified.subview(0, head_bytes);
+            break;
+        case CaptureForm::Hash:
+            capture.original_hash = xxhash64(original);
+            capture.modified_hash = xxhash64(modified);
+            break;
+        case CaptureForm::Lengths:
+            break;
+    }
+    return capture;
+}
@@ -0,0 +1,403 @@
+#include "net/event_backend.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <unistd.h>
+#include <unordered_map>
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#endif
+
+#if defined(GHOSTLINE_HAVE_LIBURING)
+#include <liburing.h>
+#endif
+
+namespace {
+
+class PollBackend : public EventBackend {
+public:
+    const char* name() const override { return "poll"; }
+
+    bool add(int fd, std::uint64_t token, std::uint32_t interest) override {
+        if (index_.count(fd) != 0) return modify(fd, token, interest);
+        pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = to_poll_events(interest);
+        pfd.revents = 0;
+        index_[fd] = fds_.size();
+        fds_.push_back(pfd);
+        tokens_.push_back(token);
+        return true;
+    }
+
+    bool modify(int fd, std::uint64_t token, std::uint32_t interest) override {
+        std::unordered_map<int, std::size_t>::const_iterator it = index_.find(fd);
+        if (it == index_.end()) return add(fd, token, interest);
+        fds_[it->second].events = to_poll_events(interest);
+        tokens_[it->second] = token;
+        return true;
+    }
+
+    void remove(int fd) override {
+        std::unordered_map<int, std::size_t>::iterator it = index_.find(fd);
+        if (it == index_.end()) return;
+        const std::size_t slot = it->second;
+        const std::size_t last = fds_.size() - 1;
+        if (slot != last) {
+            fds_[slot] = fds_[last];
+            tokens_[slot] = tokens_[last];
+            index_[fds_[slot].fd] = slot;
+        }
+        fds_.pop_back();
+        tokens_.pop_back();
+        index_.erase(fd);
+    }
+
+    int wait(std::vector<IoEvent>& events, int timeout_ms) override {
+        events.clear();
+        const int ready = ::poll(fds_.data(), fds_.size(), timeout_ms);
+        if (ready <= 0) return ready;
+
+        for (std::size_t i = 0; i < fds_.size() && static_cast<int>(events.size()) < ready; ++i) {
+            const short revents = fds_[i].revents;
+            if (revents == 0) continue;
+            IoEvent event;
+            event.token = tokens_[i];
+            event.readable = (revents & (POLLIN | POLLHUP)) != 0;
+            event.writable = (revents & POLLOUT) != 0;
+            event.error = (revents & (POLLERR | POLLNVAL)) != 0;
+            events.push_back(event);
+        }
+        return static_cast<int>(events.size());
+    }
+
+private:
+    static short to_poll_events(std::uint32_t interest) {
+        short events = 0;
+        if (interest & kInterestRead) events |= POLLIN;
+        if (interest & kInterestWrite) events |= POLLOUT;
+        return events;
+    }
+
+    std::vector<pollfd> fds_;
+    std::vector<std::uint64_t> tokens_;
+    std::unordered_map<int, std::size_t> index_;
+};
+
+#if defined(__linux__)
+
+class EpollBackend : public EventBackend {
+public:
+    EpollBackend(int epoll_fd, bool edge_triggered)
+        : epoll_fd_(epoll_fd), edge_triggered_(edge_triggered), ready_(256) {}
+
+    ~EpollBackend() override {
+        if (epoll_fd_ >= 0) ::close(epoll_fd_);
+    }
+
+    const char* name() const override { return edge_triggered_ ? "epoll-et" : "epoll"; }
+
+    bool add(int fd, std::uint64_t token, std::uint32_t interest) override {
+        epoll_event ev = make_event(token, interest);
+        if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) == 0) return true;
+        if (errno == EEXIST) return ::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev) == 0;
+        return false;
+    }
+
+    bool modify(int fd, std::uint64_t token, std::uint32_t interest) override {
+        epoll_event ev = make_event(token, interest);
+        return ::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev) == 0;
+    }
+
+    void remove(int fd) override {
+        epoll_event ev;
+        std::memset(&ev, 0, sizeof(ev));
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, &ev);
+    }
+
+    int wait(std::vector<IoEvent>& events, int timeout_ms) override {
+        events.clear();
+        const int ready = ::epoll_wait(epoll_fd_, ready_.data(), static_cast<int>(ready_.size()), timeout_ms);
+        if (ready <= 0) return ready;
+
+        for (int i = 0; i < ready; ++i) {
+            const std::uint32_t mask = ready_[static_cast<std::size_t>(i)].events;
+            IoEvent event;
+            event.token = ready_[static_cast<std::size_t>(i)].data.u64;
+            event.readable = (mask & (EPOLLIN | EPOLLHUP | EPOLLRDHUP)) != 0;
+            event.writable = (mask & EPOLLOUT) != 0;
+            event.error = (mask & EPOLLERR) != 0;
+            events.push_back(event);
+        }
+        if (static_cast<std::size_t>(ready) == ready_.size()) ready_.resize(ready_.size() * 2);
+        return ready;
+    }
+
+private:
+    epoll_event make_event(std::uint64_t token, std::uint32_t interest) const {
+        epoll_event ev;
+        std::memset(&ev, 0, sizeof(ev));
+        if (interest & kInterestRead) ev.events |= EPOLLIN | EPOLLRDHUP;
+        if (interest & kInterestWrite) ev.events |= EPOLLOUT;
+        if (edge_triggered_) ev.events |= EPOLLET;
+        ev.data.u64 = token;
+        return ev;
+    }
+
+    int epoll_fd_;
+    bool edge_triggered_;
+    std::vector<epoll_event> ready_;
+};
+
+#endif
+
+#if defined(GHOSTLINE_HAVE_LIBURING)
+
+// One-shot IORING_OP_POLL_ADD per registered fd, re-armed before each wait so
+// the caller sees level-triggered readiness. user_data packs the fd with an
+// arm generation drawn from one backend-wide counter, so a completion from a
+// superseded arm is dropped even after the fd number is closed and reused.
+class IoUringBackend : public EventBackend {
+public:
+    IoUringBackend() = default;
+
+    ~IoUringBackend() override {
+        if (initialized_) io_uring_queue_exit(&ring_);
+    }
+
+    bool init(std::string& error) {
+        const int rc = io_uring_queue_init(1024, &ring_, 0);
+        if (rc < 0) {
+            error = std::string("io_uring_queue_init failed: ") + std::strerror(-rc);
+            return false;
+        }
+        initialized_ = true;
+        return true;
+    }
+
+    const char* name() const override { return "io-uring"; }
+
+    bool add(int fd, std::uint64_t token, std::uint32_t interest) override {
+        Registration& reg = registrations_[fd];
+        reg.token = token;
+        reg.interest = interest;
+        disarm(fd, reg);
+        return true;
+    }
+
+    bool modify(int fd, std::uint64_t token, std::uint32_t interest) override {
+        std::unordered_map<int, Registration>::iterator it = registrations_.find(fd);
+        if (it == registrations_.end()) return add(fd, token, interest);
+        it->second.token = token;
+        if (it->second.interest != interest) {
+            it->second.interest = interest;
+            disarm(fd, it->second);
+        }
+        return true;
+    }
+
+    void remove(int fd) override {
+        std::unordered_map<int, Registration>::iterator it = registrations_.find(fd);
+        if (it == registrations_.end()) return;
+        disarm(fd, it->second);
+        registrations_.erase(it);
+        // The in-flight poll holds a file reference; make sure the cancel is
+        // submitted before the caller closes the fd.
+        io_uring_submit(&ring_);
+    }
+
+    int wait(std::vector<IoEvent>& events, int timeout_ms) override {
+        events.clear();
+        for (std::unordered_map<int, Registration>::iterator it = registrations_.begin(); it != registrations_.end(); ++it) {
+            if (!it->second.armed) arm(it->first, it->second);
+        }
+
+        io_uring_cqe* cqe = nullptr;
+        int rc = 0;
+        if (timeout_ms < 0) {
+            rc = io_uring_submit_and_wait(&ring_, 1);
+        } else {
+            io_uring_submit(&ring_);
+            __kernel_timespec ts;
+            ts.tv_sec = timeout_ms / 1000;
+            ts.tv_nsec = static_cast<long long>(timeout_ms % 1000) * 1000000LL;
+            rc = io_uring_wait_cqe_timeout(&ring_, &cqe, &ts);
+            if (rc == -ETIME) return 0;
+        }
+        if (rc < 0) {
+            errno = -rc;
+            return -1;
+        }
+
+        while (io_uring_peek_cqe(&ring_, &cqe) == 0 && cqe != nullptr) {
+            const std::uint64_t data = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(io_uring_cqe_get_data(cqe)));
+            const int res = cqe->res;
+            io_uring_cqe_seen(&ring_, cqe);
+            if ((data & kRemoveTag) != 0) continue;
+
+            const int fd = static_cast<int>(data & 0xffffffffULL);
+            const std::uint32_t generation = static_cast<std::uint32_t>((data >> 32U) & 0x7fffffffU);
+            std::unordered_map<int, Registration>::iterator it = registrations_.find(fd);
+            if (it == registrations_.end() || it->second.generation != generation) continue;
+            it->second.armed = false;
+            if (res < 0) continue;
+
+            IoEvent event;
+            event.token = it->second.token;
+            event.readable = (res & (POLLIN | POLLHUP | POLLRDHUP)) != 0;
+            event.writable = (res & POLLOUT) != 0;
+            event.error = (res & (POLLERR | POLLNVAL)) != 0;
+            events.push_back(event);
+        }
+        return static_cast<int>(events.size());
+    }
+
+private:
+    static constexpr std::uint64_t kRemoveTag = 1ULL << 63U;
+
+    struct Registration {
+        std::uint64_t token = 0;
+        std::uint32_t interest = 0;
+        std::uint32_t generation = 0;
+        bool armed = false;
+    };
+
+    static std::uint64_t user_data(int fd, std::uint32_t generation) {
+        return (static_cast<std::uint64_t>(generation & 0x7fffffffU) << 32U) | static_cast<std::uint32_t>(fd);
+    }
+
+    io_uring_sqe* next_sqe() {
+        io_uring_sqe* sqe = io_uring_get_sqe(&ring_);
+        if (sqe == nullptr) {
+            io_uring_submit(&ring_);
+            sqe = io_uring_get_sqe(&ring_);
+        }
+        return sqe;
+    }
+
+    void arm(int fd, Registration& reg) {
+        io_uring_sqe* sqe = next_sqe();
+        if (sqe == nullptr) return;
+        unsigned mask = POLLERR | POLLHUP;
+        if (reg.interest & kInterestRead) mask |= POLLIN | POLLRDHUP;
+        if (reg.interest & kInterestWrite) mask |= POLLOUT;
+        io_uring_prep_poll_add(sqe, fd, mask);
+        io_uring_sqe_set_data(sqe, reinterpret_cast<void*>(static_cast<std::uintptr_t>(user_data(fd, reg.generation))));
+        reg.armed = true;
+    }
+
+    void disarm(int fd, Registration& reg) {
+        if (reg.armed) {
+            io_uring_sqe* sqe = next_sqe();
+            if (sqe != nullptr) {
+                // Built by hand: io_uring_prep_poll_remove changed its
+                // argument type across liburing releases.
+                io_uring_prep_rw(IORING_OP_POLL_REMOVE, sqe, -1, nullptr, 0, 0);
+                sqe->addr = user_data(fd, reg.generation);
+                io_uring_sqe_set_data(sqe, reinterpret_cast<void*>(static_cast<std::uintptr_t>(kRemoveTag)));
+            }
+        }
+        reg.generation = next_generation_++ & 0x7fffffffU;
+        reg.armed = false;
+    }
+
+    io_uring ring_;
+    bool initialized_ = false;
+    std::uint32_t next_generation_ = 1;
+    std::unordered_map<int, Registration> registrations_;
+};
+
+#endif
+
+} // namespace
+
+bool parse_event_backend(const std::string& name, EventBackendKind& kind) {
+    if (name == "auto") kind = EventBackendKind::Auto;
+    else if (name == "poll") kind = EventBackendKind::Poll;
+    else if (name == "epoll") kind = EventBackendKind::Epoll;
+    else if (name == "epoll-et") kind = EventBackendKind::EpollEdge;
+    else if (name == "io-uring" || name == "io_uring") kind = EventBackendKind::IoUring;
+    else return false;
+    return true;
+}
+
+const char* event_backend_name(EventBackendKind kind) {
+    switch (kind) {
+        case EventBackendKind::Auto: return "auto";
+        case EventBackendKind::Poll: return "poll";
+        case EventBackendKind::Epoll: return "epoll";
+        case EventBackendKind::EpollEdge: return "epoll-et";
+        case EventBackendKind::IoUring: return "io-uring";
+    }
+    return "unknown";
+}
+
+bool event_backend_available(EventBackendKind kind) {
+    switch (kind) {
+        case EventBackendKind::Auto:
+        case EventBackendKind::Poll:
+            return true;
+        case EventBackendKind::Epoll:
+        case EventBackendKind::EpollEdge:
+#if defined(__linux__)
+            return true;
+#else
+            return false;
+#endif
+        case EventBackendKind::IoUring:
+#if defined(GHOSTLINE_HAVE_LIBURING)
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+std::unique_ptr<EventBackend> make_event_backend(EventBackendKind kind, std::string& error) {
+    if (kind == EventBackendKind::Auto) {
+#if defined(__linux__)
+        kind = EventBackendKind::Epoll;
+#else
+        kind = EventBackendKind::Poll;
+#endif
+    }
+
+    if (!event_backend_available(kind)) {
+        error = std::string("event backend ") + event_backend_name(kind) + " is not available in this build";
+        return nullptr;
+    }
+
+    switch (kind) {
+        case EventBackendKind::Auto:
+        case EventBackendKind::Poll:
+            return std::unique_ptr<EventBackend>(new PollBackend());
+        case EventBackendKind::Epoll:
+        case EventBackendKind::EpollEdge: {
+#if defined(__linux__)
+            const int epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+            if (epoll_fd < 0) {
+                error = std::string("epoll_create1 failed: ") + std::strerror(errno);
+                return nullptr;
+            }
+            return std::unique_ptr<EventBackend>(new EpollBackend(epoll_fd, kind == EventBackendKind::EpollEdge));
+#else
+            break;
+#endif
+        }
+        case EventBackendKind::IoUring: {
+#if defined(GHOSTLINE_HAVE_LIBURING)
+            std::unique_ptr<IoUringBackend> backend(new IoUringBackend());
+            if (!backend->init(error)) return nullptr;
+            return std::unique_ptr<EventBackend>(backend.release());
+#else
+            break;
+#endif
+        }
+    }
+
+    error = std::string("event backend ") + event_backend_name(kind) + " is not available in this build";
+    return nullptr;
+}
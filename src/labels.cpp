@@ -0,0 +1,240 @@
+#include "ghostline/labels.hpp"
+
+#include <cstddef>
+
+namespace {
+
+struct ValidationText {
+    ValidationCode code;
+    const char* label;
+    const char* detail;
+    const char* fallback;
+};
+
+// Indexed by ValidationCode; each row repeats its code so a reordered enum
+// trips the check in validation_row() instead of printing the wrong text.
+const ValidationText kValidationTable[] = {
+    {ValidationCode::None, "", "", ""},
+    {ValidationCode::RawLiveDirectionFilter, "raw-live-direction-filter", "raw live mutation disabled for this direction", "raw live direction is observe-only"},
+    {ValidationCode::RawLiveNoMatch, "raw-live-no-match", "raw live mutation did not find a matching region", "raw live candidate produced no mutation"},
+    {ValidationCode::RawLiveSizeBlocked, "raw-live-size-blocked", "operator disabled raw live size mutations", "raw live size mutation not allowed"},
+    {ValidationCode::RawLiveValidated, "raw-live-validated", "raw live mutation validated inline", ""},
+    {ValidationCode::RawLiveSizeMutated, "raw-live-size-mutated", "raw live mutation validated with a chunk size change", ""},
+    {ValidationCode::ByteWindowDirectionFilter, "byte-window-direction-filter", "byte-window mutation disabled for this direction", "byte-window direction is observe-only"},
+    {ValidationCode::ByteWindowNoOp, "no-op", "byte-window replacement produced no safe delta", "replacement produced no safe delta"},
+    {ValidationCode::ByteWindowSizeBlocked, "size-mutation-blocked", "operator disabled size mutations", "size mutation not allowed"},
+    {ValidationCode::ByteWindowPidDriftRisk, "pid-drift-risk", "size-changing byte-window mutation could not prove a dependent header rewrite", "size mutation could not be proven safe"},
+    {ValidationCode::ByteWindowAllowSizeMutated, "allow-size-mutated", "byte-window candidate validated", ""},
+    {ValidationCode::ByteWindowValidated, "validated", "byte-window candidate validated", ""},
+    {ValidationCode::ObservationOnly, "observe-only", "protocol plugin provided detection and audit only", "protocol plugin has detection and audit only in Phase 1"},
+    {ValidationCode::MqttControlObserveOnly, "framed-observe-only", "mqtt control packets are framed and audited first", "mqtt control packet kept on original path"},
+    {ValidationCode::MqttDirectionFilter, "mqtt-direction-filter", "mqtt mutation disabled for this direction", "mqtt direction is observe-only"},
+    {ValidationCode::MqttOpaquePayload, "opaque-publish-payload", "mqtt publish payload did not look safely mutable", "mqtt payload appeared opaque and was kept original"},
+    {ValidationCode::MqttNoOp, "no-op", "no replacement text or no safe payload delta", "mqtt publish produced no safe delta"},
+    {ValidationCode::MqttReframeInvalid, "mqtt-reframe-invalid", "mqtt reframed publish failed validation", "mqtt reframe validation failed"},
+    {ValidationCode::MqttSizeBlocked, "mqtt-size-mutation-blocked", "operator disabled size-changing mqtt mutations", "mqtt size mutation not allowed"},
+    {ValidationCode::MqttPidDriftRisk, "mqtt-pid-drift-risk", "size-changing mqtt publish candidate lacked a safe remaining-length rewrite", "mqtt size mutation could not be proven safe"},
+    {ValidationCode::MqttPublishValidated, "mqtt-publish-validated", "mqtt publish candidate validated and reframed", ""},
+    {ValidationCode::MqttPublishReframed, "mqtt-publish-reframed", "mqtt publish candidate validated and reframed", ""},
+};
+
+struct ReviewText {
+    ReviewCode code;
+    const char* reason;
+    const char* action_title;
+    const char* action_detail;
+};
+
+const ReviewText kReviewTable[] = {
+    {ReviewCode::None, "", "", ""},
+    {ReviewCode::RawLiveSizeBlocked, "size-changing raw live mutation requires review", "Review raw live mutation", "Ghostline preserved original raw bytes because the live mutation changed size and was not allowed."},
+    {ReviewCode::RawLiveThreshold, "raw live mutation exceeded configured review threshold", "Review raw live mutation", "Raw live mutation released successfully but crossed the configured review threshold."},
+    {ReviewCode::RawLiveSizeChange, "raw live size mutation should be reviewed in audit trail", "", ""},
+    {ReviewCode::ByteWindowSizeBlocked, "", "Begin framing mutation workflow", "Ghostline preserved original bytes because the candidate changed size without allow-size-mutation enabled."},
+    {ReviewCode::ByteWindowPidDriftRisk, "", "Begin live mutation workflow", "Locate header byte size, compute delta, and mutate dependent fields before retrying."},
+    {ReviewCode::ByteWindowThreshold, "byte-window mutation exceeded configured review threshold", "Review byte-window mutation", "Byte-window mutation released successfully but crossed the configured review threshold."},
+    {ReviewCode::MqttOpaquePayload, "", "Begin mqtt live mutation workflow", "Inspect MQTT publish payload framing and decide whether a live mutation attempt is safe."},
+    {ReviewCode::MqttReframeInvalid, "", "Begin mqtt live mutation workflow", "Ghostline could not validate the reframed MQTT publish packet and preserved the original bytes."},
+    {ReviewCode::MqttSizeBlocked, "", "Begin mqtt live mutation workflow", "Allow size mutation or keep observing the MQTT flow before attempting another payload rewrite."},
+    {ReviewCode::MqttPidDriftRisk, "", "Begin mqtt live mutation workflow", "Revisit MQTT remaining-length and payload framing before replacing this publish packet."},
+    {ReviewCode::MqttThreshold, "mqtt mutation exceeded configured review threshold", "Review mqtt mutation", "MQTT mutation released successfully but crossed the configured review threshold."},
+};
+
+const char* const kEventTypeNames[] = {
+    "unknown",
+    "plugin-detect",
+    "framed-packet",
+    "candidate",
+    "candidate-release-original",
+    "candidate-release-modified",
+    "framing-buffer-ceiling",
+    "framing-failed",
+    "framing-pass-through",
+    "hold-deadline-flush",
+    "read-close-flush-original",
+    "splice-passthrough",
+    "backpressure-pause",
+    "backpressure-resume",
+    "backpressure-global-pause",
+    "backpressure-global-resume",
+    "memory-budget-enforced",
+    "memory-budget-release-original",
+    "observe-transition",
+    "flow-io-stats",
+    "worker-io-stats",
+    "worker-memory-stats",
+    "rules-reloaded",
+};
+
+constexpr std::size_t kValidationCount = sizeof(kValidationTable) / sizeof(kValidationTable[0]);
+constexpr std::size_t kReviewCount = sizeof(kReviewTable) / sizeof(kReviewTable[0]);
+constexpr std::size_t kEventTypeCount = sizeof(kEventTypeNames) / sizeof(kEventTypeNames[0]);
+
+static_assert(kValidationCount == static_cast<std::size_t>(ValidationCode::MqttPublishReframed) + 1, "every ValidationCode needs a table row");
+static_assert(kReviewCount == static_cast<std::size_t>(ReviewCode::MqttThreshold) + 1, "every ReviewCode needs a table row");
+static_assert(kEventTypeCount == static_cast<std::size_t>(AuditEventType::RulesReloaded) + 1, "every AuditEventType needs a name");
+
+const ValidationText& validation_row(ValidationCode code) {
+    const std::size_t index = static_cast<std::size_t>(code);
+    if (index >= kValidationCount || kValidationTable[index].code != code) return kValidationTable[0];
+    return kValidationTable[index];
+}
+
+const ReviewText& review_row(ReviewCode code) {
+    const std::size_t index = static_cast<std::size_t>(code);
+    if (index >= kReviewCount || kReviewTable[index].code != code) return kReviewTable[0];
+    return kReviewTable[index];
+}
+
+void append_number(std::string& out, std::uint64_t value) {
+    char digits[20];
+    std::size_t count = 0;
+    do {
+        digits[count++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (count != 0) out.push_back(digits[--count]);
+}
+
+void append_sequence_id(std::string& out, const char* kind, std::uint32_t flow_id, Direction direction, const std::string& plugin_name, std::uint64_t sequence) {
+    out.append(kind);
+    append_number(out, flow_id);
+    out.push_back('-');
+    out.append(direction_code(direction));
+    out.push_back('-');
+    out.append(plugin_name);
+    out.push_back('-');
+    append_number(out, sequence);
+}
+
+} // namespace
+
+const char* direction_name(Direction direction) {
+    return direction == Direction::ClientToServer ? "client_to_server" : "server_to_client";
+}
+
+const char* direction_code(Direction direction) {
+    return direction == Direction::ClientToServer ? "c2s" : "s2c";
+}
+
+const char* flag_name(FlowFlag flag) {
+    switch (flag) {
+        case FlowFlag::ObserveOnly: return "observe-only";
+        case FlowFlag::AllowSizeMutated: return "allow-size-mutated";
+        case FlowFlag::PidDriftRisk: return "pid-drift-risk";
+    }
+    return "unknown";
+}
+
+const char* stage_name(WorkflowStage stage) {
+    switch (stage) {
+        case WorkflowStage::Observe: return "observe";
+        case WorkflowStage::Triggered: return "triggered";
+        case WorkflowStage::Framed: return "framed";
+        case WorkflowStage::CandidateBuilt: return "candidate-built";
+        case WorkflowStage::CandidateReviewed: return "candidate-reviewed";
+        case WorkflowStage::ReleasedOriginal: return "released-original";
+        case WorkflowStage::ReleasedModified: return "released-modified";
+        case WorkflowStage::ObserveTransition: return "observe-transition";
+        case WorkflowStage::ActionCreated: return "action-created";
+    }
+    return "unknown";
+}
+
+const char* audit_event_type_name(AuditEventType type) {
+    const std::size_t index = static_cast<std::size_t>(type);
+    return index < kEventTypeCount ? kEventTypeNames[index] : kEventTypeNames[0];
+}
+
+const char* validation_label(ValidationCode code) {
+    return validation_row(code).label;
+}
+
+const char* validation_detail(ValidationCode code) {
+    return validation_row(code).detail;
+}
+
+const char* fallback_reason(ValidationCode code) {
+    return validation_row(code).fallback;
+}
+
+const char* validation_detail(const CandidateDecision& decision) {
+    return decision.validation_note.empty() ? validation_detail(decision.validation) : decision.validation_note.c_str();
+}
+
+const char* review_reason(ReviewCode code) {
+    return review_row(code).reason;
+}
+
+const char* action_title(ReviewCode code) {
+    return review_row(code).action_title;
+}
+
+const char* action_detail(ReviewCode code) {
+    return review_row(code).action_detail;
+}
+
+void append_trigger_id(std::string& out, std::uint32_t flow_id, Direction direction, const std::string& plugin_name, std::uint64_t sequence) {
+    append_sequence_id(out, "trigger-", flow_id, direction, plugin_name, sequence);
+}
+
+void append_candidate_id(std::string& out, std::uint32_t flow_id, Direction direction, const std::string& plugin_name, std::uint64_t sequence) {
+    append_sequence_id(out, "candidate-", flow_id, direction, plugin_name, sequence);
+}
+
+void append_event_id(std::string& out, const AuditEvent& event) {
+    switch (event.type) {
+        case AuditEventType::Candidate:
+            if (event.candidate_sequence == 0) return;
+            append_candidate_id(out, event.flow_id, event.direction, event.plugin_name, event.candidate_sequence);
+            out.append("-result");
+            return;
+        case AuditEventType::ObserveTransition:
+            out.append("event-");
+            append_number(out, event.flow_id);
+            out.append("-observe-transition");
+            return;
+        default:
+            break;
+    }
+    out.append("event-");
+    append_number(out, event.flow_id);
+    out.push_back('-');
+    out.append(direction_code(event.direction));
+    out.push_back('-');
+    append_number(out, event.sequence);
+    out.push_back('-');
+    out.append(event.type == AuditEventType::PluginDetect ? "detect" : audit_event_type_name(event.type));
+}
+
+std::string format_trigger_id(std::uint32_t flow_id, Direction direction, const std::string& plugin_name, std::uint64_t sequence) {
+    std::string out;
+    append_trigger_id(out, flow_id, direction, plugin_name, sequence);
+    return out;
+}
+
+std::string format_candidate_id(std::uint32_t flow_id, Direction direction, const std::string& plugin_name, std::uint64_t sequence) {
+    std::string out;
+    append_candidate_id(out, flow_id, direction, plugin_name, sequence);
+    return out;
+}
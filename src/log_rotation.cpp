@@ -0,0 +1,325 @@
+#include "ghostline/log_rotation.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+
+#if defined(GHOSTLINE_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+
+namespace {
+
+constexpr std::size_t kCopyChunkBytes = 256 * 1024;
+
+std::uint64_t steady_ms() {
+    using namespace std::chrono;
+    return static_cast<std::uint64_t>(duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+bool ends_with(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+struct Segment {
+    std::uint64_t index = 0;
+    std::string path;
+};
+
+// Rotated segments of `path` ordered by index. A segment caught between
+// compression and removal of its plain copy is listed once, as the plain
+// file, which is always complete.
+std::vector<Segment> rotated_segments(const std::string& path) {
+    namespace fs = std::filesystem;
+    const fs::path active(path);
+    const fs::path dir = active.has_parent_path() ? active.parent_path() : fs::path(".");
+    const std::string prefix = active.filename().string() + ".";
+
+    std::map<std::uint64_t, std::string> found;
+    std::error_code error;
+    for (fs::directory_iterator it(dir, error), end; !error && it != end; it.increment(error)) {
+        const std::string name = it->path().filename().string();
+        if (name.size() <= prefix.size() || name.compare(0, prefix.size(), prefix) != 0) continue;
+        std::string rest = name.substr(prefix.size());
+        const bool compressed = ends_with(rest, ".gz");
+        if (compressed) rest.resize(rest.size() - 3);
+        if (rest.empty() || rest.size() > 18 || rest.find_first_not_of("0123456789") != std::string::npos) continue;
+
+        const std::uint64_t index = std::stoull(rest);
+        const auto existing = found.find(index);
+        if (existing == found.end() || (!compressed && ends_with(existing->second, ".gz"))) {
+            found[index] = (active.has_parent_path() ? (dir / name) : fs::path(name)).string();
+        }
+    }
+
+    std::vector<Segment> segments;
+    for (const auto& entry : found) segments.push_back(Segment{entry.first, entry.second});
+    return segments;
+}
+
+#if defined(GHOSTLINE_HAVE_ZLIB)
+// Writes `segment`.gz through a temporary name and removes the plain copy
+// only once the compressed one is complete.
+bool gzip_segment(const std::string& segment) {
+    const std::string target = segment + ".gz";
+    const std::string temp = target + ".tmp";
+    const int in = ::open(segment.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) return false;
+    gzFile out = gzopen(temp.c_str(), "wb6");
+    if (out == nullptr) {
+        ::close(in);
+        return false;
+    }
+
+    std::vector<char> buffer(kCopyChunkBytes);
+    bool ok = true;
+    while (ok) {
+        const ssize_t n = ::read(in, buffer.data(), buffer.size());
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            ok = n == 0;
+            break;
+        }
+        ok = gzwrite(out, buffer.data(), static_cast<unsigned>(n)) == static_cast<int>(n);
+    }
+    ::close(in);
+    if (gzclose(out) != Z_OK) ok = false;
+    if (!ok || ::rename(temp.c_str(), target.c_str()) != 0) {
+        ::unlink(temp.c_str());
+        return false;
+    }
+    ::unlink(segment.c_str());
+    return true;
+}
+#endif
+
+struct MaintenanceJob {
+    std::string path;
+    std::string segment;
+    LogRotationOptions options;
+};
+
+// One thread for the whole process: compression is CPU-bound and rare, and
+// serializing it keeps pruning from racing a segment still being written.
+class LogMaintenance {
+public:
+    ~LogMaintenance() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        if (thread_.joinable()) thread_.join();
+    }
+
+    void post(MaintenanceJob&& job) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!thread_.joinable()) thread_ = std::thread([this]() { run(); });
+        jobs_.push_back(std::move(job));
+        ++outstanding_;
+        wake_.notify_all();
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this]() { return outstanding_ == 0; });
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            wake_.wait(lock, [this]() { return stop_ || !jobs_.empty(); });
+            if (jobs_.empty()) return;
+            MaintenanceJob job = std::move(jobs_.front());
+            jobs_.pop_front();
+            lock.unlock();
+            try {
+                process(job);
+            } catch (const std::exception& error) {
+                std::fprintf(stderr, "log maintenance failed for %s: %s\n", job.segment.c_str(), error.what());
+            }
+            lock.lock();
+            --outstanding_;
+            done_.notify_all();
+        }
+    }
+
+    static void process(const MaintenanceJob& job) {
+#if defined(GHOSTLINE_HAVE_ZLIB)
+        // A later job's pruning may already have removed this segment.
+        if (job.options.compression == LogCompression::Gzip && ::access(job.segment.c_str(), F_OK) == 0 && !gzip_segment(job.segment)) {
+            std::fprintf(stderr, "log maintenance could not compress %s; leaving it uncompressed\n", job.segment.c_str());
+        }
+#endif
+        if (job.options.keep == 0) return;
+        const std::vector<Segment> segments = rotated_segments(job.path);
+        if (segments.size() <= job.options.keep) return;
+        const std::size_t excess = segments.size() - job.options.keep;
+        for (std::size_t i = 0; i < excess; ++i) {
+            if (::unlink(segments[i].path.c_str()) != 0 && errno != ENOENT) {
+                std::fprintf(stderr, "log maintenance failed to remove %s: %s\n", segments[i].path.c_str(), std::strerror(errno));
+            }
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    std::deque<MaintenanceJob> jobs_;
+    std::size_t outstanding_ = 0;
+    bool stop_ = false;
+    std::thread thread_;
+};
+
+LogMaintenance& maintenance() {
+    static LogMaintenance instance;
+    return instance;
+}
+
+} // namespace
+
+bool parse_log_compression(const std::string& name, LogCompression& compression) {
+    if (name == "none") compression = LogCompression::None;
+    else if (name == "gzip") compression = LogCompression::Gzip;
+    else return false;
+    return true;
+}
+
+const char* log_compression_name(LogCompression compression) {
+    switch (compression) {
+        case LogCompression::None: return "none";
+        case LogCompression::Gzip: return "gzip";
+    }
+    return "unknown";
+}
+
+bool log_compression_available(LogCompression compression) {
+#if defined(GHOSTLINE_HAVE_ZLIB)
+    return compression == LogCompression::None || compression == LogCompression::Gzip;
+#else
+    return compression == LogCompression::None;
+#endif
+}
+
+std::shared_ptr<LogRotator> LogRotator::for_path(const std::string& path, const LogRotationOptions& options) {
+    static std::mutex registry_mutex;
+    static std::map<std::string, std::weak_ptr<LogRotator>> registry;
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    std::shared_ptr<LogRotator> rotator = registry[path].lock();
+    if (!rotator) {
+        rotator = std::make_shared<LogRotator>(path, options);
+        registry[path] = rotator;
+    }
+    return rotator;
+}
+
+LogRotator::LogRotator(const std::string& path, const LogRotationOptions& options)
+    : path_(path), options_(options), opened_at_ms_(steady_ms()) {
+    struct stat info {};
+    if (::stat(path_.c_str(), &info) == 0) size_ = static_cast<std::uint64_t>(info.st_size);
+    const std::vector<Segment> segments = rotated_segments(path_);
+    if (!segments.empty()) last_index_ = segments.back().index;
+}
+
+void LogRotator::prepare_write(int& fd, std::uint64_t& generation, std::size_t size) {
+    const bool too_big = options_.max_bytes != 0 && size_ + size > options_.max_bytes;
+    const bool too_old = options_.max_age_s != 0 && steady_ms() - opened_at_ms_ >= static_cast<std::uint64_t>(options_.max_age_s) * 1000;
+    // A batch larger than max_bytes still lands whole in a fresh segment.
+    if (size_ != 0 && (too_big || too_old)) rotate();
+
+    if (generation != generation_) {
+        if (fd >= 0) ::close(fd);
+        fd = ::open(path_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            std::fprintf(stderr, "log rotation failed to reopen %s: %s\n", path_.c_str(), std::strerror(errno));
+        }
+        generation = generation_;
+    }
+}
+
+void LogRotator::rotate() {
+    const std::uint64_t index = last_index_ + 1;
+    const std::string segment = log_segment_path(path_, index);
+    if (::rename(path_.c_str(), segment.c_str()) != 0) {
+        std::fprintf(stderr, "log rotation failed to rename %s: %s\n", path_.c_str(), std::strerror(errno));
+        // Retry after another full segment rather than on every write.
+        size_ = 0;
+        opened_at_ms_ = steady_ms();
+        return;
+    }
+    last_index_ = index;
+    size_ = 0;
+    opened_at_ms_ = steady_ms();
+    ++generation_;
+    if (options_.compression != LogCompression::None || options_.keep != 0) {
+        maintenance().post(MaintenanceJob{path_, segment, options_});
+    }
+}
+
+std::string log_segment_path(const std::string& path, std::uint64_t index) {
+    char digits[24];
+    std::snprintf(digits, sizeof(digits), ".%06llu", static_cast<unsigned long long>(index));
+    return path + digits;
+}
+
+std::vector<std::string> list_log_segments(const std::string& path) {
+    std::vector<std::string> paths;
+    const std::vector<Segment> segments = rotated_segments(path);
+    for (std::size_t i = 0; i < segments.size(); ++i) paths.push_back(segments[i].path);
+    std::error_code error;
+    if (std::filesystem::exists(path, error)) paths.push_back(path);
+    return paths;
+}
+
+void read_log_segment(const std::string& segment, std::string& out) {
+    if (ends_with(segment, ".gz")) {
+#if defined(GHOSTLINE_HAVE_ZLIB)
+        gzFile in = gzopen(segment.c_str(), "rb");
+        if (in == nullptr) throw std::runtime_error("failed to open " + segment);
+        std::vector<char> buffer(kCopyChunkBytes);
+        int n = 0;
+        while ((n = gzread(in, buffer.data(), static_cast<unsigned>(buffer.size()))) > 0) {
+            out.append(buffer.data(), static_cast<std::size_t>(n));
+        }
+        const bool failed = n < 0;
+        gzclose(in);
+        if (failed) throw std::runtime_error("failed to inflate " + segment);
+        return;
+#else
+        throw std::runtime_error("reading " + segment + " needs a build with zlib");
+#endif
+    }
+    std::ifstream in(segment, std::ios::binary);
+    if (!in) throw std::runtime_error("failed to open " + segment);
+    std::ostringstream buffer;
+    buffer << in.rdbuf();
+    out.append(buffer.str());
+}
+
+std::string read_log_stream(const std::string& path) {
+    std::string out;
+    const std::vector<std::string> segments = list_log_segments(path);
+    for (std::size_t i = 0; i < segments.size(); ++i) read_log_segment(segments[i], out);
+    return out;
+}
+
+void wait_for_log_maintenance() {
+    maintenance().wait();
+}
@@ -0,0 +1,221 @@
+#include "ghostline/log_tail.hpp"
+#include "ghostline/log_rotation.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#endif
+
+namespace {
+
+constexpr std::size_t kScanChunkBytes = 256 * 1024;
+
+bool ends_with(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+void write_all(int fd, const std::string& data, const std::string& path) {
+    std::size_t written = 0;
+    while (written < data.size()) {
+        const ssize_t n = ::write(fd, data.data() + written, data.size() - written);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) throw std::runtime_error("failed to write " + path + ": " + std::strerror(errno));
+        written += static_cast<std::size_t>(n);
+    }
+}
+
+// Inflates a .gz segment into a temporary file that is unlinked straight
+// away, so it goes with the descriptor.
+int inflate_segment(const std::string& segment) {
+    std::string inflated;
+    read_log_segment(segment, inflated);
+    std::string temp = (std::filesystem::temp_directory_path() / "ghostline_tail_XXXXXX").string();
+    const int fd = ::mkstemp(&temp[0]);
+    if (fd < 0) throw std::runtime_error("failed to create a temporary file for " + segment + ": " + std::strerror(errno));
+    ::unlink(temp.c_str());
+    try {
+        write_all(fd, inflated, temp);
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    return fd;
+}
+
+// The rotation index of "<path>.<index>" or "<path>.<index>.gz".
+bool segment_index(const std::string& path, const std::string& segment, std::uint64_t& index) {
+    const std::string prefix = path + ".";
+    if (segment.size() <= prefix.size() || segment.compare(0, prefix.size(), prefix) != 0) return false;
+    std::string rest = segment.substr(prefix.size());
+    if (ends_with(rest, ".gz")) rest.resize(rest.size() - 3);
+    if (rest.empty() || rest.size() > 18 || rest.find_first_not_of("0123456789") != std::string::npos) return false;
+    index = std::stoull(rest);
+    return true;
+}
+
+int open_segment(const std::string& segment) {
+    if (ends_with(segment, ".gz")) return inflate_segment(segment);
+    const int fd = ::open(segment.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) return fd;
+    // Compressed and removed since it was listed.
+    if (errno == ENOENT) return inflate_segment(segment + ".gz");
+    throw std::runtime_error("failed to open " + segment + ": " + std::strerror(errno));
+}
+
+} // namespace
+
+LogLineIndex::LogLineIndex(const std::string& path) : path_(path) {
+    const std::vector<std::string> segments = list_log_segments(path_);
+    if (segments.empty()) throw std::runtime_error("failed to open " + path_);
+    try {
+        for (std::size_t i = 0; i < segments.size(); ++i) {
+            if (segments[i] == path_) continue;
+            add_segment(open_segment(segments[i]));
+            index_segment(segments_.back());
+            segment_index(path_, segments[i], last_segment_index_);
+        }
+        if (open_active()) index_segment(segments_.back());
+    } catch (...) {
+        for (std::size_t i = 0; i < segments_.size(); ++i) ::close(segments_[i].fd);
+        throw;
+    }
+}
+
+LogLineIndex::~LogLineIndex() {
+    for (std::size_t i = 0; i < segments_.size(); ++i) ::close(segments_[i].fd);
+    if (watch_fd_ >= 0) ::close(watch_fd_);
+}
+
+void LogLineIndex::add_segment(int fd) {
+    Segment segment;
+    segment.fd = fd;
+    segments_.push_back(std::move(segment));
+    first_line_.push_back(lines_);
+}
+
+bool LogLineIndex::open_active() {
+    const int fd = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+    add_segment(fd);
+    active_open_ = true;
+    active_inode_ = static_cast<std::uint64_t>(info.st_ino);
+    return true;
+}
+
+std::size_t LogLineIndex::index_segment(Segment& segment) {
+    std::vector<char> buffer(kScanChunkBytes);
+    std::uint64_t position = segment.indexed_bytes;
+    std::uint64_t line_start = segment.indexed_bytes;
+    std::size_t added = 0;
+    while (true) {
+        const ssize_t n = ::pread(segment.fd, buffer.data(), buffer.size(), static_cast<off_t>(position));
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) throw std::runtime_error("failed to read " + path_ + ": " + std::strerror(errno));
+        if (n == 0) break;
+        for (std::size_t i = 0; i < static_cast<std::size_t>(n); ++i) {
+            if (buffer[i] != '\n') continue;
+            const std::uint64_t end = position + i;
+            if (end > line_start) {
+                segment.starts.push_back(line_start);
+                ++added;
+            }
+            line_start = end + 1;
+        }
+        position += static_cast<std::uint64_t>(n);
+    }
+    segment.indexed_bytes = line_start;
+    lines_ += added;
+    return added;
+}
+
+std::size_t LogLineIndex::refresh() {
+    std::size_t added = 0;
+    if (active_open_) added += index_segment(segments_.back());
+
+    struct stat info {};
+    const bool present = ::stat(path_.c_str(), &info) == 0;
+    if (active_open_ && (!present || static_cast<std::uint64_t>(info.st_ino) != active_inode_)) {
+        // Rotated away: writers reopen before their next write, so what the
+        // old file holds now is final.
+        added += index_segment(segments_.back());
+        active_open_ = false;
+        // It took the next index. Rotations since then left segments that
+        // were never the active file here; index them before the new one.
+        ++last_segment_index_;
+        const std::vector<std::string> segments = list_log_segments(path_);
+        for (std::size_t i = 0; i < segments.size(); ++i) {
+            std::uint64_t index = 0;
+            if (!segment_index(path_, segments[i], index) || index <= last_segment_index_) continue;
+            add_segment(open_segment(segments[i]));
+            added += index_segment(segments_.back());
+            last_segment_index_ = index;
+        }
+    }
+    if (!active_open_ && present && open_active()) added += index_segment(segments_.back());
+    return added;
+}
+
+std::string LogLineIndex::line(std::size_t index) const {
+    if (index >= lines_) throw std::out_of_range("log line index out of range");
+    const std::size_t slot = static_cast<std::size_t>(std::upper_bound(first_line_.begin(), first_line_.end(), index) - first_line_.begin()) - 1;
+    const Segment& segment = segments_[slot];
+    const std::size_t local = index - first_line_[slot];
+    const std::uint64_t start = segment.starts[local];
+    const std::uint64_t end = local + 1 < segment.starts.size() ? segment.starts[local + 1] : segment.indexed_bytes;
+
+    std::string text(static_cast<std::size_t>(end - start), '\0');
+    std::size_t done = 0;
+    while (done < text.size()) {
+        const ssize_t n = ::pread(segment.fd, &text[done], text.size() - done, static_cast<off_t>(start + done));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) throw std::runtime_error("failed to read " + path_ + ": " + (n == 0 ? std::string("short read") : std::strerror(errno)));
+        done += static_cast<std::size_t>(n);
+    }
+    // Blank lines between this one and the next were not indexed.
+    while (!text.empty() && (text.back() == '\n' || text.back() == '\r')) text.pop_back();
+    return text;
+}
+
+int LogLineIndex::watch() {
+#if defined(__linux__)
+    if (watch_fd_ >= 0) return watch_fd_;
+    const int fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) return -1;
+    // Watch the directory, not the file, so renames and the new active file
+    // after a rotation are seen too.
+    const std::filesystem::path file(path_);
+    const std::string dir = file.has_parent_path() ? file.parent_path().string() : std::string(".");
+    if (::inotify_add_watch(fd, dir.c_str(), IN_MODIFY | IN_CREATE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE) < 0) {
+        ::close(fd);
+        return -1;
+    }
+    watch_fd_ = fd;
+    return watch_fd_;
+#else
+    return -1;
+#endif
+}
+
+void LogLineIndex::drain_watch() {
+#if defined(__linux__)
+    if (watch_fd_ < 0) return;
+    alignas(struct inotify_event) char buffer[4096];
+    while (::read(watch_fd_, buffer, sizeof(buffer)) > 0) {
+    }
+#endif
+}
@@ -1,9 +1,10 @@
 #include "net/proxy.hpp"
+#include "ghostline/audit_binary.hpp"
 #include "ghostline/operator_state.hpp"
 #include "ghostline/pid_search.hpp"
+#include "ghostline/rules_loader.hpp"
 
 #include <algorithm>
-#include <array>
 #include <cctype>
 #include <cstdlib>
 #include <cstdio>
@@ -30,6 +31,9 @@ constexpr const char* kUsefulAnswers =
     "    ghostline_cli 7777 127.0.0.1 8888 --rules examples/rules/raw-live.json\n"
     "  How do I get machine-readable streams?\n"
     "    ghostline_cli ... --audit-json ghostline_audit.jsonl --actions-json ghostline_actions.jsonl\n"
+    "  How do I keep audit overhead low on a busy relay?\n"
+    "    ghostline_cli ... --audit-binary ghostline_audit.bin\n"
+    "    ghostline_cli --audit-export ghostline_audit.bin --audit-log ghostline_audit.log --audit-json ghostline_audit.jsonl\n"
     "  How do I save a target profile?\n"
     "    ghostline_cli --seed-target-profiles ghostline_target_profiles\n"
     "    ghostline_cli --search-pid ollama --save-target-profile ghostline_target_profiles/ollama.json --target-label ollama-local\n"
@@ -52,14 +56,30 @@ void print_core_options(std::ostream& out) {
         << "  --end-hex <hex>         End marker for byte-window plugin\n"
         << "  --replace-text <text>   Replacement body for matched windows\n"
         << "  --raw-find-text <text>  Find text for raw live stream mutation\n"
+        << "  --substitute <f=r>      Add a raw live find=replace rule (repeatable)\n"
+        << "  --window-rule <s:e[:r]> Add a byte-window rule: start hex, end hex, optional replacement (repeatable)\n"
         << "  --raw-live              Enable protocol-agnostic live raw mutation\n"
         << "  --raw-chunk-bytes <n>   Frame raw live mutation in fixed-size chunks\n"
+        << "  --raw-stream            Stream raw live mutation: forward all but a possible partial match immediately (implies --raw-live)\n"
+        << "  --raw-flush-ms <n>      Flush a held raw stream tail after n ms without new bytes (default 50, 0 = wait)\n"
         << "  --mutate-direction <v>  Mutation direction: c2s, s2c, or both\n"
         << "  --raw-review-threshold <n>   Require review/action item for raw mutations at or above this byte size\n"
         << "  --mqtt-review-threshold <n>  Require review/action item for mqtt mutations at or above this payload size\n"
         << "  --byte-review-threshold <n>  Require review/action item for byte-window mutations at or above this payload size\n"
         << "  --rewrite-u32-prefix    Rewrite the leading 4-byte big-endian body size\n"
         << "  --max-plugin-buffer <n> Max bytes a protocol plugin may hold before fallback\n"
+        << "  --flow-high-water <n>   Pause reading a source once n bytes are queued toward its peer (default 4 MiB, 0 = off)\n"
+        << "  --flow-low-water <n>    Resume reading once the flow queue drains to n bytes (default 1 MiB)\n"
+        << "  --global-high-water <n> Pause reads on every flow once n bytes are queued in total (default 256 MiB, 0 = off)\n"
+        << "  --global-low-water <n>  Resume reads once the total drains to n bytes (default 128 MiB)\n"
+        << "  --memory-budget <n>     Force the largest flows to observe-only passthrough past n buffered bytes (default 512 MiB, 0 = off)\n"
+        << "  --event-backend <name>  Transport event loop: auto, poll, epoll, epoll-et, or io-uring\n"
+        << "  --workers <n>           Shard flows across n transport threads with SO_REUSEPORT listeners\n"
+        << "  --zerocopy-min-bytes <n> Send queued chunks of at least n bytes with MSG_ZEROCOPY (Linux, 0 = off)\n"
+        << "  --no-splice-passthrough Keep observe-only and unmatched flows on the user-space copy path\n"
+        << "  --pid-index             Tag accepted flows with the local client PID from a sock_diag socket index (Linux)\n"
+        << "  --pid-index-ms <n>      Refresh the socket index every n ms (default 1000; implies --pid-index)\n"
+        << "  --metrics-listen <ep>   Serve Prometheus metrics at /metrics on host:port or unix:<path>\n"
         << "  --protocol-hint <name>  Prefer a compiled-in plugin\n";
 }
 
@@ -67,14 +87,24 @@ void print_rules_options(std::ostream& out) {
     out
         << "  --rules <path>          Load external control rules from JSON, Jinja, or HCL/Terraform-style files\n"
         << "  --rules-var k=v         Template variable for Jinja-style rules\n"
+        << "  --rules-print           Print the flags the rules resolve to, one per line, and exit\n"
+        << "  A running relay reloads the mutation rules on SIGHUP or when the rules file changes\n"
         << "  Supported rule keys:\n"
         << "    listen_port, upstream_host, upstream_port\n"
         << "    protocol_hint, start_marker_hex, end_marker_hex\n"
         << "    replace_text, raw_find_text, raw_live, raw_live_mode\n"
+        << "    substitutions, window_rules, raw_stream, raw_flush_ms\n"
         << "    raw_chunk_bytes, mutate_direction, rewrite_u32_prefix\n"
         << "    raw_review_threshold_bytes, mqtt_review_threshold_bytes\n"
         << "    byte_window_review_threshold_bytes, max_plugin_buffer_bytes\n"
-        << "    audit_log_path, action_log_path, audit_json_path, action_json_path, review_queue_dir\n";
+        << "    flow_high_water_bytes, flow_low_water_bytes\n"
+        << "    global_high_water_bytes, global_low_water_bytes, memory_budget_bytes\n"
+        << "    event_backend, workers, zerocopy_min_bytes, splice_passthrough, pid_index, pid_index_ms\n"
+        << "    metrics_listen\n"
+        << "    audit_queue_size, audit_batch_bytes, audit_flush_ms, audit_full_policy\n"
+        << "    audit_log_path, action_log_path, audit_json_path, action_json_path, review_queue_dir\n"
+        << "    audit_binary_path, capture_policies\n"
+        << "    audit_rotate_bytes, audit_rotate_age_s, audit_keep_segments, audit_compress\n";
 }
 
 void print_search_options(std::ostream& out) {
@@ -91,9 +121,20 @@ void print_output_options(std::ostream& out) {
     out
         << "  --audit-log <path>      Audit log destination\n"
         << "  --audit-json <path>     Audit JSONL destination\n"
+        << "  --audit-binary <path>   Write audit events as compact binary records instead of text/JSONL\n"
+        << "  --audit-export <path>   Convert a binary audit file to --audit-log and --audit-json, then exit\n"
+        << "  --capture <spec>        Audit payload capture, [plugin=]full|head:<n>|sample:<n>|hash (repeatable)\n"
         << "  --action-log <path>     Action item log destination\n"
         << "  --actions-json <path>   Action item JSONL destination\n"
-        << "  --review-queue-dir <d>  Directory for saved pending review items\n";
+        << "  --review-queue-dir <d>  Directory for saved pending review items\n"
+        << "  --audit-queue-size <n>  Records buffered between a worker and its audit writer thread\n"
+        << "  --audit-batch-bytes <n> Group-commit audit lines once a stream buffers this many bytes\n"
+        << "  --audit-flush-ms <n>    Write buffered audit lines at least this often\n"
+        << "  --audit-full-policy <p> When the audit queue is full: block, drop, or summary\n"
+        << "  --audit-rotate-bytes <n> Roll audit and action logs to numbered segments past this size\n"
+        << "  --audit-rotate-age <s>  Roll audit and action logs once a segment is this many seconds old\n"
+        << "  --audit-keep <n>        Rotated segments to keep per log (0 keeps all)\n"
+        << "  --audit-compress <c>    Compress rotated segments in the background: none or gzip\n";
 }
 
 void print_profile_options(std::ostream& out) {
@@ -113,6 +154,11 @@ void print_review_options(std::ostream& out) {
         << "  --review-reject <action>     Mark a review item rejected\n"
         << "  --review-replay <action>     Create a replay artifact from a blocked mutation\n"
         << "  --review-note <text>         Decision note for approve/reject/replay\n"
+        << "  --review-status <status>     List only items with this status (pending, approved, ...)\n"
+        << "  --review-plugin <name>       List only items created by this plugin\n"
+        << "  --review-offset <n>          Skip the first n matching items when listing\n"
+        << "  --review-limit <n>           List at most n items (0 = all)\n"
+        << "  --review-compact             Drop superseded entries from the review journal\n"
         << "  --replay-dir <dir>           Directory for replay artifacts\n";
 }
 
@@ -188,6 +234,7 @@ void print_review_help(const char* argv0) {
     std::cout
         << "\nExamples:\n"
         << "  " << argv0 << " --review-list\n"
+        << "  " << argv0 << " --review-list --review-status pending --review-limit 50 --review-offset 100\n"
         << "  " << argv0 << " --review-approve action-1-3 --review-note approved\n"
         << "  " << argv0 << " --review-reject action-1-3 --review-note rejected\n"
         << "  " << argv0 << " --review-replay action-1-3 --review-note replay-now\n";
@@ -239,48 +286,132 @@ void print_pid_matches(const std::vector<ProcessSocketEntry>& matches) {
     }
 }
 
-std::string shell_quote(const std::string& value) {
-    std::string quoted = "'";
-    for (char ch : value) {
-        if (ch == '\'') {
-            quoted += "'\\''";
+// Applies the relay option at args[i], advancing i past its value. Returns
+// false when args[i] is not one; throws on a bad value.
+bool parse_proxy_option(const std::vector<std::string>& args, std::size_t& i, ProxyConfig& config) {
+    const std::string& arg = args[i];
+    if (arg == "--start-hex" && i + 1 < args.size()) {
+        config.start_marker_hex = args[++i];
+    } else if (arg == "--end-hex" && i + 1 < args.size()) {
+        config.end_marker_hex = args[++i];
+    } else if (arg == "--replace-text" && i + 1 < args.size()) {
+        config.replacement_text = args[++i];
+    } else if (arg == "--raw-find-text" && i + 1 < args.size()) {
+        config.raw_find_text = args[++i];
+    } else if (arg == "--substitute" && i + 1 < args.size()) {
+        config.substitution_specs.push_back(args[++i]);
+    } else if (arg == "--window-rule" && i + 1 < args.size()) {
+        config.window_rule_specs.push_back(args[++i]);
+    } else if (arg == "--raw-live") {
+        config.raw_live_mode = true;
+    } else if (arg == "--raw-chunk-bytes" && i + 1 < args.size()) {
+        config.raw_chunk_bytes = static_cast<std::size_t>(std::stoul(args[++i]));
+    } else if (arg == "--raw-stream") {
+        config.raw_live_mode = true;
+        config.raw_stream_mode = true;
+    } else if (arg == "--raw-flush-ms" && i + 1 < args.size()) {
+        config.raw_flush_ms = static_cast<std::uint32_t>(std::stoul(args[++i]));
+    } else if (arg == "--mutate-direction" && i + 1 < args.size()) {
+        const std::string value = args[++i];
+        if (value == "c2s") {
+            config.mutate_client_to_server = true;
+            config.mutate_server_to_client = false;
+        } else if (value == "s2c") {
+            config.mutate_client_to_server = false;
+            config.mutate_server_to_client = true;
+        } else if (value == "both") {
+            config.mutate_client_to_server = true;
+            config.mutate_server_to_client = true;
         } else {
-            quoted.push_back(ch);
+            throw std::runtime_error("unknown mutate direction: " + value);
         }
-    }
-    quoted.push_back('\'');
-    return quoted;
-}
-
-std::vector<std::string> resolve_rules_args(const std::string& rules_path, const std::vector<std::string>& vars) {
-    std::string command = "python3 tools/resolve_rules.py --rules " + shell_quote(rules_path);
-    for (const auto& var : vars) {
-        command += " --var " + shell_quote(var);
-    }
-
-    std::unique_ptr<FILE, decltype(&pclose)> pipe(popen(command.c_str(), "r"), pclose);
-    if (!pipe) {
-        throw std::runtime_error("failed to run rules resolver");
-    }
-
-    std::vector<std::string> args;
-    std::array<char, 4096> buffer{};
-    std::string line;
-    while (fgets(buffer.data(), static_cast<int>(buffer.size()), pipe.get()) != nullptr) {
-        line.assign(buffer.data());
-        while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) {
-            line.pop_back();
+    } else if (arg == "--raw-review-threshold" && i + 1 < args.size()) {
+        config.raw_review_threshold_bytes = static_cast<std::size_t>(std::stoul(args[++i]));
+    } else if (arg == "--mqtt-review-threshold" && i + 1 < args.size()) {
+        config.mqtt_review_threshold_bytes = static_cast<std::size_t>(std::stoul(args[++i]));
+    } else if (arg == "--byte-review-threshold" && i + 1 < args.size()) {
+        config.byte_window_review_threshold_bytes = static_cast<std::size_t>(std::stoul(args[++i]));
+    } else if (arg == "--rewrite-u32-prefix") {
+        config.rewrite_u32_prefix = true;
+    } else if (arg == "--no-splice-passthrough") {
+        config.splice_passthrough = false;
+    } else if (arg == "--pid-index") {
+        config.pid_index = true;
+    } else if (arg == "--pid-index-ms" && i + 1 < args.size()) {
+        config.pid_index = true;
+        config.pid_index_refresh_ms = static_cast<std::uint32_t>(std::stoul(args[++i]));
+    } else if (arg == "--metrics-listen" && i + 1 < args.size()) {
+        config.metrics_endpoint = args[++i];
+    } else if (arg == "--max-plugin-buffer" && i + 1 < args.size()) {
+        config.max_plugin_buffer_bytes = static_cast<std::size_t>(std::stoul(args[++i]));
+    } else if (arg == "--flow-high-water" && i + 1 < args.size()) {
+        config.flow_high_water_bytes = static_cast<std::size_t>(std::stoull(args[++i]));
+    } else if (arg == "--flow-low-water" && i + 1 < args.size()) {
+        config.flow_low_water_bytes = static_cast<std::size_t>(std::stoull(args[++i]));
+    } else if (arg == "--global-high-water" && i + 1 < args.size()) {
+        config.global_high_water_bytes = static_cast<std::size_t>(std::stoull(args[++i]));
+    } else if (arg == "--global-low-water" && i + 1 < args.size()) {
+        config.global_low_water_bytes = static_cast<std::size_t>(std::stoull(args[++i]));
+    } else if (arg == "--memory-budget" && i + 1 < args.size()) {
+        config.memory_budget_bytes = static_cast<std::size_t>(std::stoull(args[++i]));
+    } else if (arg == "--event-backend" && i + 1 < args.size()) {
+        const std::string value = args[++i];
+        if (!parse_event_backend(value, config.event_backend)) {
+            throw std::runtime_error("unknown event backend: " + value);
         }
-        if (!line.empty()) {
-            args.push_back(line);
+    } else if (arg == "--workers" && i + 1 < args.size()) {
+        const unsigned long value = std::stoul(args[++i]);
+        if (value < 1 || value > 256) {
+            throw std::runtime_error("workers must be between 1 and 256");
         }
+        config.workers = static_cast<unsigned>(value);
+    } else if (arg == "--zerocopy-min-bytes" && i + 1 < args.size()) {
+        config.zerocopy_min_bytes = static_cast<std::size_t>(std::stoul(args[++i]));
+    } else if (arg == "--protocol-hint" && i + 1 < args.size()) {
+        config.protocol_hint = args[++i];
+    } else if (arg == "--audit-log" && i + 1 < args.size()) {
+        config.audit_log_path = args[++i];
+    } else if (arg == "--audit-json" && i + 1 < args.size()) {
+        config.audit_json_path = args[++i];
+    } else if (arg == "--audit-binary" && i + 1 < args.size()) {
+        config.audit_binary_path = args[++i];
+    } else if (arg == "--capture" && i + 1 < args.size()) {
+        add_capture_spec(config.capture_policies, args[++i]);
+    } else if (arg == "--action-log" && i + 1 < args.size()) {
+        config.action_log_path = args[++i];
+    } else if (arg == "--actions-json" && i + 1 < args.size()) {
+        config.action_json_path = args[++i];
+    } else if (arg == "--review-queue-dir" && i + 1 < args.size()) {
+        config.review_queue_dir = args[++i];
+    } else if (arg == "--audit-queue-size" && i + 1 < args.size()) {
+        config.audit_queue_capacity = static_cast<std::size_t>(std::stoul(args[++i]));
+    } else if (arg == "--audit-batch-bytes" && i + 1 < args.size()) {
+        config.audit_batch_bytes = static_cast<std::size_t>(std::stoul(args[++i]));
+    } else if (arg == "--audit-flush-ms" && i + 1 < args.size()) {
+        config.audit_flush_ms = static_cast<std::uint32_t>(std::stoul(args[++i]));
+    } else if (arg == "--audit-full-policy" && i + 1 < args.size()) {
+        const std::string value = args[++i];
+        if (!parse_audit_queue_policy(value, config.audit_queue_policy)) {
+            throw std::runtime_error("unknown audit full policy: " + value);
+        }
+    } else if (arg == "--audit-rotate-bytes" && i + 1 < args.size()) {
+        config.audit_rotate_bytes = static_cast<std::uint64_t>(std::stoull(args[++i]));
+    } else if (arg == "--audit-rotate-age" && i + 1 < args.size()) {
+        config.audit_rotate_age_s = static_cast<std::uint32_t>(std::stoul(args[++i]));
+    } else if (arg == "--audit-keep" && i + 1 < args.size()) {
+        config.audit_keep_segments = static_cast<std::uint32_t>(std::stoul(args[++i]));
+    } else if (arg == "--audit-compress" && i + 1 < args.size()) {
+        const std::string value = args[++i];
+        if (!parse_log_compression(value, config.audit_compression)) {
+            throw std::runtime_error("unknown audit compression: " + value);
+        }
+        if (!log_compression_available(config.audit_compression)) {
+            throw std::runtime_error("audit compression " + value + " needs a build with zlib");
+        }
+    } else {
+        return false;
     }
-
-    const int status = pclose(pipe.release());
-    if (status != 0) {
-        throw std::runtime_error("rules resolver failed for " + rules_path);
-    }
-    return args;
+    return true;
 }
 
 } // namespace
@@ -322,19 +453,34 @@ int main(int argc, char** argv) {
 
     std::string rules_path;
     std::vector<std::string> rules_vars;
+    bool rules_print = false;
     std::vector<std::string> passthrough_args;
     for (std::size_t i = 0; i < input_args.size(); ++i) {
         if (input_args[i] == "--rules" && i + 1 < input_args.size()) {
             rules_path = input_args[++i];
         } else if (input_args[i] == "--rules-var" && i + 1 < input_args.size()) {
             rules_vars.push_back(input_args[++i]);
+        } else if (input_args[i] == "--rules-print") {
+            rules_print = true;
         } else {
             passthrough_args.push_back(input_args[i]);
         }
     }
 
     if (!rules_path.empty()) {
-        std::vector<std::string> resolved_args = resolve_rules_args(rules_path, rules_vars);
+        std::vector<std::string> resolved_args;
+        try {
+            resolved_args = resolve_rules_args(rules_path, rules_vars);
+        } catch (const std::exception& error) {
+            std::cerr << "Rules error: " << error.what() << "\n";
+            return 2;
+        }
+        if (rules_print) {
+            for (const auto& arg : resolved_args) {
+                std::cout << arg << "\n";
+            }
+            return 0;
+        }
         resolved_args.insert(resolved_args.end(), passthrough_args.begin(), passthrough_args.end());
         input_args = std::move(resolved_args);
     } else {
@@ -352,11 +498,16 @@ int main(int argc, char** argv) {
     std::string list_target_profiles_dir;
     std::string target_label;
     bool review_list = false;
+    bool review_compact = false;
+    ReviewFilter review_filter;
+    std::size_t review_offset = 0;
+    std::size_t review_limit = 0;
     std::string review_approve_id;
     std::string review_reject_id;
     std::string review_replay_id;
     std::string review_note;
     std::string replay_dir = "ghostline_replays";
+    std::string audit_export_path;
     std::size_t positional_start = 0;
 
     try {
@@ -393,6 +544,20 @@ int main(int argc, char** argv) {
                 list_target_profiles_dir = input_args[++i];
             } else if (arg == "--review-list") {
                 review_list = true;
+            } else if (arg == "--review-status" && i + 1 < input_args.size()) {
+                review_list = true;
+                review_filter.status = input_args[++i];
+            } else if (arg == "--review-plugin" && i + 1 < input_args.size()) {
+                review_list = true;
+                review_filter.plugin = input_args[++i];
+            } else if (arg == "--review-offset" && i + 1 < input_args.size()) {
+                review_list = true;
+                review_offset = static_cast<std::size_t>(std::stoul(input_args[++i]));
+            } else if (arg == "--review-limit" && i + 1 < input_args.size()) {
+                review_list = true;
+                review_limit = static_cast<std::size_t>(std::stoul(input_args[++i]));
+            } else if (arg == "--review-compact") {
+                review_compact = true;
             } else if (arg == "--review-approve" && i + 1 < input_args.size()) {
                 review_approve_id = input_args[++i];
             } else if (arg == "--review-reject" && i + 1 < input_args.size()) {
@@ -403,61 +568,15 @@ int main(int argc, char** argv) {
                 review_note = input_args[++i];
             } else if (arg == "--replay-dir" && i + 1 < input_args.size()) {
                 replay_dir = input_args[++i];
+            } else if (arg == "--audit-export" && i + 1 < input_args.size()) {
+                audit_export_path = input_args[++i];
             } else if (arg == "--listen-only") {
                 search_mode = true;
                 search_query.listen_only = true;
             } else if (arg == "--established-only") {
                 search_mode = true;
                 search_query.established_only = true;
-            } else if (arg == "--start-hex" && i + 1 < input_args.size()) {
-                config.start_marker_hex = input_args[++i];
-            } else if (arg == "--end-hex" && i + 1 < input_args.size()) {
-                config.end_marker_hex = input_args[++i];
-            } else if (arg == "--replace-text" && i + 1 < input_args.size()) {
-                config.replacement_text = input_args[++i];
-            } else if (arg == "--raw-find-text" && i + 1 < input_args.size()) {
-                config.raw_find_text = input_args[++i];
-            } else if (arg == "--raw-live") {
-                config.raw_live_mode = true;
-            } else if (arg == "--raw-chunk-bytes" && i + 1 < input_args.size()) {
-                config.raw_chunk_bytes = static_cast<std::size_t>(std::stoul(input_args[++i]));
-            } else if (arg == "--mutate-direction" && i + 1 < input_args.size()) {
-                const std::string value = input_args[++i];
-                if (value == "c2s") {
-                    config.mutate_client_to_server = true;
-                    config.mutate_server_to_client = false;
-                } else if (value == "s2c") {
-                    config.mutate_client_to_server = false;
-                    config.mutate_server_to_client = true;
-                } else if (value == "both") {
-                    config.mutate_client_to_server = true;
-                    config.mutate_server_to_client = true;
-                } else {
-                    throw std::runtime_error("unknown mutate direction: " + value);
-                }
-            } else if (arg == "--raw-review-threshold" && i + 1 < input_args.size()) {
-                config.raw_review_threshold_bytes = static_cast<std::size_t>(std::stoul(input_args[++i]));
-            } else if (arg == "--mqtt-review-threshold" && i + 1 < input_args.size()) {
-                config.mqtt_review_threshold_bytes = static_cast<std::size_t>(std::stoul(input_args[++i]));
-            } else if (arg == "--byte-review-threshold" && i + 1 < input_args.size()) {
-                config.byte_window_review_threshold_bytes = static_cast<std::size_t>(std::stoul(input_args[++i]));
-            } else if (arg == "--rewrite-u32-prefix") {
-                config.rewrite_u32_prefix = true;
-            } else if (arg == "--max-plugin-buffer" && i + 1 < input_args.size()) {
-                config.max_plugin_buffer_bytes = static_cast<std::size_t>(std::stoul(input_args[++i]));
-            } else if (arg == "--protocol-hint" && i + 1 < input_args.size()) {
-                config.protocol_hint = input_args[++i];
-            } else if (arg == "--audit-log" && i + 1 < input_args.size()) {
-                config.audit_log_path = input_args[++i];
-            } else if (arg == "--audit-json" && i + 1 < input_args.size()) {
-                config.audit_json_path = input_args[++i];
-            } else if (arg == "--action-log" && i + 1 < input_args.size()) {
-                config.action_log_path = input_args[++i];
-            } else if (arg == "--actions-json" && i + 1 < input_args.size()) {
-                config.action_json_path = input_args[++i];
-            } else if (arg == "--review-queue-dir" && i + 1 < input_args.size()) {
-                config.review_queue_dir = input_args[++i];
-            } else {
+            } else if (!parse_proxy_option(input_args, i, config)) {
                 positional_start = i;
                 break;
             }
@@ -471,6 +590,19 @@ int main(int argc, char** argv) {
             return written.empty() ? 1 : 0;
         }
 
+        if (!audit_export_path.empty()) {
+            const AuditExportResult result = export_audit_binary(audit_export_path, config.audit_log_path, config.audit_json_path);
+            std::cout << "Exported " << result.records << " audit records from " << audit_export_path;
+            if (!config.audit_log_path.empty()) std::cout << " to " << config.audit_log_path;
+            if (!config.audit_json_path.empty()) std::cout << (config.audit_log_path.empty() ? " to " : " and ") << config.audit_json_path;
+            std::cout << "\n";
+            if (result.status != AuditRecordStatus::End) {
+                std::cerr << "Stopped at byte " << result.stopped_at << " of " << result.segment << ": " << audit_record_status_name(result.status) << " record\n";
+                return 1;
+            }
+            return 0;
+        }
+
         if (!show_target_profile_path.empty()) {
             const TargetProfile profile = load_target_profile(show_target_profile_path);
             std::cout << target_profile_to_json(profile) << "\n";
@@ -485,7 +617,15 @@ int main(int argc, char** argv) {
             return paths.empty() ? 1 : 0;
         }
 
-        if (review_list || !review_approve_id.empty() || !review_reject_id.empty() || !review_replay_id.empty()) {
+        if (review_list || review_compact || !review_approve_id.empty() || !review_reject_id.empty() || !review_replay_id.empty()) {
+            if (review_compact) {
+                const std::shared_ptr<ReviewJournal> journal = ReviewJournal::for_dir(config.review_queue_dir);
+                const std::size_t superseded = journal->superseded_lines();
+                journal->compact();
+                std::cout << "Compacted " << journal->path() << ": " << journal->live_items()
+                          << " items, dropped " << superseded << " superseded entries\n";
+                return 0;
+            }
             if (!review_approve_id.empty()) {
                 update_review_item(config.review_queue_dir, review_approve_id, "approved", review_note);
                 std::cout << "Approved review item " << review_approve_id << "\n";
@@ -502,18 +642,22 @@ int main(int argc, char** argv) {
                 return 0;
             }
 
-            const auto items = list_review_items(config.review_queue_dir);
-            if (items.empty()) {
+            const ReviewPage page = list_review_page(config.review_queue_dir, review_filter, review_offset, review_limit);
+            if (page.items.empty()) {
                 std::cout << "No review items found.\n";
                 return 1;
             }
-            for (const auto& item : items) {
+            for (const auto& item : page.items) {
                 std::cout << item.action_id
                           << " status=" << item.review_status
                           << " plugin=" << item.plugin_name
                           << " flow=" << item.flow_id
                           << " title=\"" << item.title << "\"\n";
             }
+            if (page.items.size() < page.total) {
+                std::cout << "Showing " << review_offset + 1 << "-" << review_offset + page.items.size()
+                          << " of " << page.total << " items.\n";
+            }
             return 0;
         }
 
@@ -554,55 +698,7 @@ int main(int argc, char** argv) {
 
         for (std::size_t i = positional_start + 3; i < input_args.size(); ++i) {
             const std::string arg = input_args[i];
-            if (arg == "--start-hex" && i + 1 < input_args.size()) {
-                config.start_marker_hex = input_args[++i];
-            } else if (arg == "--end-hex" && i + 1 < input_args.size()) {
-                config.end_marker_hex = input_args[++i];
-            } else if (arg == "--replace-text" && i + 1 < input_args.size()) {
-                config.replacement_text = input_args[++i];
-            } else if (arg == "--raw-find-text" && i + 1 < input_args.size()) {
-                config.raw_find_text = input_args[++i];
-            } else if (arg == "--raw-live") {
-                config.raw_live_mode = true;
-            } else if (arg == "--raw-chunk-bytes" && i + 1 < input_args.size()) {
-                config.raw_chunk_bytes = static_cast<std::size_t>(std::stoul(input_args[++i]));
-            } else if (arg == "--mutate-direction" && i + 1 < input_args.size()) {
-                const std::string value = input_args[++i];
-                if (value == "c2s") {
-                    config.mutate_client_to_server = true;
-                    config.mutate_server_to_client = false;
-                } else if (value == "s2c") {
-                    config.mutate_client_to_server = false;
-                    config.mutate_server_to_client = true;
-                } else if (value == "both") {
-                    config.mutate_client_to_server = true;
-                    config.mutate_server_to_client = true;
-                } else {
-                    throw std::runtime_error("unknown mutate direction: " + value);
-                }
-            } else if (arg == "--raw-review-threshold" && i + 1 < input_args.size()) {
-                config.raw_review_threshold_bytes = static_cast<std::size_t>(std::stoul(input_args[++i]));
-            } else if (arg == "--mqtt-review-threshold" && i + 1 < input_args.size()) {
-                config.mqtt_review_threshold_bytes = static_cast<std::size_t>(std::stoul(input_args[++i]));
-            } else if (arg == "--byte-review-threshold" && i + 1 < input_args.size()) {
-                config.byte_window_review_threshold_bytes = static_cast<std::size_t>(std::stoul(input_args[++i]));
-            } else if (arg == "--rewrite-u32-prefix") {
-                config.rewrite_u32_prefix = true;
-            } else if (arg == "--max-plugin-buffer" && i + 1 < input_args.size()) {
-                config.max_plugin_buffer_bytes = static_cast<std::size_t>(std::stoul(input_args[++i]));
-            } else if (arg == "--protocol-hint" && i + 1 < input_args.size()) {
-                config.protocol_hint = input_args[++i];
-            } else if (arg == "--audit-log" && i + 1 < input_args.size()) {
-                config.audit_log_path = input_args[++i];
-            } else if (arg == "--audit-json" && i + 1 < input_args.size()) {
-                config.audit_json_path = input_args[++i];
-            } else if (arg == "--action-log" && i + 1 < input_args.size()) {
-                config.action_log_path = input_args[++i];
-            } else if (arg == "--actions-json" && i + 1 < input_args.size()) {
-                config.action_json_path = input_args[++i];
-            } else if (arg == "--review-queue-dir" && i + 1 < input_args.size()) {
-                config.review_queue_dir = input_args[++i];
-            } else {
+            if (!parse_proxy_option(input_args, i, config)) {
                 throw std::runtime_error("unknown option: " + arg);
             }
         }
@@ -627,7 +723,13 @@ int main(int argc, char** argv) {
                       ? "both"
                       : (config.mutate_client_to_server ? "c2s" : "s2c"))
               << "\n";
-    std::cout << "Audit log: " << config.audit_log_path << "\n";
+    std::cout << "Event backend: " << event_backend_name(config.event_backend)
+              << " workers=" << config.workers << "\n";
+    if (config.audit_binary_path.empty()) {
+        std::cout << "Audit log: " << config.audit_log_path << "\n";
+    } else {
+        std::cout << "Audit binary: " << config.audit_binary_path << "\n";
+    }
     std::cout << "Action log: " << config.action_log_path << "\n";
     if (!config.audit_json_path.empty()) {
         std::cout << "Audit JSON: " << config.audit_json_path << "\n";
@@ -636,6 +738,26 @@ int main(int argc, char** argv) {
         std::cout << "Action JSON: " << config.action_json_path << "\n";
     }
     std::cout << "Review queue: " << config.review_queue_dir << "\n";
+    if (!config.metrics_endpoint.empty()) {
+        std::cout << "Metrics: " << config.metrics_endpoint << " (GET /metrics)\n";
+    }
+
+    if (!rules_path.empty()) {
+        // A reload resolves the rules again and layers the command line's
+        // options over them, as startup did. The listen and upstream
+        // arguments are skipped; they keep their startup values.
+        config.rules_path = rules_path;
+        config.reload_rules = [rules_path, rules_vars, passthrough_args]() {
+            std::vector<std::string> args = resolve_rules_args(rules_path, rules_vars);
+            args.insert(args.end(), passthrough_args.begin(), passthrough_args.end());
+            ProxyConfig reloaded;
+            for (std::size_t i = 0; i < args.size(); ++i) {
+                parse_proxy_option(args, i, reloaded);
+            }
+            return reloaded;
+        };
+        std::cout << "Rules: " << rules_path << " (reloaded on change or SIGHUP)\n";
+    }
 
     return run_transport_core(config);
 }
@@ -0,0 +1,65 @@
+#include "net/memory_accountant.hpp"
+
+#include <sstream>
+
+std::size_t MemoryCharge::total() const {
+    std::size_t sum = 0;
+    for (std::size_t i = 0; i < bytes.size(); ++i) sum += bytes[i];
+    return sum;
+}
+
+MemoryAccountant::MemoryAccountant(std::size_t budget_bytes) : budget_(budget_bytes) {
+    for (std::size_t i = 0; i < totals_.size(); ++i) totals_[i].store(0, std::memory_order_relaxed);
+}
+
+void MemoryAccountant::set(MemoryCharge& charge, MemoryCategory category, std::size_t bytes) {
+    const std::size_t index = static_cast<std::size_t>(category);
+    const std::size_t previous = charge.bytes[index];
+    if (bytes == previous) return;
+    charge.bytes[index] = bytes;
+
+    if (bytes > previous) {
+        const std::size_t delta = bytes - previous;
+        totals_[index].fetch_add(delta, std::memory_order_relaxed);
+        const std::size_t total = total_.fetch_add(delta, std::memory_order_relaxed) + delta;
+        std::size_t peak = peak_.load(std::memory_order_relaxed);
+        while (total > peak && !peak_.compare_exchange_weak(peak, total, std::memory_order_relaxed)) {
+        }
+    } else {
+        const std::size_t delta = previous - bytes;
+        totals_[index].fetch_sub(delta, std::memory_order_relaxed);
+        total_.fetch_sub(delta, std::memory_order_relaxed);
+    }
+}
+
+void MemoryAccountant::release(MemoryCharge& charge) {
+    for (std::size_t i = 0; i < kMemoryCategoryCount; ++i) {
+        set(charge, static_cast<MemoryCategory>(i), 0);
+    }
+}
+
+std::size_t MemoryAccountant::total(MemoryCategory category) const {
+    return totals_[static_cast<std::size_t>(category)].load(std::memory_order_relaxed);
+}
+
+std::string MemoryAccountant::summary() const {
+    std::ostringstream out;
+    out << "total=" << total()
+        << " peak=" << peak()
+        << " budget=" << budget_;
+    for (std::size_t i = 0; i < kMemoryCategoryCount; ++i) {
+        const MemoryCategory category = static_cast<MemoryCategory>(i);
+        out << " " << memory_category_name(category) << "=" << total(category);
+    }
+    return out.str();
+}
+
+const char* memory_category_name(MemoryCategory category) {
+    switch (category) {
+        case MemoryCategory::Pending: return "pending";
+        case MemoryCategory::OutQueue: return "outq";
+        case MemoryCategory::Candidate: return "candidate";
+        case MemoryCategory::Audit: return "audit";
+    }
+    return "unknown";
+}
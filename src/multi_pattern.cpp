@@ -0,0 +1,106 @@
+#include "core/multi_pattern.hpp"
+
+#include <algorithm>
+#include <deque>
+
+MultiPattern::MultiPattern(const std::vector<ByteVec>& patterns) : pattern_count_(patterns.size()) {
+    next_.assign(256, kNone);
+    output_.push_back(kNone);
+    depth_.push_back(0);
+
+    // Trie of every non-empty pattern.
+    for (std::size_t index = 0; index < patterns.size(); ++index) {
+        const ByteVec& pattern = patterns[index];
+        if (pattern.empty()) continue;
+        std::int32_t state = 0;
+        for (std::size_t i = 0; i < pattern.size(); ++i) {
+            const std::size_t slot = static_cast<std::size_t>(state) * 256 + pattern[i];
+            if (next_[slot] == kNone) {
+                next_[slot] = static_cast<std::int32_t>(depth_.size());
+                next_.resize(next_.size() + 256, kNone);
+                output_.push_back(kNone);
+                depth_.push_back(depth_[static_cast<std::size_t>(state)] + 1);
+            }
+            state = next_[slot];
+        }
+        if (output_[static_cast<std::size_t>(state)] == kNone) {
+            output_[static_cast<std::size_t>(state)] = static_cast<std::int32_t>(index);
+        }
+        max_length_ = std::max(max_length_, pattern.size());
+    }
+
+    // Breadth-first pass: fold failure links into the dense table and link
+    // each state to the nearest suffix state that ends a pattern.
+    std::vector<std::int32_t> failure(depth_.size(), 0);
+    output_link_.assign(depth_.size(), kNone);
+    std::deque<std::int32_t> queue;
+    for (std::size_t value = 0; value < 256; ++value) {
+        std::int32_t& edge = next_[value];
+        if (edge == kNone) {
+            edge = 0;
+        } else {
+            queue.push_back(edge);
+        }
+    }
+    while (!queue.empty()) {
+        const std::size_t state = static_cast<std::size_t>(queue.front());
+        queue.pop_front();
+        const std::size_t fail = static_cast<std::size_t>(failure[state]);
+        output_link_[state] = output_[fail] != kNone ? static_cast<std::int32_t>(fail) : output_link_[fail];
+        for (std::size_t value = 0; value < 256; ++value) {
+            std::int32_t& edge = next_[state * 256 + value];
+            const std::int32_t fallback = next_[fail * 256 + value];
+            if (edge == kNone) {
+                edge = fallback;
+            } else {
+                failure[static_cast<std::size_t>(edge)] = fallback;
+                queue.push_back(edge);
+            }
+        }
+    }
+}
+
+PatternMatch MultiPattern::find_leftmost(ByteView haystack, std::size_t offset) const {
+    PatternMatch best;
+    if (empty()) return best;
+
+    std::int32_t state = 0;
+    for (std::size_t i = offset; i < haystack.size(); ++i) {
+        state = next_[static_cast<std::size_t>(state) * 256 + haystack[i]];
+        std::int32_t hit = output_[static_cast<std::size_t>(state)] != kNone ? state : output_link_[static_cast<std::size_t>(state)];
+        for (; hit != kNone; hit = output_link_[static_cast<std::size_t>(hit)]) {
+            const std::size_t length = depth_[static_cast<std::size_t>(hit)];
+            const std::size_t start = i + 1 - length;
+            if (!best.found() || start < best.start || (start == best.start && length > best.length)) {
+                best.start = start;
+                best.length = length;
+                best.pattern = static_cast<std::uint32_t>(output_[static_cast<std::size_t>(hit)]);
+            }
+        }
+        // Nothing that ends later can start at or before best.start.
+        if (best.found() && i + 1 >= best.start + max_length_) break;
+    }
+    return best;
+}
+
+std::size_t MultiPattern::partial_suffix(ByteView haystack) const {
+    if (empty()) return 0;
+    // The automaton state after a scan is the longest suffix in the trie;
+    // a partial match is shorter than max_length_, so the tail suffices.
+    const std::size_t span = std::min(haystack.size(), max_length_ - 1);
+    std::int32_t state = 0;
+    for (std::size_t i = haystack.size() - span; i < haystack.size(); ++i) {
+        state = next_[static_cast<std::size_t>(state) * 256 + haystack[i]];
+    }
+    return depth_[static_cast<std::size_t>(state)];
+}
+
+void MultiPattern::find_non_overlapping(ByteView haystack, std::vector<PatternMatch>& out) const {
+    std::size_t offset = 0;
+    while (offset < haystack.size()) {
+        const PatternMatch match = find_leftmost(haystack, offset);
+        if (!match.found()) return;
+        out.push_back(match);
+        offset = match.end();
+    }
+}
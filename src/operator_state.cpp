@@ -1,4 +1,5 @@
 #include "ghostline/operator_state.hpp"
+#include "ghostline/review_journal.hpp"
 
 #include <algorithm>
 #include <cctype>
@@ -115,6 +116,8 @@ std::filesystem::path ensure_dir(const std::string& dir) {
     return path;
 }
 
+} // namespace
+
 std::string action_item_to_json(const ActionItem& item) {
     std::ostringstream out;
     out << "{"
@@ -162,9 +165,7 @@ ActionItem parse_action_item_json(const std::string& text) {
     return item;
 }
 
-} // namespace
-
-std::string bytes_to_hex_string(const ByteVec& bytes) {
+std::string bytes_to_hex_string(ByteView bytes) {
     static const char* kHex = "0123456789abcdef";
     std::string out;
     out.reserve(bytes.size() * 2);
@@ -278,44 +279,52 @@ std::vector<std::string> seed_protocol_target_profiles(const std::string& direct
 }
 
 void save_review_item(const std::string& queue_dir, const ActionItem& item) {
-    const auto dir = ensure_dir(queue_dir);
-    write_text((dir / (item.action_id + ".json")).string(), action_item_to_json(item));
+    ReviewJournal::for_dir(queue_dir)->put(item);
 }
 
 ActionItem load_review_item(const std::string& path) {
     return parse_action_item_json(read_text(path));
 }
 
+bool find_review_item(const std::string& queue_dir, const std::string& action_id, ActionItem& item) {
+    return ReviewJournal::for_dir(queue_dir)->get(action_id, item);
+}
+
 std::vector<ActionItem> list_review_items(const std::string& queue_dir) {
-    std::vector<ActionItem> items;
-    for (const auto& path : list_target_profiles(queue_dir)) {
-        items.push_back(load_review_item(path));
-    }
-    return items;
+    return ReviewJournal::for_dir(queue_dir)->page(ReviewFilter(), 0, 0).items;
+}
+
+ReviewPage list_review_page(const std::string& queue_dir, const ReviewFilter& filter, std::size_t offset, std::size_t limit) {
+    return ReviewJournal::for_dir(queue_dir)->page(filter, offset, limit);
 }
 
 void update_review_item(const std::string& queue_dir,
                         const std::string& action_id,
                         const std::string& status,
                         const std::string& decision_note) {
-    const auto dir = ensure_dir(queue_dir);
-    const std::filesystem::path path = dir / (action_id + ".json");
-    ActionItem item = load_review_item(path.string());
+    const std::shared_ptr<ReviewJournal> journal = ReviewJournal::for_dir(queue_dir);
+    ActionItem item;
+    if (!journal->get(action_id, item)) {
+        throw std::runtime_error("review item not found: " + action_id);
+    }
     item.review_status = status;
     item.decision_note = decision_note;
-    write_text(path.string(), action_item_to_json(item));
+    journal->put(item);
 }
 
 std::string replay_review_item(const std::string& queue_dir,
                                const std::string& action_id,
                                const std::string& replay_dir,
                                const std::string& decision_note) {
-    const auto queue = ensure_dir(queue_dir);
-    ActionItem item = load_review_item((queue / (action_id + ".json")).string());
+    const std::shared_ptr<ReviewJournal> journal = ReviewJournal::for_dir(queue_dir);
+    ActionItem item;
+    if (!journal->get(action_id, item)) {
+        throw std::runtime_error("review item not found: " + action_id);
+    }
     item.review_status = "replayed";
     item.decision_note = decision_note;
     ++item.replay_count;
-    write_text((queue / (action_id + ".json")).string(), action_item_to_json(item));
+    journal->put(item);
 
     const auto replay = ensure_dir(replay_dir);
     const std::filesystem::path replay_path = replay / (action_id + "-replay-" + std::to_string(item.replay_count) + ".json");
@@ -0,0 +1,86 @@
+#include "ghostline/packet_arena.hpp"
+
+#include <utility>
+
+// Without reuse the old object is swapped out and destroyed, so its buffers
+// are freed just as a local's would be; plain assignment could keep them.
+Candidate& PacketArena::next_candidate() {
+    if (kReuse) {
+        reset_for_reuse(candidate_);
+    } else {
+        Candidate fresh;
+        std::swap(candidate_, fresh);
+    }
+    return candidate_;
+}
+
+CandidateDecision& PacketArena::next_decision() {
+    if (kReuse) {
+        reset_for_reuse(decision_);
+    } else {
+        CandidateDecision fresh;
+        std::swap(decision_, fresh);
+    }
+    return decision_;
+}
+
+AuditEvent& PacketArena::next_event() {
+    if (kReuse) {
+        reset_for_reuse(event_);
+    } else {
+        AuditEvent fresh;
+        std::swap(event_, fresh);
+    }
+    return event_;
+}
+
+void reset_for_reuse(Candidate& candidate) {
+    candidate.trigger_sequence = 0;
+    candidate.candidate_sequence = 0;
+    candidate.plugin_name.clear();
+    candidate.trigger_label.clear();
+    candidate.original_bytes = ByteView();
+    candidate.mutated_bytes.clear();
+    candidate.mutated = false;
+    candidate.header_size = 0;
+    candidate.footer_size = 0;
+    candidate.payload_offset = 0;
+    candidate.payload_size = 0;
+    candidate.size_delta = 0;
+    candidate.allow_size_mutated = false;
+    candidate.pid_drift_risk = false;
+    candidate.valid = false;
+    candidate.packet_type.clear();
+    candidate.protocol_note.clear();
+    candidate.review_label.clear();
+    candidate.workflow_stage = WorkflowStage::CandidateBuilt;
+    candidate.note.clear();
+}
+
+void reset_for_reuse(CandidateDecision& decision) {
+    decision.release = CandidateRelease::ReleaseOriginal;
+    decision.outcome = ValidationOutcome::ValidationFallbackOriginal;
+    decision.observe_only = false;
+    decision.create_action_item = false;
+    decision.review_required = false;
+    decision.validation = ValidationCode::None;
+    decision.review = ReviewCode::None;
+    decision.validation_note.clear();
+    decision.workflow_stage = WorkflowStage::CandidateReviewed;
+}
+
+void reset_for_reuse(AuditEvent& event) {
+    event.type = AuditEventType::Unknown;
+    event.trigger_sequence = 0;
+    event.candidate_sequence = 0;
+    event.flow_id = 0;
+    event.direction = Direction::ClientToServer;
+    event.plugin_name.clear();
+    event.message.clear();
+    event.original_bytes = ByteView();
+    event.modified_bytes = ByteView();
+    event.flags.clear();
+    event.workflow_stage = WorkflowStage::Observe;
+    event.sequence = 0;
+    event.timestamp_ns = 0;
+}
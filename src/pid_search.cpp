@@ -1,12 +1,30 @@
 #include "ghostline/pid_search.hpp"
 
 #include <algorithm>
+#include <arpa/inet.h>
 #include <array>
 #include <cctype>
+#include <chrono>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
 #include <memory>
+#include <netinet/in.h>
 #include <sstream>
 #include <stdexcept>
+#include <sys/stat.h>
+#include <map>
+#include <unistd.h>
+#include <unordered_map>
+#include <unordered_set>
+
+#if defined(__linux__)
+#include <linux/inet_diag.h>
+#include <linux/netlink.h>
+#include <linux/sock_diag.h>
+#endif
 
 namespace {
 
@@ -131,8 +149,329 @@ std::string run_command_capture(const std::string& command) {
     return output;
 }
 
+// Kernel TCP states as numbered in include/net/tcp_states.h, named as lsof
+// reports them.
+const char* tcp_state_name(unsigned state) {
+    static const char* const kNames[] = {
+        "UNKNOWN", "ESTABLISHED", "SYN_SENT", "SYN_RECV", "FIN_WAIT1", "FIN_WAIT2", "TIME_WAIT",
+        "CLOSE", "CLOSE_WAIT", "LAST_ACK", "LISTEN", "CLOSING", "NEW_SYN_RECV",
+    };
+    return state < sizeof(kNames) / sizeof(kNames[0]) ? kNames[state] : kNames[0];
+}
+
+bool parse_hex_u32(const std::string& text, std::size_t offset, std::size_t digits, std::uint32_t& value) {
+    if (offset + digits > text.size()) return false;
+    value = 0;
+    for (std::size_t i = 0; i < digits; ++i) {
+        const char ch = text[offset + i];
+        std::uint32_t digit = 0;
+        if (ch >= '0' && ch <= '9') digit = static_cast<std::uint32_t>(ch - '0');
+        else if (ch >= 'A' && ch <= 'F') digit = static_cast<std::uint32_t>(ch - 'A' + 10);
+        else if (ch >= 'a' && ch <= 'f') digit = static_cast<std::uint32_t>(ch - 'a' + 10);
+        else return false;
+        value = (value << 4) | digit;
+    }
+    return true;
+}
+
+// "0100007F:075B" → address bytes and port. The kernel prints each 32-bit
+// word of the address as a native integer, so copying the parsed words back
+// into memory restores network byte order on any host.
+bool parse_proc_address(const std::string& field, bool ipv6, std::uint8_t (&address)[16], std::uint16_t& port) {
+    const std::size_t words = ipv6 ? 4 : 1;
+    if (field.size() != words * 8 + 5 || field[words * 8] != ':') return false;
+    std::uint32_t raw[4] = {};
+    for (std::size_t i = 0; i < words; ++i) {
+        if (!parse_hex_u32(field, i * 8, 8, raw[i])) return false;
+    }
+    std::uint32_t port_value = 0;
+    if (!parse_hex_u32(field, words * 8 + 1, 4, port_value)) return false;
+    std::memcpy(address, raw, sizeof(raw));
+    port = static_cast<std::uint16_t>(port_value);
+    return true;
+}
+
+// Renders an address the way lsof does: "127.0.0.1:1883", "[::1]:1883", and
+// "*:1883" for a wildcard.
+std::string format_endpoint(bool ipv6, const std::uint8_t* address, std::uint16_t port) {
+    const std::size_t size = ipv6 ? 16 : 4;
+    std::string endpoint;
+    if (std::all_of(address, address + size, [](std::uint8_t byte) { return byte == 0; })) {
+        endpoint = "*";
+    } else {
+        char text[INET6_ADDRSTRLEN] = {};
+        inet_ntop(ipv6 ? AF_INET6 : AF_INET, address, text, sizeof(text));
+        endpoint = ipv6 ? std::string("[") + text + "]" : std::string(text);
+    }
+    return endpoint + ":" + std::to_string(port);
+}
+
+TcpSocketEntry make_socket_entry(bool ipv6,
+                                 const std::uint8_t* local,
+                                 std::uint16_t local_port,
+                                 const std::uint8_t* remote,
+                                 std::uint16_t remote_port,
+                                 unsigned state) {
+    TcpSocketEntry socket;
+    socket.address_family = ipv6 ? "IPv6" : "IPv4";
+    socket.state = tcp_state_name(state);
+    socket.endpoint = format_endpoint(ipv6, local, local_port);
+    if (remote_port != 0) socket.endpoint += "->" + format_endpoint(ipv6, remote, remote_port);
+    hydrate_endpoint(socket);
+    return socket;
+}
+
+bool read_small_file(const std::string& path, std::string& out) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::ostringstream buffer;
+    buffer << in.rdbuf();
+    out = buffer.str();
+    return true;
+}
+
+// Numeric directory entries of `dir`, as /proc/<pid> and /proc/<pid>/fd use.
+std::vector<std::int64_t> numeric_entries(const std::string& dir) {
+    std::vector<std::int64_t> values;
+    DIR* handle = opendir(dir.c_str());
+    if (handle == nullptr) return values;
+    while (const dirent* entry = readdir(handle)) {
+        const char* name = entry->d_name;
+        if (*name == '\0' || !std::all_of(name, name + std::strlen(name), ::isdigit)) continue;
+        values.push_back(std::strtoll(name, nullptr, 10));
+    }
+    closedir(handle);
+    std::sort(values.begin(), values.end());
+    return values;
+}
+
+// Inode of a "socket:[12345]" fd link, or 0 for anything else.
+std::uint64_t socket_inode(const std::string& link_path) {
+    char target[64];
+    const ssize_t size = ::readlink(link_path.c_str(), target, sizeof(target) - 1);
+    if (size <= 9 || std::strncmp(target, "socket:[", 8) != 0 || target[size - 1] != ']') return 0;
+    target[size - 1] = '\0';
+    return std::strtoull(target + 8, nullptr, 10);
+}
+
+std::uint32_t file_owner(const std::string& path) {
+    struct stat info {};
+    return ::stat(path.c_str(), &info) == 0 ? static_cast<std::uint32_t>(info.st_uid) : static_cast<std::uint32_t>(-1);
+}
+
+// Requested refreshes are spaced at least this far apart, so a stream of
+// lookups for remote peers cannot keep the index thread dumping.
+constexpr std::chrono::milliseconds kRequestedRefreshGap(50);
+
+constexpr std::uint32_t kOwnerSearches = 2;
+
+struct TupleEndpoint {
+    std::uint8_t family = 0;
+    std::array<std::uint8_t, 16> address{};
+    std::uint16_t port = 0;
+};
+
+TupleEndpoint make_tuple_endpoint(bool ipv6, const std::uint8_t* address, std::uint16_t port) {
+    static const std::uint8_t kMappedPrefix[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff};
+    TupleEndpoint endpoint;
+    endpoint.port = port;
+    if (ipv6 && std::memcmp(address, kMappedPrefix, sizeof(kMappedPrefix)) == 0) {
+        endpoint.family = 4;
+        std::memcpy(endpoint.address.data(), address + 12, 4);
+    } else {
+        endpoint.family = ipv6 ? 6 : 4;
+        std::memcpy(endpoint.address.data(), address, ipv6 ? 16 : 4);
+    }
+    return endpoint;
+}
+
+bool tuple_from_endpoints(const TupleEndpoint& local, const TupleEndpoint& remote, SocketTuple& tuple) {
+    if (local.family != remote.family) return false;
+    tuple.family = local.family;
+    tuple.local = local.address;
+    tuple.remote = remote.address;
+    tuple.local_port = local.port;
+    tuple.remote_port = remote.port;
+    return true;
+}
+
+bool endpoint_from_sockaddr(const sockaddr_storage& storage, TupleEndpoint& endpoint) {
+    if (storage.ss_family == AF_INET) {
+        const auto& address = reinterpret_cast<const sockaddr_in&>(storage);
+        endpoint = make_tuple_endpoint(false, reinterpret_cast<const std::uint8_t*>(&address.sin_addr), ntohs(address.sin_port));
+        return true;
+    }
+    if (storage.ss_family == AF_INET6) {
+        const auto& address = reinterpret_cast<const sockaddr_in6&>(storage);
+        endpoint = make_tuple_endpoint(true, reinterpret_cast<const std::uint8_t*>(&address.sin6_addr), ntohs(address.sin6_port));
+        return true;
+    }
+    return false;
+}
+
+std::string tuple_key(const SocketTuple& tuple) {
+    std::string key;
+    key.reserve(37);
+    key.push_back(static_cast<char>(tuple.family));
+    key.append(reinterpret_cast<const char*>(tuple.local.data()), tuple.local.size());
+    key.append(reinterpret_cast<const char*>(tuple.remote.data()), tuple.remote.size());
+    key.push_back(static_cast<char>(tuple.local_port >> 8));
+    key.push_back(static_cast<char>(tuple.local_port & 0xff));
+    key.push_back(static_cast<char>(tuple.remote_port >> 8));
+    key.push_back(static_cast<char>(tuple.remote_port & 0xff));
+    return key;
+}
+
+struct DiagSocket {
+    ProcTcpSocket row;
+    SocketTuple tuple;
+    std::uint32_t uid = 0;
+};
+
+#if defined(__linux__)
+// Appends every TCP socket of `family` from one inet_diag dump.
+bool dump_inet_diag(int fd, std::uint8_t family, std::uint32_t sequence, std::vector<DiagSocket>& out) {
+    struct {
+        nlmsghdr header;
+        inet_diag_req_v2 request;
+    } message {};
+    message.header.nlmsg_len = sizeof(message);
+    message.header.nlmsg_type = SOCK_DIAG_BY_FAMILY;
+    message.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    message.header.nlmsg_seq = sequence;
+    message.request.sdiag_family = family;
+    message.request.sdiag_protocol = IPPROTO_TCP;
+    message.request.idiag_states = ~0U;
+
+    sockaddr_nl kernel {};
+    kernel.nl_family = AF_NETLINK;
+    if (::sendto(fd, &message, sizeof(message), 0, reinterpret_cast<sockaddr*>(&kernel), sizeof(kernel)) < 0) return false;
+
+    alignas(nlmsghdr) char buffer[64 * 1024];
+    while (true) {
+        ssize_t size = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (size < 0 && errno == EINTR) continue;
+        if (size <= 0) return false;
+        for (const nlmsghdr* header = reinterpret_cast<const nlmsghdr*>(buffer);
+             NLMSG_OK(header, static_cast<unsigned>(size));
+             header = NLMSG_NEXT(header, size)) {
+            if (header->nlmsg_seq != sequence) continue;
+            if (header->nlmsg_type == NLMSG_DONE) return true;
+            if (header->nlmsg_type == NLMSG_ERROR) return false;
+            if (header->nlmsg_len < NLMSG_LENGTH(sizeof(inet_diag_msg))) continue;
+
+            const auto* diag = static_cast<const inet_diag_msg*>(NLMSG_DATA(header));
+            const bool ipv6 = diag->idiag_family == AF_INET6;
+            const auto* local = reinterpret_cast<const std::uint8_t*>(diag->id.idiag_src);
+            const auto* remote = reinterpret_cast<const std::uint8_t*>(diag->id.idiag_dst);
+            const std::uint16_t local_port = ntohs(diag->id.idiag_sport);
+            const std::uint16_t remote_port = ntohs(diag->id.idiag_dport);
+
+            DiagSocket socket;
+            socket.row.inode = diag->idiag_inode;
+            socket.row.socket = make_socket_entry(ipv6, local, local_port, remote, remote_port, diag->idiag_state);
+            socket.uid = diag->idiag_uid;
+            tuple_from_endpoints(make_tuple_endpoint(ipv6, local, local_port), make_tuple_endpoint(ipv6, remote, remote_port), socket.tuple);
+            out.push_back(std::move(socket));
+        }
+    }
+}
+#endif
+
+bool dump_tcp_sockets(std::vector<DiagSocket>& out) {
+#if defined(__linux__)
+    const int fd = ::socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_SOCK_DIAG);
+    if (fd < 0) return false;
+    const bool ok = dump_inet_diag(fd, AF_INET, 1, out) && dump_inet_diag(fd, AF_INET6, 2, out);
+    ::close(fd);
+    return ok;
+#else
+    (void)out;
+    return false;
+#endif
+}
+
 } // namespace
 
+std::vector<ProcTcpSocket> parse_proc_net_tcp(const std::string& text, bool ipv6) {
+    std::vector<ProcTcpSocket> sockets;
+    std::istringstream stream(text);
+    std::string line;
+    std::getline(stream, line);  // column header
+    while (std::getline(stream, line)) {
+        std::istringstream fields(line);
+        std::string slot, local, remote, state, queues, timer, retransmits, uid, timeout;
+        std::uint64_t inode = 0;
+        if (!(fields >> slot >> local >> remote >> state >> queues >> timer >> retransmits >> uid >> timeout >> inode)) continue;
+
+        std::uint8_t local_address[16] = {};
+        std::uint8_t remote_address[16] = {};
+        std::uint16_t local_port = 0;
+        std::uint16_t remote_port = 0;
+        std::uint32_t state_value = 0;
+        if (!parse_proc_address(local, ipv6, local_address, local_port)
+            || !parse_proc_address(remote, ipv6, remote_address, remote_port)
+            || !parse_hex_u32(state, 0, state.size(), state_value)) {
+            continue;
+        }
+        ProcTcpSocket row;
+        row.inode = inode;
+        row.socket = make_socket_entry(ipv6, local_address, local_port, remote_address, remote_port, state_value);
+        sockets.push_back(std::move(row));
+    }
+    return sockets;
+}
+
+std::vector<ProcessSocketEntry> query_proc_tcp_processes(const PidSearchQuery& query, const std::string& proc_root) {
+    std::string tcp4;
+    if (!read_small_file(proc_root + "/net/tcp", tcp4)) {
+        throw std::runtime_error("failed to read " + proc_root + "/net/tcp");
+    }
+    std::string tcp6;
+    std::vector<ProcTcpSocket> sockets = parse_proc_net_tcp(tcp4, false);
+    if (read_small_file(proc_root + "/net/tcp6", tcp6)) {
+        std::vector<ProcTcpSocket> v6 = parse_proc_net_tcp(tcp6, true);
+        sockets.insert(sockets.end(), std::make_move_iterator(v6.begin()), std::make_move_iterator(v6.end()));
+    }
+
+    // Sockets in TIME_WAIT and other orphans have inode 0 and no owner.
+    std::unordered_map<std::uint64_t, std::size_t> by_inode;
+    for (std::size_t i = 0; i < sockets.size(); ++i) {
+        if (sockets[i].inode != 0) by_inode.emplace(sockets[i].inode, i);
+    }
+
+    std::vector<ProcessSocketEntry> processes;
+    if (by_inode.empty()) return processes;
+
+    const std::vector<std::int64_t> pids = query.pid >= 0 ? std::vector<std::int64_t>{query.pid} : numeric_entries(proc_root);
+    for (const std::int64_t pid : pids) {
+        const std::string pid_dir = proc_root + "/" + std::to_string(pid);
+        ProcessSocketEntry process;
+        process.pid = pid;
+        // Reading comm first lets a name search skip the fd walk.
+        if (read_small_file(pid_dir + "/comm", process.command)) process.command = trim_copy(process.command);
+        if (!entry_matches_process(process, query)) continue;
+
+        const std::string fd_dir = pid_dir + "/fd";
+        const std::vector<std::int64_t> fds = numeric_entries(fd_dir);
+        for (const std::int64_t fd : fds) {
+            const std::uint64_t inode = socket_inode(fd_dir + "/" + std::to_string(fd));
+            if (inode == 0) continue;
+            const auto found = by_inode.find(inode);
+            if (found == by_inode.end()) continue;
+            process.sockets.push_back(sockets[found->second].socket);
+            process.sockets.back().file_descriptor = std::to_string(fd);
+        }
+        if (process.sockets.empty()) continue;
+
+        struct stat info {};
+        if (::stat(pid_dir.c_str(), &info) == 0) process.user = std::to_string(info.st_uid);
+        processes.push_back(std::move(process));
+    }
+
+    return filter_process_sockets(processes, query);
+}
+
 std::vector<ProcessSocketEntry> parse_lsof_tcp_listing(const std::string& text) {
     std::vector<ProcessSocketEntry> processes;
     ProcessSocketEntry* current_process = nullptr;
@@ -224,6 +563,11 @@ std::vector<ProcessSocketEntry> filter_process_sockets(const std::vector<Process
 }
 
 std::vector<ProcessSocketEntry> query_tcp_processes(const PidSearchQuery& query) {
+#if defined(__linux__)
+    if (::access("/proc/net/tcp", R_OK) == 0) {
+        return query_proc_tcp_processes(query);
+    }
+#endif
     const std::string output = run_command_capture("lsof -nP -FpcuftnT -iTCP");
     return filter_process_sockets(parse_lsof_tcp_listing(output), query);
 }
@@ -258,3 +602,208 @@ std::string process_sockets_to_json(const std::vector<ProcessSocketEntry>& entri
     out << "\n  ]\n}\n";
     return out.str();
 }
+
+bool make_socket_tuple(const sockaddr_storage& local, const sockaddr_storage& remote, SocketTuple& tuple) {
+    TupleEndpoint local_endpoint;
+    TupleEndpoint remote_endpoint;
+    return endpoint_from_sockaddr(local, local_endpoint)
+        && endpoint_from_sockaddr(remote, remote_endpoint)
+        && tuple_from_endpoints(local_endpoint, remote_endpoint, tuple);
+}
+
+struct SocketIndex::Snapshot {
+    struct Owner {
+        std::int64_t pid = -1;
+        std::int64_t fd = -1;
+    };
+    struct Process {
+        std::string command;
+        std::string user;
+    };
+
+    std::vector<ProcTcpSocket> sockets;
+    std::unordered_map<std::uint64_t, Owner> owners;
+    std::unordered_map<std::int64_t, Process> processes;
+    std::unordered_map<std::string, std::uint64_t> by_tuple;
+    // Failed owner searches per socket. A socket still in a listener's
+    // accept queue has no fd yet, so one miss is retried; after
+    // kOwnerSearches misses the owner is taken to be unreadable.
+    std::unordered_map<std::uint64_t, std::uint32_t> unowned;
+};
+
+SocketIndex::SocketIndex(const std::string& proc_root) : proc_root_(proc_root) {}
+
+SocketIndex::~SocketIndex() {
+    stop();
+}
+
+bool SocketIndex::start(std::uint32_t refresh_ms) {
+    if (thread_.joinable()) return true;
+    if (!refresh()) return false;
+    refresh_ms_ = refresh_ms == 0 ? 1 : refresh_ms;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = false;
+    }
+    thread_ = std::thread([this]() { run(); });
+    return true;
+}
+
+void SocketIndex::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) thread_.join();
+}
+
+void SocketIndex::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_) {
+        const bool requested = wake_.wait_for(lock, std::chrono::milliseconds(refresh_ms_), [this]() { return stop_ || refresh_requested_; });
+        if (stop_) break;
+        refresh_requested_ = false;
+        lock.unlock();
+        refresh();
+        if (requested) std::this_thread::sleep_for(kRequestedRefreshGap);
+        lock.lock();
+    }
+}
+
+std::shared_ptr<const SocketIndex::Snapshot> SocketIndex::snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return snapshot_;
+}
+
+std::uint64_t SocketIndex::refreshes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return refreshes_;
+}
+
+bool SocketIndex::refresh() {
+    std::lock_guard<std::mutex> refresh_lock(refresh_mutex_);
+    std::vector<DiagSocket> dumped;
+    if (!dump_tcp_sockets(dumped)) return false;
+
+    const std::shared_ptr<const Snapshot> previous = snapshot();
+    auto next = std::make_shared<Snapshot>();
+    std::unordered_set<std::uint64_t> unresolved;
+    std::unordered_set<std::uint32_t> unresolved_uids;
+    for (std::size_t i = 0; i < dumped.size(); ++i) {
+        const std::uint64_t inode = dumped[i].row.inode;
+        next->sockets.push_back(dumped[i].row);
+        // TIME_WAIT and other orphaned sockets have inode 0 and no owner.
+        if (inode == 0) continue;
+        next->by_tuple.emplace(tuple_key(dumped[i].tuple), inode);
+
+        if (previous) {
+            const auto owner = previous->owners.find(inode);
+            if (owner != previous->owners.end()) {
+                next->owners.insert(*owner);
+                const auto process = previous->processes.find(owner->second.pid);
+                if (process != previous->processes.end()) next->processes.insert(*process);
+                continue;
+            }
+            const auto misses = previous->unowned.find(inode);
+            if (misses != previous->unowned.end()) {
+                next->unowned.insert(*misses);
+                if (misses->second >= kOwnerSearches) continue;
+            }
+        }
+        unresolved.insert(inode);
+        unresolved_uids.insert(dumped[i].uid);
+    }
+
+    if (!unresolved.empty()) {
+        // Processes that already own sockets (servers, pools) are the likely
+        // owners of new ones, so their fd tables are read first.
+        std::vector<std::int64_t> pids;
+        for (const auto& process : next->processes) pids.push_back(process.first);
+        std::sort(pids.begin(), pids.end());
+        const std::size_t known = pids.size();
+        const std::vector<std::int64_t> all = numeric_entries(proc_root_);
+        for (std::size_t i = 0; i < all.size(); ++i) {
+            if (!std::binary_search(pids.begin(), pids.begin() + static_cast<std::ptrdiff_t>(known), all[i])) pids.push_back(all[i]);
+        }
+
+        for (std::size_t i = 0; i < pids.size() && !unresolved.empty(); ++i) {
+            const std::string pid_dir = proc_root_ + "/" + std::to_string(pids[i]);
+            const std::uint32_t uid = file_owner(pid_dir);
+            if (i >= known && unresolved_uids.count(uid) == 0) continue;
+
+            const std::string fd_dir = pid_dir + "/fd";
+            const std::vector<std::int64_t> fds = numeric_entries(fd_dir);
+            bool owns_socket = false;
+            for (std::size_t j = 0; j < fds.size(); ++j) {
+                const std::uint64_t inode = socket_inode(fd_dir + "/" + std::to_string(fds[j]));
+                if (inode == 0 || unresolved.erase(inode) == 0) continue;
+                next->owners[inode] = Snapshot::Owner{pids[i], fds[j]};
+                next->unowned.erase(inode);
+                owns_socket = true;
+            }
+            if (owns_socket && next->processes.count(pids[i]) == 0) {
+                Snapshot::Process process;
+                if (read_small_file(pid_dir + "/comm", process.command)) process.command = trim_copy(process.command);
+                process.user = std::to_string(uid);
+                next->processes.emplace(pids[i], std::move(process));
+            }
+        }
+        for (const std::uint64_t inode : unresolved) ++next->unowned[inode];
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    snapshot_ = std::move(next);
+    ++refreshes_;
+    return true;
+}
+
+std::vector<ProcessSocketEntry> SocketIndex::query(const PidSearchQuery& query) const {
+    const std::shared_ptr<const Snapshot> current = snapshot();
+    if (!current) return query_tcp_processes(query);
+
+    std::map<std::int64_t, std::vector<std::pair<std::int64_t, const TcpSocketEntry*>>> owned;
+    for (std::size_t i = 0; i < current->sockets.size(); ++i) {
+        const auto owner = current->owners.find(current->sockets[i].inode);
+        if (owner == current->owners.end()) continue;
+        owned[owner->second.pid].emplace_back(owner->second.fd, &current->sockets[i].socket);
+    }
+
+    std::vector<ProcessSocketEntry> processes;
+    for (auto& entry : owned) {
+        ProcessSocketEntry process;
+        process.pid = entry.first;
+        const auto info = current->processes.find(entry.first);
+        if (info != current->processes.end()) {
+            process.command = info->second.command;
+            process.user = info->second.user;
+        }
+        std::sort(entry.second.begin(), entry.second.end(), [](const auto& left, const auto& right) { return left.first < right.first; });
+        for (std::size_t i = 0; i < entry.second.size(); ++i) {
+            process.sockets.push_back(*entry.second[i].second);
+            process.sockets.back().file_descriptor = std::to_string(entry.second[i].first);
+        }
+        processes.push_back(std::move(process));
+    }
+    return filter_process_sockets(processes, query);
+}
+
+std::int64_t SocketIndex::owner_of(const SocketTuple& tuple) {
+    const std::shared_ptr<const Snapshot> current = snapshot();
+    if (current) {
+        const auto socket = current->by_tuple.find(tuple_key(tuple));
+        if (socket != current->by_tuple.end()) {
+            const auto owner = current->owners.find(socket->second);
+            if (owner != current->owners.end()) return owner->second.pid;
+            // Owner unreadable after repeated searches; another dump will not help.
+            const auto misses = current->unowned.find(socket->second);
+            if (misses != current->unowned.end() && misses->second >= kOwnerSearches) return -1;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        refresh_requested_ = true;
+    }
+    wake_.notify_one();
+    return -1;
+}
@@ -4,16 +4,23 @@
 
 std::vector<std::unique_ptr<ProtocolPlugin>> make_builtin_plugins(const MutationConfig& config);
 
-PluginRegistry::PluginRegistry(const MutationConfig& config) : plugins_(make_builtin_plugins(config)) {}
+PluginRegistry::PluginRegistry(const MutationConfig& config) : plugins_(make_builtin_plugins(config)) {
+    for (std::size_t i = 0; i < plugins_.size(); ++i) {
+        plugins_[i]->id_ = static_cast<PluginId>(i);
+        ids_by_name_.emplace(plugins_[i]->name(), static_cast<PluginId>(i));
+    }
+}
+
+PluginId PluginRegistry::id_of(const std::string& name) const {
+    std::unordered_map<std::string, PluginId>::const_iterator it = ids_by_name_.find(name);
+    return it == ids_by_name_.end() ? kNoPluginId : it->second;
+}
 
 const ProtocolPlugin* PluginRegistry::find_by_name(const std::string& name) const {
-    for (std::vector<std::unique_ptr<ProtocolPlugin>>::const_iterator it = plugins_.begin(); it != plugins_.end(); ++it) {
-        if ((*it)->name() == name) return it->get();
-    }
-    return nullptr;
+    return get(id_of(name));
 }
 
-const ProtocolPlugin* PluginRegistry::match(const FlowContext& flow, Direction direction, std::uint16_t upstream_port, const ByteVec& buffer) const {
+const ProtocolPlugin* PluginRegistry::match(const FlowContext& flow, Direction direction, std::uint16_t upstream_port, ByteView buffer) const {
     if (!flow.preferred_plugin.empty()) {
         const ProtocolPlugin* preferred = find_by_name(flow.preferred_plugin);
         if (preferred != nullptr) return preferred;
@@ -1,33 +1,46 @@
+#include "ghostline/log_tail.hpp"
 #include "ghostline/operator_state.hpp"
 #include "ghostline/pid_search.hpp"
 
+#include <QAbstractListModel>
 #include <QApplication>
 #include <QCheckBox>
 #include <QFileDialog>
 #include <QFormLayout>
 #include <QGroupBox>
 #include <QHBoxLayout>
+#include <QItemSelectionModel>
 #include <QLabel>
 #include <QLineEdit>
+#include <QListView>
 #include <QListWidget>
 #include <QListWidgetItem>
 #include <QMessageBox>
 #include <QPlainTextEdit>
 #include <QPushButton>
+#include <QSocketNotifier>
 #include <QSplitter>
 #include <QTabWidget>
 #include <QTextStream>
+#include <QTimer>
 #include <QVBoxLayout>
 #include <QWidget>
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
+#include <limits>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <vector>
 
 namespace {
 
+// Review items loaded per refresh; the journal index keeps larger queues
+// from being read in full just to fill the list.
+constexpr std::size_t kReviewListLimit = 1000;
+
 QString to_qstring(const std::string& value) {
     return QString::fromStdString(value);
 }
@@ -102,22 +115,6 @@ std::string read_file_text(const std::string& path) {
     return buffer.str();
 }
 
-std::vector<std::string> read_non_empty_lines(const std::string& path) {
-    std::ifstream in(path);
-    if (!in) {
-        throw std::runtime_error("failed to open " + path);
-    }
-
-    std::vector<std::string> lines;
-    std::string line;
-    while (std::getline(in, line)) {
-        if (!line.empty()) {
-            lines.push_back(line);
-        }
-    }
-    return lines;
-}
-
 std::string summarize_jsonl_line(const std::string& line) {
     auto extract = [&line](const std::string& key) {
         const std::string needle = "\"" + key + "\":";
@@ -147,6 +144,74 @@ std::string summarize_jsonl_line(const std::string& line) {
     return line.size() > 96 ? line.substr(0, 96) + "..." : line;
 }
 
+// Rows of one audit or action stream. Only the line offsets are held; a row
+// is read and summarized when the view asks for it, which with uniform item
+// sizes means only while it is on screen.
+class LogLineModel : public QAbstractListModel {
+public:
+    explicit LogLineModel(QObject* parent = nullptr) : QAbstractListModel(parent) {}
+
+    void reset(std::unique_ptr<LogLineIndex> index) {
+        beginResetModel();
+        index_ = std::move(index);
+        rows_ = index_ ? clamped_rows(index_->size()) : 0;
+        cache_.assign(kSummaryCacheSlots, CachedSummary());
+        endResetModel();
+    }
+
+    // Indexes lines appended since the last call and returns how many rows
+    // that added.
+    std::size_t refresh() {
+        if (!index_) return 0;
+        index_->refresh();
+        const std::size_t total = clamped_rows(index_->size());
+        if (total <= rows_) return 0;
+        const std::size_t added = total - rows_;
+        beginInsertRows(QModelIndex(), static_cast<int>(rows_), static_cast<int>(total - 1));
+        rows_ = total;
+        endInsertRows();
+        return added;
+    }
+
+    LogLineIndex* line_index() const { return index_.get(); }
+    std::string line(int row) const { return index_->line(static_cast<std::size_t>(row)); }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override {
+        return parent.isValid() ? 0 : static_cast<int>(rows_);
+    }
+
+    QVariant data(const QModelIndex& index, int role) const override {
+        if (role != Qt::DisplayRole || !index.isValid() || static_cast<std::size_t>(index.row()) >= rows_) return QVariant();
+        CachedSummary& cached = cache_[static_cast<std::size_t>(index.row()) % kSummaryCacheSlots];
+        if (cached.row != index.row()) {
+            try {
+                cached.text = to_qstring(summarize_jsonl_line(line(index.row())));
+            } catch (const std::exception& error) {
+                cached.text = to_qstring(error.what());
+            }
+            cached.row = index.row();
+        }
+        return cached.text;
+    }
+
+private:
+    static std::size_t clamped_rows(std::size_t lines) {
+        return std::min<std::size_t>(lines, static_cast<std::size_t>(std::numeric_limits<int>::max()));
+    }
+
+    // A screenful or two of summaries, so repaints do not re-read lines.
+    static constexpr std::size_t kSummaryCacheSlots = 256;
+
+    struct CachedSummary {
+        int row = -1;
+        QString text;
+    };
+
+    std::unique_ptr<LogLineIndex> index_;
+    std::size_t rows_ = 0;
+    mutable std::vector<CachedSummary> cache_ = std::vector<CachedSummary>(kSummaryCacheSlots);
+};
+
 class GhostlineOperatorWindow : public QWidget {
 public:
     GhostlineOperatorWindow() {
@@ -175,6 +240,9 @@ public:
 
         refresh_profiles();
         refresh_review_items();
+        // Searches answer from this index on Linux; elsewhere it stays
+        // empty and query() runs lsof.
+        socket_index_.start(2000);
     }
 
 private:
@@ -320,8 +388,10 @@ private:
         queue_dir_row->addWidget(refresh_queue_button);
 
         review_items_ = new QListWidget;
+        review_count_label_ = new QLabel;
         queue_layout->addLayout(queue_dir_row);
         queue_layout->addWidget(review_items_, 1);
+        queue_layout->addWidget(review_count_label_);
 
         auto* note_row = new QHBoxLayout;
         review_note_input_ = new QLineEdit;
@@ -433,10 +503,17 @@ private:
         action_row->addWidget(choose_actions_button);
         action_row->addWidget(load_actions_button);
 
-        file_entries_ = new QListWidget;
+        follow_input_ = new QCheckBox("Follow appended lines");
+        file_model_ = new LogLineModel(this);
+        file_entries_ = new QListView;
+        file_entries_->setUniformItemSizes(true);
+        file_entries_->setModel(file_model_);
+        follow_timer_ = new QTimer(this);
+        follow_timer_->setInterval(500);
 
         jsonl_layout->addLayout(audit_row);
         jsonl_layout->addLayout(action_row);
+        jsonl_layout->addWidget(follow_input_);
         jsonl_layout->addWidget(file_entries_, 1);
         left_layout->addWidget(jsonl_group, 1);
 
@@ -461,7 +538,10 @@ private:
         connect(load_audit_button, &QPushButton::clicked, this, [this]() { load_jsonl_file(audit_file_input_, "audit"); });
         connect(choose_actions_button, &QPushButton::clicked, this, [this]() { choose_actions_file(); });
         connect(load_actions_button, &QPushButton::clicked, this, [this]() { load_jsonl_file(actions_file_input_, "actions"); });
-        connect(file_entries_, &QListWidget::currentRowChanged, this, [this](int row) { show_file_entry(row); });
+        connect(file_entries_->selectionModel(), &QItemSelectionModel::currentRowChanged, this,
+                [this](const QModelIndex& current, const QModelIndex&) { show_file_entry(current.row()); });
+        connect(follow_input_, &QCheckBox::toggled, this, [this](bool) { update_follow(); });
+        connect(follow_timer_, &QTimer::timeout, this, [this]() { append_file_lines(); });
 
         return tab;
     }
@@ -488,7 +568,7 @@ private:
 
     void run_search() {
         try {
-            current_results_ = query_tcp_processes(current_query());
+            current_results_ = socket_index_.query(current_query());
             search_results_->clear();
             for (const auto& entry : current_results_) {
                 search_results_->addItem(to_qstring(process_summary(entry)));
@@ -616,11 +696,15 @@ private:
 
     void refresh_review_items() {
         try {
-            current_review_items_ = list_review_items(to_std_string(review_queue_dir_input_->text().trimmed()));
+            const ReviewPage page = list_review_page(to_std_string(review_queue_dir_input_->text().trimmed()), ReviewFilter(), 0, kReviewListLimit);
+            current_review_items_ = page.items;
             review_items_->clear();
             for (const auto& item : current_review_items_) {
                 review_items_->addItem(to_qstring(review_summary(item)));
             }
+            review_count_label_->setText(page.total > current_review_items_.size()
+                                             ? QString("Showing %1 of %2 items").arg(current_review_items_.size()).arg(page.total)
+                                             : QString("%1 items").arg(page.total));
             if (!current_review_items_.empty()) {
                 review_items_->setCurrentRow(0);
             } else {
@@ -726,8 +810,8 @@ private:
             return;
         }
         try {
-            file_entries_->clear();
-            current_file_lines_.clear();
+            stop_follow();
+            file_model_->reset(nullptr);
             current_file_type_ = "rules";
             file_details_->setPlainText(to_qstring(read_file_text(path)));
         } catch (const std::exception& error) {
@@ -742,14 +826,15 @@ private:
             return;
         }
         try {
-            current_file_lines_ = read_non_empty_lines(path);
+            // Rotated segments come first, so a rolled-over log reads as one
+            // continuous stream.
+            std::unique_ptr<LogLineIndex> index(new LogLineIndex(path));
+            stop_follow();
+            file_model_->reset(std::move(index));
             current_file_type_ = type;
-            file_entries_->clear();
-            for (const auto& line : current_file_lines_) {
-                file_entries_->addItem(to_qstring(summarize_jsonl_line(line)));
-            }
-            if (!current_file_lines_.empty()) {
-                file_entries_->setCurrentRow(0);
+            update_follow();
+            if (file_model_->rowCount() != 0) {
+                file_entries_->setCurrentIndex(file_model_->index(0));
             } else {
                 file_details_->setPlainText("No entries found.");
             }
@@ -759,10 +844,60 @@ private:
     }
 
     void show_file_entry(int row) {
-        if (row < 0 || static_cast<std::size_t>(row) >= current_file_lines_.size()) {
+        if (row < 0 || row >= file_model_->rowCount()) {
             return;
         }
-        file_details_->setPlainText(to_qstring(current_file_lines_[static_cast<std::size_t>(row)]));
+        try {
+            file_details_->setPlainText(to_qstring(file_model_->line(row)));
+        } catch (const std::exception& error) {
+            file_details_->setPlainText(to_qstring(error.what()));
+        }
+    }
+
+    // inotify wakes follow mode where available; elsewhere it polls.
+    void update_follow() {
+        stop_follow();
+        LogLineIndex* index = file_model_->line_index();
+        if (!follow_input_->isChecked() || index == nullptr) {
+            return;
+        }
+        const int fd = index->watch();
+        if (fd >= 0) {
+            follow_notifier_ = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+            connect(follow_notifier_, &QSocketNotifier::activated, this, [this]() {
+                file_model_->line_index()->drain_watch();
+                append_file_lines();
+            });
+        } else {
+            follow_timer_->start();
+        }
+        append_file_lines();
+    }
+
+    // May run inside the notifier's own activated() slot, so the notifier is
+    // disabled now and deleted once control is back in the event loop.
+    void stop_follow() {
+        follow_timer_->stop();
+        if (follow_notifier_ != nullptr) {
+            follow_notifier_->setEnabled(false);
+            follow_notifier_->deleteLater();
+            follow_notifier_ = nullptr;
+        }
+    }
+
+    void append_file_lines() {
+        const int rows = file_model_->rowCount();
+        const int current = file_entries_->currentIndex().row();
+        const bool at_end = current < 0 || current == rows - 1;
+        try {
+            if (file_model_->refresh() != 0 && at_end) {
+                file_entries_->scrollToBottom();
+            }
+        } catch (const std::exception& error) {
+            stop_follow();
+            follow_input_->setChecked(false);
+            QMessageBox::critical(this, "Follow File", to_qstring(error.what()));
+        }
     }
 
     QLineEdit* process_input_ = nullptr;
@@ -781,18 +916,23 @@ private:
     QLineEdit* review_queue_dir_input_ = nullptr;
     QLineEdit* replay_dir_input_ = nullptr;
     QListWidget* review_items_ = nullptr;
+    QLabel* review_count_label_ = nullptr;
     QLineEdit* review_note_input_ = nullptr;
     QPlainTextEdit* review_details_ = nullptr;
     QLineEdit* rules_file_input_ = nullptr;
     QLineEdit* audit_file_input_ = nullptr;
     QLineEdit* actions_file_input_ = nullptr;
-    QListWidget* file_entries_ = nullptr;
+    QCheckBox* follow_input_ = nullptr;
+    QListView* file_entries_ = nullptr;
+    LogLineModel* file_model_ = nullptr;
+    QTimer* follow_timer_ = nullptr;
+    QSocketNotifier* follow_notifier_ = nullptr;
     QPlainTextEdit* file_details_ = nullptr;
 
+    SocketIndex socket_index_;
     std::vector<ProcessSocketEntry> current_results_;
     std::vector<std::string> current_profile_paths_;
     std::vector<ActionItem> current_review_items_;
-    std::vector<std::string> current_file_lines_;
     std::string current_file_type_;
 };
 
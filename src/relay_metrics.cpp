@@ -0,0 +1,321 @@
+#include "net/relay_metrics.hpp"
+
+#include "ghostline/labels.hpp"
+#include "net/socket_io.hpp"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr std::size_t kMaxRequestBytes = 8 * 1024;
+// A scraper that connects and stalls holds the server for at most this long.
+constexpr int kClientTimeoutMs = 2000;
+
+const MemoryCategory kQueueCategories[] = {
+    MemoryCategory::Pending,
+    MemoryCategory::OutQueue,
+    MemoryCategory::Candidate,
+    MemoryCategory::Audit,
+};
+
+std::uint64_t load(const std::atomic<std::uint64_t>& value) {
+    return value.load(std::memory_order_relaxed);
+}
+
+void header(std::ostringstream& out, const char* name, const char* type, const char* help) {
+    out << "# HELP " << name << " " << help << "\n"
+        << "# TYPE " << name << " " << type << "\n";
+}
+
+void write_all(int fd, const std::string& data) {
+    std::size_t written = 0;
+    while (written < data.size()) {
+        const ssize_t n = ::send(fd, data.data() + written, data.size() - written, kSendFlags);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return;
+        written += static_cast<std::size_t>(n);
+    }
+}
+
+int listen_tcp(const std::string& host, const std::string& port, std::string& error) {
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+
+    addrinfo* result = nullptr;
+    const int rc = getaddrinfo(host.empty() ? "127.0.0.1" : host.c_str(), port.c_str(), &hints, &result);
+    if (rc != 0) {
+        error = "cannot resolve " + host + ":" + port + ": " + gai_strerror(rc);
+        return -1;
+    }
+
+    int listen_fd = -1;
+    for (addrinfo* p = result; p; p = p->ai_next) {
+        const int fd = ::socket(p->ai_family, p->ai_socktype, p->ai_protocol);
+        if (fd < 0) continue;
+        ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+        const int yes = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+        if (::bind(fd, p->ai_addr, p->ai_addrlen) == 0 && ::listen(fd, 16) == 0) {
+            listen_fd = fd;
+            break;
+        }
+        error = std::strerror(errno);
+        ::close(fd);
+    }
+    freeaddrinfo(result);
+    if (listen_fd < 0) error = "cannot listen on " + host + ":" + port + (error.empty() ? std::string() : ": " + error);
+    return listen_fd;
+}
+
+int listen_unix(const std::string& path, std::string& error) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        error = "unix socket path is empty or too long: " + path;
+        return -1;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size());
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        error = std::string("cannot create unix socket: ") + std::strerror(errno);
+        return -1;
+    }
+    ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+    // A socket left behind by an earlier run would make bind fail.
+    struct stat info {};
+    if (::lstat(path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) ::unlink(path.c_str());
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(fd, 16) != 0) {
+        error = "cannot listen on " + path + ": " + std::strerror(errno);
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+} // namespace
+
+RelayMetrics::RelayMetrics(unsigned workers, const MemoryAccountant* memory) : memory_(memory) {
+    for (unsigned i = 0; i < (workers == 0 ? 1U : workers); ++i) {
+        workers_.push_back(std::unique_ptr<WorkerMetrics>(new WorkerMetrics()));
+    }
+}
+
+std::string RelayMetrics::render() const {
+    WorkerMetrics sum;
+    std::uint64_t rules_generation = 0;
+    for (std::size_t w = 0; w < workers_.size(); ++w) {
+        const WorkerMetrics& worker = *workers_[w];
+        WorkerMetrics::add(sum.active_flows, load(worker.active_flows));
+        for (std::size_t i = 0; i < sum.relayed_bytes.size(); ++i) WorkerMetrics::add(sum.relayed_bytes[i], load(worker.relayed_bytes[i]));
+        for (std::size_t i = 0; i < sum.candidates.size(); ++i) WorkerMetrics::add(sum.candidates[i], load(worker.candidates[i]));
+        WorkerMetrics::add(sum.released_modified, load(worker.released_modified));
+        WorkerMetrics::add(sum.released_original, load(worker.released_original));
+        WorkerMetrics::add(sum.observe_transitions, load(worker.observe_transitions));
+        WorkerMetrics::add(sum.framing_failures, load(worker.framing_failures));
+        WorkerMetrics::add(sum.framing_buffer_ceilings, load(worker.framing_buffer_ceilings));
+        WorkerMetrics::add(sum.audit_backlog, load(worker.audit_backlog));
+        WorkerMetrics::add(sum.audit_dropped, load(worker.audit_dropped));
+        // Idle workers pick a reload up on their next event; report the
+        // newest generation any worker runs.
+        if (load(worker.rules_generation) > rules_generation) rules_generation = load(worker.rules_generation);
+    }
+
+    std::ostringstream out;
+    header(out, "ghostline_active_flows", "gauge", "Flows currently relayed.");
+    out << "ghostline_active_flows " << load(sum.active_flows) << "\n";
+
+    header(out, "ghostline_relayed_bytes_total", "counter", "Bytes written toward the destination peer, sent or spliced.");
+    out << "ghostline_relayed_bytes_total{direction=\"c2s\"} " << load(sum.relayed_bytes[static_cast<std::size_t>(Direction::ClientToServer)]) << "\n"
+        << "ghostline_relayed_bytes_total{direction=\"s2c\"} " << load(sum.relayed_bytes[static_cast<std::size_t>(Direction::ServerToClient)]) << "\n";
+
+    header(out, "ghostline_candidates_total", "counter", "Mutation candidates decided, by validation label.");
+    // Codes that share a label (both no-op outcomes) are one series.
+    for (std::size_t i = 0; i < sum.candidates.size(); ++i) {
+        const std::string label = validation_label(static_cast<ValidationCode>(i));
+        bool seen = false;
+        for (std::size_t j = 0; j < i && !seen; ++j) seen = label == validation_label(static_cast<ValidationCode>(j));
+        if (seen) continue;
+        std::uint64_t count = 0;
+        for (std::size_t j = i; j < sum.candidates.size(); ++j) {
+            if (label == validation_label(static_cast<ValidationCode>(j))) count += load(sum.candidates[j]);
+        }
+        out << "ghostline_candidates_total{validation=\"" << (label.empty() ? "none" : label) << "\"} " << count << "\n";
+    }
+
+    header(out, "ghostline_candidate_releases_total", "counter", "Candidates released, modified or as the original bytes.");
+    out << "ghostline_candidate_releases_total{release=\"modified\"} " << load(sum.released_modified) << "\n"
+        << "ghostline_candidate_releases_total{release=\"original\"} " << load(sum.released_original) << "\n";
+
+    header(out, "ghostline_observe_transitions_total", "counter", "Flows switched to observe-only.");
+    out << "ghostline_observe_transitions_total " << load(sum.observe_transitions) << "\n";
+
+    header(out, "ghostline_framing_failures_total", "counter", "Protocol framing given up on, by reason.");
+    out << "ghostline_framing_failures_total{reason=\"framing-failed\"} " << load(sum.framing_failures) << "\n"
+        << "ghostline_framing_failures_total{reason=\"buffer-ceiling\"} " << load(sum.framing_buffer_ceilings) << "\n";
+
+    if (memory_ != nullptr) {
+        header(out, "ghostline_queued_bytes", "gauge", "Bytes held in user space, by queue.");
+        for (std::size_t i = 0; i < sizeof(kQueueCategories) / sizeof(kQueueCategories[0]); ++i) {
+            out << "ghostline_queued_bytes{queue=\"" << memory_category_name(kQueueCategories[i]) << "\"} " << memory_->total(kQueueCategories[i]) << "\n";
+        }
+        header(out, "ghostline_memory_budget_bytes", "gauge", "Configured memory budget; 0 is unlimited.");
+        out << "ghostline_memory_budget_bytes " << memory_->budget() << "\n";
+    }
+
+    header(out, "ghostline_audit_queue_records", "gauge", "Audit records queued for the writer threads.");
+    out << "ghostline_audit_queue_records " << load(sum.audit_backlog) << "\n";
+    header(out, "ghostline_audit_dropped_total", "counter", "Audit lines dropped by a full queue.");
+    out << "ghostline_audit_dropped_total " << load(sum.audit_dropped) << "\n";
+
+    header(out, "ghostline_rules_generation", "gauge", "Generation of the mutation rules in use.");
+    out << "ghostline_rules_generation " << rules_generation << "\n";
+    return out.str();
+}
+
+MetricsServer::MetricsServer(const RelayMetrics& metrics) : metrics_(metrics) {}
+
+MetricsServer::~MetricsServer() {
+    stop();
+}
+
+bool MetricsServer::start(const std::string& endpoint, std::string& error) {
+    if (thread_.joinable()) return true;
+    if (endpoint.compare(0, 5, "unix:") == 0) {
+        unix_path_ = endpoint.substr(5);
+        listen_fd_ = listen_unix(unix_path_, error);
+        if (listen_fd_ < 0) unix_path_.clear();
+    } else {
+        const std::size_t split = endpoint.rfind(':');
+        if (split == std::string::npos) {
+            error = "metrics endpoint must be host:port or unix:<path>: " + endpoint;
+            return false;
+        }
+        std::string host = endpoint.substr(0, split);
+        // [::1]:9464
+        if (host.size() >= 2 && host.front() == '[' && host.back() == ']') host = host.substr(1, host.size() - 2);
+        listen_fd_ = listen_tcp(host, endpoint.substr(split + 1), error);
+        if (listen_fd_ >= 0) {
+            sockaddr_storage bound;
+            socklen_t bound_len = sizeof(bound);
+            if (::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&bound), &bound_len) == 0) {
+                if (bound.ss_family == AF_INET) port_ = ntohs(reinterpret_cast<sockaddr_in*>(&bound)->sin_port);
+                if (bound.ss_family == AF_INET6) port_ = ntohs(reinterpret_cast<sockaddr_in6*>(&bound)->sin6_port);
+            }
+        }
+    }
+    if (listen_fd_ < 0) return false;
+
+    if (::pipe(stop_pipe_) != 0) {
+        error = std::string("cannot create stop pipe: ") + std::strerror(errno);
+        stop();
+        return false;
+    }
+    ::fcntl(stop_pipe_[0], F_SETFD, FD_CLOEXEC);
+    ::fcntl(stop_pipe_[1], F_SETFD, FD_CLOEXEC);
+    thread_ = std::thread([this]() { run(); });
+    return true;
+}
+
+void MetricsServer::stop() {
+    if (thread_.joinable()) {
+        const char byte = 1;
+        if (::write(stop_pipe_[1], &byte, 1) < 0) {
+            // A full pipe already holds a stop byte.
+        }
+        thread_.join();
+    }
+    for (int i = 0; i < 2; ++i) {
+        if (stop_pipe_[i] >= 0) ::close(stop_pipe_[i]);
+        stop_pipe_[i] = -1;
+    }
+    if (listen_fd_ >= 0) ::close(listen_fd_);
+    listen_fd_ = -1;
+    if (!unix_path_.empty()) ::unlink(unix_path_.c_str());
+    unix_path_.clear();
+}
+
+void MetricsServer::run() {
+    while (true) {
+        pollfd fds[2];
+        fds[0].fd = stop_pipe_[0];
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+        fds[1].fd = listen_fd_;
+        fds[1].events = POLLIN;
+        fds[1].revents = 0;
+        const int ready = ::poll(fds, 2, -1);
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready < 0 || fds[0].revents != 0) return;
+        if (fds[1].revents == 0) continue;
+
+        const int client_fd = ::accept(listen_fd_, nullptr, nullptr);
+        if (client_fd < 0) continue;
+        ::fcntl(client_fd, F_SETFD, FD_CLOEXEC);
+        configure_send_socket(client_fd, false);
+        serve(client_fd);
+        ::close(client_fd);
+    }
+}
+
+void MetricsServer::serve(int client_fd) {
+    timeval timeout;
+    timeout.tv_sec = kClientTimeoutMs / 1000;
+    timeout.tv_usec = (kClientTimeoutMs % 1000) * 1000;
+    ::setsockopt(client_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    ::setsockopt(client_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.find("\n\n") == std::string::npos && request.size() < kMaxRequestBytes) {
+        const ssize_t n = ::recv(client_fd, buffer, sizeof(buffer), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        request.append(buffer, static_cast<std::size_t>(n));
+    }
+
+    // "GET /metrics HTTP/1.1"; a query string is ignored.
+    const std::size_t method_end = request.find(' ');
+    const std::size_t path_end = method_end == std::string::npos ? std::string::npos : request.find_first_of(" ?\r\n", method_end + 1);
+    const std::string method = request.substr(0, method_end);
+    const std::string path = path_end == std::string::npos ? std::string() : request.substr(method_end + 1, path_end - method_end - 1);
+
+    std::string status = "200 OK";
+    std::string content_type = "text/plain; version=0.0.4; charset=utf-8";
+    std::string body;
+    if (method != "GET" && method != "HEAD") {
+        status = "405 Method Not Allowed";
+        content_type = "text/plain; charset=utf-8";
+        body = "only GET is supported\n";
+    } else if (path != "/metrics" && path != "/") {
+        status = "404 Not Found";
+        content_type = "text/plain; charset=utf-8";
+        body = "metrics are served at /metrics\n";
+    } else {
+        body = metrics_.render();
+    }
+
+    std::string response = "HTTP/1.0 " + status + "\r\n"
+        + "Content-Type: " + content_type + "\r\n"
+        + "Content-Length: " + std::to_string(body.size()) + "\r\n"
+        + "Connection: close\r\n\r\n";
+    if (method != "HEAD") response += body;
+    write_all(client_fd, response);
+}
@@ -0,0 +1,333 @@
+#include "ghostline/review_journal.hpp"
+#include "ghostline/operator_state.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <functional>
+#include <stdexcept>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace {
+
+constexpr const char* kJournalName = "review_journal.jsonl";
+constexpr std::size_t kReadChunkBytes = 256 * 1024;
+// Compaction is a full rewrite, so wait until it reclaims a useful amount.
+constexpr std::size_t kCompactMinSuperseded = 1024;
+
+std::string errno_text() {
+    return std::strerror(errno);
+}
+
+// flock() held for one call; released before the fd it names is closed.
+class JournalLock {
+public:
+    JournalLock(int fd, int operation) : fd_(fd) {
+        while (::flock(fd_, operation) != 0) {
+            if (errno != EINTR) throw std::runtime_error("failed to lock review journal: " + errno_text());
+        }
+    }
+    ~JournalLock() { release(); }
+
+    JournalLock(const JournalLock&) = delete;
+    JournalLock& operator=(const JournalLock&) = delete;
+
+    void release() {
+        if (fd_ >= 0) ::flock(fd_, LOCK_UN);
+        fd_ = -1;
+    }
+
+private:
+    int fd_;
+};
+
+void write_all(int fd, const std::string& data, const std::string& path) {
+    std::size_t written = 0;
+    while (written < data.size()) {
+        const ssize_t n = ::write(fd, data.data() + written, data.size() - written);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) throw std::runtime_error("failed to write " + path + ": " + errno_text());
+        written += static_cast<std::size_t>(n);
+    }
+}
+
+std::string read_at(int fd, std::uint64_t offset, std::size_t length, const std::string& path) {
+    std::string data(length, '\0');
+    std::size_t done = 0;
+    while (done < length) {
+        const ssize_t n = ::pread(fd, &data[done], length - done, static_cast<off_t>(offset + done));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) throw std::runtime_error("failed to read " + path + ": " + (n == 0 ? std::string("short read") : errno_text()));
+        done += static_cast<std::size_t>(n);
+    }
+    return data;
+}
+
+} // namespace
+
+std::shared_ptr<ReviewJournal> ReviewJournal::for_dir(const std::string& queue_dir) {
+    static std::mutex registry_mutex;
+    static std::map<std::string, std::weak_ptr<ReviewJournal>> registry;
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    std::shared_ptr<ReviewJournal> journal = registry[queue_dir].lock();
+    if (!journal) {
+        journal = std::make_shared<ReviewJournal>(queue_dir);
+        registry[queue_dir] = journal;
+    }
+    return journal;
+}
+
+ReviewJournal::ReviewJournal(const std::string& queue_dir)
+    : dir_(queue_dir), path_((std::filesystem::path(queue_dir) / kJournalName).string()) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    std::filesystem::create_directories(dir_);
+    open_locked();
+    with_journal_lock(LOCK_EX, [this]() { import_legacy_locked(); });
+}
+
+ReviewJournal::~ReviewJournal() {
+    if (fd_ >= 0) ::close(fd_);
+}
+
+void ReviewJournal::open_locked() {
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd_ < 0) throw std::runtime_error("failed to open " + path_ + ": " + errno_text());
+    struct stat info {};
+    if (::fstat(fd_, &info) != 0) throw std::runtime_error("failed to stat " + path_ + ": " + errno_text());
+    inode_ = static_cast<std::uint64_t>(info.st_ino);
+    indexed_bytes_ = 0;
+    superseded_ = 0;
+    entries_.clear();
+    by_status_.clear();
+    by_plugin_.clear();
+    index_from(0);
+}
+
+void ReviewJournal::with_journal_lock(int operation, const std::function<void()>& fn) {
+    for (;;) {
+        JournalLock lock(fd_, operation);
+        struct stat info {};
+        if (::stat(path_.c_str(), &info) != 0 || static_cast<std::uint64_t>(info.st_ino) != inode_) {
+            // Compacted (or removed) by another process since we opened it.
+            lock.release();
+            open_locked();
+            continue;
+        }
+        if (static_cast<std::uint64_t>(info.st_size) > indexed_bytes_) index_from(indexed_bytes_);
+
+        reopen_ = false;
+        fn();
+        if (reopen_) {
+            lock.release();
+            open_locked();
+        }
+        return;
+    }
+}
+
+void ReviewJournal::index_from(std::uint64_t offset) {
+    std::string carry;
+    std::uint64_t line_start = offset;
+    std::uint64_t position = offset;
+    std::vector<char> buffer(kReadChunkBytes);
+    while (true) {
+        const ssize_t n = ::pread(fd_, buffer.data(), buffer.size(), static_cast<off_t>(position));
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) throw std::runtime_error("failed to read " + path_ + ": " + errno_text());
+        if (n == 0) break;
+        std::size_t begin = 0;
+        for (std::size_t i = 0; i < static_cast<std::size_t>(n); ++i) {
+            if (buffer[i] != '\n') continue;
+            carry.append(buffer.data() + begin, i - begin);
+            index_line(carry, line_start);
+            carry.clear();
+            begin = i + 1;
+            line_start = position + begin;
+        }
+        carry.append(buffer.data() + begin, static_cast<std::size_t>(n) - begin);
+        position += static_cast<std::uint64_t>(n);
+    }
+    // A trailing line without its newline is an append still in flight or
+    // cut short by a crash; it is picked up, or skipped, next time.
+    indexed_bytes_ = line_start;
+}
+
+void ReviewJournal::index_line(const std::string& line, std::uint64_t offset) {
+    if (line.empty() || line[0] != '{') return;
+    const ActionItem item = parse_action_item_json(line);
+    if (item.action_id.empty()) return;
+
+    if (entries_.count(item.action_id) != 0) {
+        unindex(item.action_id);
+        ++superseded_;
+    }
+    Entry& entry = entries_[item.action_id];
+    entry.offset = offset;
+    entry.length = static_cast<std::uint32_t>(line.size());
+    entry.status = item.review_status;
+    entry.plugin = item.plugin_name;
+    by_status_[entry.status].insert(item.action_id);
+    by_plugin_[entry.plugin].insert(item.action_id);
+}
+
+void ReviewJournal::unindex(const std::string& action_id) {
+    const auto found = entries_.find(action_id);
+    if (found == entries_.end()) return;
+    const auto status = by_status_.find(found->second.status);
+    if (status != by_status_.end()) {
+        status->second.erase(action_id);
+        if (status->second.empty()) by_status_.erase(status);
+    }
+    const auto plugin = by_plugin_.find(found->second.plugin);
+    if (plugin != by_plugin_.end()) {
+        plugin->second.erase(action_id);
+        if (plugin->second.empty()) by_plugin_.erase(plugin);
+    }
+    entries_.erase(found);
+}
+
+// Call under an exclusive journal lock.
+void ReviewJournal::append_locked(const ActionItem& item) {
+    struct stat info {};
+    if (::fstat(fd_, &info) != 0) throw std::runtime_error("failed to stat " + path_ + ": " + errno_text());
+    const std::uint64_t size = static_cast<std::uint64_t>(info.st_size);
+    // Close off a torn line so this record starts on its own.
+    const std::string prefix = size > indexed_bytes_ ? "\n" : "";
+    const std::string line = action_item_to_json(item);
+    write_all(fd_, prefix + line, path_);
+
+    const std::uint64_t offset = size + prefix.size();
+    index_line(line.substr(0, line.size() - 1), offset);
+    indexed_bytes_ = offset + line.size();
+}
+
+void ReviewJournal::put(const ActionItem& item) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    with_journal_lock(LOCK_EX, [&]() {
+        append_locked(item);
+        if (superseded_ >= kCompactMinSuperseded && superseded_ > entries_.size()) compact_locked();
+    });
+}
+
+bool ReviewJournal::get(const std::string& action_id, ActionItem& item) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    bool found = false;
+    with_journal_lock(LOCK_SH, [&]() {
+        const auto entry = entries_.find(action_id);
+        if (entry == entries_.end()) return;
+        item = read_entry(entry->second);
+        found = true;
+    });
+    return found;
+}
+
+ReviewPage ReviewJournal::page(const ReviewFilter& filter, std::size_t offset, std::size_t limit) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    ReviewPage page;
+    with_journal_lock(LOCK_SH, [&]() {
+        // Walk the smallest matching index; ids come out sorted either way.
+        const std::set<std::string> none;
+        const std::set<std::string>* candidates = nullptr;
+        if (!filter.status.empty()) {
+            const auto found = by_status_.find(filter.status);
+            candidates = found == by_status_.end() ? &none : &found->second;
+        }
+        if (!filter.plugin.empty()) {
+            const auto found = by_plugin_.find(filter.plugin);
+            const std::set<std::string>* plugin = found == by_plugin_.end() ? &none : &found->second;
+            if (candidates == nullptr || plugin->size() < candidates->size()) candidates = plugin;
+        }
+
+        auto take = [&](const Entry& entry) {
+            if (!filter.status.empty() && entry.status != filter.status) return;
+            if (!filter.plugin.empty() && entry.plugin != filter.plugin) return;
+            const std::size_t position = page.total++;
+            if (position >= offset && (limit == 0 || position - offset < limit)) {
+                page.items.push_back(read_entry(entry));
+            }
+        };
+        if (candidates == nullptr) {
+            for (const auto& entry : entries_) take(entry.second);
+        } else {
+            for (const auto& action_id : *candidates) take(entries_.at(action_id));
+        }
+    });
+    return page;
+}
+
+void ReviewJournal::compact() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    with_journal_lock(LOCK_EX, [this]() { compact_locked(); });
+}
+
+// Call under an exclusive journal lock. The rewritten journal is reopened
+// once the lock on the old one is released.
+void ReviewJournal::compact_locked() {
+    const std::string temp = path_ + ".compact";
+    const int out = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (out < 0) throw std::runtime_error("failed to open " + temp + ": " + errno_text());
+    try {
+        std::string chunk;
+        for (const auto& entry : entries_) {
+            chunk += read_at(fd_, entry.second.offset, entry.second.length, path_);
+            chunk.push_back('\n');
+            if (chunk.size() >= kReadChunkBytes) {
+                write_all(out, chunk, temp);
+                chunk.clear();
+            }
+        }
+        write_all(out, chunk, temp);
+        if (::fsync(out) != 0) throw std::runtime_error("failed to sync " + temp + ": " + errno_text());
+    } catch (...) {
+        ::close(out);
+        ::unlink(temp.c_str());
+        throw;
+    }
+    ::close(out);
+    if (::rename(temp.c_str(), path_.c_str()) != 0) {
+        const std::string error = errno_text();
+        ::unlink(temp.c_str());
+        throw std::runtime_error("failed to replace " + path_ + ": " + error);
+    }
+    reopen_ = true;
+}
+
+void ReviewJournal::import_legacy_locked() {
+    namespace fs = std::filesystem;
+    std::vector<std::string> imported;
+    for (const auto& path : list_target_profiles(dir_)) {
+        if (fs::path(path).extension() != ".json") continue;
+        const ActionItem item = load_review_item(path);
+        if (item.action_id.empty()) continue;
+        if (entries_.count(item.action_id) == 0) append_locked(item);
+        imported.push_back(path);
+    }
+    if (imported.empty()) return;
+    if (::fsync(fd_) != 0) throw std::runtime_error("failed to sync " + path_ + ": " + errno_text());
+    for (std::size_t i = 0; i < imported.size(); ++i) {
+        std::error_code error;
+        fs::remove(imported[i], error);
+    }
+    std::fprintf(stderr, "review queue: imported %zu per-item files into %s\n", imported.size(), path_.c_str());
+}
+
+ActionItem ReviewJournal::read_entry(const Entry& entry) const {
+    return parse_action_item_json(read_at(fd_, entry.offset, entry.length, path_));
+}
+
+std::size_t ReviewJournal::live_items() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return entries_.size();
+}
+
+std::size_t ReviewJournal::superseded_lines() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return superseded_;
+}
@@ -0,0 +1,548 @@
+#include "ghostline/rules_loader.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+// Rule keys that map straight onto one valued flag, in emitted order.
+const std::pair<const char*, const char*> kValueFlags[] = {
+    {"start_marker_hex", "--start-hex"},
+    {"end_marker_hex", "--end-hex"},
+    {"replace_text", "--replace-text"},
+    {"raw_find_text", "--raw-find-text"},
+    {"raw_chunk_bytes", "--raw-chunk-bytes"},
+    {"raw_flush_ms", "--raw-flush-ms"},
+    {"mutate_direction", "--mutate-direction"},
+    {"raw_review_threshold", "--raw-review-threshold"},
+    {"raw_review_threshold_bytes", "--raw-review-threshold"},
+    {"mqtt_review_threshold", "--mqtt-review-threshold"},
+    {"mqtt_review_threshold_bytes", "--mqtt-review-threshold"},
+    {"byte_review_threshold", "--byte-review-threshold"},
+    {"byte_window_review_threshold_bytes", "--byte-review-threshold"},
+    {"max_plugin_buffer", "--max-plugin-buffer"},
+    {"max_plugin_buffer_bytes", "--max-plugin-buffer"},
+    {"flow_high_water_bytes", "--flow-high-water"},
+    {"flow_low_water_bytes", "--flow-low-water"},
+    {"global_high_water_bytes", "--global-high-water"},
+    {"global_low_water_bytes", "--global-low-water"},
+    {"memory_budget_bytes", "--memory-budget"},
+    {"protocol_hint", "--protocol-hint"},
+    {"event_backend", "--event-backend"},
+    {"workers", "--workers"},
+    {"zerocopy_min_bytes", "--zerocopy-min-bytes"},
+    {"audit_log_path", "--audit-log"},
+    {"action_log_path", "--action-log"},
+    {"audit_json_path", "--audit-json"},
+    {"audit_binary_path", "--audit-binary"},
+    {"action_json_path", "--actions-json"},
+    {"audit_queue_size", "--audit-queue-size"},
+    {"audit_batch_bytes", "--audit-batch-bytes"},
+    {"audit_flush_ms", "--audit-flush-ms"},
+    {"audit_full_policy", "--audit-full-policy"},
+    {"audit_rotate_bytes", "--audit-rotate-bytes"},
+    {"audit_rotate_age_s", "--audit-rotate-age"},
+    {"audit_keep_segments", "--audit-keep"},
+    {"audit_compress", "--audit-compress"},
+    {"pid_index_ms", "--pid-index-ms"},
+    {"metrics_listen", "--metrics-listen"},
+};
+
+std::string read_rules_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("failed to open rules file " + path);
+    std::ostringstream buffer;
+    buffer << in.rdbuf();
+    return buffer.str();
+}
+
+std::string trim(const std::string& text) {
+    std::size_t begin = 0;
+    std::size_t end = text.size();
+    while (begin < end && std::isspace(static_cast<unsigned char>(text[begin]))) ++begin;
+    while (end > begin && std::isspace(static_cast<unsigned char>(text[end - 1]))) --end;
+    return text.substr(begin, end - begin);
+}
+
+bool is_name_char(char ch) {
+    return std::isalnum(static_cast<unsigned char>(ch)) || ch == '_' || ch == '.' || ch == '-';
+}
+
+void append_utf8(std::string& out, std::uint32_t code) {
+    if (code < 0x80) {
+        out.push_back(static_cast<char>(code));
+    } else if (code < 0x800) {
+        out.push_back(static_cast<char>(0xc0 | (code >> 6)));
+        out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+    } else if (code < 0x10000) {
+        out.push_back(static_cast<char>(0xe0 | (code >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+        out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+    } else {
+        out.push_back(static_cast<char>(0xf0 | (code >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3f)));
+        out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+        out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+    }
+}
+
+void set_member(RuleValue& object, const std::string& key, RuleValue&& value) {
+    for (std::size_t i = 0; i < object.members.size(); ++i) {
+        if (object.members[i].first == key) {
+            object.members[i].second = std::move(value);
+            return;
+        }
+    }
+    object.members.emplace_back(key, std::move(value));
+}
+
+class JsonParser {
+public:
+    explicit JsonParser(const std::string& text) : text_(text) {}
+
+    RuleValue parse_document() {
+        RuleValue value = parse_value();
+        skip_space();
+        if (pos_ != text_.size()) fail("unexpected trailing data");
+        return value;
+    }
+
+private:
+    [[noreturn]] void fail(const std::string& message) const {
+        throw std::runtime_error("invalid rules JSON at offset " + std::to_string(pos_) + ": " + message);
+    }
+
+    void skip_space() {
+        while (pos_ < text_.size() && (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\n' || text_[pos_] == '\r')) ++pos_;
+    }
+
+    bool consume(const char* literal) {
+        const std::size_t length = std::char_traits<char>::length(literal);
+        if (text_.compare(pos_, length, literal) != 0) return false;
+        pos_ += length;
+        return true;
+    }
+
+    RuleValue parse_value() {
+        skip_space();
+        if (pos_ >= text_.size()) fail("unexpected end of input");
+        RuleValue value;
+        const char ch = text_[pos_];
+        if (ch == '{') {
+            parse_object(value);
+        } else if (ch == '[') {
+            parse_array(value);
+        } else if (ch == '"') {
+            value.kind = RuleValue::Kind::String;
+            value.text = parse_string();
+        } else if (ch == '-' || (ch >= '0' && ch <= '9')) {
+            value.kind = RuleValue::Kind::Number;
+            value.text = parse_number();
+        } else if (consume("true")) {
+            value.kind = RuleValue::Kind::Bool;
+            value.boolean = true;
+        } else if (consume("false")) {
+            value.kind = RuleValue::Kind::Bool;
+        } else if (!consume("null")) {
+            fail("unexpected character");
+        }
+        return value;
+    }
+
+    void parse_object(RuleValue& value) {
+        value.kind = RuleValue::Kind::Object;
+        ++pos_;
+        skip_space();
+        if (pos_ < text_.size() && text_[pos_] == '}') {
+            ++pos_;
+            return;
+        }
+        while (true) {
+            skip_space();
+            if (pos_ >= text_.size() || text_[pos_] != '"') fail("expected a member name");
+            const std::string key = parse_string();
+            skip_space();
+            if (pos_ >= text_.size() || text_[pos_] != ':') fail("expected ':'");
+            ++pos_;
+            set_member(value, key, parse_value());
+            skip_space();
+            if (pos_ < text_.size() && text_[pos_] == ',') {
+                ++pos_;
+                continue;
+            }
+            if (pos_ < text_.size() && text_[pos_] == '}') {
+                ++pos_;
+                return;
+            }
+            fail("expected ',' or '}'");
+        }
+    }
+
+    void parse_array(RuleValue& value) {
+        value.kind = RuleValue::Kind::Array;
+        ++pos_;
+        skip_space();
+        if (pos_ < text_.size() && text_[pos_] == ']') {
+            ++pos_;
+            return;
+        }
+        while (true) {
+            value.items.push_back(parse_value());
+            skip_space();
+            if (pos_ < text_.size() && text_[pos_] == ',') {
+                ++pos_;
+                continue;
+            }
+            if (pos_ < text_.size() && text_[pos_] == ']') {
+                ++pos_;
+                return;
+            }
+            fail("expected ',' or ']'");
+        }
+    }
+
+    std::uint32_t parse_hex4() {
+        if (pos_ + 4 > text_.size()) fail("truncated \\u escape");
+        std::uint32_t code = 0;
+        for (std::size_t i = 0; i < 4; ++i) {
+            const char ch = text_[pos_++];
+            code <<= 4;
+            if (ch >= '0' && ch <= '9') code |= static_cast<std::uint32_t>(ch - '0');
+            else if (ch >= 'a' && ch <= 'f') code |= static_cast<std::uint32_t>(ch - 'a' + 10);
+            else if (ch >= 'A' && ch <= 'F') code |= static_cast<std::uint32_t>(ch - 'A' + 10);
+            else fail("invalid \\u escape");
+        }
+        return code;
+    }
+
+    std::string parse_string() {
+        ++pos_;
+        std::string out;
+        while (true) {
+            if (pos_ >= text_.size()) fail("unterminated string");
+            const char ch = text_[pos_++];
+            if (ch == '"') return out;
+            if (static_cast<unsigned char>(ch) < 0x20) fail("control character in string");
+            if (ch != '\\') {
+                out.push_back(ch);
+                continue;
+            }
+            if (pos_ >= text_.size()) fail("unterminated string");
+            const char escape = text_[pos_++];
+            switch (escape) {
+                case '"': out.push_back('"'); break;
+                case '\\': out.push_back('\\'); break;
+                case '/': out.push_back('/'); break;
+                case 'b': out.push_back('\b'); break;
+                case 'f': out.push_back('\f'); break;
+                case 'n': out.push_back('\n'); break;
+                case 'r': out.push_back('\r'); break;
+                case 't': out.push_back('\t'); break;
+                case 'u': {
+                    std::uint32_t code = parse_hex4();
+                    if (code >= 0xd800 && code < 0xdc00 && text_.compare(pos_, 2, "\\u") == 0) {
+                        const std::size_t saved = pos_;
+                        pos_ += 2;
+                        const std::uint32_t low = parse_hex4();
+                        if (low >= 0xdc00 && low < 0xe000) {
+                            code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+                        } else {
+                            pos_ = saved;
+                        }
+                    }
+                    append_utf8(out, code);
+                    break;
+                }
+                default: fail("invalid escape");
+            }
+        }
+    }
+
+    std::string parse_number() {
+        const std::size_t start = pos_;
+        if (text_[pos_] == '-') ++pos_;
+        auto digits = [this]() {
+            const std::size_t begin = pos_;
+            while (pos_ < text_.size() && text_[pos_] >= '0' && text_[pos_] <= '9') ++pos_;
+            return pos_ - begin;
+        };
+        const std::size_t int_start = pos_;
+        const std::size_t int_digits = digits();
+        if (int_digits == 0) fail("invalid number");
+        if (int_digits > 1 && text_[int_start] == '0') fail("leading zero in number");
+        if (pos_ < text_.size() && text_[pos_] == '.') {
+            ++pos_;
+            if (digits() == 0) fail("invalid number");
+        }
+        if (pos_ < text_.size() && (text_[pos_] == 'e' || text_[pos_] == 'E')) {
+            ++pos_;
+            if (pos_ < text_.size() && (text_[pos_] == '+' || text_[pos_] == '-')) ++pos_;
+            if (digits() == 0) fail("invalid number");
+        }
+        return text_.substr(start, pos_ - start);
+    }
+
+    const std::string& text_;
+    std::size_t pos_ = 0;
+};
+
+RuleValue parse_hcl_scalar(std::string value) {
+    value = trim(value);
+    while (!value.empty() && value.back() == ',') value.pop_back();
+    RuleValue parsed;
+    if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+        parsed = parse_rules_json(value);
+        if (parsed.kind != RuleValue::Kind::String) throw std::runtime_error("unsupported HCL/Terraform value: " + value);
+        return parsed;
+    }
+    if (value == "true" || value == "false") {
+        parsed.kind = RuleValue::Kind::Bool;
+        parsed.boolean = value == "true";
+        return parsed;
+    }
+    const std::size_t digits = value.size() > 0 && value[0] == '-' ? 1 : 0;
+    if (value.size() > digits && std::all_of(value.begin() + static_cast<std::ptrdiff_t>(digits), value.end(), [](char ch) { return ch >= '0' && ch <= '9'; })) {
+        // Written the way the integer reads back: no leading zeros, no "-0".
+        std::size_t first = value.find_first_not_of('0', digits);
+        std::string magnitude = first == std::string::npos ? "0" : value.substr(first);
+        parsed.kind = RuleValue::Kind::Number;
+        parsed.text = digits != 0 && magnitude != "0" ? "-" + magnitude : magnitude;
+        return parsed;
+    }
+    throw std::runtime_error("unsupported HCL/Terraform value: " + value);
+}
+
+std::string lowercase_extension(const std::string& path) {
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
+    return extension;
+}
+
+const RuleValue& list_member(const RuleValue& data, const std::string& key) {
+    static const RuleValue empty_list = []() {
+        RuleValue list;
+        list.kind = RuleValue::Kind::Array;
+        return list;
+    }();
+    const RuleValue* value = data.find(key);
+    if (value == nullptr) return empty_list;
+    if (value->kind != RuleValue::Kind::Array) throw std::runtime_error("rules key " + key + " must be a list");
+    return *value;
+}
+
+std::string required_field(const RuleValue& rule, const std::string& key, const std::string& list) {
+    const RuleValue* value = rule.kind == RuleValue::Kind::Object ? rule.find(key) : nullptr;
+    if (value == nullptr) throw std::runtime_error("each " + list + " entry needs " + key);
+    return value->as_arg();
+}
+
+} // namespace
+
+const RuleValue* RuleValue::find(const std::string& key) const {
+    for (std::size_t i = 0; i < members.size(); ++i) {
+        if (members[i].first == key) return &members[i].second;
+    }
+    return nullptr;
+}
+
+bool RuleValue::truthy() const {
+    switch (kind) {
+        case Kind::Null: return false;
+        case Kind::Bool: return boolean;
+        case Kind::Number: {
+            const std::size_t exponent = text.find_first_of("eE");
+            const std::string mantissa = text.substr(0, exponent);
+            return mantissa.find_first_not_of("-0.") != std::string::npos;
+        }
+        case Kind::String: return !text.empty();
+        case Kind::Array: return !items.empty();
+        case Kind::Object: return !members.empty();
+    }
+    return false;
+}
+
+// Scalars render as the Python resolver this loader replaced printed them,
+// so existing rules files keep producing the same flags.
+std::string RuleValue::as_arg() const {
+    switch (kind) {
+        case Kind::Null: return "None";
+        case Kind::Bool: return boolean ? "True" : "False";
+        case Kind::Number:
+        case Kind::String: return text;
+        case Kind::Array:
+        case Kind::Object: break;
+    }
+    throw std::runtime_error("rules value must be a string, number or boolean");
+}
+
+RuleValue parse_rules_json(const std::string& text) {
+    return JsonParser(text).parse_document();
+}
+
+RuleValue parse_rules_hcl(const std::string& text) {
+    RuleValue data;
+    data.kind = RuleValue::Kind::Object;
+    std::istringstream in(text);
+    std::string raw_line;
+    while (std::getline(in, raw_line)) {
+        if (!raw_line.empty() && raw_line.back() == '\r') raw_line.pop_back();
+        std::string line = trim(raw_line);
+        // Comment markers are cut wherever they appear, even inside quotes.
+        const std::size_t hash = line.find('#');
+        if (hash != std::string::npos) line = trim(line.substr(0, hash));
+        const std::size_t slashes = line.find("//");
+        if (slashes != std::string::npos) line = trim(line.substr(0, slashes));
+        if (line.empty()) continue;
+
+        std::size_t key_end = 0;
+        while (key_end < line.size() && is_name_char(line[key_end])) ++key_end;
+        std::size_t equals = key_end;
+        while (equals < line.size() && std::isspace(static_cast<unsigned char>(line[equals]))) ++equals;
+        if (key_end == 0 || equals >= line.size() || line[equals] != '=' || trim(line.substr(equals + 1)).empty()) {
+            throw std::runtime_error("unsupported HCL/Terraform rule line: " + raw_line);
+        }
+        set_member(data, line.substr(0, key_end), parse_hcl_scalar(line.substr(equals + 1)));
+    }
+    return data;
+}
+
+std::string render_rules_template(const std::string& text, const std::map<std::string, std::string>& variables) {
+    std::string out;
+    out.reserve(text.size());
+    std::size_t pos = 0;
+    while (pos < text.size()) {
+        const std::size_t open = text.find("{{", pos);
+        if (open == std::string::npos) break;
+        out.append(text, pos, open - pos);
+
+        std::size_t cursor = open + 2;
+        while (cursor < text.size() && std::isspace(static_cast<unsigned char>(text[cursor]))) ++cursor;
+        const std::size_t name_start = cursor;
+        while (cursor < text.size() && is_name_char(text[cursor])) ++cursor;
+        const std::size_t name_end = cursor;
+        while (cursor < text.size() && std::isspace(static_cast<unsigned char>(text[cursor]))) ++cursor;
+        if (name_end == name_start || text.compare(cursor, 2, "}}") != 0) {
+            // Not a placeholder; "{{{ name }}" still matches one brace in.
+            out.push_back('{');
+            pos = open + 1;
+            continue;
+        }
+
+        const std::string name = text.substr(name_start, name_end - name_start);
+        const auto found = variables.find(name);
+        if (found == variables.end()) throw std::runtime_error("missing template variable: " + name);
+        out += found->second;
+        pos = cursor + 2;
+    }
+    if (pos < text.size()) out.append(text, pos, std::string::npos);
+    return out;
+}
+
+RuleValue load_rule_data(const std::string& path, const std::vector<std::string>& vars) {
+    std::map<std::string, std::string> variables;
+    for (std::size_t i = 0; i < vars.size(); ++i) {
+        const std::size_t equals = vars[i].find('=');
+        if (equals == std::string::npos) throw std::runtime_error("invalid --rules-var entry: " + vars[i]);
+        variables[vars[i].substr(0, equals)] = vars[i].substr(equals + 1);
+    }
+
+    const std::string extension = lowercase_extension(path);
+    RuleValue data;
+    if (extension == ".j2" || extension == ".jinja" || extension == ".jinja2") {
+        data = parse_rules_json(render_rules_template(read_rules_file(path), variables));
+    } else if (extension == ".json") {
+        data = parse_rules_json(read_rules_file(path));
+    } else if (extension == ".tf" || extension == ".tfvars" || extension == ".hcl") {
+        data = parse_rules_hcl(read_rules_file(path));
+    } else {
+        throw std::runtime_error("unsupported rules format: " + std::filesystem::path(path).filename().string());
+    }
+    if (data.kind != RuleValue::Kind::Object) throw std::runtime_error("rules file must hold an object: " + path);
+    return data;
+}
+
+std::vector<std::string> rules_to_args(const RuleValue& data) {
+    std::vector<std::string> args;
+
+    const char* const positional_keys[] = {"listen_port", "upstream_host", "upstream_port"};
+    std::vector<std::string> positional;
+    for (const char* key : positional_keys) {
+        const RuleValue* value = data.find(key);
+        if (value != nullptr) positional.push_back(value->as_arg());
+    }
+    if (!positional.empty()) {
+        if (positional.size() != 3) throw std::runtime_error("rules must define listen_port, upstream_host, and upstream_port together");
+        args.insert(args.end(), positional.begin(), positional.end());
+    }
+
+    auto truthy = [&data](const char* key, bool default_value) {
+        const RuleValue* value = data.find(key);
+        return value == nullptr ? default_value : value->truthy();
+    };
+    if (truthy("raw_live", false) || truthy("raw_live_mode", false)) args.push_back("--raw-live");
+    if (truthy("raw_stream", false)) args.push_back("--raw-stream");
+    if (truthy("rewrite_u32_prefix", false)) args.push_back("--rewrite-u32-prefix");
+    if (!truthy("splice_passthrough", true)) args.push_back("--no-splice-passthrough");
+    if (truthy("pid_index", false)) args.push_back("--pid-index");
+
+    for (const auto& mapping : kValueFlags) {
+        const RuleValue* value = data.find(mapping.first);
+        if (value == nullptr) continue;
+        args.push_back(mapping.second);
+        args.push_back(value->as_arg());
+    }
+
+    const RuleValue& substitutions = list_member(data, "substitutions");
+    for (std::size_t i = 0; i < substitutions.items.size(); ++i) {
+        const RuleValue& rule = substitutions.items[i];
+        args.push_back("--substitute");
+        if (rule.kind == RuleValue::Kind::String) {
+            args.push_back(rule.text);
+            continue;
+        }
+        const RuleValue* replace = rule.find("replace");
+        args.push_back(required_field(rule, "find", "substitutions") + "=" + (replace == nullptr ? std::string() : replace->as_arg()));
+    }
+
+    const RuleValue& window_rules = list_member(data, "window_rules");
+    for (std::size_t i = 0; i < window_rules.items.size(); ++i) {
+        const RuleValue& rule = window_rules.items[i];
+        args.push_back("--window-rule");
+        if (rule.kind == RuleValue::Kind::String) {
+            args.push_back(rule.text);
+            continue;
+        }
+        std::string spec = required_field(rule, "start_hex", "window_rules") + ":" + required_field(rule, "end_hex", "window_rules");
+        const RuleValue* replacement = rule.find("replace_text");
+        if (replacement != nullptr) spec += ":" + replacement->as_arg();
+        args.push_back(spec);
+    }
+
+    // {"mqtt": "hash", "*": "head:64"}; "*" sets the default for every plugin.
+    const RuleValue* captures = data.find("capture_policies");
+    if (captures != nullptr && captures->kind == RuleValue::Kind::Object) {
+        for (std::size_t i = 0; i < captures->members.size(); ++i) {
+            const std::string& plugin = captures->members[i].first;
+            const std::string policy = captures->members[i].second.as_arg();
+            args.push_back("--capture");
+            args.push_back(plugin == "*" ? policy : plugin + "=" + policy);
+        }
+    } else if (captures != nullptr) {
+        const RuleValue& specs = list_member(data, "capture_policies");
+        for (std::size_t i = 0; i < specs.items.size(); ++i) {
+            args.push_back("--capture");
+            args.push_back(specs.items[i].as_arg());
+        }
+    }
+
+    return args;
+}
+
+std::vector<std::string> resolve_rules_args(const std::string& path, const std::vector<std::string>& vars) {
+    return rules_to_args(load_rule_data(path, vars));
+}
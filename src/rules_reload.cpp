@@ -0,0 +1,184 @@
+#include "ghostline/rules_reload.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <exception>
+#include <fcntl.h>
+#include <filesystem>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#endif
+
+namespace {
+
+// File checks when there is no inotify watch.
+constexpr int kPollIntervalMs = 1000;
+// Quiet time after a directory event before the file is looked at, so a
+// save that truncates, writes and renames reloads once.
+constexpr int kSettleMs = 100;
+
+std::string file_stamp(const std::string& path) {
+    struct stat info {};
+    if (path.empty() || ::stat(path.c_str(), &info) != 0) return std::string();
+#if defined(__APPLE__)
+    const long long mtime_ns = static_cast<long long>(info.st_mtimespec.tv_nsec);
+#elif defined(__linux__)
+    const long long mtime_ns = static_cast<long long>(info.st_mtim.tv_nsec);
+#else
+    const long long mtime_ns = 0;
+#endif
+    return std::to_string(static_cast<unsigned long long>(info.st_ino)) + ":"
+        + std::to_string(static_cast<long long>(info.st_size)) + ":"
+        + std::to_string(static_cast<long long>(info.st_mtime)) + "."
+        + std::to_string(mtime_ns);
+}
+
+void drain(int fd) {
+    char buffer[4096];
+    while (::read(fd, buffer, sizeof(buffer)) == static_cast<ssize_t>(sizeof(buffer))) {
+    }
+}
+
+} // namespace
+
+PluginRegistryCell::PluginRegistryCell(std::shared_ptr<const PluginRegistry> registry) : registry_(std::move(registry)) {}
+
+std::shared_ptr<const PluginRegistry> PluginRegistryCell::load(std::uint64_t& generation) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    generation = generation_.load(std::memory_order_relaxed);
+    return registry_;
+}
+
+std::uint64_t PluginRegistryCell::publish(std::shared_ptr<const PluginRegistry> registry) {
+    std::shared_ptr<const PluginRegistry> previous;
+    std::uint64_t generation = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        previous = std::move(registry_);
+        registry_ = std::move(registry);
+        generation = generation_.fetch_add(1, std::memory_order_release) + 1;
+    }
+    // `previous` may be the last reference; free it outside the lock.
+    return generation;
+}
+
+RulesWatcher::RulesWatcher(PluginRegistryCell& cell, Rebuild rebuild) : cell_(cell), rebuild_(std::move(rebuild)) {}
+
+RulesWatcher::~RulesWatcher() {
+    stop();
+}
+
+bool RulesWatcher::start(const std::string& rules_path, int trigger_fd) {
+    if (thread_.joinable()) return true;
+    if (::pipe(stop_pipe_) != 0) return false;
+    ::fcntl(stop_pipe_[0], F_SETFD, FD_CLOEXEC);
+    ::fcntl(stop_pipe_[1], F_SETFD, FD_CLOEXEC);
+    rules_path_ = rules_path;
+    trigger_fd_ = trigger_fd;
+    // The running registry was built from the file as it is now.
+    file_stamp_ = file_stamp(rules_path_);
+
+#if defined(__linux__)
+    if (!rules_path_.empty()) {
+        watch_fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        const std::filesystem::path file(rules_path_);
+        const std::string dir = file.has_parent_path() ? file.parent_path().string() : std::string(".");
+        if (watch_fd_ >= 0 && ::inotify_add_watch(watch_fd_, dir.c_str(), IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_MOVED_TO) < 0) {
+            ::close(watch_fd_);
+            watch_fd_ = -1;
+        }
+    }
+#endif
+
+    thread_ = std::thread([this]() { run(); });
+    return true;
+}
+
+void RulesWatcher::stop() {
+    if (thread_.joinable()) {
+        const char byte = 1;
+        if (::write(stop_pipe_[1], &byte, 1) < 0) {
+            // A full pipe already holds a stop byte.
+        }
+        thread_.join();
+    }
+    for (int i = 0; i < 2; ++i) {
+        if (stop_pipe_[i] >= 0) ::close(stop_pipe_[i]);
+        stop_pipe_[i] = -1;
+    }
+    if (watch_fd_ >= 0) ::close(watch_fd_);
+    watch_fd_ = -1;
+}
+
+bool RulesWatcher::reload(std::string& error) {
+    file_stamp_ = file_stamp(rules_path_);
+    try {
+        cell_.publish(rebuild_());
+        return true;
+    } catch (const std::exception& failure) {
+        error = failure.what();
+        return false;
+    }
+}
+
+bool RulesWatcher::file_changed() {
+    const std::string stamp = file_stamp(rules_path_);
+    // Missing for a moment while an editor swaps it in; the rename that
+    // brings it back is another event.
+    return !stamp.empty() && stamp != file_stamp_;
+}
+
+void RulesWatcher::run() {
+    while (true) {
+        pollfd fds[3];
+        nfds_t count = 0;
+        fds[count].fd = stop_pipe_[0];
+        fds[count++].events = POLLIN;
+        const nfds_t trigger_slot = count;
+        if (trigger_fd_ >= 0) {
+            fds[count].fd = trigger_fd_;
+            fds[count++].events = POLLIN;
+        }
+        const nfds_t watch_slot = count;
+        if (watch_fd_ >= 0) {
+            fds[count].fd = watch_fd_;
+            fds[count++].events = POLLIN;
+        }
+        for (nfds_t i = 0; i < count; ++i) fds[i].revents = 0;
+
+        const int timeout = !rules_path_.empty() && watch_fd_ < 0 ? kPollIntervalMs : -1;
+        const int ready = ::poll(fds, count, timeout);
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready < 0 || fds[0].revents != 0) return;
+
+        bool requested = false;
+        if (trigger_fd_ >= 0 && fds[trigger_slot].revents != 0) {
+            drain(trigger_fd_);
+            requested = true;
+        }
+        if (watch_fd_ >= 0 && fds[watch_slot].revents != 0) {
+            pollfd quiet;
+            quiet.fd = stop_pipe_[0];
+            quiet.events = POLLIN;
+            quiet.revents = 0;
+            if (::poll(&quiet, 1, kSettleMs) > 0) return;
+            drain(watch_fd_);
+        }
+        if (!requested && !file_changed()) continue;
+
+        std::string error;
+        if (reload(error)) {
+            std::fprintf(stderr, "rules reloaded%s%s (generation %llu)\n",
+                         rules_path_.empty() ? "" : " from ",
+                         rules_path_.c_str(),
+                         static_cast<unsigned long long>(cell_.generation()));
+        } else {
+            std::fprintf(stderr, "rules reload failed, keeping the current rules: %s\n", error.c_str());
+        }
+    }
+}
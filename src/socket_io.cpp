@@ -0,0 +1,364 @@
+#include "net/socket_io.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <thread>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/errqueue.h>
+#endif
+
+#if defined(__linux__) && defined(MSG_ZEROCOPY) && defined(SO_ZEROCOPY) && defined(SO_EE_ORIGIN_ZEROCOPY)
+#define GHOSTLINE_HAVE_ZEROCOPY 1
+#endif
+
+namespace {
+
+#if defined(IOV_MAX)
+constexpr std::size_t kMaxIov = IOV_MAX;
+#else
+constexpr std::size_t kMaxIov = 1024;
+#endif
+
+bool zerocopy_eligible(const ZeroCopyState& zerocopy, std::size_t zerocopy_min_bytes, std::size_t chunk_size) {
+    // Chunks at or below the coalescing limit may still grow in place, which
+    // would move storage the kernel is reading from.
+    return zerocopy.enabled && zerocopy_min_bytes != 0 && chunk_size >= zerocopy_min_bytes
+        && chunk_size > ChunkQueue::kCoalesceBytes;
+}
+
+std::uint64_t steady_ms() {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Closes with an RST so the kernel drops queued segments, and with them its
+// references to zero-copy pages.
+void reset_close(int fd) {
+    linger abort;
+    abort.l_onoff = 1;
+    abort.l_linger = 0;
+    ::setsockopt(fd, SOL_SOCKET, SO_LINGER, &abort, sizeof(abort));
+    ::close(fd);
+}
+
+// Sequence numbers wrap; compare them the way the kernel hands them out.
+bool sequence_done(std::uint32_t sequence, std::uint32_t completed) {
+    return static_cast<std::int32_t>(sequence - completed) <= 0;
+}
+
+} // namespace
+
+void IoCounters::add(const IoCounters& other) {
+    send_calls += other.send_calls;
+    sent_bytes += other.sent_bytes;
+    would_block += other.would_block;
+    zerocopy_sends += other.zerocopy_sends;
+    zerocopy_completions += other.zerocopy_completions;
+    zerocopy_copied += other.zerocopy_copied;
+    splice_calls += other.splice_calls;
+    spliced_bytes += other.spliced_bytes;
+}
+
+std::string IoCounters::summary() const {
+    std::ostringstream out;
+    out << "send_calls=" << send_calls
+        << " bytes=" << sent_bytes
+        << " bytes_per_call=" << (send_calls == 0 ? 0 : sent_bytes / send_calls)
+        << " would_block=" << would_block
+        << " zerocopy_sends=" << zerocopy_sends
+        << " zerocopy_completions=" << zerocopy_completions
+        << " zerocopy_copied=" << zerocopy_copied
+        << " splice_calls=" << splice_calls
+        << " spliced_bytes=" << spliced_bytes;
+    return out.str();
+}
+
+bool zerocopy_supported() {
+#if defined(GHOSTLINE_HAVE_ZEROCOPY)
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool configure_send_socket(int fd, bool want_zerocopy) {
+    const int yes = 1;
+#if defined(SO_NOSIGPIPE)
+    ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &yes, sizeof(yes));
+#endif
+#if defined(GHOSTLINE_HAVE_ZEROCOPY)
+    if (want_zerocopy) {
+        return ::setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &yes, sizeof(yes)) == 0;
+    }
+#else
+    (void)fd;
+    (void)want_zerocopy;
+    (void)yes;
+#endif
+    return false;
+}
+
+FlushStatus flush_chunks(int fd, ChunkQueue& queue, std::size_t zerocopy_min_bytes, ZeroCopyState& zerocopy, IoCounters& counters) {
+    iovec iov[kMaxIov];
+
+    while (!queue.empty()) {
+        const bool front_zerocopy = zerocopy_eligible(zerocopy, zerocopy_min_bytes, queue.front_chunk_size());
+
+        // Gather as many queued chunks as fit in one call. A zero-copy chunk
+        // always goes out on its own so its completion maps to one buffer.
+        std::size_t count = 0;
+        std::size_t requested = 0;
+        const std::size_t limit = front_zerocopy ? 1 : std::min(queue.chunk_count(), kMaxIov);
+        for (std::size_t i = 0; i < limit; ++i) {
+            const ByteView chunk = queue.chunk(i);
+            if (i != 0 && zerocopy_eligible(zerocopy, zerocopy_min_bytes, chunk.size())) break;
+            iov[count].iov_base = const_cast<byte*>(chunk.data());
+            iov[count].iov_len = chunk.size();
+            requested += chunk.size();
+            ++count;
+        }
+
+        msghdr message;
+        std::memset(&message, 0, sizeof(message));
+        message.msg_iov = iov;
+        message.msg_iovlen = count;
+
+        int flags = kSendFlags;
+#if defined(GHOSTLINE_HAVE_ZEROCOPY)
+        if (front_zerocopy) flags |= MSG_ZEROCOPY;
+#endif
+        ssize_t sent = ::sendmsg(fd, &message, flags);
+        ++counters.send_calls;
+#if defined(GHOSTLINE_HAVE_ZEROCOPY)
+        if (sent < 0 && errno == ENOBUFS && front_zerocopy) {
+            // Out of optmem for pinned pages; fall back to a copying send.
+            sent = ::sendmsg(fd, &message, kSendFlags);
+            ++counters.send_calls;
+            flags = kSendFlags;
+        }
+#endif
+
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EWOULDBLOCK || errno == EAGAIN) {
+                ++counters.would_block;
+                return FlushStatus::WouldBlock;
+            }
+            return FlushStatus::Failed;
+        }
+
+        const std::size_t written = static_cast<std::size_t>(sent);
+        counters.sent_bytes += written;
+        if (front_zerocopy) {
+#if defined(GHOSTLINE_HAVE_ZEROCOPY)
+            if ((flags & MSG_ZEROCOPY) != 0) {
+                ++counters.zerocopy_sends;
+                ++zerocopy.next_sequence;
+            }
+#endif
+            std::deque<ByteVec> retired;
+            queue.consume(written, &retired);
+            // Keep the storage until the last zero-copy send that may have
+            // referenced it completes.
+            for (std::size_t i = 0; i < retired.size() && zerocopy.next_sequence != 0; ++i) {
+                ZeroCopyBuffer buffer;
+                buffer.last_sequence = zerocopy.next_sequence - 1;
+                buffer.bytes = std::move(retired[i]);
+                zerocopy.in_flight.push_back(std::move(buffer));
+            }
+        } else {
+            queue.consume(written);
+        }
+
+        // A short write means the socket buffer is full; the next call would
+        // only return EAGAIN.
+        if (written < requested) return FlushStatus::WouldBlock;
+    }
+    return FlushStatus::Drained;
+}
+
+void reap_zerocopy_completions(int fd, ZeroCopyState& zerocopy, IoCounters& counters) {
+#if defined(GHOSTLINE_HAVE_ZEROCOPY)
+    while (true) {
+        char control[128];
+        msghdr message;
+        std::memset(&message, 0, sizeof(message));
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        if (::recvmsg(fd, &message, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        // Notifications carry no payload, only the control message; a read
+        // without one is not from the error queue.
+        if (message.msg_controllen == 0) return;
+
+        for (cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg != nullptr; cmsg = CMSG_NXTHDR(&message, cmsg)) {
+            const bool ip_error = (cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR)
+                || (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR);
+            if (!ip_error) continue;
+
+            sock_extended_err error;
+            std::memcpy(&error, CMSG_DATA(cmsg), sizeof(error));
+            if (error.ee_origin != SO_EE_ORIGIN_ZEROCOPY || error.ee_errno != 0) continue;
+
+            const std::uint32_t first = error.ee_info;
+            const std::uint32_t last = error.ee_data;
+            const std::uint64_t completed = static_cast<std::uint64_t>(last - first) + 1;
+            counters.zerocopy_completions += completed;
+            if ((error.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0) counters.zerocopy_copied += completed;
+
+            while (!zerocopy.in_flight.empty() && sequence_done(zerocopy.in_flight.front().last_sequence, last)) {
+                zerocopy.in_flight.pop_front();
+            }
+        }
+    }
+#else
+    (void)fd;
+    (void)zerocopy;
+    (void)counters;
+#endif
+}
+
+void ZeroCopyGraveyard::bury(int fd, ZeroCopyState& zerocopy, IoCounters& counters) {
+    if (fd < 0) return;
+    if (!zerocopy.in_flight.empty()) reap_zerocopy_completions(fd, zerocopy, counters);
+    if (zerocopy.in_flight.empty()) {
+        ::close(fd);
+        return;
+    }
+    // Stops reads and sends the FIN after whatever is still queued, as
+    // close() would have.
+    ::shutdown(fd, SHUT_RDWR);
+    Grave grave;
+    grave.fd = fd;
+    grave.deadline_ms = steady_ms() + linger_ms_;
+    grave.counters = &counters;
+    grave.zerocopy = std::move(zerocopy);
+    zerocopy.in_flight.clear();
+    graves_.push_back(std::move(grave));
+}
+
+void ZeroCopyGraveyard::reap() {
+    const std::uint64_t now = steady_ms();
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < graves_.size(); ++i) {
+        Grave& grave = graves_[i];
+        reap_zerocopy_completions(grave.fd, grave.zerocopy, *grave.counters);
+        if (grave.zerocopy.in_flight.empty()) {
+            ::close(grave.fd);
+            continue;
+        }
+        if (now >= grave.deadline_ms) {
+            reset_close(grave.fd);
+            continue;
+        }
+        if (kept != i) graves_[kept] = std::move(grave);
+        ++kept;
+    }
+    graves_.resize(kept);
+}
+
+void ZeroCopyGraveyard::close_all(int wait_ms) {
+    for (int waited = 0; !graves_.empty() && waited < wait_ms; waited += 10) {
+        reap();
+        if (!graves_.empty()) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    if (!graves_.empty()) reap();
+    for (std::size_t i = 0; i < graves_.size(); ++i) reset_close(graves_[i].fd);
+    graves_.clear();
+}
+
+bool splice_supported() {
+#if defined(__linux__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool open_splice_pipe(SplicePipe& pipe) {
+#if defined(__linux__)
+    int fds[2];
+    if (::pipe2(fds, O_NONBLOCK | O_CLOEXEC) != 0) return false;
+    pipe.read_fd = fds[0];
+    pipe.write_fd = fds[1];
+    pipe.bytes = 0;
+    const int size = ::fcntl(fds[1], F_GETPIPE_SZ);
+    pipe.capacity = size > 0 ? static_cast<std::size_t>(size) : 64 * 1024;
+    return true;
+#else
+    (void)pipe;
+    return false;
+#endif
+}
+
+void close_splice_pipe(SplicePipe& pipe) {
+    if (pipe.read_fd >= 0) ::close(pipe.read_fd);
+    if (pipe.write_fd >= 0) ::close(pipe.write_fd);
+    pipe = SplicePipe();
+}
+
+SpliceStatus splice_into_pipe(int fd, SplicePipe& pipe, IoCounters& counters) {
+#if defined(__linux__)
+    bool moved = false;
+    while (!pipe.full()) {
+        const ssize_t count = ::splice(fd, nullptr, pipe.write_fd, nullptr, pipe.capacity - pipe.bytes, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        ++counters.splice_calls;
+        if (count > 0) {
+            pipe.bytes += static_cast<std::size_t>(count);
+            moved = true;
+            continue;
+        }
+        if (count == 0) return SpliceStatus::EndOfStream;
+        if (errno == EINTR) continue;
+        if (errno == EWOULDBLOCK || errno == EAGAIN) {
+            return moved ? SpliceStatus::Moved : SpliceStatus::WouldBlock;
+        }
+        return SpliceStatus::Failed;
+    }
+    return SpliceStatus::Moved;
+#else
+    (void)fd;
+    (void)pipe;
+    (void)counters;
+    return SpliceStatus::Failed;
+#endif
+}
+
+FlushStatus splice_from_pipe(SplicePipe& pipe, int fd, IoCounters& counters) {
+#if defined(__linux__)
+    while (pipe.bytes != 0) {
+        const ssize_t count = ::splice(pipe.read_fd, nullptr, fd, nullptr, pipe.bytes, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        ++counters.splice_calls;
+        if (count > 0) {
+            pipe.bytes -= static_cast<std::size_t>(count);
+            counters.spliced_bytes += static_cast<std::size_t>(count);
+            continue;
+        }
+        if (count < 0 && errno == EINTR) continue;
+        if (count < 0 && (errno == EWOULDBLOCK || errno == EAGAIN)) {
+            ++counters.would_block;
+            return FlushStatus::WouldBlock;
+        }
+        return FlushStatus::Failed;
+    }
+    return FlushStatus::Drained;
+#else
+    (void)pipe;
+    (void)fd;
+    (void)counters;
+    return FlushStatus::Failed;
+#endif
+}
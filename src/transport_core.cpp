@@ -1,25 +1,42 @@
 #include "net/proxy.hpp"
 
 #include "ghostline/audit.hpp"
+#include "ghostline/labels.hpp"
 #include "ghostline/operator_state.hpp"
+#include "ghostline/packet_arena.hpp"
+#include "ghostline/pid_search.hpp"
 #include "ghostline/plugin.hpp"
-
+#include "ghostline/rules_reload.hpp"
+#include "net/backpressure.hpp"
+#include "net/flow_ids.hpp"
+#include "net/memory_accountant.hpp"
+#include "net/relay_metrics.hpp"
+#include "net/socket_io.hpp"
+#include "net/stream_buffer.hpp"
+
+#include <algorithm>
 #include <arpa/inet.h>
+#include <array>
+#include <atomic>
 #include <cctype>
 #include <cerrno>
 #include <chrono>
 #include <cstdio>
 #include <cstring>
-#include <deque>
 #include <fcntl.h>
+#include <functional>
 #include <netdb.h>
-#include <poll.h>
+#include <queue>
+#include <signal.h>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <stdexcept>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <thread>
 #include <unistd.h>
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
@@ -30,6 +47,10 @@ std::uint64_t now_ns() {
     return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
 }
 
+std::uint64_t now_ms() {
+    return now_ns() / 1000000ULL;
+}
+
 std::string last_err() {
     return std::strerror(errno);
 }
@@ -45,20 +66,47 @@ void add_flag(FlowContext& flow, FlowFlag flag) {
     if (!has_flag(flow, flag)) flow.flags.push_back(flag);
 }
 
-std::string direction_name(Direction direction) {
-    return direction == Direction::ClientToServer ? "c2s" : "s2c";
-}
-
 struct PeerState {
     int fd = -1;
     bool connecting = false;
     bool read_open = true;
     bool write_open = true;
     bool shutdown_when_drained = false;
-    bool plugin_logged = false;
-    std::string plugin_name;
-    ByteVec pending;
-    std::deque<ByteVec> outq;
+    // Reads from this peer are spliced straight into the opposite peer's
+    // inbound pipe; read_paused is set while that pipe is full. rearm forces
+    // the next interest sync through so edge-triggered backends report data
+    // that was left unread while paused.
+    bool passthrough = false;
+    bool read_paused = false;
+    bool rearm = false;
+    // Reads paused while the opposite peer's out queue is over the flow
+    // water marks.
+    BackpressureGate backpressure;
+    std::uint32_t interest = 0;
+    // Plugin bound to this direction. Matched once, then reused until a
+    // framing pass-through asks for re-detection. `rules` is the registry it
+    // came from, held until the direction moves to reloaded rules.
+    const ProtocolPlugin* plugin = nullptr;
+    std::shared_ptr<const PluginRegistry> rules;
+    PluginId logged_plugin = kNoPluginId;
+    WindowRule window;
+    bool has_window = false;
+    // Bytes of `pending` already searched without finding the next frame or
+    // window boundary; reset whenever pending is consumed. While non-zero in
+    // window mode, window_index names the rule whose window is open.
+    std::size_t scan_resume = 0;
+    std::size_t window_index = 0;
+    // Steady-clock ms after which held pending bytes are flushed (0 = no
+    // deadline); hold_scheduled_ms is the deadline already in the timer heap.
+    std::uint64_t hold_deadline_ms = 0;
+    std::uint64_t hold_scheduled_ms = 0;
+    StreamBuffer pending;
+    ChunkQueue outq;
+    SplicePipe inbound;
+    ZeroCopyState zerocopy;
+    IoCounters io;
+    // Scratch candidate and decision for the packet being released.
+    PacketArena arena;
 };
 
 struct FlowState {
@@ -66,13 +114,108 @@ struct FlowState {
     PeerState client;
     PeerState upstream;
     bool closed = false;
+    // Bytes this flow holds, as last reported to the shared accountant.
+    MemoryAccountant* accountant = nullptr;
+    MemoryCharge memory;
+    bool memory_forced = false;
+    // The client's own socket (its address, then ours) for --pid-index.
+    SocketIndex* pid_index = nullptr;
+    SocketTuple client_socket;
+    // The accepting worker's metrics, and the relayed byte counts per
+    // direction already added to them.
+    WorkerMetrics* metrics = nullptr;
+    std::array<std::uint64_t, 2> reported_bytes{};
 };
 
-struct FdContext {
-    std::uint32_t flow_id = 0;
-    bool is_client = true;
+// Hold deadlines live in a min-heap and are validated lazily: an entry only
+// fires if the peer still has exactly that deadline armed.
+struct HoldTimer {
+    std::uint64_t deadline_ms = 0;
+    std::uint64_t token = 0;
 };
 
+struct HoldTimerLater {
+    bool operator()(const HoldTimer& left, const HoldTimer& right) const {
+        return left.deadline_ms > right.deadline_ms;
+    }
+};
+
+using HoldTimerQueue = std::priority_queue<HoldTimer, std::vector<HoldTimer>, HoldTimerLater>;
+
+// Backend tokens: 0 is the listen socket, 1 the shutdown pipe, flows encode
+// (flow_id << 1) | is_client. Flow ids start at 1, so a stale event for a
+// closed flow never aliases a live one.
+constexpr std::uint64_t kListenToken = 0;
+constexpr std::uint64_t kShutdownToken = 1;
+
+// While reads are globally paused, queues drained by other workers raise no
+// event here, so the wait is capped to notice the total falling.
+constexpr int kGlobalBackpressureRecheckMs = 10;
+// How often sockets closed with zero-copy sends outstanding are checked for
+// completions, and how long shutdown waits for them.
+constexpr int kZeroCopyReapMs = 20;
+constexpr int kZeroCopyShutdownWaitMs = 1000;
+
+// Self-pipe written by SIGINT/SIGTERM. It is never drained, so every worker
+// sees it readable and unwinds, letting its AuditTrail flush on the way out.
+int g_shutdown_pipe[2] = {-1, -1};
+
+void handle_shutdown_signal(int) {
+    const int saved_errno = errno;
+    const char byte = 1;
+    if (::write(g_shutdown_pipe[1], &byte, 1) < 0) {
+        // Nothing useful to do inside a signal handler.
+    }
+    errno = saved_errno;
+}
+
+void install_shutdown_handler() {
+    if (g_shutdown_pipe[0] >= 0) return;
+    if (::pipe(g_shutdown_pipe) != 0) return;
+    ::fcntl(g_shutdown_pipe[0], F_SETFD, FD_CLOEXEC);
+    ::fcntl(g_shutdown_pipe[1], F_SETFD, FD_CLOEXEC);
+    ::fcntl(g_shutdown_pipe[1], F_SETFL, O_NONBLOCK);
+
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = handle_shutdown_signal;
+    sigemptyset(&action.sa_mask);
+    ::sigaction(SIGINT, &action, nullptr);
+    ::sigaction(SIGTERM, &action, nullptr);
+}
+
+// Self-pipe written by SIGHUP and drained by the RulesWatcher.
+int g_reload_pipe[2] = {-1, -1};
+
+void handle_reload_signal(int) {
+    const int saved_errno = errno;
+    const char byte = 1;
+    if (::write(g_reload_pipe[1], &byte, 1) < 0) {
+        // A full pipe already asks for a reload.
+    }
+    errno = saved_errno;
+}
+
+void install_reload_handler() {
+    if (g_reload_pipe[0] >= 0) return;
+    if (::pipe(g_reload_pipe) != 0) return;
+    for (int i = 0; i < 2; ++i) {
+        ::fcntl(g_reload_pipe[i], F_SETFD, FD_CLOEXEC);
+        ::fcntl(g_reload_pipe[i], F_SETFL, O_NONBLOCK);
+    }
+
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = handle_reload_signal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    ::sigaction(SIGHUP, &action, nullptr);
+}
+
+std::uint64_t peer_token(std::uint32_t flow_id, bool is_client) {
+    return (static_cast<std::uint64_t>(flow_id) << 1U) | (is_client ? 1U : 0U);
+}
+
 int set_nonblocking(int fd) {
     const int flags = fcntl(fd, F_GETFL, 0);
     if (flags < 0) return -1;
@@ -83,7 +226,7 @@ void close_quiet(int fd) {
     if (fd >= 0) ::close(fd);
 }
 
-int create_listen_socket(const std::string& host, std::uint16_t port) {
+int create_listen_socket(const std::string& host, std::uint16_t port, bool reuse_port) {
     addrinfo hints;
     std::memset(&hints, 0, sizeof(hints));
     hints.ai_family = AF_UNSPEC;
@@ -103,6 +246,17 @@ int create_listen_socket(const std::string& host, std::uint16_t port) {
 
         const int yes = 1;
         ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+        if (reuse_port) {
+#if defined(SO_REUSEPORT)
+            if (::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &yes, sizeof(yes)) != 0) {
+                close_quiet(fd);
+                continue;
+            }
+#else
+            close_quiet(fd);
+            continue;
+#endif
+        }
 
         if (::bind(fd, p->ai_addr, p->ai_addrlen) == 0 && ::listen(fd, 128) == 0) {
             listen_fd = fd;
@@ -160,29 +314,71 @@ int connect_upstream(const std::string& host, std::uint16_t port, bool& in_progr
     return connected_fd;
 }
 
-std::size_t find_subsequence(const ByteVec& haystack, const ByteVec& needle, std::size_t offset) {
-    if (needle.empty()) return std::string::npos;
-    if (haystack.size() < needle.size() || offset > haystack.size() - needle.size()) return std::string::npos;
-    for (std::size_t i = offset; i + needle.size() <= haystack.size(); ++i) {
-        if (std::equal(needle.begin(), needle.end(), haystack.begin() + static_cast<long>(i))) {
-            return i;
-        }
+// Hands every pending byte to the opposite peer's out queue. The pending
+// storage is moved rather than copied whenever nothing was consumed from it.
+void release_pending(PeerState& src, PeerState& dst) {
+    if (!src.pending.empty()) dst.outq.push(src.pending.take_all());
+    src.scan_resume = 0;
+    src.hold_deadline_ms = 0;
+}
+
+void consume_pending(PeerState& src, std::size_t count) {
+    src.pending.consume(count);
+    src.scan_resume = 0;
+    src.hold_deadline_ms = 0;
+}
+
+// Reports the flow's buffered bytes to the accountant. Called whenever the
+// flow was touched, so the shared totals lag by at most one event round.
+void charge_flow_memory(FlowState& flow) {
+    if (flow.accountant == nullptr) return;
+    flow.accountant->set(flow.memory, MemoryCategory::Pending, flow.client.pending.size() + flow.upstream.pending.size());
+    flow.accountant->set(flow.memory, MemoryCategory::OutQueue, flow.client.outq.bytes() + flow.upstream.outq.bytes());
+}
+
+// Adds the bytes relayed since the last report to the worker's metrics, on
+// the same schedule as charge_flow_memory. Each direction's bytes are
+// counted on the peer that receives them.
+void report_flow_metrics(FlowState& flow) {
+    const std::uint64_t relayed[2] = {
+        flow.upstream.io.sent_bytes + flow.upstream.io.spliced_bytes,
+        flow.client.io.sent_bytes + flow.client.io.spliced_bytes,
+    };
+    for (std::size_t i = 0; i < 2; ++i) {
+        if (relayed[i] == flow.reported_bytes[i]) continue;
+        WorkerMetrics::add(flow.metrics->relayed_bytes[i], relayed[i] - flow.reported_bytes[i]);
+        flow.reported_bytes[i] = relayed[i];
     }
-    return std::string::npos;
 }
 
-void enqueue_bytes(std::deque<ByteVec>& outq, const ByteVec& bytes) {
-    if (!bytes.empty()) outq.push_back(bytes);
+void count_candidate(FlowState& flow, const CandidateDecision& decision) {
+    WorkerMetrics& metrics = *flow.metrics;
+    const std::size_t code = static_cast<std::size_t>(decision.validation);
+    if (code < metrics.candidates.size()) WorkerMetrics::add(metrics.candidates[code], 1);
+    WorkerMetrics::add(decision.release == CandidateRelease::ReleaseModified ? metrics.released_modified : metrics.released_original, 1);
 }
 
-void record_detection(AuditTrail& audit, const FlowState& flow, Direction direction, const ProtocolPlugin& plugin, const ByteVec& sample) {
-    AuditEvent event;
-    event.event_id = "event-" + std::to_string(flow.context.flow_id) + "-" + direction_name(direction) + "-" + std::to_string(flow.context.event_sequence) + "-detect";
+// A rewritten candidate owns its bytes from build until release.
+void charge_candidate_memory(FlowState& flow, std::size_t bytes) {
+    if (flow.accountant != nullptr) flow.accountant->set(flow.memory, MemoryCategory::Candidate, bytes);
+}
+
+// Memory-only lookup; a client that was not in the index yet usually is by
+// the time its first bytes are matched.
+void resolve_pid_hint(FlowState& flow) {
+    if (flow.pid_index != nullptr && flow.context.pid_hint < 0) {
+        flow.context.pid_hint = flow.pid_index->owner_of(flow.client_socket);
+    }
+}
+
+void record_detection(AuditTrail& audit, const FlowState& flow, Direction direction, const ProtocolPlugin& plugin, ByteView sample) {
+    AuditEvent& event = audit.next_event();
+    event.type = AuditEventType::PluginDetect;
     event.flow_id = flow.context.flow_id;
     event.direction = direction;
     event.plugin_name = plugin.name();
-    event.event_type = "plugin-detect";
     event.message = "Matched plugin " + plugin.audit_label();
+    if (flow.context.pid_hint >= 0) event.message += " pid_hint=" + std::to_string(flow.context.pid_hint);
     event.original_bytes = sample;
     event.flags = flow.context.flags;
     event.workflow_stage = WorkflowStage::Triggered;
@@ -195,18 +391,17 @@ void record_protocol_event(AuditTrail& audit,
                            const FlowContext& flow,
                            Direction direction,
                            const std::string& plugin_name,
-                           const std::string& event_type,
-                           const std::string& message,
-                           const ByteVec& original_bytes,
-                           const ByteVec& modified_bytes) {
-    AuditEvent event;
-    event.event_id = "event-" + std::to_string(flow.flow_id) + "-" + direction_name(direction) + "-" + std::to_string(flow.event_sequence) + "-" + event_type;
+                           AuditEventType type,
+                           std::string_view message,
+                           ByteView original_bytes,
+                           ByteView modified_bytes) {
+    AuditEvent& event = audit.next_event();
+    event.type = type;
     event.flow_id = flow.flow_id;
     event.direction = direction;
     event.plugin_name = plugin_name;
-    event.event_type = event_type;
-    event.message = message;
-    event.workflow_stage = event_type == "framed-packet" ? WorkflowStage::Framed : WorkflowStage::Observe;
+    event.message.assign(message);
+    event.workflow_stage = type == AuditEventType::FramedPacket ? WorkflowStage::Framed : WorkflowStage::Observe;
     event.original_bytes = original_bytes;
     event.modified_bytes = modified_bytes;
     event.flags = flow.flags;
@@ -215,41 +410,108 @@ void record_protocol_event(AuditTrail& audit,
     audit.record_event(event);
 }
 
-void flush_prefix(ByteVec& pending, std::size_t prefix_len, std::deque<ByteVec>& outq) {
+void flush_prefix(PeerState& src, std::size_t prefix_len, PeerState& dst) {
     if (prefix_len == 0) return;
-    ByteVec prefix(pending.begin(), pending.begin() + static_cast<long>(prefix_len));
-    enqueue_bytes(outq, prefix);
-    pending.erase(pending.begin(), pending.begin() + static_cast<long>(prefix_len));
+    // A large buffer released whole is handed over rather than copied; small
+    // ones are coalesced into the out queue tail either way.
+    if (prefix_len == src.pending.size() && prefix_len > ChunkQueue::kCoalesceBytes) {
+        release_pending(src, dst);
+        return;
+    }
+    dst.outq.push(src.pending.view().subview(0, prefix_len));
+    consume_pending(src, prefix_len);
 }
 
-bool flush_outq(PeerState& peer) {
-    while (!peer.outq.empty()) {
-        ByteVec& chunk = peer.outq.front();
-        if (chunk.empty()) {
-            peer.outq.pop_front();
-            continue;
-        }
+// Queues a decided candidate and drops its `consumed` bytes from pending. A
+// rewrite moves the candidate's own copy; the original goes straight from
+// the receive buffer.
+void release_candidate(PeerState& src, PeerState& dst, Candidate& candidate, const CandidateDecision& decision, std::size_t consumed) {
+    if (decision.release == CandidateRelease::ReleaseModified && candidate.mutated) {
+        dst.outq.push(std::move(candidate.mutated_bytes));
+        consume_pending(src, consumed);
+        return;
+    }
+    if (candidate.original_bytes.data() == src.pending.data() && candidate.original_bytes.size() == consumed) {
+        flush_prefix(src, consumed, dst);
+        return;
+    }
+    dst.outq.push(candidate.original_bytes);
+    consume_pending(src, consumed);
+}
 
-        const ssize_t sent = ::send(peer.fd, chunk.data(), chunk.size(), 0);
-        if (sent > 0) {
-            chunk.erase(chunk.begin(), chunk.begin() + sent);
-            if (chunk.empty()) {
-                peer.outq.pop_front();
-                continue;
-            }
-            return true;
-        }
+WaterMarks flow_water_marks(const ProxyConfig& cfg) {
+    WaterMarks marks;
+    marks.high = cfg.flow_high_water_bytes;
+    marks.low = cfg.flow_low_water_bytes;
+    return marks;
+}
 
-        if (sent < 0 && (errno == EWOULDBLOCK || errno == EAGAIN)) {
-            return true;
-        }
-        return false;
+WaterMarks global_water_marks(const ProxyConfig& cfg) {
+    WaterMarks marks;
+    marks.high = cfg.global_high_water_bytes;
+    marks.low = cfg.global_low_water_bytes;
+    return marks;
+}
+
+// True once the process-wide totals, including this flow's share not
+// charged yet, reach the global high-water mark or the memory budget; the
+// worker acts on either only between event rounds.
+bool over_global_limit(const ProxyConfig& cfg, FlowState& flow) {
+    if (flow.accountant == nullptr) return false;
+    if (cfg.global_high_water_bytes == 0 && flow.accountant->budget() == 0) return false;
+    charge_flow_memory(flow);
+    return (cfg.global_high_water_bytes != 0 && flow.accountant->total(MemoryCategory::OutQueue) >= cfg.global_high_water_bytes)
+        || flow.accountant->over_budget();
+}
+
+// Re-evaluates the read gate on src against the bytes queued toward dst and
+// audits every transition. Returns true while reads from src stay paused.
+bool apply_flow_backpressure(FlowState& flow, PeerState& src, const PeerState& dst, Direction direction, const ProxyConfig& cfg, AuditTrail& audit) {
+    WaterMarks marks = flow_water_marks(cfg);
+    if (flow.memory_forced) {
+        // Over budget: read nothing more into user space until the queued
+        // originals drain and the direction can move onto passthrough.
+        marks.high = 1;
+        marks.low = 0;
+    }
+    const std::size_t queued = dst.outq.bytes();
+    if (src.backpressure.update(queued, marks)) {
+        // Reads may have stopped short of EAGAIN; make edge-triggered
+        // backends report what is still unread.
+        if (!src.backpressure.paused()) src.rearm = true;
+        record_protocol_event(audit,
+                              flow.context,
+                              direction,
+                              "transport-core",
+                              src.backpressure.paused() ? AuditEventType::BackpressurePause : AuditEventType::BackpressureResume,
+                              "queued=" + std::to_string(queued) + " high=" + std::to_string(marks.high) + " low=" + std::to_string(marks.low),
+                              ByteView(),
+                              ByteView());
+    }
+    return src.backpressure.paused();
+}
+
+bool has_unsent(const PeerState& peer) {
+    return !peer.outq.empty() || peer.inbound.bytes != 0;
+}
+
+// Writes everything queued for `peer`: the out queue first, then whatever
+// passthrough bytes the opposite peer (`reader`) parked in its inbound pipe.
+bool flush_outq(PeerState& peer, PeerState& reader, const ProxyConfig& cfg) {
+    const FlushStatus status = flush_chunks(peer.fd, peer.outq, cfg.zerocopy_min_bytes, peer.zerocopy, peer.io);
+    if (status != FlushStatus::Drained) return status != FlushStatus::Failed;
+    if (peer.inbound.bytes == 0) return true;
+
+    if (splice_from_pipe(peer.inbound, peer.fd, peer.io) == FlushStatus::Failed) return false;
+    if (reader.read_paused && !peer.inbound.full()) {
+        reader.read_paused = false;
+        reader.rearm = true;
     }
     return true;
 }
 
 void maybe_shutdown_write(PeerState& peer) {
-    if (peer.shutdown_when_drained && peer.outq.empty() && peer.write_open) {
+    if (peer.shutdown_when_drained && !has_unsent(peer) && peer.write_open) {
         ::shutdown(peer.fd, SHUT_WR);
         peer.write_open = false;
     }
@@ -262,30 +524,34 @@ void create_action_item(AuditTrail& audit,
                         const CandidateDecision& decision) {
     ActionItem item;
     item.action_id = "action-" + std::to_string(flow.flow_id) + "-" + std::to_string(flow.event_sequence);
-    item.trigger_id = candidate.trigger_id;
-    item.candidate_id = candidate.candidate_id;
+    item.trigger_id = format_trigger_id(flow.flow_id, direction, candidate.plugin_name, candidate.trigger_sequence);
+    item.candidate_id = format_candidate_id(flow.flow_id, direction, candidate.plugin_name, candidate.candidate_sequence);
     item.flow_id = flow.flow_id;
     item.plugin_name = candidate.plugin_name;
     item.direction = direction;
-    item.title = decision.action_title;
-    item.detail = decision.action_detail;
-    item.validation_label = decision.validation_label;
-    item.fallback_reason = decision.fallback_reason;
+    item.title = action_title(decision.review);
+    item.detail = action_detail(decision.review);
+    item.validation_label = validation_label(decision.validation);
+    item.fallback_reason = fallback_reason(decision.validation);
     item.original_hex = bytes_to_hex_string(candidate.original_bytes);
-    item.modified_hex = bytes_to_hex_string(candidate.modified_bytes);
+    item.modified_hex = bytes_to_hex_string(candidate.modified_bytes());
     item.workflow_stage = WorkflowStage::ActionCreated;
     item.created_at_ns = now_ns();
     audit.save_action_item(item);
 }
 
-std::string next_trigger_id(FlowContext& flow, Direction direction, const std::string& plugin_name) {
-    ++flow.trigger_sequence;
-    return "trigger-" + std::to_string(flow.flow_id) + "-" + direction_name(direction) + "-" + plugin_name + "-" + std::to_string(flow.trigger_sequence);
+// The candidate-release event carries the validation detail, or the label
+// when the plugin left no detail.
+const char* release_message(const CandidateDecision& decision) {
+    const char* detail = validation_detail(decision);
+    return detail[0] != '\0' ? detail : validation_label(decision.validation);
 }
 
-std::string next_candidate_id(FlowContext& flow, Direction direction, const std::string& plugin_name) {
-    ++flow.candidate_sequence;
-    return "candidate-" + std::to_string(flow.flow_id) + "-" + direction_name(direction) + "-" + plugin_name + "-" + std::to_string(flow.candidate_sequence);
+// The trigger and candidate IDs are only rendered when something is written
+// out (labels.hpp); the packet path carries the sequence numbers.
+void assign_candidate_sequences(FlowContext& flow, Candidate& candidate) {
+    candidate.trigger_sequence = ++flow.trigger_sequence;
+    candidate.candidate_sequence = ++flow.candidate_sequence;
 }
 
 void set_observe_only(FlowState& flow, Direction direction, AuditTrail& audit, const std::string& reason) {
@@ -293,70 +559,171 @@ void set_observe_only(FlowState& flow, Direction direction, AuditTrail& audit, c
         flow.context.observe_only = true;
         flow.context.observe_reason = reason;
         add_flag(flow.context, FlowFlag::ObserveOnly);
+        WorkerMetrics::add(flow.metrics->observe_transitions, 1);
         audit.record_observe_transition(flow.context, direction, reason);
     }
 }
 
+// Switches one direction to kernel-side forwarding. Takes effect on the next
+// readable event once pending bytes and the destination out queue have
+// drained, so byte order is preserved.
+void enter_passthrough(FlowState& flow, PeerState& src, PeerState& dst, Direction direction, const ProxyConfig& cfg, AuditTrail& audit, const std::string& reason) {
+    if (src.passthrough || !cfg.splice_passthrough || !splice_supported()) return;
+    if (!open_splice_pipe(dst.inbound)) return;
+    src.passthrough = true;
+    record_protocol_event(audit,
+                          flow.context,
+                          direction,
+                          flow.context.active_plugin.empty() ? "transport-core" : flow.context.active_plugin,
+                          AuditEventType::SplicePassthrough,
+                          reason,
+                          ByteView(),
+                          ByteView());
+}
+
+// Runs one framed packet through candidate build, decision and audit, then
+// queues the released bytes and drops the frame from pending.
+void release_framed_packet(FlowState& flow,
+                           PeerState& src,
+                           PeerState& dst,
+                           Direction direction,
+                           const ProtocolPlugin& plugin,
+                           const FramingResult& framed,
+                           AuditTrail& audit) {
+    flow.context.last_packet_type = framed.packet_type;
+    record_protocol_event(audit,
+                          flow.context,
+                          direction,
+                          plugin.name(),
+                          AuditEventType::FramedPacket,
+                          framed.detail + " packet=" + framed.packet_type,
+                          framed.frame_bytes,
+                          ByteView());
+
+    Candidate& candidate = src.arena.next_candidate();
+    plugin.build_candidate(flow.context, direction, framed.frame_bytes, &framed, candidate);
+    assign_candidate_sequences(flow.context, candidate);
+    candidate.workflow_stage = WorkflowStage::CandidateBuilt;
+    CandidateDecision& decision = src.arena.next_decision();
+    plugin.decide(flow.context, direction, candidate, decision);
+    decision.workflow_stage = WorkflowStage::CandidateReviewed;
+    charge_candidate_memory(flow, candidate.mutated_bytes.size());
+
+    if (candidate.allow_size_mutated) add_flag(flow.context, FlowFlag::AllowSizeMutated);
+    if (candidate.pid_drift_risk) add_flag(flow.context, FlowFlag::PidDriftRisk);
+    if (decision.observe_only) {
+        set_observe_only(flow, direction, audit, fallback_reason(decision.validation));
+    }
+
+    audit.record_candidate(flow.context, direction, candidate, decision);
+    count_candidate(flow, decision);
+    record_protocol_event(audit,
+                          flow.context,
+                          direction,
+                          plugin.name(),
+                          decision.release == CandidateRelease::ReleaseModified ? AuditEventType::CandidateReleaseModified : AuditEventType::CandidateReleaseOriginal,
+                          release_message(decision),
+                          candidate.original_bytes,
+                          decision.release == CandidateRelease::ReleaseModified ? candidate.modified_bytes() : ByteView());
+    if (decision.create_action_item) {
+        create_action_item(audit, flow.context, direction, candidate, decision);
+    }
+
+    release_candidate(src, dst, candidate, decision, framed.consumed_bytes);
+    charge_candidate_memory(flow, 0);
+}
+
+void bind_plugin(FlowState& flow, PeerState& src, Direction direction, const ProtocolPlugin* plugin) {
+    src.plugin = plugin;
+    src.window = WindowRule();
+    src.has_window = plugin->configure_window(flow.context, direction, src.window)
+        && src.window.rules != nullptr && !src.window.rules->windows.empty();
+    src.scan_resume = 0;
+}
+
+// Moves a direction onto `registry`. A bound plugin is swapped for the one
+// of the same name there, with its window rules taken from the new config;
+// without one the direction is matched again.
+void move_to_rules(FlowState& flow, PeerState& src, Direction direction, const std::shared_ptr<const PluginRegistry>& registry) {
+    const ProtocolPlugin* plugin = src.plugin == nullptr ? nullptr : registry->find_by_name(src.plugin->name());
+    src.plugin = nullptr;
+    src.has_window = false;
+    if (plugin != nullptr) bind_plugin(flow, src, direction, plugin);
+    src.rules = registry;
+}
+
 void process_pending(FlowState& flow,
                      PeerState& src,
                      PeerState& dst,
                      Direction direction,
                      const ProxyConfig& cfg,
-                     const PluginRegistry& registry,
+                     const std::shared_ptr<const PluginRegistry>& registry,
                      AuditTrail& audit) {
     while (!src.pending.empty()) {
         ++flow.context.event_sequence;
-        if (flow.context.observe_only) {
-            enqueue_bytes(dst.outq, src.pending);
-            src.pending.clear();
+        if (flow.context.observe_only || src.passthrough) {
+            release_pending(src, dst);
+            enter_passthrough(flow, src, dst, direction, cfg, audit, "observe-only flow");
             return;
         }
 
-        const ProtocolPlugin* plugin = registry.match(flow.context, direction, cfg.upstream_port, src.pending);
-        if (plugin == nullptr) {
-            enqueue_bytes(dst.outq, src.pending);
-            src.pending.clear();
-            return;
-        }
+        // Reloaded rules take over at a frame boundary: pending starts at one
+        // here, while a non-zero scan_resume means a frame or window is still
+        // being assembled under the rules it started with.
+        if (src.rules != registry && src.scan_resume == 0) move_to_rules(flow, src, direction, registry);
 
-        flow.context.active_plugin = plugin->name();
-        if (!src.plugin_logged || src.plugin_name != plugin->name()) {
-            src.plugin_logged = true;
-            src.plugin_name = plugin->name();
-            record_detection(audit, flow, direction, *plugin, src.pending);
+        const ProtocolPlugin* plugin = src.plugin;
+        if (plugin == nullptr) {
+            plugin = src.rules->match(flow.context, direction, cfg.upstream_port, src.pending.view());
+            if (plugin == nullptr) {
+                release_pending(src, dst);
+                enter_passthrough(flow, src, dst, direction, cfg, audit, "no plugin matched");
+                return;
+            }
+            bind_plugin(flow, src, direction, plugin);
+            flow.context.active_plugin = plugin->name();
+            if (src.logged_plugin != plugin->id()) {
+                src.logged_plugin = plugin->id();
+                resolve_pid_hint(flow);
+                record_detection(audit, flow, direction, *plugin, src.pending.view());
+            }
         }
 
         if (plugin->uses_protocol_framing()) {
-            FramingResult framed = plugin->frame(flow.context, direction, src.pending);
+            FramingResult framed = plugin->frame(flow.context, direction, src.pending.view(), src.scan_resume);
             if (framed.disposition == FramingDisposition::NeedMoreBytes) {
+                src.scan_resume = framed.resume_offset;
+                if (framed.hold_deadline_ms != 0 && src.hold_deadline_ms == 0) {
+                    src.hold_deadline_ms = now_ms() + framed.hold_deadline_ms;
+                }
                 if (src.pending.size() > cfg.max_plugin_buffer_bytes) {
                     set_observe_only(flow, direction, audit, "plugin buffer ceiling reached before framing completed");
+                    WorkerMetrics::add(flow.metrics->framing_buffer_ceilings, 1);
                     record_protocol_event(audit,
                                           flow.context,
                                           direction,
                                           plugin->name(),
-                                          "framing-buffer-ceiling",
+                                          AuditEventType::FramingBufferCeiling,
                                           "released original bytes after plugin buffering ceiling was exceeded",
-                                          src.pending,
-                                          ByteVec());
-                    enqueue_bytes(dst.outq, src.pending);
-                    src.pending.clear();
+                                          src.pending.view(),
+                                          ByteView());
+                    release_pending(src, dst);
                 }
                 return;
             }
 
             if (framed.disposition == FramingDisposition::FramingFailed) {
                 set_observe_only(flow, direction, audit, framed.detail.empty() ? "protocol framing failed" : framed.detail);
+                WorkerMetrics::add(flow.metrics->framing_failures, 1);
                 record_protocol_event(audit,
                                       flow.context,
                                       direction,
                                       plugin->name(),
-                                      "framing-failed",
+                                      AuditEventType::FramingFailed,
                                       framed.detail,
-                                      src.pending,
-                                      ByteVec());
-                enqueue_bytes(dst.outq, src.pending);
-                src.pending.clear();
+                                      src.pending.view(),
+                                      ByteView());
+                release_pending(src, dst);
                 return;
             }
 
@@ -365,122 +732,116 @@ void process_pending(FlowState& flow,
                                       flow.context,
                                       direction,
                                       plugin->name(),
-                                      "framing-pass-through",
+                                      AuditEventType::FramingPassThrough,
                                       framed.detail,
-                                      src.pending,
-                                      ByteVec());
-                enqueue_bytes(dst.outq, src.pending);
-                src.pending.clear();
+                                      src.pending.view(),
+                                      ByteView());
+                release_pending(src, dst);
+                src.plugin = nullptr;
+                src.has_window = false;
                 return;
             }
 
             if (framed.disposition == FramingDisposition::FramedPacket) {
-                flow.context.last_packet_type = framed.packet_type;
-                record_protocol_event(audit,
-                                      flow.context,
-                                      direction,
-                                      plugin->name(),
-                                      "framed-packet",
-                                      framed.detail + " packet=" + framed.packet_type,
-                                      framed.frame_bytes,
-                                      ByteVec());
-
-                Candidate candidate = plugin->build_candidate(flow.context, direction, framed.frame_bytes, &framed);
-                candidate.trigger_id = next_trigger_id(flow.context, direction, plugin->name());
-                candidate.candidate_id = next_candidate_id(flow.context, direction, plugin->name());
-                candidate.workflow_stage = WorkflowStage::CandidateBuilt;
-                CandidateDecision decision = plugin->decide(flow.context, direction, candidate);
-                decision.trigger_id = candidate.trigger_id;
-                decision.candidate_id = candidate.candidate_id;
-                decision.workflow_stage = WorkflowStage::CandidateReviewed;
-
-                if (candidate.allow_size_mutated) add_flag(flow.context, FlowFlag::AllowSizeMutated);
-                if (candidate.pid_drift_risk) add_flag(flow.context, FlowFlag::PidDriftRisk);
-                if (decision.observe_only) {
-                    set_observe_only(flow, direction, audit, decision.fallback_reason);
-                }
-
-                audit.record_candidate(flow.context, direction, candidate, decision);
-                record_protocol_event(audit,
-                                      flow.context,
-                                      direction,
-                                      plugin->name(),
-                                      decision.release == CandidateRelease::ReleaseModified ? "candidate-release-modified" : "candidate-release-original",
-                                      decision.validation_detail.empty() ? decision.validation_label : decision.validation_detail,
-                                      candidate.original_bytes,
-                                      decision.release == CandidateRelease::ReleaseModified ? candidate.modified_bytes : ByteVec());
-                if (decision.create_action_item) {
-                    create_action_item(audit, flow.context, direction, candidate, decision);
-                }
-
-                enqueue_bytes(dst.outq,
-                              decision.release == CandidateRelease::ReleaseModified
-                                  ? candidate.modified_bytes
-                                  : candidate.original_bytes);
-                src.pending.erase(src.pending.begin(), src.pending.begin() + static_cast<long>(framed.consumed_bytes));
+                release_framed_packet(flow, src, dst, direction, *plugin, framed, audit);
                 continue;
             }
         }
 
-        WindowRule rule;
-        if (!plugin->configure_window(flow.context, direction, rule) || rule.start_marker.empty() || rule.end_marker.empty()) {
-            enqueue_bytes(dst.outq, src.pending);
-            src.pending.clear();
+        if (!src.has_window) {
+            release_pending(src, dst);
             return;
         }
 
-        const std::size_t start_pos = find_subsequence(src.pending, rule.start_marker, 0);
-        if (start_pos == std::string::npos) {
-            const std::size_t keep = rule.start_marker.empty() ? 0 : rule.start_marker.size() - 1;
-            if (src.pending.size() <= keep) return;
-            flush_prefix(src.pending, src.pending.size() - keep, dst.outq);
-            return;
-        }
+        // One automaton pass finds the leftmost start marker across every
+        // window rule. Once a window is open its start marker sits at offset
+        // 0 and only that rule's end marker search can resume.
+        const WindowRuleSet& rules = *src.window.rules;
+        if (src.scan_resume == 0) {
+            const PatternMatch head = rules.start_markers.find_leftmost(src.pending.view());
+            if (!head.found()) {
+                const std::size_t keep = rules.start_markers.max_length() - 1;
+                if (src.pending.size() <= keep) return;
+                flush_prefix(src, src.pending.size() - keep, dst);
+                return;
+            }
 
-        if (start_pos > 0) {
-            flush_prefix(src.pending, start_pos, dst.outq);
-            continue;
+            if (head.start > 0) {
+                flush_prefix(src, head.start, dst);
+                continue;
+            }
+            src.window_index = head.pattern;
         }
 
-        const std::size_t end_search_offset = rule.start_marker.size();
-        const std::size_t end_pos = find_subsequence(src.pending, rule.end_marker, end_search_offset);
+        const CompiledWindow& rule = rules.windows[src.window_index];
+        const std::size_t end_search_offset = std::max(rule.start_marker.size(), src.scan_resume);
+        const std::size_t end_pos = rule.end_marker.find(src.pending.view(), end_search_offset);
         if (end_pos == std::string::npos) {
             if (src.pending.size() > cfg.max_inspect_bytes) {
-                enqueue_bytes(dst.outq, src.pending);
-                src.pending.clear();
+                release_pending(src, dst);
+            } else {
+                src.scan_resume = std::max(end_search_offset, rule.end_marker.resume_offset(src.pending.view()));
             }
             return;
         }
 
         const std::size_t window_len = end_pos + rule.end_marker.size();
-        ByteVec window(src.pending.begin(), src.pending.begin() + static_cast<long>(window_len));
-        Candidate candidate = plugin->build_candidate(flow.context, direction, window);
-        candidate.trigger_id = next_trigger_id(flow.context, direction, plugin->name());
-        candidate.candidate_id = next_candidate_id(flow.context, direction, plugin->name());
+        const ByteView window = src.pending.view().subview(0, window_len);
+        Candidate& candidate = src.arena.next_candidate();
+        plugin->build_candidate(flow.context, direction, window, nullptr, candidate);
+        assign_candidate_sequences(flow.context, candidate);
         candidate.workflow_stage = WorkflowStage::CandidateBuilt;
-        CandidateDecision decision = plugin->decide(flow.context, direction, candidate);
-        decision.trigger_id = candidate.trigger_id;
-        decision.candidate_id = candidate.candidate_id;
+        CandidateDecision& decision = src.arena.next_decision();
+        plugin->decide(flow.context, direction, candidate, decision);
         decision.workflow_stage = WorkflowStage::CandidateReviewed;
+        charge_candidate_memory(flow, candidate.mutated_bytes.size());
 
         if (candidate.allow_size_mutated) add_flag(flow.context, FlowFlag::AllowSizeMutated);
         if (candidate.pid_drift_risk) add_flag(flow.context, FlowFlag::PidDriftRisk);
         if (decision.observe_only) {
-            set_observe_only(flow, direction, audit, decision.fallback_reason);
+            set_observe_only(flow, direction, audit, fallback_reason(decision.validation));
         }
 
         audit.record_candidate(flow.context, direction, candidate, decision);
+        count_candidate(flow, decision);
         if (decision.create_action_item) {
             create_action_item(audit, flow.context, direction, candidate, decision);
         }
 
-        enqueue_bytes(dst.outq,
-                      decision.release == CandidateRelease::ReleaseModified
-                          ? candidate.modified_bytes
-                          : candidate.original_bytes);
+        release_candidate(src, dst, candidate, decision, window_len);
+        charge_candidate_memory(flow, 0);
+    }
+}
 
-        src.pending.erase(src.pending.begin(), src.pending.begin() + static_cast<long>(window_len));
+// Releases bytes a plugin is still holding. The bound plugin gets one last
+// chance to frame them (flush_held); whatever it leaves goes out unchanged.
+void flush_held_pending(FlowState& flow,
+                        PeerState& src,
+                        PeerState& dst,
+                        Direction direction,
+                        AuditTrail& audit,
+                        AuditEventType type,
+                        const std::string& detail) {
+    if (src.pending.empty()) return;
+
+    ++flow.context.event_sequence;
+    if (src.plugin != nullptr && !flow.context.observe_only && !src.passthrough) {
+        const FramingResult framed = src.plugin->flush_held(flow.context, direction, src.pending.view());
+        if (framed.disposition == FramingDisposition::FramedPacket && framed.consumed_bytes <= src.pending.size()) {
+            release_framed_packet(flow, src, dst, direction, *src.plugin, framed, audit);
+            if (src.pending.empty()) return;
+        }
     }
+
+    record_protocol_event(audit,
+                          flow.context,
+                          direction,
+                          flow.context.active_plugin.empty() ? "transport-core" : flow.context.active_plugin,
+                          type,
+                          detail,
+                          src.pending.view(),
+                          ByteView());
+    release_pending(src, dst);
 }
 
 void flush_pending_on_read_close(FlowState& flow,
@@ -488,40 +849,168 @@ void flush_pending_on_read_close(FlowState& flow,
                                  PeerState& dst,
                                  Direction direction,
                                  AuditTrail& audit) {
-    if (src.pending.empty()) return;
+    flush_held_pending(flow, src, dst, direction, audit, AuditEventType::ReadCloseFlushOriginal, "released pending original bytes on read-close");
+}
 
-    ++flow.context.event_sequence;
+void schedule_hold(HoldTimerQueue& timers, PeerState& peer, std::uint64_t token) {
+    if (peer.hold_deadline_ms == 0 || peer.hold_deadline_ms == peer.hold_scheduled_ms) return;
+    HoldTimer timer;
+    timer.deadline_ms = peer.hold_deadline_ms;
+    timer.token = token;
+    timers.push(timer);
+    peer.hold_scheduled_ms = peer.hold_deadline_ms;
+}
+
+int next_wait_timeout(const HoldTimerQueue& timers) {
+    if (timers.empty()) return -1;
+    const std::uint64_t now = now_ms();
+    if (timers.top().deadline_ms <= now) return 0;
+    return static_cast<int>(std::min<std::uint64_t>(timers.top().deadline_ms - now, 60000));
+}
+
+// Bytes written to the upstream socket travel client-to-server, so each
+// direction's counters live on the peer that receives them.
+void record_io_stats(AuditTrail& audit, const FlowContext& context, AuditEventType type, const IoCounters& c2s, const IoCounters& s2c) {
     record_protocol_event(audit,
-                          flow.context,
-                          direction,
-                          flow.context.active_plugin.empty() ? "transport-core" : flow.context.active_plugin,
-                          "read-close-flush-original",
-                          "released pending original bytes on read-close",
-                          src.pending,
-                          ByteVec());
-    enqueue_bytes(dst.outq, src.pending);
-    src.pending.clear();
+                          context,
+                          Direction::ClientToServer,
+                          "transport-core",
+                          type,
+                          "c2s " + c2s.summary() + " s2c " + s2c.summary(),
+                          ByteView(),
+                          ByteView());
+}
+
+// Releases whatever the plugin holds as original bytes and moves the
+// direction onto the passthrough path.
+void release_held_originals(FlowState& flow, PeerState& src, PeerState& dst, Direction direction, const ProxyConfig& cfg, AuditTrail& audit, const std::string& reason) {
+    if (!src.pending.empty()) {
+        record_protocol_event(audit,
+                              flow.context,
+                              direction,
+                              flow.context.active_plugin.empty() ? "transport-core" : flow.context.active_plugin,
+                              AuditEventType::MemoryBudgetReleaseOriginal,
+                              "released held original bytes to stay within the memory budget",
+                              src.pending.view(),
+                              ByteView());
+        release_pending(src, dst);
+    }
+    src.plugin = nullptr;
+    src.has_window = false;
+    enter_passthrough(flow, src, dst, direction, cfg, audit, reason);
+}
+
+// Forces the largest flows to observe-only passthrough while the process is
+// over its memory budget. Flows already forced keep draining their queued
+// originals, so they count toward the excess before anyone else is forced.
+// Appends the ids of newly forced flows to `forced`.
+void enforce_memory_budget(std::unordered_map<std::uint32_t, FlowState>& flows,
+                           const MemoryAccountant& memory,
+                           const ProxyConfig& cfg,
+                           AuditTrail& audit,
+                           std::vector<std::uint32_t>& forced) {
+    if (!memory.over_budget()) return;
+
+    std::size_t excess = memory.total() - memory.budget();
+    std::vector<std::pair<std::size_t, std::uint32_t>> offenders;
+    for (std::unordered_map<std::uint32_t, FlowState>::iterator it = flows.begin(); it != flows.end(); ++it) {
+        const std::size_t held = it->second.memory.total();
+        if (!it->second.memory_forced) {
+            if (held != 0) offenders.push_back(std::make_pair(held, it->first));
+        } else {
+            excess -= std::min(excess, held);
+        }
+    }
+    std::sort(offenders.begin(), offenders.end(), std::greater<std::pair<std::size_t, std::uint32_t>>());
+
+    const std::string reason = "memory budget exceeded";
+    for (std::size_t i = 0; i < offenders.size() && excess != 0; ++i) {
+        FlowState& flow = flows[offenders[i].second];
+        flow.memory_forced = true;
+        ++flow.context.event_sequence;
+        record_protocol_event(audit,
+                              flow.context,
+                              Direction::ClientToServer,
+                              "transport-core",
+                              AuditEventType::MemoryBudgetEnforced,
+                              "flow_bytes=" + std::to_string(offenders[i].first) + " " + memory.summary(),
+                              ByteView(),
+                              ByteView());
+        set_observe_only(flow, Direction::ClientToServer, audit, reason);
+        release_held_originals(flow, flow.client, flow.upstream, Direction::ClientToServer, cfg, audit, reason);
+        release_held_originals(flow, flow.upstream, flow.client, Direction::ServerToClient, cfg, audit, reason);
+        apply_flow_backpressure(flow, flow.client, flow.upstream, Direction::ClientToServer, cfg, audit);
+        apply_flow_backpressure(flow, flow.upstream, flow.client, Direction::ServerToClient, cfg, audit);
+        excess -= std::min(excess, offenders[i].first);
+        forced.push_back(offenders[i].second);
+    }
 }
 
 void close_flow(std::unordered_map<std::uint32_t, FlowState>& flows,
-                std::unordered_map<int, FdContext>& fd_contexts,
+                EventBackend& backend,
+                ZeroCopyGraveyard& graveyard,
+                AuditTrail& audit,
+                IoCounters& worker_c2s,
+                IoCounters& worker_s2c,
                 std::uint32_t flow_id) {
     std::unordered_map<std::uint32_t, FlowState>::iterator it = flows.find(flow_id);
     if (it == flows.end()) return;
 
-    close_quiet(it->second.client.fd);
-    close_quiet(it->second.upstream.fd);
-    fd_contexts.erase(it->second.client.fd);
-    fd_contexts.erase(it->second.upstream.fd);
+    record_io_stats(audit, it->second.context, AuditEventType::FlowIoStats, it->second.upstream.io, it->second.client.io);
+    report_flow_metrics(it->second);
+    if (it->second.accountant != nullptr) it->second.accountant->release(it->second.memory);
+    worker_c2s.add(it->second.upstream.io);
+    worker_s2c.add(it->second.client.io);
+
+    backend.remove(it->second.client.fd);
+    backend.remove(it->second.upstream.fd);
+    // An error or abort can close a flow before its zero-copy sends
+    // complete; the kernel may still read those buffers.
+    graveyard.bury(it->second.client.fd, it->second.client.zerocopy, worker_s2c);
+    graveyard.bury(it->second.upstream.fd, it->second.upstream.zerocopy, worker_c2s);
+    close_splice_pipe(it->second.client.inbound);
+    close_splice_pipe(it->second.upstream.inbound);
     flows.erase(it);
 }
 
 bool flow_finished(const FlowState& flow) {
-    const bool client_done = !flow.client.read_open && flow.client.outq.empty() && !flow.client.write_open;
-    const bool upstream_done = !flow.upstream.read_open && flow.upstream.outq.empty() && !flow.upstream.write_open;
+    const bool client_done = !flow.client.read_open && !has_unsent(flow.client) && !flow.client.write_open
+        && flow.client.zerocopy.in_flight.empty();
+    const bool upstream_done = !flow.upstream.read_open && !has_unsent(flow.upstream) && !flow.upstream.write_open
+        && flow.upstream.zerocopy.in_flight.empty();
     return client_done && upstream_done;
 }
 
+std::uint32_t desired_interest(const PeerState& peer, bool global_paused) {
+    std::uint32_t interest = 0;
+    if (peer.read_open && !peer.connecting && !peer.read_paused && !peer.backpressure.paused() && !global_paused) {
+        interest |= kInterestRead;
+    }
+    if (peer.connecting || has_unsent(peer)) interest |= kInterestWrite;
+    return interest;
+}
+
+void sync_interest(EventBackend& backend, PeerState& peer, std::uint64_t token, bool global_paused) {
+    const std::uint32_t interest = desired_interest(peer, global_paused);
+    if (interest == peer.interest && !peer.rearm) return;
+    backend.modify(peer.fd, token, interest);
+    peer.interest = interest;
+    peer.rearm = false;
+}
+
+AuditWriterOptions make_audit_writer_options(const ProxyConfig& cfg) {
+    AuditWriterOptions options;
+    options.queue_capacity = cfg.audit_queue_capacity;
+    options.batch_bytes = cfg.audit_batch_bytes;
+    options.flush_interval_ms = cfg.audit_flush_ms;
+    options.full_policy = cfg.audit_queue_policy;
+    options.rotation.max_bytes = cfg.audit_rotate_bytes;
+    options.rotation.max_age_s = cfg.audit_rotate_age_s;
+    options.rotation.keep = cfg.audit_keep_segments;
+    options.rotation.compression = cfg.audit_compression;
+    return options;
+}
+
 MutationConfig make_mutation_config(const ProxyConfig& cfg) {
     MutationConfig config;
 
@@ -546,10 +1035,37 @@ MutationConfig make_mutation_config(const ProxyConfig& cfg) {
     config.end_marker = decode_hex(cfg.end_marker_hex);
     config.replacement_text = cfg.replacement_text;
     config.raw_find_text = cfg.raw_find_text;
+    for (std::size_t i = 0; i < cfg.substitution_specs.size(); ++i) {
+        const std::string& spec = cfg.substitution_specs[i];
+        const std::size_t split = spec.find('=');
+        if (split == std::string::npos || split == 0) {
+            throw std::runtime_error("substitution must look like find=replace: " + spec);
+        }
+        SubstitutionRule rule;
+        rule.find.assign(spec.begin(), spec.begin() + static_cast<long>(split));
+        rule.replacement.assign(spec.begin() + static_cast<long>(split) + 1, spec.end());
+        config.substitutions.push_back(rule);
+    }
+    for (std::size_t i = 0; i < cfg.window_rule_specs.size(); ++i) {
+        const std::string& spec = cfg.window_rule_specs[i];
+        const std::size_t first = spec.find(':');
+        const std::size_t second = first == std::string::npos ? std::string::npos : spec.find(':', first + 1);
+        MarkerWindowRule rule;
+        rule.start_marker = decode_hex(spec.substr(0, first));
+        rule.end_marker = first == std::string::npos ? ByteVec() : decode_hex(spec.substr(first + 1, second == std::string::npos ? std::string::npos : second - first - 1));
+        if (rule.start_marker.empty() || rule.end_marker.empty()) {
+            throw std::runtime_error("window rule must look like starthex:endhex[:replacement]: " + spec);
+        }
+        if (second != std::string::npos) rule.replacement_text = spec.substr(second + 1);
+        else rule.replacement_text = cfg.replacement_text;
+        config.window_rules.push_back(rule);
+    }
     config.allow_size_mutation = cfg.allow_size_mutation;
     config.rewrite_u32_prefix = cfg.rewrite_u32_prefix;
     config.raw_live_mode = cfg.raw_live_mode;
     config.raw_chunk_bytes = cfg.raw_chunk_bytes;
+    config.raw_stream_mode = cfg.raw_stream_mode;
+    config.raw_flush_ms = cfg.raw_flush_ms;
     config.mutate_client_to_server = cfg.mutate_client_to_server;
     config.mutate_server_to_client = cfg.mutate_server_to_client;
     config.raw_review_threshold_bytes = cfg.raw_review_threshold_bytes;
@@ -558,174 +1074,481 @@ MutationConfig make_mutation_config(const ProxyConfig& cfg) {
     return config;
 }
 
-} // namespace
+void accept_clients(int listen_fd,
+                    const ProxyConfig& cfg,
+                    EventBackend& backend,
+                    std::unordered_map<std::uint32_t, FlowState>& flows,
+                    FlowIdSequence& flow_ids,
+                    MemoryAccountant& memory,
+                    SocketIndex* pid_index,
+                    WorkerMetrics& metrics,
+                    bool global_paused) {
+    while (true) {
+        sockaddr_storage address;
+        socklen_t address_len = sizeof(address);
+        const int client_fd = ::accept(listen_fd, reinterpret_cast<sockaddr*>(&address), &address_len);
+        if (client_fd < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EWOULDBLOCK && errno != EAGAIN) {
+                std::fprintf(stderr, "accept failed: %s\n", last_err().c_str());
+            }
+            return;
+        }
 
-int run_transport_core(const ProxyConfig& cfg) {
-    const int listen_fd = create_listen_socket(cfg.listen_host, cfg.listen_port);
-    if (listen_fd < 0) {
-        std::fprintf(stderr, "Failed to create listen socket on %s:%u\n", cfg.listen_host.c_str(), static_cast<unsigned>(cfg.listen_port));
+        if (set_nonblocking(client_fd) != 0) {
+            close_quiet(client_fd);
+            continue;
+        }
+
+        bool connecting = false;
+        const int upstream_fd = connect_upstream(cfg.upstream_host, cfg.upstream_port, connecting);
+        if (upstream_fd < 0) {
+            close_quiet(client_fd);
+            continue;
+        }
+
+        FlowState flow;
+        flow.context.flow_id = flow_ids.take(flows);
+        flow.context.preferred_plugin = cfg.protocol_hint;
+        flow.accountant = &memory;
+        flow.metrics = &metrics;
+        if (pid_index != nullptr) {
+            sockaddr_storage local;
+            socklen_t local_len = sizeof(local);
+            if (::getsockname(client_fd, reinterpret_cast<sockaddr*>(&local), &local_len) == 0
+                && make_socket_tuple(address, local, flow.client_socket)) {
+                flow.pid_index = pid_index;
+                resolve_pid_hint(flow);
+            }
+        }
+        flow.client.fd = client_fd;
+        flow.upstream.fd = upstream_fd;
+        flow.client.zerocopy.enabled = configure_send_socket(client_fd, cfg.zerocopy_min_bytes != 0);
+        flow.upstream.zerocopy.enabled = configure_send_socket(upstream_fd, cfg.zerocopy_min_bytes != 0);
+        flow.upstream.connecting = connecting;
+        flow.client.interest = desired_interest(flow.client, global_paused);
+        flow.upstream.interest = desired_interest(flow.upstream, global_paused);
+
+        const std::uint32_t flow_id = flow.context.flow_id;
+        if (!backend.add(client_fd, peer_token(flow_id, true), flow.client.interest)
+            || !backend.add(upstream_fd, peer_token(flow_id, false), flow.upstream.interest)) {
+            std::fprintf(stderr, "event backend registration failed: %s\n", last_err().c_str());
+            backend.remove(client_fd);
+            backend.remove(upstream_fd);
+            close_quiet(client_fd);
+            close_quiet(upstream_fd);
+            continue;
+        }
+        flows[flow_id] = flow;
+    }
+}
+
+// Moves readable bytes from src to dst through dst's inbound pipe without
+// copying them into user space. Stops at EAGAIN, end of stream, or when the
+// pipe is full because dst cannot keep up; the latter pauses reads on src
+// until flush_outq() drains the pipe.
+bool splice_passthrough(PeerState& src, PeerState& dst) {
+    while (true) {
+        if (dst.inbound.full()) {
+            src.read_paused = true;
+            return true;
+        }
+
+        const SpliceStatus status = splice_into_pipe(src.fd, dst.inbound, dst.io);
+        if (status == SpliceStatus::Failed) return false;
+        if (status == SpliceStatus::EndOfStream) {
+            src.read_open = false;
+            dst.shutdown_when_drained = true;
+            return true;
+        }
+        if (status == SpliceStatus::WouldBlock) return true;
+
+        if (!dst.connecting && dst.write_open) {
+            if (splice_from_pipe(dst.inbound, dst.fd, dst.io) == FlushStatus::Failed) return false;
+        }
+    }
+}
+
+// Returns false when the flow hit a fatal socket error and must be closed.
+bool handle_peer_event(FlowState& flow,
+                       bool is_client,
+                       const IoEvent& event,
+                       const ProxyConfig& cfg,
+                       const std::shared_ptr<const PluginRegistry>& registry,
+                       AuditTrail& audit,
+                       std::vector<byte>& read_buffer) {
+    PeerState& src = is_client ? flow.client : flow.upstream;
+    PeerState& dst = is_client ? flow.upstream : flow.client;
+    const Direction direction = is_client ? Direction::ClientToServer : Direction::ServerToClient;
+
+    if (event.error && !src.connecting) {
+        // Zero-copy completions arrive on the error queue and raise POLLERR
+        // without any socket error; only a pending SO_ERROR is fatal.
+        if (!src.zerocopy.enabled) return false;
+        reap_zerocopy_completions(src.fd, src.zerocopy, src.io);
+        int so_error = 0;
+        socklen_t len = sizeof(so_error);
+        if (getsockopt(src.fd, SOL_SOCKET, SO_ERROR, &so_error, &len) != 0 || so_error != 0) {
+            return false;
+        }
+    }
+
+    if ((event.writable || event.error) && src.connecting) {
+        int so_error = 0;
+        socklen_t len = sizeof(so_error);
+        if (getsockopt(src.fd, SOL_SOCKET, SO_ERROR, &so_error, &len) != 0 || so_error != 0) {
+            return false;
+        }
+        src.connecting = false;
+    }
+
+    if (event.readable && src.read_open && !src.connecting && src.passthrough && src.pending.empty() && dst.outq.empty()) {
+        if (!splice_passthrough(src, dst)) return false;
+    } else if (event.readable && src.read_open && !src.connecting) {
+        while (true) {
+            const ssize_t received = ::recv(src.fd, read_buffer.data(), read_buffer.size(), 0);
+            if (received > 0) {
+                src.pending.append(read_buffer.data(), static_cast<std::size_t>(received));
+                process_pending(flow, src, dst, direction, cfg, registry, audit);
+                if (apply_flow_backpressure(flow, src, dst, direction, cfg, audit)) break;
+                if (over_global_limit(cfg, flow)) {
+                    // The worker's global gate and budget decide after this
+                    // round; either way the unread bytes must be reported again.
+                    src.rearm = true;
+                    break;
+                }
+                continue;
+            }
+
+            if (received == 0) {
+                flush_pending_on_read_close(flow, src, dst, direction, audit);
+                src.read_open = false;
+                dst.shutdown_when_drained = true;
+                break;
+            }
+
+            if (errno == EINTR) continue;
+            if (errno == EWOULDBLOCK || errno == EAGAIN) break;
+            return false;
+        }
+    }
+
+    if (event.writable && !src.connecting && has_unsent(src)) {
+        if (!flush_outq(src, dst, cfg)) return false;
+    }
+
+    // Write through to the opposite peer right away instead of waiting for
+    // its next writable event. This also keeps edge-triggered backends
+    // correct: every flush ends either drained or at EAGAIN.
+    if (!dst.connecting && dst.write_open && has_unsent(dst)) {
+        if (!flush_outq(dst, src, cfg)) return false;
+    }
+
+    maybe_shutdown_write(src);
+    return true;
+}
+
+// One shard of the transport core. A worker owns its listen socket, event
+// backend, flow table and audit sink; a flow never leaves the worker that
+// accepted it, so per-flow state is never shared across threads. The plugin
+// registry is shared read-only through `rules` and may be replaced by a
+// reload at any time.
+// Flow ids are handed out as first_flow_id + k * flow_id_stride so they stay
+// unique across shards; see FlowIdSequence for the wrap rules.
+int run_worker(const ProxyConfig& cfg,
+               const PluginRegistryCell& rules,
+               MemoryAccountant& memory,
+               WorkerMetrics& metrics,
+               SocketIndex* pid_index,
+               int listen_fd,
+               std::uint32_t first_flow_id,
+               std::uint32_t flow_id_stride) {
+    std::string backend_error;
+    std::unique_ptr<EventBackend> backend = make_event_backend(cfg.event_backend, backend_error);
+    if (!backend) {
+        std::fprintf(stderr, "Failed to create event backend: %s\n", backend_error.c_str());
+        close_quiet(listen_fd);
         return 1;
     }
+    if (!backend->add(listen_fd, kListenToken, kInterestRead)) {
+        std::fprintf(stderr, "Failed to register listen socket with %s: %s\n", backend->name(), last_err().c_str());
+        close_quiet(listen_fd);
+        return 1;
+    }
+
+    if (g_shutdown_pipe[0] >= 0) backend->add(g_shutdown_pipe[0], kShutdownToken, kInterestRead);
 
-    PluginRegistry registry(make_mutation_config(cfg));
+    std::uint64_t rules_generation = 0;
+    std::shared_ptr<const PluginRegistry> registry = rules.load(rules_generation);
+    WorkerMetrics::set(metrics.rules_generation, rules_generation);
     AuditTrail audit(cfg.audit_log_path,
                      cfg.action_log_path,
                      cfg.audit_json_path,
                      cfg.action_json_path,
-                     cfg.review_queue_dir);
+                     cfg.review_queue_dir,
+                     make_audit_writer_options(cfg),
+                     cfg.audit_binary_path);
+    audit.set_capture_policies(cfg.capture_policies);
 
     std::unordered_map<std::uint32_t, FlowState> flows;
-    std::unordered_map<int, FdContext> fd_contexts;
-    std::uint32_t next_flow_id = 1;
+    FlowIdSequence flow_ids(first_flow_id, flow_id_stride);
 
     std::vector<byte> read_buffer(cfg.max_chunk);
-
-    while (true) {
-        std::vector<pollfd> pollfds;
-        pollfds.reserve(1 + flows.size() * 2);
-        pollfd listen_pfd;
-        listen_pfd.fd = listen_fd;
-        listen_pfd.events = POLLIN;
-        listen_pfd.revents = 0;
-        pollfds.push_back(listen_pfd);
-
-        for (std::unordered_map<std::uint32_t, FlowState>::iterator it = flows.begin(); it != flows.end(); ++it) {
-            FlowState& flow = it->second;
-
-            pollfd client_pfd;
-            client_pfd.fd = flow.client.fd;
-            client_pfd.events = 0;
-            if (flow.client.read_open) client_pfd.events |= POLLIN;
-            if (flow.client.connecting || !flow.client.outq.empty()) client_pfd.events |= POLLOUT;
-            client_pfd.revents = 0;
-            pollfds.push_back(client_pfd);
-
-            pollfd upstream_pfd;
-            upstream_pfd.fd = flow.upstream.fd;
-            upstream_pfd.events = 0;
-            if (flow.upstream.read_open && !flow.upstream.connecting) upstream_pfd.events |= POLLIN;
-            if (flow.upstream.connecting || !flow.upstream.outq.empty()) upstream_pfd.events |= POLLOUT;
-            upstream_pfd.revents = 0;
-            pollfds.push_back(upstream_pfd);
+    std::vector<IoEvent> events;
+    std::vector<std::uint32_t> touched;
+    std::vector<std::uint32_t> forced;
+    bool stopping = false;
+    IoCounters worker_c2s;
+    IoCounters worker_s2c;
+    ZeroCopyGraveyard graveyard;
+
+    HoldTimerQueue hold_timers;
+    const WaterMarks global_marks = global_water_marks(cfg);
+    BackpressureGate global_gate;
+    FlowContext worker_context;
+    // The audit backlog belongs to the worker, not to any one flow.
+    MemoryCharge audit_memory;
+
+    while (!stopping) {
+        int timeout_ms = next_wait_timeout(hold_timers);
+        if (global_gate.paused() && (timeout_ms < 0 || timeout_ms > kGlobalBackpressureRecheckMs)) {
+            timeout_ms = kGlobalBackpressureRecheckMs;
         }
-
-        const int ready = ::poll(pollfds.data(), pollfds.size(), -1);
+        if (!graveyard.empty() && (timeout_ms < 0 || timeout_ms > kZeroCopyReapMs)) timeout_ms = kZeroCopyReapMs;
+        const int ready = backend->wait(events, timeout_ms);
         if (ready < 0) {
             if (errno == EINTR) continue;
-            std::fprintf(stderr, "poll failed: %s\n", last_err().c_str());
+            std::fprintf(stderr, "%s wait failed: %s\n", backend->name(), last_err().c_str());
             break;
         }
 
-        for (std::size_t i = 0; i < pollfds.size(); ++i) {
-            const pollfd& pfd = pollfds[i];
-            if (pfd.revents == 0) continue;
-
-            if (pfd.fd == listen_fd) {
-                while (true) {
-                    sockaddr_storage address;
-                    socklen_t address_len = sizeof(address);
-                    const int client_fd = ::accept(listen_fd, reinterpret_cast<sockaddr*>(&address), &address_len);
-                    if (client_fd < 0) {
-                        if (errno == EWOULDBLOCK || errno == EAGAIN) break;
-                        std::fprintf(stderr, "accept failed: %s\n", last_err().c_str());
-                        break;
-                    }
-
-                    if (set_nonblocking(client_fd) != 0) {
-                        close_quiet(client_fd);
-                        continue;
-                    }
-
-                    bool connecting = false;
-                    const int upstream_fd = connect_upstream(cfg.upstream_host, cfg.upstream_port, connecting);
-                    if (upstream_fd < 0) {
-                        close_quiet(client_fd);
-                        continue;
-                    }
-
-                    FlowState flow;
-                    flow.context.flow_id = next_flow_id++;
-                    flow.context.preferred_plugin = cfg.protocol_hint;
-                    flow.client.fd = client_fd;
-                    flow.upstream.fd = upstream_fd;
-                    flow.upstream.connecting = connecting;
-
-                    fd_contexts[client_fd] = FdContext{flow.context.flow_id, true};
-                    fd_contexts[upstream_fd] = FdContext{flow.context.flow_id, false};
-                    flows[flow.context.flow_id] = flow;
-                }
+        // Checked after the wait, so the events it returns already see rules
+        // published while it slept.
+        if (rules.generation() != rules_generation) {
+            registry = rules.load(rules_generation);
+            WorkerMetrics::set(metrics.rules_generation, rules_generation);
+            record_protocol_event(audit,
+                                  worker_context,
+                                  Direction::ClientToServer,
+                                  "transport-core",
+                                  AuditEventType::RulesReloaded,
+                                  "generation=" + std::to_string(rules_generation) + " flows=" + std::to_string(flows.size()),
+                                  ByteView(),
+                                  ByteView());
+        }
+
+        graveyard.reap();
+        touched.clear();
+        for (std::size_t i = 0; i < events.size(); ++i) {
+            const IoEvent& event = events[i];
+            if (event.token == kListenToken) {
+                accept_clients(listen_fd, cfg, *backend, flows, flow_ids, memory, pid_index, metrics, global_gate.paused());
                 continue;
             }
+            if (event.token == kShutdownToken) {
+                stopping = true;
+                break;
+            }
+            const std::uint32_t flow_id = static_cast<std::uint32_t>(event.token >> 1U);
+            std::unordered_map<std::uint32_t, FlowState>::iterator flow_it = flows.find(flow_id);
+            if (flow_it == flows.end()) continue;
 
-            std::unordered_map<int, FdContext>::iterator ctx_it = fd_contexts.find(pfd.fd);
-            if (ctx_it == fd_contexts.end()) continue;
+            const bool is_client = (event.token & 1U) != 0;
+            if (!handle_peer_event(flow_it->second, is_client, event, cfg, registry, audit, read_buffer)) {
+                close_flow(flows, *backend, graveyard, audit, worker_c2s, worker_s2c, flow_id);
+                continue;
+            }
+            touched.push_back(flow_id);
+        }
 
-            std::unordered_map<std::uint32_t, FlowState>::iterator flow_it = flows.find(ctx_it->second.flow_id);
+        // Flush held tails whose deadline passed without new bytes.
+        const std::uint64_t now = now_ms();
+        while (!stopping && !hold_timers.empty() && hold_timers.top().deadline_ms <= now) {
+            const HoldTimer timer = hold_timers.top();
+            hold_timers.pop();
+            const std::uint32_t flow_id = static_cast<std::uint32_t>(timer.token >> 1U);
+            std::unordered_map<std::uint32_t, FlowState>::iterator flow_it = flows.find(flow_id);
             if (flow_it == flows.end()) continue;
 
             FlowState& flow = flow_it->second;
-            PeerState& src = ctx_it->second.is_client ? flow.client : flow.upstream;
-            PeerState& dst = ctx_it->second.is_client ? flow.upstream : flow.client;
-            const Direction direction = ctx_it->second.is_client ? Direction::ClientToServer : Direction::ServerToClient;
-
-            if (pfd.revents & (POLLERR | POLLNVAL)) {
-                close_flow(flows, fd_contexts, flow.context.flow_id);
+            const bool is_client = (timer.token & 1U) != 0;
+            PeerState& src = is_client ? flow.client : flow.upstream;
+            PeerState& dst = is_client ? flow.upstream : flow.client;
+            if (src.hold_deadline_ms != timer.deadline_ms) continue;
+
+            flush_held_pending(flow,
+                               src,
+                               dst,
+                               is_client ? Direction::ClientToServer : Direction::ServerToClient,
+                               audit,
+                               AuditEventType::HoldDeadlineFlush,
+                               "released held bytes after the hold deadline");
+            if (!dst.connecting && dst.write_open && has_unsent(dst) && !flush_outq(dst, src, cfg)) {
+                close_flow(flows, *backend, graveyard, audit, worker_c2s, worker_s2c, flow_id);
                 continue;
             }
+            touched.push_back(flow_id);
+        }
 
-            if ((pfd.revents & POLLOUT) && src.connecting) {
-                int so_error = 0;
-                socklen_t len = sizeof(so_error);
-                if (getsockopt(src.fd, SOL_SOCKET, SO_ERROR, &so_error, &len) != 0 || so_error != 0) {
-                    close_flow(flows, fd_contexts, flow.context.flow_id);
-                    continue;
-                }
-                src.connecting = false;
+        // Only flows that saw an event this round can have changed interest
+        // or finished; everything else keeps its existing registration.
+        for (std::size_t i = 0; i < touched.size(); ++i) {
+            std::unordered_map<std::uint32_t, FlowState>::iterator it = flows.find(touched[i]);
+            if (it == flows.end()) continue;
+            FlowState& flow = it->second;
+            maybe_shutdown_write(flow.client);
+            maybe_shutdown_write(flow.upstream);
+            if (flow_finished(flow)) {
+                close_flow(flows, *backend, graveyard, audit, worker_c2s, worker_s2c, touched[i]);
+                continue;
             }
+            charge_flow_memory(flow);
+            report_flow_metrics(flow);
+            apply_flow_backpressure(flow, flow.client, flow.upstream, Direction::ClientToServer, cfg, audit);
+            apply_flow_backpressure(flow, flow.upstream, flow.client, Direction::ServerToClient, cfg, audit);
+            sync_interest(*backend, flow.client, peer_token(touched[i], true), global_gate.paused());
+            sync_interest(*backend, flow.upstream, peer_token(touched[i], false), global_gate.paused());
+            schedule_hold(hold_timers, flow.client, peer_token(touched[i], true));
+            schedule_hold(hold_timers, flow.upstream, peer_token(touched[i], false));
+        }
 
-            if ((pfd.revents & POLLIN) && src.read_open) {
-                while (true) {
-                    const ssize_t received = ::recv(src.fd, read_buffer.data(), read_buffer.size(), 0);
-                    if (received > 0) {
-                        src.pending.insert(src.pending.end(), read_buffer.begin(), read_buffer.begin() + received);
-                        process_pending(flow, src, dst, direction, cfg, registry, audit);
-                        continue;
-                    }
-
-                    if (received == 0) {
-                        flush_pending_on_read_close(flow, src, dst, direction, audit);
-                        src.read_open = false;
-                        dst.shutdown_when_drained = true;
-                        break;
-                    }
-
-                    if (errno == EWOULDBLOCK || errno == EAGAIN) break;
-                    close_flow(flows, fd_contexts, flow.context.flow_id);
-                    break;
-                }
-            }
+        memory.set(audit_memory, MemoryCategory::Audit, audit.queued_bytes());
+        WorkerMetrics::set(metrics.active_flows, flows.size());
+        WorkerMetrics::set(metrics.audit_backlog, audit.backlog());
+        WorkerMetrics::set(metrics.audit_dropped, audit.stats().dropped);
+        forced.clear();
+        enforce_memory_budget(flows, memory, cfg, audit, forced);
+        for (std::size_t i = 0; i < forced.size(); ++i) {
+            FlowState& flow = flows[forced[i]];
+            charge_flow_memory(flow);
+            sync_interest(*backend, flow.client, peer_token(forced[i], true), global_gate.paused());
+            sync_interest(*backend, flow.upstream, peer_token(forced[i], false), global_gate.paused());
+        }
 
-            if ((pfd.revents & POLLOUT) && !src.outq.empty()) {
-                if (!flush_outq(src)) {
-                    close_flow(flows, fd_contexts, flow.context.flow_id);
-                    continue;
+        // The global gate pauses or resumes reads on every flow this worker
+        // owns; only transitions touch the registrations.
+        const std::size_t queued = memory.total(MemoryCategory::OutQueue);
+        if (!stopping && global_gate.update(queued, global_marks)) {
+            record_protocol_event(audit,
+                                  worker_context,
+                                  Direction::ClientToServer,
+                                  "transport-core",
+                                  global_gate.paused() ? AuditEventType::BackpressureGlobalPause : AuditEventType::BackpressureGlobalResume,
+                                  "queued=" + std::to_string(queued) + " high=" + std::to_string(global_marks.high) + " low=" + std::to_string(global_marks.low),
+                                  ByteView(),
+                                  ByteView());
+            for (std::unordered_map<std::uint32_t, FlowState>::iterator it = flows.begin(); it != flows.end(); ++it) {
+                if (!global_gate.paused()) {
+                    it->second.client.rearm = true;
+                    it->second.upstream.rearm = true;
                 }
+                sync_interest(*backend, it->second.client, peer_token(it->first, true), global_gate.paused());
+                sync_interest(*backend, it->second.upstream, peer_token(it->first, false), global_gate.paused());
             }
-
-            maybe_shutdown_write(src);
         }
+    }
+
+    while (!flows.empty()) close_flow(flows, *backend, graveyard, audit, worker_c2s, worker_s2c, flows.begin()->first);
+    graveyard.close_all(kZeroCopyShutdownWaitMs);
+    record_io_stats(audit, worker_context, AuditEventType::WorkerIoStats, worker_c2s, worker_s2c);
+    memory.release(audit_memory);
+    record_protocol_event(audit,
+                          worker_context,
+                          Direction::ClientToServer,
+                          "transport-core",
+                          AuditEventType::WorkerMemoryStats,
+                          memory.summary(),
+                          ByteView(),
+                          ByteView());
+    if (g_shutdown_pipe[0] >= 0) backend->remove(g_shutdown_pipe[0]);
+    backend->remove(listen_fd);
+    close_quiet(listen_fd);
+    return stopping ? 0 : 1;
+}
+
+} // namespace
 
-        std::vector<std::uint32_t> finished;
-        for (std::unordered_map<std::uint32_t, FlowState>::iterator it = flows.begin(); it != flows.end(); ++it) {
-            maybe_shutdown_write(it->second.client);
-            maybe_shutdown_write(it->second.upstream);
-            if (flow_finished(it->second)) finished.push_back(it->first);
+int run_transport_core(const ProxyConfig& cfg) {
+    const unsigned worker_count = cfg.workers == 0 ? 1U : cfg.workers;
+    if ((cfg.flow_high_water_bytes != 0 && cfg.flow_low_water_bytes > cfg.flow_high_water_bytes)
+        || (cfg.global_high_water_bytes != 0 && cfg.global_low_water_bytes > cfg.global_high_water_bytes)) {
+        std::fprintf(stderr, "low-water marks must not exceed their high-water marks\n");
+        return 1;
+    }
+
+    install_shutdown_handler();
+    std::shared_ptr<const PluginRegistry> registry;
+    try {
+        registry = std::make_shared<const PluginRegistry>(make_mutation_config(cfg));
+    } catch (const std::exception& error) {
+        std::fprintf(stderr, "Invalid mutation rules: %s\n", error.what());
+        return 1;
+    }
+    PluginRegistryCell rules(registry);
+    registry.reset();
+    // Reloads build and compile the new registry on the watcher's thread;
+    // workers only ever swap a pointer.
+    std::unique_ptr<RulesWatcher> rules_watcher;
+    if (cfg.reload_rules) {
+        install_reload_handler();
+        rules_watcher.reset(new RulesWatcher(rules, [&cfg]() {
+            return std::make_shared<const PluginRegistry>(make_mutation_config(cfg.reload_rules()));
+        }));
+        if (!rules_watcher->start(cfg.rules_path, g_reload_pipe[0])) {
+            std::fprintf(stderr, "rules reload unavailable; SIGHUP and rules file changes are ignored\n");
+            rules_watcher.reset();
+        }
+    }
+    MemoryAccountant memory(cfg.memory_budget_bytes);
+    RelayMetrics metrics(worker_count, &memory);
+    std::unique_ptr<MetricsServer> metrics_server;
+    if (!cfg.metrics_endpoint.empty()) {
+        metrics_server.reset(new MetricsServer(metrics));
+        std::string error;
+        if (!metrics_server->start(cfg.metrics_endpoint, error)) {
+            std::fprintf(stderr, "Failed to start metrics endpoint: %s\n", error.c_str());
+            return 1;
+        }
+    }
+    // One index for every worker; it refreshes on its own thread.
+    std::unique_ptr<SocketIndex> pid_index;
+    if (cfg.pid_index) {
+        pid_index.reset(new SocketIndex());
+        if (!pid_index->start(cfg.pid_index_refresh_ms)) {
+            std::fprintf(stderr, "pid index unavailable (needs NETLINK_SOCK_DIAG); flows will carry no pid_hint\n");
+            pid_index.reset();
         }
-        for (std::size_t i = 0; i < finished.size(); ++i) {
-            close_flow(flows, fd_contexts, finished[i]);
+    }
+
+    std::vector<int> listen_fds;
+    for (unsigned i = 0; i < worker_count; ++i) {
+        const int listen_fd = create_listen_socket(cfg.listen_host, cfg.listen_port, worker_count > 1);
+        if (listen_fd < 0) {
+            std::fprintf(stderr, "Failed to create listen socket on %s:%u%s\n",
+                         cfg.listen_host.c_str(),
+                         static_cast<unsigned>(cfg.listen_port),
+                         worker_count > 1 ? " with SO_REUSEPORT" : "");
+            for (std::size_t j = 0; j < listen_fds.size(); ++j) close_quiet(listen_fds[j]);
+            return 1;
         }
+        listen_fds.push_back(listen_fd);
     }
 
-    close_quiet(listen_fd);
-    return 1;
+    if (worker_count == 1) {
+        return run_worker(cfg, rules, memory, metrics.worker(0), pid_index.get(), listen_fds[0], 1, 1);
+    }
+
+    std::vector<int> results(worker_count, 0);
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < worker_count; ++i) {
+        threads.emplace_back([&cfg, &rules, &memory, &metrics, &pid_index, &results, &listen_fds, i, worker_count]() {
+            results[i] = run_worker(cfg, rules, memory, metrics.worker(i), pid_index.get(), listen_fds[i], i + 1, worker_count);
+        });
+    }
+    int rc = 0;
+    for (unsigned i = 0; i < worker_count; ++i) {
+        threads[i].join();
+        if (results[i] != 0) rc = results[i];
+    }
+    return rc;
 }
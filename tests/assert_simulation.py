@@ -1,5 +1,6 @@
 #!/usr/bin/env python3
 
+import gzip
 import json
 import pathlib
 import re
@@ -12,6 +13,26 @@ def read_text(path: pathlib.Path) -> str:
     return path.read_text()
 
 
+def read_log_stream(path: pathlib.Path) -> str:
+    """Rotated segments (<name>.000001[.gz], ...) oldest first, then the active file."""
+    segments = {}
+    for candidate in path.parent.glob(path.name + ".*"):
+        index = candidate.name[len(path.name) + 1:]
+        compressed = index.endswith(".gz")
+        if compressed:
+            index = index[:-3]
+        if not index.isdigit():
+            continue
+        # A plain copy left beside its .gz is the complete one.
+        if int(index) not in segments or not compressed:
+            segments[int(index)] = candidate
+    text = ""
+    for index in sorted(segments):
+        segment = segments[index]
+        text += gzip.open(segment, "rt").read() if segment.name.endswith(".gz") else segment.read_text()
+    return text + read_text(path)
+
+
 def assert_contains(label: str, text: str, needles: list[str]) -> None:
     for needle in needles:
         if needle not in text:
@@ -40,10 +61,10 @@ def main() -> int:
     host_log = read_text(out_dir / "host.log")
     server_log = read_text(out_dir / "server.log")
     ghostline_log = read_text(out_dir / "ghostline.log")
-    audit_log = read_text(out_dir / "ghostline_audit.log")
-    actions_log = read_text(out_dir / "ghostline_actions.log")
-    audit_json = read_text(out_dir / "ghostline_audit.jsonl")
-    actions_json = read_text(out_dir / "ghostline_actions.jsonl")
+    audit_log = read_log_stream(out_dir / "ghostline_audit.log")
+    actions_log = read_log_stream(out_dir / "ghostline_actions.log")
+    audit_json = read_log_stream(out_dir / "ghostline_audit.jsonl")
+    actions_json = read_log_stream(out_dir / "ghostline_actions.jsonl")
 
     assert_contains("host.log", host_log, fixture.get("host_contains", []))
     assert_contains("server.log", server_log, fixture.get("server_contains", []))
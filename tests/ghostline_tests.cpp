@@ -1,11 +1,43 @@
+#include "core/xxhash64.hpp"
+#include "ghostline/audit.hpp"
+#include "ghostline/audit_binary.hpp"
+#include "ghostline/capture_policy.hpp"
+#include "ghostline/labels.hpp"
+#include "ghostline/log_rotation.hpp"
+#include "ghostline/log_tail.hpp"
 #include "ghostline/plugin.hpp"
 #include "ghostline/pid_search.hpp"
+#include "ghostline/rules_loader.hpp"
+#include "ghostline/rules_reload.hpp"
 #include "ghostline/operator_state.hpp"
-
+#include "ghostline/packet_arena.hpp"
+#include "net/backpressure.hpp"
+#include "net/event_backend.hpp"
+#include "net/flow_ids.hpp"
+#include "net/memory_accountant.hpp"
+#include "net/proxy.hpp"
+#include "net/relay_metrics.hpp"
+#include "net/socket_io.hpp"
+#include "net/stream_buffer.hpp"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstring>
 #include <filesystem>
 #include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
 #include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
 
 namespace {
 
@@ -38,7 +70,7 @@ void test_byte_window_plugin_releases_modified() {
     Candidate candidate = plugin->build_candidate(flow, Direction::ClientToServer, input);
     CandidateDecision decision = plugin->decide(flow, Direction::ClientToServer, candidate);
     expect(decision.release == CandidateRelease::ReleaseModified, "expected modified candidate release");
-    expect(std::string(candidate.modified_bytes.begin(), candidate.modified_bytes.end()) == "HEADNEWTAIL", "expected replacement bytes");
+    expect(std::string(candidate.modified_bytes().begin(), candidate.modified_bytes().end()) == "HEADNEWTAIL", "expected replacement bytes");
 }
 
 void test_observation_plugin_stays_passive() {
@@ -107,6 +139,20 @@ void test_all_named_plugins_are_registered() {
     expect(registry.find_by_name("kafka") != nullptr, "missing kafka plugin");
 }
 
+void test_registry_interns_plugin_ids() {
+    MutationConfig config;
+    PluginRegistry registry(config);
+    for (std::size_t i = 0; i < registry.plugins().size(); ++i) {
+        const ProtocolPlugin& plugin = *registry.plugins()[i];
+        expect(plugin.id() == static_cast<PluginId>(i), "plugin id should be its registry index");
+        expect(registry.get(plugin.id()) == &plugin, "registry lookup by id should round-trip");
+        expect(registry.id_of(plugin.name()) == plugin.id(), "name index should map back to the id");
+        expect(&plugin.name() == &plugin.name(), "plugin name should be a stable reference");
+    }
+    expect(registry.id_of("no-such-plugin") == kNoPluginId, "unknown names should not resolve");
+    expect(registry.get(kNoPluginId) == nullptr, "sentinel id should not resolve");
+}
+
 void test_raw_live_mutation_releases_modified() {
     MutationConfig config;
     config.raw_live_mode = true;
@@ -130,7 +176,198 @@ void test_raw_live_mutation_releases_modified() {
     Candidate candidate = plugin->build_candidate(flow, Direction::ClientToServer, framed.frame_bytes, &framed);
     CandidateDecision decision = plugin->decide(flow, Direction::ClientToServer, candidate);
     expect(decision.release == CandidateRelease::ReleaseModified, "raw-live should release modified bytes");
-    expect(std::string(candidate.modified_bytes.begin(), candidate.modified_bytes.end()) == "new!!!", "raw-live should mutate the live raw chunk");
+    expect(std::string(candidate.modified_bytes().begin(), candidate.modified_bytes().end()) == "new!!!", "raw-live should mutate the live raw chunk");
+}
+
+void test_byte_pattern_engines_agree_with_naive_search() {
+    // Small alphabet so partial first/last-byte hits are common, with
+    // haystack lengths straddling the 16- and 32-byte vector strides.
+    std::uint32_t seed = 12345;
+    const ByteScanEngine engines[] = {ByteScanEngine::Horspool, ByteScanEngine::Sse2, ByteScanEngine::Avx2};
+    for (int round = 0; round < 400; ++round) {
+        ByteVec haystack(static_cast<std::size_t>(round % 97));
+        for (std::size_t i = 0; i < haystack.size(); ++i) {
+            seed = seed * 1103515245u + 12345u;
+            haystack[i] = static_cast<byte>('a' + (seed >> 16) % 3);
+        }
+        const std::size_t needle_size = 1 + static_cast<std::size_t>(round % 5);
+        ByteVec needle(needle_size);
+        for (std::size_t i = 0; i < needle.size(); ++i) {
+            seed = seed * 1103515245u + 12345u;
+            needle[i] = static_cast<byte>('a' + (seed >> 16) % 3);
+        }
+        const BytePattern pattern(needle);
+        const std::size_t offset = static_cast<std::size_t>(round % 7);
+
+        std::size_t expected = std::string::npos;
+        if (offset <= haystack.size()) {
+            ByteVec::const_iterator hit = std::search(haystack.begin() + static_cast<long>(offset), haystack.end(), needle.begin(), needle.end());
+            if (hit != haystack.end()) expected = static_cast<std::size_t>(hit - haystack.begin());
+        }
+        for (const ByteScanEngine engine : engines) {
+            expect(pattern.find(haystack, offset, engine) == expected,
+                   std::string("byte pattern mismatch for engine ") + byte_scan_engine_name(engine));
+        }
+    }
+    expect(BytePattern().find(bytes_from_ascii("abc")) == std::string::npos, "empty pattern should never match");
+}
+
+void test_multi_pattern_prefers_leftmost_longest() {
+    std::vector<ByteVec> patterns;
+    patterns.push_back(bytes_from_ascii("he"));
+    patterns.push_back(bytes_from_ascii("she"));
+    patterns.push_back(bytes_from_ascii("hers"));
+    patterns.push_back(bytes_from_ascii("his"));
+    patterns.push_back(ByteVec());
+    const MultiPattern automaton(patterns);
+    expect(automaton.pattern_count() == 5 && automaton.max_length() == 4, "automaton should keep every pattern slot");
+
+    const PatternMatch first = automaton.find_leftmost(bytes_from_ascii("ushers"));
+    expect(first.found() && first.start == 1 && first.pattern == 1, "leftmost match should be 'she' at offset 1");
+
+    const PatternMatch longest = automaton.find_leftmost(bytes_from_ascii("xhers"));
+    expect(longest.found() && longest.start == 1 && longest.pattern == 2, "longest match at the leftmost offset should win");
+
+    std::vector<PatternMatch> matches;
+    automaton.find_non_overlapping(bytes_from_ascii("she his hers"), matches);
+    expect(matches.size() == 3, "expected three non-overlapping matches");
+    expect(matches[0].pattern == 1 && matches[1].pattern == 3 && matches[2].pattern == 2, "matches should follow haystack order");
+    expect(!automaton.find_leftmost(bytes_from_ascii("nothing")).found(), "unrelated bytes should not match");
+}
+
+void test_rule_lists_drive_raw_live_and_byte_window() {
+    MutationConfig config;
+    config.raw_live_mode = true;
+    config.raw_chunk_bytes = 21;
+    config.raw_find_text = "cat";
+    config.replacement_text = "dog";
+    SubstitutionRule extra;
+    extra.find = bytes_from_ascii("category");
+    extra.replacement = bytes_from_ascii("CLASS");
+    config.substitutions.push_back(extra);
+    extra.find = bytes_from_ascii("mouse");
+    extra.replacement = bytes_from_ascii("hamster");
+    config.substitutions.push_back(extra);
+
+    PluginRegistry registry(config);
+    FlowContext flow;
+    const ProtocolPlugin* raw = registry.find_by_name("raw-live");
+    ByteVec input = bytes_from_ascii("cat category mouse!!");
+    Candidate candidate = raw->build_candidate(flow, Direction::ClientToServer, input);
+    expect(std::string(candidate.modified_bytes().begin(), candidate.modified_bytes().end()) == "dog CLASS hamster!!",
+           "every substitution rule should apply in one pass");
+
+    MutationConfig window_config;
+    MarkerWindowRule rule;
+    rule.start_marker = bytes_from_ascii("<<");
+    rule.end_marker = bytes_from_ascii(">>");
+    rule.replacement_text = "A";
+    window_config.window_rules.push_back(rule);
+    rule.start_marker = bytes_from_ascii("[[");
+    rule.end_marker = bytes_from_ascii("]]");
+    rule.replacement_text = "BB";
+    window_config.window_rules.push_back(rule);
+
+    PluginRegistry window_registry(window_config);
+    const ProtocolPlugin* window_plugin = window_registry.find_by_name("byte-window");
+    expect(window_plugin->matches(flow, Direction::ClientToServer, 0, ByteView()), "window rules alone should enable byte-window");
+    WindowRule configured;
+    expect(window_plugin->configure_window(flow, Direction::ClientToServer, configured) && configured.rules->windows.size() == 2,
+           "byte-window should expose both compiled rules");
+    const PatternMatch head = configured.rules->start_markers.find_leftmost(bytes_from_ascii("xx[[body]]<<"));
+    expect(head.found() && head.start == 2 && head.pattern == 1, "leftmost start marker should select the second rule");
+
+    const ByteVec window = bytes_from_ascii("[[body]]");
+    Candidate window_candidate = window_plugin->build_candidate(flow, Direction::ClientToServer, window);
+    expect(std::string(window_candidate.modified_bytes().begin(), window_candidate.modified_bytes().end()) == "[[BB]]",
+           "window candidate should use its own rule's replacement");
+}
+
+void test_raw_live_end_marker_scan_resumes() {
+    MutationConfig config;
+    config.raw_live_mode = true;
+    config.end_marker = bytes_from_ascii("END");
+    PluginRegistry registry(config);
+    FlowContext flow;
+    flow.preferred_plugin = "raw-live";
+
+    ByteVec input = bytes_from_ascii("payload-E");
+    const ProtocolPlugin* plugin = registry.match(flow, Direction::ClientToServer, 9999, input);
+    expect(plugin != nullptr && plugin->name() == "raw-live", "expected raw-live plugin");
+
+    FramingResult waiting = plugin->frame(flow, Direction::ClientToServer, input);
+    expect(waiting.disposition == FramingDisposition::NeedMoreBytes, "raw-live should wait for the end marker");
+    expect(waiting.resume_offset == input.size() - 2, "resume offset should keep a possible partial marker");
+
+    ByteVec more = bytes_from_ascii("ND-tail");
+    input.insert(input.end(), more.begin(), more.end());
+    FramingResult framed = plugin->frame(flow, Direction::ClientToServer, input, waiting.resume_offset);
+    expect(framed.disposition == FramingDisposition::FramedPacket, "raw-live should frame across the split marker");
+    expect(framed.consumed_bytes == 11, "raw-live frame should end after the marker");
+}
+
+void test_raw_live_stream_holds_only_partial_match_tail() {
+    MutationConfig config;
+    config.raw_live_mode = true;
+    config.raw_stream_mode = true;
+    config.raw_flush_ms = 25;
+    config.raw_find_text = "hello";
+    config.replacement_text = "HOWDY";
+    SubstitutionRule extra;
+    extra.find = bytes_from_ascii("lo");
+    extra.replacement = bytes_from_ascii("LO");
+    config.substitutions.push_back(extra);
+
+    PluginRegistry registry(config);
+    FlowContext flow;
+    const ProtocolPlugin* plugin = registry.find_by_name("raw-live");
+
+    FramingResult framed = plugin->frame(flow, Direction::ClientToServer, bytes_from_ascii("say hel"));
+    expect(framed.disposition == FramingDisposition::FramedPacket && framed.consumed_bytes == 4,
+           "stream framing should hold back only a possible partial match");
+
+    FramingResult held = plugin->frame(flow, Direction::ClientToServer, bytes_from_ascii("hel"));
+    expect(held.disposition == FramingDisposition::NeedMoreBytes && held.hold_deadline_ms == 25,
+           "a possible partial match should be held with the flush deadline");
+
+    const ByteVec segment = bytes_from_ascii("hello, hel");
+    framed = plugin->frame(flow, Direction::ClientToServer, segment);
+    expect(framed.disposition == FramingDisposition::FramedPacket && framed.consumed_bytes == 7,
+           "completed matches should be released while the partial one is held");
+    Candidate candidate = plugin->build_candidate(flow, Direction::ClientToServer, framed.frame_bytes, &framed);
+    expect(std::string(candidate.modified_bytes().begin(), candidate.modified_bytes().end()) == "HOWDY, ", "stream segment should be rewritten inline");
+
+    const ByteVec held_tail = bytes_from_ascii("xlo");
+    FramingResult tail = plugin->flush_held(flow, Direction::ClientToServer, held_tail);
+    expect(tail.disposition == FramingDisposition::FramedPacket && tail.consumed_bytes == 3, "held tail should flush as a final segment");
+    candidate = plugin->build_candidate(flow, Direction::ClientToServer, tail.frame_bytes, &tail);
+    expect(std::string(candidate.modified_bytes().begin(), candidate.modified_bytes().end()) == "xLO", "shorter rules should still apply to the tail");
+}
+
+void test_candidate_views_framed_bytes_until_mutated() {
+    MutationConfig config;
+    config.raw_live_mode = true;
+    config.raw_find_text = "old";
+    config.replacement_text = "new";
+    config.end_marker = bytes_from_ascii("\n");
+
+    PluginRegistry registry(config);
+    FlowContext flow;
+    const ProtocolPlugin* plugin = registry.find_by_name("raw-live");
+
+    const ByteVec quiet = bytes_from_ascii("nothing here\n");
+    FramingResult framed = plugin->frame(flow, Direction::ClientToServer, quiet);
+    expect(framed.frame_bytes.data() == quiet.data(), "framed bytes should view the receive buffer");
+    Candidate candidate = plugin->build_candidate(flow, Direction::ClientToServer, framed.frame_bytes, &framed);
+    expect(!candidate.mutated && candidate.mutated_bytes.empty(), "an unmatched candidate should not copy its bytes");
+    expect(candidate.original_bytes.data() == quiet.data() && candidate.modified_bytes().data() == quiet.data(),
+           "an unmatched candidate should release straight from the receive buffer");
+
+    const ByteVec loud = bytes_from_ascii("old news\n");
+    framed = plugin->frame(flow, Direction::ClientToServer, loud);
+    candidate = plugin->build_candidate(flow, Direction::ClientToServer, framed.frame_bytes, &framed);
+    expect(candidate.mutated && candidate.original_bytes.data() == loud.data(), "a rewrite should keep viewing the original");
+    expect(candidate.modified_bytes().equals(bytes_from_ascii("new news\n")), "a rewrite should own the modified bytes");
 }
 
 void test_raw_live_size_change_can_force_review() {
@@ -180,7 +417,7 @@ void test_raw_live_direction_filter_keeps_original() {
     Candidate candidate = plugin->build_candidate(flow, Direction::ServerToClient, framed.frame_bytes, &framed);
     CandidateDecision decision = plugin->decide(flow, Direction::ServerToClient, candidate);
     expect(decision.release == CandidateRelease::ReleaseOriginal, "raw-live direction filter should keep original");
-    expect(decision.validation_label == "raw-live-direction-filter", "raw-live direction filter label mismatch");
+    expect(decision.validation == ValidationCode::RawLiveDirectionFilter, "raw-live direction filter label mismatch");
 }
 
 void test_raw_live_review_threshold_creates_action_item() {
@@ -250,8 +487,8 @@ void test_mqtt_publish_mutation_reframes_remaining_length() {
     expect(decision.release == CandidateRelease::ReleaseModified, "mqtt publish should release modified candidate");
     expect(candidate.valid, "mqtt publish candidate should validate");
     expect(candidate.allow_size_mutated, "mqtt publish should allow reframed size mutation");
-    expect(candidate.modified_bytes[0] == 0x30, "mqtt fixed header should be preserved");
-    expect(candidate.modified_bytes[1] == static_cast<byte>(2 + 5 + std::string("patched-payload").size()), "mqtt remaining length should be rewritten");
+    expect(candidate.modified_bytes()[0] == 0x30, "mqtt fixed header should be preserved");
+    expect(candidate.modified_bytes()[1] == static_cast<byte>(2 + 5 + std::string("patched-payload").size()), "mqtt remaining length should be rewritten");
 }
 
 void test_mqtt_incomplete_frame_needs_more_bytes() {
@@ -311,7 +548,7 @@ void test_mqtt_direction_filter_keeps_original_publish() {
     Candidate candidate = plugin->build_candidate(flow, Direction::ClientToServer, framed.frame_bytes, &framed);
     CandidateDecision decision = plugin->decide(flow, Direction::ClientToServer, candidate);
     expect(decision.release == CandidateRelease::ReleaseOriginal, "mqtt direction filter should keep original");
-    expect(decision.validation_label == "mqtt-direction-filter", "mqtt direction filter label mismatch");
+    expect(decision.validation == ValidationCode::MqttDirectionFilter, "mqtt direction filter label mismatch");
 }
 
 void test_mqtt_review_threshold_creates_action_item() {
@@ -394,6 +631,111 @@ void test_pid_search_filters_by_process_and_port() {
     expect(filtered[0].sockets[0].state == "ESTABLISHED", "expected established socket");
 }
 
+void test_pid_search_reads_proc_net_tcp() {
+    const std::string root = "/tmp/ghostline_fake_proc";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root + "/net");
+    std::filesystem::create_directories(root + "/4242/fd");
+    std::filesystem::create_directories(root + "/5151/fd");
+
+    std::ofstream(root + "/net/tcp")
+        << "  sl  local_address rem_address   st tx_queue rx_queue tr tm->when retrnsmt   uid  timeout inode\n"
+        << "   0: 0100007F:075B 00000000:0000 0A 00000000:00000000 00:00000000 00000000   501        0 1001 1 0 100 0 0 10 0\n"
+        << "   1: 0100007F:075B 0100007F:F230 01 00000000:00000000 00:00000000 00000000   501        0 1002 1 0 20 4 30 10 -1\n"
+        << "   2: 0100007F:F231 0100007F:075B 06 00000000:00000000 03:00000000 00000000     0        0 0 3 0\n";
+    std::ofstream(root + "/net/tcp6")
+        << "  sl  local_address                         remote_address                        st tx_queue rx_queue tr tm->when retrnsmt   uid  timeout inode\n"
+        << "   0: 00000000000000000000000000000000:1F90 00000000000000000000000000000000:0000 0A 00000000:00000000 00:00000000 00000000   501        0 2001 1 0 100 0 0 10 0\n";
+    std::ofstream(root + "/4242/comm") << "mosquitto\n";
+    std::ofstream(root + "/5151/comm") << "bash\n";
+    std::filesystem::create_symlink("socket:[1002]", root + "/4242/fd/7");
+    std::filesystem::create_symlink("socket:[1001]", root + "/4242/fd/3");
+    std::filesystem::create_symlink("/dev/null", root + "/4242/fd/0");
+    std::filesystem::create_symlink("socket:[2001]", root + "/5151/fd/4");
+    std::filesystem::create_symlink("pipe:[1001]", root + "/5151/fd/5");
+
+    const auto rows = parse_proc_net_tcp("header\n   0: 0100007F:075B 0100007F:F230 01 0:0 0:0 0 501 0 1002\n", false);
+    expect(rows.size() == 1 && rows[0].inode == 1002, "expected one parsed /proc/net/tcp row");
+    if (rows.size() == 1) {
+        expect(rows[0].socket.endpoint == "127.0.0.1:1883->127.0.0.1:62000" && rows[0].socket.state == "ESTABLISHED", "proc rows should render like lsof endpoints");
+    }
+
+    const auto all = query_proc_tcp_processes(PidSearchQuery(), root);
+    expect(all.size() == 2, "expected both socket-owning processes");
+    if (all.size() == 2) {
+        expect(all[0].pid == 4242 && all[0].command == "mosquitto", "expected processes in pid order with their comm");
+        expect(all[0].sockets.size() == 2 && all[0].sockets[0].file_descriptor == "3" && all[0].sockets[0].is_listen, "expected sockets in fd order");
+        expect(all[0].sockets[0].endpoint == "127.0.0.1:1883" && all[0].sockets[1].has_remote, "expected listen and connected endpoints");
+        expect(all[1].sockets.size() == 1 && all[1].sockets[0].endpoint == "*:8080" && all[1].sockets[0].address_family == "IPv6", "expected wildcard ipv6 listener");
+    }
+
+    PidSearchQuery query;
+    query.process_contains = "mosq";
+    query.established_only = true;
+    const auto filtered = query_proc_tcp_processes(query, root);
+    expect(filtered.size() == 1 && filtered[0].sockets.size() == 1 && filtered[0].sockets[0].remote_port == 62000, "expected proc results to honor the query filters");
+}
+
+void test_socket_index_resolves_local_client_pid() {
+    sockaddr_in v4 {};
+    v4.sin_family = AF_INET;
+    v4.sin_port = htons(5000);
+    v4.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    sockaddr_in6 mapped {};
+    mapped.sin6_family = AF_INET6;
+    mapped.sin6_port = htons(5000);
+    inet_pton(AF_INET6, "::ffff:127.0.0.1", &mapped.sin6_addr);
+    sockaddr_storage plain {};
+    sockaddr_storage dual {};
+    std::memcpy(&plain, &v4, sizeof(v4));
+    std::memcpy(&dual, &mapped, sizeof(mapped));
+    SocketTuple from_v4;
+    SocketTuple from_mapped;
+    expect(make_socket_tuple(plain, plain, from_v4) && make_socket_tuple(dual, dual, from_mapped), "expected tuples for inet addresses");
+    expect(from_mapped.family == 4 && from_mapped.local == from_v4.local && from_mapped.remote_port == 5000, "ipv4-mapped addresses should index as ipv4");
+
+    const int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in bound = v4;
+    bound.sin_port = 0;
+    socklen_t bound_len = sizeof(bound);
+    if (listener < 0 || ::bind(listener, reinterpret_cast<sockaddr*>(&bound), sizeof(bound)) != 0 || ::listen(listener, 4) != 0
+        || ::getsockname(listener, reinterpret_cast<sockaddr*>(&bound), &bound_len) != 0) {
+        if (listener >= 0) ::close(listener);
+        return;
+    }
+    const int client = ::socket(AF_INET, SOCK_STREAM, 0);
+    expect(client >= 0 && ::connect(client, reinterpret_cast<sockaddr*>(&bound), sizeof(bound)) == 0, "expected loopback connect");
+    const int accepted = ::accept(listener, nullptr, nullptr);
+
+    SocketIndex index;
+    // Sandboxes without NETLINK_SOCK_DIAG leave nothing to check here.
+    if (index.refresh()) {
+        sockaddr_storage local {};
+        sockaddr_storage remote {};
+        socklen_t local_len = sizeof(local);
+        socklen_t remote_len = sizeof(remote);
+        ::getsockname(client, reinterpret_cast<sockaddr*>(&local), &local_len);
+        ::getpeername(client, reinterpret_cast<sockaddr*>(&remote), &remote_len);
+        SocketTuple tuple;
+        expect(make_socket_tuple(local, remote, tuple), "expected a tuple for the client socket");
+        expect(index.owner_of(tuple) == ::getpid(), "client socket should resolve to this process");
+        expect(index.owner_of(from_v4) == -1, "unknown tuple should have no owner");
+
+        PidSearchQuery query;
+        query.port = ntohs(bound.sin_port);
+        query.listen_only = true;
+        const auto listeners = index.query(query);
+        expect(listeners.size() == 1 && listeners[0].pid == ::getpid() && listeners[0].sockets.size() == 1, "index query should find the listener");
+        if (listeners.size() == 1 && listeners[0].sockets.size() == 1) {
+            expect(listeners[0].sockets[0].file_descriptor == std::to_string(listener), "expected the listener fd");
+        }
+    }
+
+    if (accepted >= 0) ::close(accepted);
+    if (client >= 0) ::close(client);
+    ::close(listener);
+}
+
 void test_pid_search_json_contains_core_fields() {
     ProcessSocketEntry process;
     process.pid = 3860;
@@ -491,17 +833,1108 @@ void test_review_queue_save_update_and_replay() {
     expect(items[0].review_status == "pending", "expected pending status");
 
     update_review_item(queue_dir, "action-1-3", "approved", "looks good");
-    ActionItem approved = load_review_item(queue_dir + "/action-1-3.json");
+    ActionItem approved;
+    expect(find_review_item(queue_dir, "action-1-3", approved), "expected saved review item");
     expect(approved.review_status == "approved", "expected approved status");
     expect(approved.decision_note == "looks good", "expected approval note");
 
     const std::string replay_path = replay_review_item(queue_dir, "action-1-3", replay_dir, "replay now");
     expect(std::filesystem::exists(replay_path), "expected replay artifact");
-    ActionItem replayed = load_review_item(queue_dir + "/action-1-3.json");
+    ActionItem replayed;
+    expect(find_review_item(queue_dir, "action-1-3", replayed), "expected replayed review item");
     expect(replayed.review_status == "replayed", "expected replayed status");
     expect(replayed.replay_count == 1, "expected replay count");
 }
 
+void test_review_journal_pages_compacts_and_migrates() {
+    const std::string queue_dir = "/tmp/ghostline_review_journal_test";
+    std::filesystem::remove_all(queue_dir);
+    std::filesystem::create_directories(queue_dir);
+
+    // A queue from before the journal: one file per item.
+    ActionItem legacy;
+    legacy.action_id = "action-0-1";
+    legacy.plugin_name = "raw-live";
+    legacy.title = "Legacy item";
+    {
+        std::ofstream out(queue_dir + "/action-0-1.json");
+        out << action_item_to_json(legacy);
+    }
+
+    {
+        ReviewJournal journal(queue_dir);
+        expect(!std::filesystem::exists(queue_dir + "/action-0-1.json"), "expected legacy item file removed after import");
+        ActionItem imported;
+        expect(journal.get("action-0-1", imported) && imported.title == "Legacy item", "expected legacy item imported");
+
+        for (int i = 0; i < 10; ++i) {
+            ActionItem item;
+            item.action_id = "action-1-" + std::to_string(10 + i);
+            item.plugin_name = i % 2 == 0 ? "mqtt" : "raw-live";
+            item.title = "item " + std::to_string(i);
+            journal.put(item);
+        }
+        ActionItem item;
+        expect(journal.get("action-1-12", item), "expected item lookup");
+        item.review_status = "approved";
+        journal.put(item);
+        expect(journal.superseded_lines() == 1, "expected one superseded line");
+
+        ReviewFilter pending;
+        pending.status = "pending";
+        ReviewPage page = journal.page(pending, 2, 3);
+        expect(page.total == 10, "expected ten pending items");
+        expect(page.items.size() == 3 && page.items[0].action_id == "action-1-11" && page.items[2].action_id == "action-1-14",
+               "expected the third to fifth pending items in id order");
+
+        ReviewFilter mqtt_approved;
+        mqtt_approved.status = "approved";
+        mqtt_approved.plugin = "mqtt";
+        page = journal.page(mqtt_approved, 0, 0);
+        expect(page.total == 1 && page.items[0].action_id == "action-1-12", "expected one approved mqtt item");
+
+        journal.compact();
+        expect(journal.superseded_lines() == 0 && journal.live_items() == 11, "expected compaction to keep live items only");
+        expect(journal.get("action-1-12", item) && item.review_status == "approved", "expected latest state after compaction");
+    }
+
+    // A second instance sees what the first wrote, as another process would,
+    // and a torn trailing line does not swallow the next append.
+    {
+        std::ofstream out(queue_dir + "/review_journal.jsonl", std::ios::app);
+        out << "{\"action_id\":\"action-9";
+    }
+    ReviewJournal reopened(queue_dir);
+    expect(reopened.live_items() == 11, "expected reopened journal to index every item");
+    ActionItem late;
+    late.action_id = "action-2-1";
+    reopened.put(late);
+    ReviewJournal third(queue_dir);
+    expect(third.get("action-2-1", late) && third.live_items() == 12, "expected append after a torn line to be indexed");
+}
+
+void test_log_line_index_follows_appends_and_rotation() {
+    const std::string dir = "/tmp/ghostline_log_tail_test";
+    const std::string path = dir + "/audit.jsonl";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    auto append = [&path](const std::string& text) {
+        std::ofstream out(path, std::ios::app | std::ios::binary);
+        out << text;
+    };
+
+    append("{\"seq\":1}\n\n{\"seq\":2}\r\n{\"seq\":3");
+    LogLineIndex index(path);
+    expect(index.size() == 2, "expected complete non-empty lines indexed");
+    expect(index.line(0) == "{\"seq\":1}" && index.line(1) == "{\"seq\":2}", "expected lines without newlines");
+
+    const int watch_fd = index.watch();
+    append("}\n{\"seq\":4}\n");
+#if defined(__linux__)
+    expect(watch_fd >= 0, "expected an inotify watch on linux");
+    pollfd ready{watch_fd, POLLIN, 0};
+    expect(::poll(&ready, 1, 1000) == 1, "expected the watch to fire on append");
+    index.drain_watch();
+#else
+    (void)watch_fd;
+#endif
+    expect(index.refresh() == 2 && index.line(2) == "{\"seq\":3}" && index.line(3) == "{\"seq\":4}",
+           "expected the partial line completed and the next one added");
+
+    // Rotate the way LogRotator does: rename away, then a new active file.
+    append("{\"seq\":5}\n");
+    std::filesystem::rename(path, log_segment_path(path, 1));
+    append("{\"seq\":6}\n");
+    expect(index.refresh() == 2 && index.size() == 6, "expected lines from the rotated and new active files");
+    expect(index.line(4) == "{\"seq\":5}" && index.line(5) == "{\"seq\":6}", "expected rotation to keep write order");
+
+    // Two rotations between refreshes: segment 3 was never the active file
+    // while the index looked.
+    append("{\"seq\":7}\n");
+    std::filesystem::rename(path, log_segment_path(path, 2));
+    append("{\"seq\":8}\n");
+    std::filesystem::rename(path, log_segment_path(path, 3));
+    append("{\"seq\":9}\n");
+    expect(index.refresh() == 3 && index.size() == 9, "expected every segment rotated between refreshes indexed");
+    expect(index.line(6) == "{\"seq\":7}" && index.line(7) == "{\"seq\":8}" && index.line(8) == "{\"seq\":9}",
+           "expected skipped segments in write order");
+
+    LogLineIndex reopened(path);
+    expect(reopened.size() == 9 && reopened.line(8) == "{\"seq\":9}", "expected segments indexed oldest first");
+    append("{\"seq\":10}\n");
+    std::filesystem::rename(path, log_segment_path(path, 4));
+    append("{\"seq\":11}\n");
+    std::filesystem::rename(path, log_segment_path(path, 5));
+    expect(reopened.refresh() == 2 && reopened.line(10) == "{\"seq\":11}", "expected rotation followed without a new active file");
+}
+
+void test_rules_loader_resolves_example_rules() {
+    const std::string root = GHOSTLINE_SOURCE_DIR;
+    auto contains = [](const std::vector<std::string>& args, const std::vector<std::string>& expected) {
+        for (const auto& item : expected) {
+            if (std::find(args.begin(), args.end(), item) == args.end()) return false;
+        }
+        return true;
+    };
+
+    const auto json_args = resolve_rules_args(root + "/examples/rules/raw-live.json", {});
+    expect(contains(json_args, {"--protocol-hint", "raw-live", "--raw-live", "--raw-find-text", "hello", "--actions-json", "ghostline_actions.jsonl"}),
+           "expected json rules flags");
+
+    const auto jinja_args = resolve_rules_args(root + "/examples/rules/mqtt_publish.jinja",
+                                               {"replacement_text=patched-payload", "mqtt_review_threshold=8",
+                                                "audit_json_path=a.jsonl", "action_json_path=b.jsonl"});
+    expect(contains(jinja_args, {"--protocol-hint", "mqtt", "--replace-text", "patched-payload", "--mqtt-review-threshold", "8"}),
+           "expected jinja rules flags");
+    bool missing_var = false;
+    try {
+        resolve_rules_args(root + "/examples/rules/mqtt_publish.jinja", {"replacement_text=x"});
+    } catch (const std::runtime_error& error) {
+        missing_var = std::string(error.what()).find("missing template variable") != std::string::npos;
+    }
+    expect(missing_var, "expected a missing template variable to throw");
+
+    const auto hcl_args = resolve_rules_args(root + "/examples/rules/raw-live.tfvars", {});
+    expect(contains(hcl_args, {"--protocol-hint", "raw-live", "--raw-live", "--raw-chunk-bytes", "1024", "--audit-json", "ghostline_audit.jsonl"}),
+           "expected hcl rules flags");
+
+    const auto multi_args = resolve_rules_args(root + "/examples/rules/multi-rule.json", {});
+    expect(contains(multi_args, {"--substitute", "hello=patch", "alpha-token=bravo-token", "root=nobody", "--window-rule", "3c3c:3e3e:masked", "5b5b:5d5d"}),
+           "expected multi rules flags");
+
+    // Flag order follows the rules key order; the last duplicate key wins.
+    const RuleValue captures = parse_rules_json("{\"capture_policies\": {\"*\": \"head:64\", \"mqtt\": \"full\", \"mqtt\": \"hash\"}, \"replace_text\": \"caf\\u00e9\\n\"}");
+    const std::vector<std::string> capture_args = rules_to_args(captures);
+    const std::vector<std::string> expected = {"--replace-text", "caf\xc3\xa9\n", "--capture", "head:64", "--capture", "mqtt=hash"};
+    expect(capture_args == expected, "expected capture flags in key order and decoded escapes");
+
+    const RuleValue hcl = parse_rules_hcl("# comment\nworkers = 007 // inline\nsplice_passthrough = false,\nlisten_port = 7777\n");
+    expect(hcl.find("workers") != nullptr && hcl.find("workers")->as_arg() == "7", "expected hcl integers normalized");
+    bool partial_positional = false;
+    try {
+        rules_to_args(hcl);
+    } catch (const std::runtime_error&) {
+        partial_positional = true;
+    }
+    expect(partial_positional, "expected partial listen/upstream keys to throw");
+    expect(render_rules_template("{{{ a }}-{{b}}-{{ c d }}", {{"a", "1"}, {"b", "2"}}) == "{1-2-{{ c d }}", "expected placeholder matching");
+}
+
+void test_rules_watcher_swaps_registry_on_change_and_trigger() {
+    const std::string dir = "/tmp/ghostline_rules_reload_test";
+    const std::string path = dir + "/rules.json";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    // Editors save by writing a new file and renaming it over the old one.
+    auto save = [&dir, &path](const std::string& text) {
+        {
+            std::ofstream out(dir + "/rules.json.tmp", std::ios::binary);
+            out << text;
+        }
+        std::filesystem::rename(dir + "/rules.json.tmp", path);
+    };
+    auto wait_for_generation = [](const PluginRegistryCell& cell, std::uint64_t generation) {
+        for (int i = 0; i < 300 && cell.generation() < generation; ++i) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        return cell.generation() == generation;
+    };
+
+    save("{\"raw_find_text\": \"alpha\"}");
+    std::string loaded_find;
+    auto rebuild = [&path, &loaded_find]() {
+        std::ifstream in(path, std::ios::binary);
+        const std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        MutationConfig config;
+        config.raw_live_mode = true;
+        config.raw_find_text = parse_rules_json(text).find("raw_find_text")->as_arg();
+        loaded_find = config.raw_find_text;
+        return std::make_shared<const PluginRegistry>(config);
+    };
+
+    PluginRegistryCell cell(rebuild());
+    std::uint64_t generation = 0;
+    const std::shared_ptr<const PluginRegistry> first = cell.load(generation);
+    expect(generation == 1 && first->find_by_name("raw-live") != nullptr, "expected the startup registry at generation 1");
+
+    int trigger[2];
+    expect(::pipe(trigger) == 0, "expected a trigger pipe");
+    RulesWatcher watcher(cell, rebuild);
+    expect(watcher.start(path, trigger[0]), "expected the watcher to start");
+
+    save("{\"raw_find_text\": \"bravo\"}");
+    expect(wait_for_generation(cell, 2) && loaded_find == "bravo", "expected a rules file change to publish a new registry");
+    const std::shared_ptr<const PluginRegistry> second = cell.load(generation);
+    expect(second != first && first->find_by_name("raw-live") != nullptr, "expected the old registry to stay valid for its holders");
+
+    const char byte = 1;
+    expect(::write(trigger[1], &byte, 1) == 1, "expected a trigger write");
+    expect(wait_for_generation(cell, 3), "expected the trigger to reload unchanged rules");
+
+    // A rebuild that throws keeps the current rules.
+    save("{\"raw_find_text\": ");
+    std::this_thread::sleep_for(std::chrono::milliseconds(400));
+    std::string error;
+    expect(cell.generation() == 3 && !watcher.reload(error) && !error.empty(), "expected malformed rules to keep the current registry");
+
+    watcher.stop();
+    ::close(trigger[0]);
+    ::close(trigger[1]);
+}
+
+void test_event_backends_ignore_a_removed_registration_on_fd_reuse() {
+    const EventBackendKind kinds[] = {EventBackendKind::Poll, EventBackendKind::Epoll, EventBackendKind::EpollEdge, EventBackendKind::IoUring};
+    for (EventBackendKind kind : kinds) {
+        if (!event_backend_available(kind)) continue;
+        std::string error;
+        std::unique_ptr<EventBackend> backend = make_event_backend(kind, error);
+        expect(backend != nullptr, std::string("expected backend ") + event_backend_name(kind) + ": " + error);
+        const std::string name = event_backend_name(kind);
+
+        int first[2];
+        expect(::socketpair(AF_UNIX, SOCK_STREAM, 0, first) == 0, "socketpair failed");
+        expect(backend->add(first[0], 1, kInterestRead), "expected read registration");
+        std::vector<IoEvent> events;
+        expect(backend->wait(events, 0) == 0, name + " reported readiness on an idle socket");
+        backend->remove(first[0]);
+        const int reused = first[0];
+        ::close(first[0]);
+
+        // The lowest free fd number comes back, as it does for accepted sockets.
+        int second[2];
+        expect(::socketpair(AF_UNIX, SOCK_STREAM, 0, second) == 0, "socketpair failed");
+        expect(second[0] == reused || second[1] == reused, "expected the closed fd number to be reused");
+        const int fd = second[0] == reused ? second[0] : second[1];
+        const int peer = fd == second[0] ? second[1] : second[0];
+        expect(backend->add(fd, 2, kInterestRead), "expected read registration on the reused fd");
+        expect(backend->wait(events, 0) == 0, name + " reported the removed registration");
+
+        expect(::write(peer, "x", 1) == 1, "socketpair write failed");
+        for (int round = 0; round < 3; ++round) {
+            expect(backend->wait(events, 1000) == 1, name + " reported the reused fd other than once per wait");
+            expect(events[0].token == 2 && events[0].readable, "expected the new registration's token");
+            if (kind == EventBackendKind::EpollEdge) break;
+        }
+
+        backend->remove(fd);
+        ::close(first[1]);
+        ::close(second[0]);
+        ::close(second[1]);
+    }
+}
+
+void test_event_backends_report_registered_tokens() {
+    const EventBackendKind kinds[] = {EventBackendKind::Poll, EventBackendKind::Epoll, EventBackendKind::EpollEdge, EventBackendKind::IoUring};
+    for (EventBackendKind kind : kinds) {
+        if (!event_backend_available(kind)) continue;
+        std::string error;
+        std::unique_ptr<EventBackend> backend = make_event_backend(kind, error);
+        expect(backend != nullptr, std::string("expected backend ") + event_backend_name(kind) + ": " + error);
+
+        int fds[2];
+        expect(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0, "socketpair failed");
+        expect(backend->add(fds[0], 42, kInterestRead), "expected read registration");
+
+        std::vector<IoEvent> events;
+        expect(backend->wait(events, 0) == 0, std::string(event_backend_name(kind)) + " reported readiness on an idle socket");
+
+        expect(::write(fds[1], "x", 1) == 1, "socketpair write failed");
+        expect(backend->wait(events, 1000) == 1, std::string(event_backend_name(kind)) + " missed readable socket");
+        expect(events[0].token == 42 && events[0].readable, "expected readable event with registered token");
+
+        expect(backend->modify(fds[0], 43, kInterestRead | kInterestWrite), "expected interest update");
+        expect(backend->wait(events, 1000) == 1, std::string(event_backend_name(kind)) + " missed modified interest");
+        expect(events[0].token == 43 && events[0].writable, "expected writable event with updated token");
+
+        backend->remove(fds[0]);
+        expect(backend->wait(events, 0) == 0, std::string(event_backend_name(kind)) + " reported a removed socket");
+        ::close(fds[0]);
+        ::close(fds[1]);
+    }
+
+    EventBackendKind parsed = EventBackendKind::Auto;
+    expect(parse_event_backend("epoll-et", parsed) && parsed == EventBackendKind::EpollEdge, "expected epoll-et to parse");
+    expect(!parse_event_backend("select", parsed), "unknown backend should not parse");
+}
+
+std::size_t count_lines(const std::string& path) {
+    std::ifstream in(path.c_str());
+    std::string line;
+    std::size_t count = 0;
+    while (std::getline(in, line)) ++count;
+    return count;
+}
+
+void test_audit_trail_writes_through_background_writer() {
+    const std::string dir = "/tmp/ghostline_audit_writer_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    FlowContext flow;
+    flow.flow_id = 7;
+    ActionItem item;
+    item.action_id = "action-7-1";
+    item.flow_id = 7;
+    item.plugin_name = "raw-live";
+    {
+        AuditTrail audit(dir + "/audit.log", dir + "/actions.log", dir + "/audit.jsonl", "", dir + "/queue");
+        for (int i = 0; i < 100; ++i) {
+            audit.record_observe_transition(flow, Direction::ClientToServer, "test");
+        }
+        audit.save_action_item(item);
+        audit.flush();
+        expect(count_lines(dir + "/audit.log") == 100, "expected flushed text audit lines");
+        expect(count_lines(dir + "/audit.jsonl") == 100, "expected flushed json audit lines");
+        ActionItem saved;
+        expect(find_review_item(dir + "/queue", "action-7-1", saved), "expected review item written by writer thread");
+        expect(audit.stats().write_calls < 100, "expected audit lines to be group-committed");
+    }
+    expect(count_lines(dir + "/actions.log") == 1, "expected action line after shutdown");
+}
+
+std::string read_all(const std::string& path) {
+    std::ifstream in(path);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void test_audit_trail_renders_codes_and_ids_at_the_sink() {
+    expect(std::string(validation_label(ValidationCode::MqttPublishReframed)) == "mqtt-publish-reframed", "validation label table mismatch");
+    expect(std::string(action_title(ReviewCode::MqttThreshold)) == "Review mqtt mutation", "review table mismatch");
+    expect(format_trigger_id(3, Direction::ServerToClient, "mqtt", 12) == "trigger-3-s2c-mqtt-12", "trigger id format mismatch");
+    CandidateDecision noted;
+    noted.validation = ValidationCode::MqttReframeInvalid;
+    noted.validation_note = "remaining length mismatch";
+    expect(std::string(validation_detail(noted)) == "remaining length mismatch", "a validation note should replace the table detail");
+
+    const std::string dir = "/tmp/ghostline_audit_labels_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    FlowContext flow;
+    flow.flow_id = 4;
+    flow.event_sequence = 2;
+    Candidate candidate;
+    candidate.plugin_name = "raw-live";
+    candidate.trigger_sequence = 1;
+    candidate.candidate_sequence = 1;
+    candidate.note = "note";
+    CandidateDecision decision;
+    decision.validation = ValidationCode::RawLiveNoMatch;
+    {
+        AuditTrail audit(dir + "/audit.log", "", dir + "/audit.jsonl", "", "");
+        audit.record_candidate(flow, Direction::ClientToServer, candidate, decision);
+        AuditEvent& event = audit.next_event();
+        event.type = AuditEventType::PluginDetect;
+        event.flow_id = 4;
+        event.direction = Direction::ServerToClient;
+        event.plugin_name = "mqtt";
+        event.sequence = 5;
+        audit.record_event(event);
+        audit.flush();
+    }
+    const std::string text = read_all(dir + "/audit.log");
+    expect(text.find("event_id=candidate-4-c2s-raw-live-1-result trigger_id=trigger-4-c2s-raw-live-1 candidate_id=candidate-4-c2s-raw-live-1 ") != std::string::npos, "candidate ids should be rendered from sequences");
+    expect(text.find("type=candidate ") != std::string::npos, "candidate type should be rendered");
+    expect(text.find("message=\"note validation=raw-live-no-match detail=raw live mutation did not find a matching region fallback=raw live candidate produced no mutation\"") != std::string::npos, "candidate message should carry table text");
+    expect(text.find("event_id=event-4-s2c-5-detect trigger_id= candidate_id= ") != std::string::npos, "detect event id should be rendered");
+    expect(text.find("type=plugin-detect ") != std::string::npos, "event type should be rendered");
+    const std::string json = read_all(dir + "/audit.jsonl");
+    expect(json.find("\"event_id\":\"event-4-s2c-5-detect\",\"trigger_id\":\"\",\"candidate_id\":\"\"") != std::string::npos, "json ids should be rendered");
+    expect(json.find("\"type\":\"candidate\"") != std::string::npos, "json type should be rendered");
+}
+
+void record_sample_events(AuditTrail& audit, const ByteVec& original, const ByteVec& modified) {
+    AuditEvent& candidate = audit.next_event();
+    candidate.type = AuditEventType::Candidate;
+    candidate.trigger_sequence = 2;
+    candidate.candidate_sequence = 2;
+    candidate.flow_id = 9;
+    candidate.direction = Direction::ServerToClient;
+    candidate.plugin_name = "mqtt";
+    candidate.message = "note with \"quotes\" and a tab\t";
+    candidate.original_bytes = original;
+    candidate.modified_bytes = modified;
+    candidate.flags = {FlowFlag::PidDriftRisk, FlowFlag::ObserveOnly};
+    candidate.workflow_stage = WorkflowStage::ReleasedModified;
+    candidate.sequence = 3;
+    candidate.timestamp_ns = 123456789;
+    audit.record_event(candidate);
+
+    AuditEvent& stats = audit.next_event();
+    stats.type = AuditEventType::FlowIoStats;
+    stats.flow_id = 9;
+    stats.plugin_name = "transport-core";
+    stats.message = "c2s reads=1";
+    stats.sequence = 4;
+    stats.timestamp_ns = 123456790;
+    audit.record_event(stats);
+}
+
+void test_binary_audit_exports_to_text_and_jsonl() {
+    const std::string dir = "/tmp/ghostline_audit_binary_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    ByteVec original = bytes_from_ascii("payload");
+    original.push_back(0x00);
+    original.push_back(0xff);
+    const ByteVec modified = bytes_from_ascii("patched");
+    {
+        CapturePolicySet policies;
+        add_capture_spec(policies, "mqtt=head:4");
+        AuditTrail text(dir + "/live.log", "", dir + "/live.jsonl", "", "");
+        record_sample_events(text, original, modified);
+        text.set_capture_policies(policies);
+        record_sample_events(text, original, modified);
+        AuditTrail binary(dir + "/unused.log", "", dir + "/unused.jsonl", "", "", AuditWriterOptions(), dir + "/audit.bin");
+        record_sample_events(binary, original, modified);
+        binary.set_capture_policies(policies);
+        record_sample_events(binary, original, modified);
+    }
+    expect(!std::filesystem::exists(dir + "/unused.log"), "binary mode should not open the text audit stream");
+
+    const AuditExportResult result = export_audit_binary(dir + "/audit.bin", dir + "/export.log", dir + "/export.jsonl");
+    expect(result.records == 4 && result.status == AuditRecordStatus::End, "expected every binary record to export");
+    expect(read_all(dir + "/export.log") == read_all(dir + "/live.log"), "exported text should match the live text sink");
+    expect(read_all(dir + "/export.log").find("original=7061796c modified=70617463 original_len=9 modified_len=7") != std::string::npos, "head capture should survive the binary round trip");
+    expect(read_all(dir + "/export.jsonl") == read_all(dir + "/live.jsonl"), "exported jsonl should match the live jsonl sink");
+    expect(std::filesystem::file_size(dir + "/audit.bin") < std::filesystem::file_size(dir + "/live.log"), "binary records should be smaller than text lines");
+
+    const std::string bytes = read_all(dir + "/audit.bin");
+    const ByteVec truncated(bytes.begin(), bytes.end() - 3);
+    std::size_t offset = 0;
+    DecodedAuditRecord record;
+    expect(decode_audit_record(truncated, offset, record) == AuditRecordStatus::Ok && record.event.message.find("quotes") != std::string::npos, "first record should decode");
+    expect(decode_audit_record(truncated, offset, record) == AuditRecordStatus::Ok, "second record should decode");
+    expect(decode_audit_record(truncated, offset, record) == AuditRecordStatus::Ok && record.payload.form == CaptureForm::Head && record.payload.original_len == 9, "head record should decode with its full lengths");
+    expect(decode_audit_record(truncated, offset, record) == AuditRecordStatus::Truncated, "a cut record should report truncation");
+}
+
+void test_capture_policies_trim_payloads_per_plugin() {
+    CapturePolicy policy;
+    expect(parse_capture_policy("head:16", policy) && policy.mode == CaptureMode::Head && policy.head_bytes == 16, "head policy should parse");
+    expect(parse_capture_policy("sample:10", policy) && policy.sample_every == 10, "sample policy should parse");
+    expect(!parse_capture_policy("sample:0", policy) && !parse_capture_policy("head", policy) && !parse_capture_policy("hash:1", policy), "malformed policies should be rejected");
+    expect(xxhash64(ByteView()) == 0xef46db3751d8e999ULL && xxhash64(bytes_from_ascii("abc")) == 0x44bc2cf5ad770999ULL, "xxhash64 reference vectors");
+
+    const std::string dir = "/tmp/ghostline_capture_policy_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    CapturePolicySet policies;
+    add_capture_spec(policies, "hash");
+    add_capture_spec(policies, "mqtt=sample:2");
+    add_capture_spec(policies, "raw-live=head:2");
+    bool rejected = false;
+    try {
+        add_capture_spec(policies, "mqtt=tail:4");
+    } catch (const std::runtime_error&) {
+        rejected = true;
+    }
+    expect(rejected, "a malformed capture spec should throw");
+
+    const ByteVec payload = bytes_from_ascii("abc");
+    FlowContext flow;
+    flow.flow_id = 2;
+    Candidate candidate;
+    candidate.plugin_name = "raw-live";
+    candidate.candidate_sequence = 1;
+    candidate.original_bytes = payload;
+    CandidateDecision decision;
+    decision.create_action_item = true;
+    {
+        AuditTrail audit(dir + "/audit.log", "", "", "", "");
+        audit.set_capture_policies(policies);
+        const char* plugins[] = {"raw-live", "mqtt", "mqtt", "mqtt", "kafka"};
+        for (const char* plugin : plugins) {
+            AuditEvent& event = audit.next_event();
+            event.type = AuditEventType::FramedPacket;
+            event.plugin_name = plugin;
+            event.original_bytes = payload;
+            audit.record_event(event);
+        }
+        audit.record_candidate(flow, Direction::ClientToServer, candidate, decision);
+        audit.flush();
+    }
+
+    std::ifstream in(dir + "/audit.log");
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(in, line);) lines.push_back(line);
+    expect(lines.size() == 6, "expected one line per event");
+    if (lines.size() != 6) return;
+    const auto ends_with = [](const std::string& line, const std::string& tail) {
+        return line.size() >= tail.size() && line.compare(line.size() - tail.size(), tail.size(), tail) == 0;
+    };
+    expect(ends_with(lines[0], " original=6162 modified= original_len=3 modified_len=0"), "head policy should keep a prefix and lengths");
+    expect(ends_with(lines[1], " original=616263 modified="), "first sampled event should be captured in full");
+    expect(ends_with(lines[2], " original_len=3 modified_len=0"), "unsampled event should keep lengths only");
+    expect(ends_with(lines[3], " original=616263 modified="), "every second mqtt event should be captured in full");
+    expect(ends_with(lines[4], " original_xxh64=44bc2cf5ad770999 modified_xxh64=ef46db3751d8e999 original_len=3 modified_len=0"), "fallback hash policy should write XXH64 values");
+    expect(ends_with(lines[5], " original=616263 modified=616263"), "action-item candidates should bypass capture policies");
+}
+
+void test_audit_writer_drop_policy_accounts_for_every_line() {
+    const std::string path = "/tmp/ghostline_audit_writer_drop.log";
+    std::filesystem::remove(path);
+
+    AuditWriterOptions options;
+    options.queue_capacity = 2;
+    options.full_policy = AuditQueuePolicy::Drop;
+    AuditWriterStats stats;
+    {
+        AuditWriter writer(options);
+        const int stream = writer.open_stream(path);
+        for (int i = 0; i < 1000; ++i) writer.push_line(stream, "line");
+        writer.flush();
+        stats = writer.stats();
+    }
+    expect(stats.enqueued + stats.dropped == 1000, "expected every line to be enqueued or dropped");
+    expect(count_lines(path) == stats.enqueued, "expected every enqueued line on disk");
+
+    AuditQueuePolicy policy = AuditQueuePolicy::Block;
+    expect(parse_audit_queue_policy("summary", policy) && policy == AuditQueuePolicy::Summary, "expected summary policy to parse");
+}
+
+void test_audit_writer_rotates_and_prunes_segments() {
+    const std::string dir = "/tmp/ghostline_log_rotation_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    const std::string path = dir + "/audit.log";
+
+    AuditWriterOptions options;
+    options.batch_bytes = 1;
+    options.rotation.max_bytes = 20;
+    options.rotation.keep = 2;
+    options.rotation.compression = log_compression_available(LogCompression::Gzip) ? LogCompression::Gzip : LogCompression::None;
+    {
+        AuditWriter writer(options);
+        const int stream = writer.open_stream(path);
+        for (int i = 0; i < 10; ++i) writer.push_line(stream, "line-0" + std::to_string(i));
+    }
+    wait_for_log_maintenance();
+
+    // Two eight-byte lines fit under 20 bytes, so lines 0-7 went to segments
+    // 1-4 and keep=2 leaves segments 3 and 4 ahead of the active file.
+    const std::vector<std::string> segments = list_log_segments(path);
+    const std::string suffix = options.rotation.compression == LogCompression::Gzip ? ".gz" : "";
+    expect(segments.size() == 3, "expected two kept segments and the active file");
+    if (segments.size() == 3) {
+        expect(segments[0] == log_segment_path(path, 3) + suffix && segments[1] == log_segment_path(path, 4) + suffix, "expected the newest segments to be kept");
+        expect(segments[2] == path, "expected the active file last");
+    }
+    expect(read_log_stream(path) == "line-04\nline-05\nline-06\nline-07\nline-08\nline-09\n", "segments should read back as one stream");
+
+    LogCompression compression = LogCompression::None;
+    expect(parse_log_compression("gzip", compression) && compression == LogCompression::Gzip && !parse_log_compression("zip", compression), "expected compression names to parse");
+}
+
+void test_relay_metrics_sum_workers_and_serve_prometheus_text() {
+    MemoryAccountant memory(1024);
+    MemoryCharge charge;
+    memory.set(charge, MemoryCategory::OutQueue, 300);
+    RelayMetrics metrics(2, &memory);
+    WorkerMetrics& first = metrics.worker(0);
+    WorkerMetrics& second = metrics.worker(1);
+    WorkerMetrics::set(first.active_flows, 2);
+    WorkerMetrics::set(second.active_flows, 1);
+    WorkerMetrics::add(first.relayed_bytes[static_cast<std::size_t>(Direction::ClientToServer)], 100);
+    WorkerMetrics::add(second.relayed_bytes[static_cast<std::size_t>(Direction::ClientToServer)], 23);
+    WorkerMetrics::add(second.candidates[static_cast<std::size_t>(ValidationCode::MqttPublishReframed)], 4);
+    WorkerMetrics::add(first.candidates[static_cast<std::size_t>(ValidationCode::ByteWindowNoOp)], 2);
+    WorkerMetrics::add(second.candidates[static_cast<std::size_t>(ValidationCode::MqttNoOp)], 1);
+    WorkerMetrics::add(first.released_modified, 4);
+    WorkerMetrics::add(second.framing_failures, 1);
+
+    const std::string text = metrics.render();
+    auto has = [&text](const std::string& line) { return text.find(line + "\n") != std::string::npos; };
+    expect(has("ghostline_active_flows 3"), "expected active flows summed across workers");
+    expect(has("ghostline_relayed_bytes_total{direction=\"c2s\"} 123") && has("ghostline_relayed_bytes_total{direction=\"s2c\"} 0"),
+           "expected relayed bytes per direction");
+    expect(has("ghostline_candidates_total{validation=\"mqtt-publish-reframed\"} 4"), "expected candidates by validation label");
+    expect(has("ghostline_candidates_total{validation=\"no-op\"} 3") && text.find("validation=\"no-op\"") == text.rfind("validation=\"no-op\""),
+           "expected codes sharing a label merged into one series");
+    expect(has("ghostline_candidate_releases_total{release=\"modified\"} 4") && has("ghostline_framing_failures_total{reason=\"framing-failed\"} 1"),
+           "expected release and framing counters");
+    expect(has("ghostline_queued_bytes{queue=\"outq\"} 300") && has("# TYPE ghostline_queued_bytes gauge"), "expected queue depths from the accountant");
+
+    auto scrape = [](int fd, const std::string& request) {
+        expect(::send(fd, request.data(), request.size(), 0) == static_cast<ssize_t>(request.size()), "expected the request sent");
+        std::string response;
+        char buffer[4096];
+        ssize_t n = 0;
+        while ((n = ::recv(fd, buffer, sizeof(buffer), 0)) > 0) response.append(buffer, static_cast<std::size_t>(n));
+        ::close(fd);
+        return response;
+    };
+
+    MetricsServer server(metrics);
+    std::string error;
+    expect(server.start("127.0.0.1:0", error) && server.port() != 0, "expected the metrics server on an ephemeral port: " + error);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(server.port());
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    expect(::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0, "expected to connect to the metrics server");
+    const std::string response = scrape(fd, "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    expect(response.compare(0, 15, "HTTP/1.0 200 OK") == 0 && response.find("ghostline_active_flows 3") != std::string::npos,
+           "expected the rendered metrics over http");
+    fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    expect(::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0, "expected a second connection");
+    expect(scrape(fd, "GET /other HTTP/1.0\r\n\r\n").compare(0, 12, "HTTP/1.0 404") == 0, "expected 404 off /metrics");
+    server.stop();
+
+    const std::string socket_path = "/tmp/ghostline_metrics_test.sock";
+    MetricsServer unix_server(metrics);
+    expect(unix_server.start("unix:" + socket_path, error), "expected the metrics server on a unix socket: " + error);
+    sockaddr_un unix_address{};
+    unix_address.sun_family = AF_UNIX;
+    std::strncpy(unix_address.sun_path, socket_path.c_str(), sizeof(unix_address.sun_path) - 1);
+    fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    expect(::connect(fd, reinterpret_cast<sockaddr*>(&unix_address), sizeof(unix_address)) == 0, "expected to connect to the unix socket");
+    expect(scrape(fd, "GET /metrics HTTP/1.0\r\n\r\n").find("ghostline_framing_failures_total") != std::string::npos, "expected metrics over the unix socket");
+    unix_server.stop();
+    expect(!std::filesystem::exists(socket_path), "expected the socket file removed on stop");
+    memory.release(charge);
+}
+
+void test_stream_buffer_consumes_without_shifting() {
+    StreamBuffer buffer;
+    const ByteVec first = bytes_from_ascii("hello ghostline");
+    buffer.append(first.data(), first.size());
+    const byte* base = buffer.data();
+    buffer.consume(6);
+    expect(buffer.data() == base + 6, "consume should advance the head instead of moving bytes");
+    expect(buffer.view().to_vec() == bytes_from_ascii("ghostline"), "expected remaining bytes in view");
+
+    buffer.append(bytes_from_ascii("-tail"));
+    expect(buffer.view().to_vec() == bytes_from_ascii("ghostline-tail"), "expected contiguous view after append");
+    expect(buffer.take(5) == bytes_from_ascii("ghost"), "expected take to return the front bytes");
+    expect(buffer.take_all() == bytes_from_ascii("line-tail"), "expected take_all to drain the buffer");
+    expect(buffer.empty(), "expected empty buffer after take_all");
+}
+
+void test_backpressure_gate_uses_hysteresis() {
+    WaterMarks marks;
+    marks.high = 100;
+    marks.low = 40;
+    BackpressureGate gate;
+
+    expect(!gate.update(99, marks) && !gate.paused(), "reads should continue below the high-water mark");
+    expect(gate.update(100, marks) && gate.paused(), "reads should pause at the high-water mark");
+    expect(!gate.update(60, marks) && gate.paused(), "reads should stay paused until the low-water mark");
+    expect(gate.update(40, marks) && !gate.paused(), "reads should resume at the low-water mark");
+
+    gate.update(500, marks);
+    expect(gate.update(500, WaterMarks()) && !gate.paused(), "disabling the marks should release a paused gate");
+}
+
+// Runs the transport core in a child process so a test can drive real
+// sockets through it and stop it with SIGTERM like an operator would.
+struct TransportCoreProcess {
+    pid_t pid = -1;
+
+    ~TransportCoreProcess() {
+        if (pid > 0) {
+            ::kill(pid, SIGKILL);
+            ::waitpid(pid, nullptr, 0);
+        }
+    }
+
+    int stop() {
+        int status = 0;
+        ::kill(pid, SIGTERM);
+        const pid_t reaped = ::waitpid(pid, &status, 0);
+        pid = -1;
+        return reaped > 0 && WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    }
+};
+
+std::uint16_t listen_on_loopback(int& fd) {
+    fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    expect(fd >= 0, "expected a loopback listener");
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t address_len = sizeof(address);
+    expect(::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0 && ::listen(fd, 4) == 0
+               && ::getsockname(fd, reinterpret_cast<sockaddr*>(&address), &address_len) == 0,
+           "expected the loopback listener bound to an ephemeral port");
+    return ntohs(address.sin_port);
+}
+
+// Starts a single-worker relay between a fresh client socket and a fresh
+// upstream socket. The client is nonblocking.
+void open_test_relay(ProxyConfig& cfg, const std::string& dir, TransportCoreProcess& core, int& client, int& upstream) {
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    cfg.audit_log_path = dir + "/audit.log";
+    cfg.action_log_path = dir + "/actions.log";
+    cfg.audit_json_path = dir + "/audit.jsonl";
+    cfg.review_queue_dir = dir + "/queue";
+    cfg.splice_passthrough = false;
+
+    int upstream_listener = -1;
+    cfg.upstream_port = listen_on_loopback(upstream_listener);
+    int probe = -1;
+    cfg.listen_port = listen_on_loopback(probe);
+    ::close(probe);
+
+    core.pid = ::fork();
+    expect(core.pid >= 0, "expected to fork the transport core");
+    if (core.pid == 0) {
+        ::close(upstream_listener);
+        ::_exit(run_transport_core(cfg));
+    }
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(cfg.listen_port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    client = -1;
+    for (int attempt = 0; attempt < 200 && client < 0; ++attempt) {
+        client = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (::connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            ::close(client);
+            client = -1;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+    expect(client >= 0, "expected the transport core to accept a client");
+    expect(::fcntl(client, F_SETFL, ::fcntl(client, F_GETFL, 0) | O_NONBLOCK) == 0, "expected a nonblocking client");
+
+    pollfd pending{upstream_listener, POLLIN, 0};
+    upstream = ::poll(&pending, 1, 2000) == 1 ? ::accept(upstream_listener, nullptr, nullptr) : -1;
+    ::close(upstream_listener);
+    expect(upstream >= 0, "expected the transport core to connect upstream");
+}
+
+// Sends from `sent` until the relay stops taking bytes; returns the new offset.
+std::size_t send_until_stalled(int client, const ByteVec& payload, std::size_t sent) {
+    while (sent < payload.size()) {
+        const ssize_t n = ::send(client, payload.data() + sent, payload.size() - sent, kSendFlags);
+        if (n > 0) {
+            sent += static_cast<std::size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) break;
+        pollfd writable{client, POLLOUT, 0};
+        if (::poll(&writable, 1, 300) == 0) break;
+    }
+    return sent;
+}
+
+// Sends the rest of the payload while reading upstream; true when every
+// byte arrives in order.
+bool relay_remaining(int client, int upstream, const ByteVec& payload, std::size_t sent) {
+    ByteVec received;
+    std::vector<byte> buffer(64 * 1024);
+    while (received.size() < payload.size()) {
+        pollfd fds[2] = {{upstream, POLLIN, 0}, {client, static_cast<short>(sent < payload.size() ? POLLOUT : 0), 0}};
+        if (::poll(fds, 2, 2000) <= 0) return false;
+        if ((fds[1].revents & POLLOUT) != 0) {
+            const ssize_t n = ::send(client, payload.data() + sent, payload.size() - sent, kSendFlags);
+            if (n > 0) sent += static_cast<std::size_t>(n);
+        }
+        if ((fds[0].revents & (POLLIN | POLLHUP)) != 0) {
+            const ssize_t n = ::recv(upstream, buffer.data(), buffer.size(), 0);
+            if (n <= 0) return false;
+            received.insert(received.end(), buffer.begin(), buffer.begin() + n);
+        }
+    }
+    return received == payload;
+}
+
+std::string wait_for_audit(const std::string& path, const std::string& needle) {
+    for (int attempt = 0; attempt < 200; ++attempt) {
+        const std::string text = read_all(path);
+        if (text.find(needle) != std::string::npos) return text;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return read_all(path);
+}
+
+std::string audit_line(const std::string& text, const std::string& needle) {
+    const std::size_t at = text.find(needle);
+    if (at == std::string::npos) return std::string();
+    const std::size_t begin = text.rfind('\n', at);
+    const std::size_t start = begin == std::string::npos ? 0 : begin + 1;
+    return text.substr(start, text.find('\n', at) - start);
+}
+
+std::size_t audit_number(const std::string& line, const std::string& key) {
+    const std::size_t at = line.find(key + "=");
+    return at == std::string::npos ? 0 : static_cast<std::size_t>(std::strtoull(line.c_str() + at + key.size() + 1, nullptr, 10));
+}
+
+// Bytes below 0x10 read as a reserved MQTT packet type and match no other
+// built-in plugin, so every read relays as-is without per-chunk audit events.
+ByteVec relay_test_payload(std::size_t size) {
+    ByteVec payload(size);
+    for (std::size_t i = 0; i < size; ++i) payload[i] = static_cast<byte>((i * 7 + i / 16) % 16);
+    return payload;
+}
+
+void test_relay_pauses_reads_at_the_flow_high_water_mark() {
+    ProxyConfig cfg;
+    cfg.flow_high_water_bytes = 64 * 1024;
+    cfg.flow_low_water_bytes = 16 * 1024;
+    const std::string dir = "/tmp/ghostline_relay_backpressure_test";
+    TransportCoreProcess core;
+    int client = -1;
+    int upstream = -1;
+    open_test_relay(cfg, dir, core, client, upstream);
+
+    // Upstream reads nothing yet. Without the gate the relay would keep
+    // queueing the client's bytes; with it the client stalls once the
+    // socket buffers behind the paused read fill.
+    const ByteVec payload = relay_test_payload(32 * 1024 * 1024);
+    const std::size_t stalled_at = send_until_stalled(client, payload, 0);
+    expect(stalled_at < payload.size(), "the relay should stop reading from the client while its queue is over the high-water mark");
+
+    wait_for_audit(dir + "/audit.jsonl", "backpressure-pause");
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    const std::string paused = read_all(dir + "/audit.jsonl");
+    const std::string pause = audit_line(paused, "backpressure-pause");
+    expect(!pause.empty() && audit_number(pause, "queued") >= cfg.flow_high_water_bytes, "expected a pause audit event at the high-water mark");
+    // The relay's own upstream socket buffer may absorb a few rounds before
+    // it fills, but once the client stalls the last transition is a pause.
+    const std::size_t last_pause = paused.rfind("\"backpressure-pause\"");
+    const std::size_t last_resume = paused.rfind("\"backpressure-resume\"");
+    expect(last_resume == std::string::npos || last_pause > last_resume, "reads should stay paused while upstream is not reading");
+
+    expect(relay_remaining(client, upstream, payload, stalled_at), "every byte should arrive once upstream drains the queue");
+    ::close(client);
+    ::close(upstream);
+    expect(core.stop() == 0, "the transport core should exit cleanly on SIGTERM");
+
+    const std::string audit = read_all(dir + "/audit.jsonl");
+    const std::string resume = audit_line(audit, "backpressure-resume");
+    expect(!resume.empty() && audit_number(resume, "queued") <= cfg.flow_low_water_bytes, "expected a resume audit event at the low-water mark");
+    expect(audit.find("backpressure-pause") < audit.find("backpressure-resume"), "the pause should be recorded before the resume");
+}
+
+void test_flow_id_sequence_wraps_without_reusing_live_or_reserved_ids() {
+    std::unordered_map<std::uint32_t, int> live;
+    FlowIdSequence ids(3, 0x40000000U);
+    expect(ids.take(live) == 3U && ids.take(live) == 0x40000003U, "ids should advance by the worker stride");
+    expect(ids.take(live) == 0x80000003U && ids.take(live) == 0xC0000003U, "ids should run up to the top of the id space");
+
+    live[3] = 1;
+    expect(ids.take(live) == 0x40000003U, "a wrapped sequence should skip an id still held by a live flow");
+    expect(ids.take(live) == 0x80000003U, "the sequence should keep the worker's residue after a wrap");
+
+    std::unordered_map<std::uint32_t, int> none;
+    FlowIdSequence wide(0, 0x80000000U);
+    expect(wide.take(none) != 0 && wide.take(none) != 0 && wide.take(none) != 0, "id 0 shares its tokens with the listen and shutdown descriptors");
+}
+
+void test_memory_accountant_tracks_owners_against_budget() {
+    MemoryAccountant memory(1000);
+    MemoryCharge first;
+    MemoryCharge second;
+
+    memory.set(first, MemoryCategory::Pending, 300);
+    memory.set(first, MemoryCategory::OutQueue, 400);
+    memory.set(second, MemoryCategory::Audit, 200);
+    expect(memory.total() == 900 && first.total() == 700, "charges should add up per owner and in total");
+    expect(!memory.over_budget(), "900 bytes should fit a 1000 byte budget");
+
+    memory.set(second, MemoryCategory::Candidate, 150);
+    expect(memory.over_budget() && memory.total(MemoryCategory::Candidate) == 150, "a candidate copy should push the total over budget");
+
+    memory.set(first, MemoryCategory::OutQueue, 100);
+    expect(memory.total() == 750 && memory.peak() == 1050, "shrinking a charge should lower the total but keep the peak");
+
+    memory.release(first);
+    memory.release(second);
+    expect(memory.total() == 0 && memory.total(MemoryCategory::Pending) == 0, "released owners should leave nothing charged");
+    expect(!MemoryAccountant(0).over_budget(), "a zero budget should be unlimited");
+}
+
+void test_relay_forces_observe_only_over_the_memory_budget() {
+    ProxyConfig cfg;
+    cfg.memory_budget_bytes = 128 * 1024;
+    const std::string dir = "/tmp/ghostline_relay_memory_budget_test";
+    TransportCoreProcess core;
+    int client = -1;
+    int upstream = -1;
+    open_test_relay(cfg, dir, core, client, upstream);
+
+    // The flow high-water mark is far above the budget, so only the budget
+    // can stop the queue toward the unread upstream from growing.
+    const ByteVec payload = relay_test_payload(32 * 1024 * 1024);
+    const std::size_t stalled_at = send_until_stalled(client, payload, 0);
+    expect(stalled_at < payload.size(), "a flow forced over the budget should stop reading from the client");
+
+    const std::string forced = wait_for_audit(dir + "/audit.jsonl", "\"type\":\"observe-transition\"");
+    const std::string enforced = audit_line(forced, "memory-budget-enforced");
+    const std::string transition = audit_line(forced, "\"type\":\"observe-transition\"");
+    expect(!enforced.empty() && audit_number(enforced, "budget") == cfg.memory_budget_bytes, "expected the enforcement audited with the budget");
+    expect(transition.find("memory budget exceeded") != std::string::npos && transition.find("\"flow\":1,") != std::string::npos,
+           "expected the flow's switch to observe-only audited with the budget as the reason");
+    expect(forced.find("memory-budget-enforced") < forced.find("\"type\":\"observe-transition\""), "enforcement should be recorded before the transition");
+
+    expect(relay_remaining(client, upstream, payload, stalled_at), "an observe-only flow should still relay every byte");
+    ::close(client);
+    ::close(upstream);
+    expect(core.stop() == 0, "the transport core should exit cleanly on SIGTERM");
+
+    const std::string audit = read_all(dir + "/audit.jsonl");
+    expect(audit.find("\"type\":\"observe-transition\"") == audit.rfind("\"type\":\"observe-transition\""), "the flow should switch to observe-only once");
+    expect(audit.find("\"flags\":[\"observe-only\"]") != std::string::npos, "later events should carry the observe-only flag");
+}
+
+void test_packet_arena_resets_scratch_between_packets() {
+    PacketArena arena;
+    Candidate& first = arena.next_candidate();
+    first.candidate_sequence = 9;
+    first.protocol_note = "raw live rewrite note long enough to need a heap buffer";
+    first.modify().assign(4096, 0x41);
+    first.size_delta = 12;
+    first.valid = true;
+    CandidateDecision& decision = arena.next_decision();
+    decision.release = CandidateRelease::ReleaseModified;
+    decision.validation = ValidationCode::RawLiveValidated;
+    decision.validation_note = "chunk size change note";
+
+    Candidate& second = arena.next_candidate();
+    expect(second.candidate_sequence == 0 && second.protocol_note.empty() && !second.mutated && second.mutated_bytes.empty(), "next candidate should start empty");
+    expect(second.size_delta == 0 && !second.valid && second.workflow_stage == WorkflowStage::CandidateBuilt, "next candidate should have default fields");
+    expect((second.mutated_bytes.capacity() >= 4096) == PacketArena::kReuse, "only a reusing arena should keep the rewrite buffer");
+    const CandidateDecision& next_decision = arena.next_decision();
+    expect(next_decision.release == CandidateRelease::ReleaseOriginal && next_decision.validation == ValidationCode::None && next_decision.validation_note.empty(), "next decision should have default fields");
+
+    ChunkQueue queue;
+    const ByteVec chunk(1024, 0x42);
+    queue.push(ByteView(chunk));
+    queue.consume(chunk.size());
+    expect(queue.empty() && queue.spare_count() == std::min<std::size_t>(1, ChunkQueue::kSpareChunks), "a sent chunk should become a spare only with the arena");
+    queue.push(ByteView(chunk));
+    expect(queue.bytes() == chunk.size() && queue.front().equals(ByteView(chunk)) && queue.spare_count() == 0, "a spare should back the next copied chunk");
+}
+
+void test_chunk_queue_tracks_partial_sends() {
+    ChunkQueue queue;
+    queue.push(bytes_from_ascii("abc"));
+    queue.push(bytes_from_ascii("def"));
+    expect(queue.chunk_count() == 1, "small pushes should coalesce into one chunk");
+
+    queue.push(ByteVec(ChunkQueue::kCoalesceBytes, 'x'));
+    expect(queue.chunk_count() == 2, "large push should start a new chunk");
+    expect(queue.bytes() == 6 + ChunkQueue::kCoalesceBytes, "expected byte total across chunks");
+
+    queue.consume(2);
+    expect(queue.front().to_vec() == bytes_from_ascii("cdef"), "expected front to skip sent bytes");
+    queue.consume(5);
+    expect(queue.chunk_count() == 1 && queue.front().size() == ChunkQueue::kCoalesceBytes - 1, "consume should span chunk boundaries");
+    queue.consume(queue.bytes());
+    expect(queue.empty() && queue.bytes() == 0, "expected drained queue");
+}
+
+void test_flush_chunks_gathers_queue_and_tracks_partial_writes() {
+    int fds[2];
+    expect(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0, "socketpair failed");
+    expect(::fcntl(fds[0], F_SETFL, ::fcntl(fds[0], F_GETFL, 0) | O_NONBLOCK) == 0, "failed to make writer nonblocking");
+
+    ChunkQueue queue;
+    ByteVec expected;
+    for (int i = 0; i < 64; ++i) {
+        ByteVec chunk(ChunkQueue::kCoalesceBytes + 1, static_cast<byte>('a' + (i % 26)));
+        expected.insert(expected.end(), chunk.begin(), chunk.end());
+        queue.push(std::move(chunk));
+    }
+
+    ZeroCopyState zerocopy;
+    IoCounters counters;
+    ByteVec received;
+    std::vector<byte> scratch(64 * 1024);
+    FlushStatus status = FlushStatus::WouldBlock;
+    while (status != FlushStatus::Drained) {
+        status = flush_chunks(fds[0], queue, 0, zerocopy, counters);
+        expect(status != FlushStatus::Failed, "flush_chunks failed");
+        while (received.size() < counters.sent_bytes) {
+            const ssize_t got = ::read(fds[1], scratch.data(), scratch.size());
+            expect(got > 0, "socketpair read failed");
+            received.insert(received.end(), scratch.begin(), scratch.begin() + got);
+        }
+    }
+    ::close(fds[0]);
+    ::close(fds[1]);
+
+    expect(received == expected, "expected byte-identical stream across partial writes");
+    expect(queue.empty() && queue.bytes() == 0, "expected drained queue");
+    expect(counters.send_calls < 64, "expected chunks gathered into fewer send calls");
+}
+
+void test_zerocopy_graveyard_holds_sockets_until_completions() {
+    ZeroCopyGraveyard graveyard(30);
+    IoCounters counters;
+    auto open_fd = [](int fd) { return ::fcntl(fd, F_GETFD) >= 0; };
+
+    int idle[2];
+    expect(::socketpair(AF_UNIX, SOCK_STREAM, 0, idle) == 0, "socketpair failed");
+    ZeroCopyState nothing;
+    graveyard.bury(idle[0], nothing, counters);
+    expect(graveyard.empty() && !open_fd(idle[0]), "expected a socket with nothing in flight closed at once");
+    ::close(idle[1]);
+
+    // No completions ever arrive on a socketpair, so the kernel still owns
+    // these bytes as far as the graveyard can tell.
+    int busy[2];
+    expect(::socketpair(AF_UNIX, SOCK_STREAM, 0, busy) == 0, "socketpair failed");
+    ZeroCopyState sending;
+    sending.enabled = true;
+    ZeroCopyBuffer buffer;
+    buffer.bytes.assign(256, static_cast<byte>('z'));
+    sending.in_flight.push_back(std::move(buffer));
+    graveyard.bury(busy[0], sending, counters);
+    graveyard.reap();
+    expect(graveyard.size() == 1 && sending.in_flight.empty() && open_fd(busy[0]), "expected the socket and its buffers parked");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    graveyard.reap();
+    expect(graveyard.empty() && !open_fd(busy[0]), "expected the socket reset past its linger deadline");
+    ::close(busy[1]);
+
+    int last[2];
+    expect(::socketpair(AF_UNIX, SOCK_STREAM, 0, last) == 0, "socketpair failed");
+    ZeroCopyState pending;
+    pending.in_flight.push_back(ZeroCopyBuffer());
+    graveyard.bury(last[0], pending, counters);
+    graveyard.close_all(0);
+    expect(graveyard.empty() && !open_fd(last[0]), "expected close_all to reset what is left");
+    ::close(last[1]);
+}
+
+void test_splice_pipe_forwards_between_sockets() {
+    if (!splice_supported()) return;
+
+    int in_fds[2];
+    int out_fds[2];
+    expect(::socketpair(AF_UNIX, SOCK_STREAM, 0, in_fds) == 0, "socketpair failed");
+    expect(::socketpair(AF_UNIX, SOCK_STREAM, 0, out_fds) == 0, "socketpair failed");
+
+    SplicePipe pipe;
+    expect(open_splice_pipe(pipe) && pipe.capacity > 0, "expected splice pipe");
+
+    IoCounters counters;
+    expect(::write(in_fds[1], "passthrough", 11) == 11, "socketpair write failed");
+    expect(splice_into_pipe(in_fds[0], pipe, counters) == SpliceStatus::Moved, "expected bytes moved into pipe");
+    expect(pipe.bytes == 11, "expected pipe byte count");
+    expect(splice_from_pipe(pipe, out_fds[0], counters) == FlushStatus::Drained, "expected pipe drained into socket");
+    expect(counters.spliced_bytes == 11 && pipe.bytes == 0, "expected spliced byte accounting");
+
+    char received[16] = {};
+    expect(::read(out_fds[1], received, sizeof(received)) == 11 && std::string(received, 11) == "passthrough", "expected forwarded bytes");
+
+    ::shutdown(in_fds[1], SHUT_WR);
+    expect(splice_into_pipe(in_fds[0], pipe, counters) == SpliceStatus::EndOfStream, "expected end of stream after half-close");
+
+    close_splice_pipe(pipe);
+    ::close(in_fds[0]);
+    ::close(in_fds[1]);
+    ::close(out_fds[0]);
+    ::close(out_fds[1]);
+}
+
 } // namespace
 
 int main() {
@@ -511,7 +1944,14 @@ int main() {
         test_size_mutation_requires_safe_rewrite();
         test_protocol_hint_selects_requested_plugin();
         test_all_named_plugins_are_registered();
+        test_registry_interns_plugin_ids();
         test_raw_live_mutation_releases_modified();
+        test_byte_pattern_engines_agree_with_naive_search();
+        test_raw_live_end_marker_scan_resumes();
+        test_multi_pattern_prefers_leftmost_longest();
+        test_rule_lists_drive_raw_live_and_byte_window();
+        test_raw_live_stream_holds_only_partial_match_tail();
+        test_candidate_views_framed_bytes_until_mutated();
         test_raw_live_size_change_can_force_review();
         test_raw_live_direction_filter_keeps_original();
         test_raw_live_review_threshold_creates_action_item();
@@ -522,10 +1962,36 @@ int main() {
         test_mqtt_review_threshold_creates_action_item();
         test_pid_search_parser_extracts_tcp_entries();
         test_pid_search_filters_by_process_and_port();
+        test_pid_search_reads_proc_net_tcp();
+        test_socket_index_resolves_local_client_pid();
         test_pid_search_json_contains_core_fields();
         test_target_profile_save_and_load();
         test_default_protocol_target_profiles_cover_mq_family();
         test_review_queue_save_update_and_replay();
+        test_review_journal_pages_compacts_and_migrates();
+        test_log_line_index_follows_appends_and_rotation();
+        test_rules_loader_resolves_example_rules();
+        test_rules_watcher_swaps_registry_on_change_and_trigger();
+        test_event_backends_report_registered_tokens();
+        test_event_backends_ignore_a_removed_registration_on_fd_reuse();
+        test_audit_trail_writes_through_background_writer();
+        test_audit_trail_renders_codes_and_ids_at_the_sink();
+        test_binary_audit_exports_to_text_and_jsonl();
+        test_capture_policies_trim_payloads_per_plugin();
+        test_audit_writer_drop_policy_accounts_for_every_line();
+        test_audit_writer_rotates_and_prunes_segments();
+        test_relay_metrics_sum_workers_and_serve_prometheus_text();
+        test_stream_buffer_consumes_without_shifting();
+        test_backpressure_gate_uses_hysteresis();
+        test_relay_pauses_reads_at_the_flow_high_water_mark();
+        test_flow_id_sequence_wraps_without_reusing_live_or_reserved_ids();
+        test_memory_accountant_tracks_owners_against_budget();
+        test_relay_forces_observe_only_over_the_memory_budget();
+        test_packet_arena_resets_scratch_between_packets();
+        test_chunk_queue_tracks_partial_sends();
+        test_flush_chunks_gathers_queue_and_tracks_partial_writes();
+        test_zerocopy_graveyard_holds_sockets_until_completions();
+        test_splice_pipe_forwards_between_sockets();
     } catch (const std::exception& error) {
         std::cerr << "ghostline_tests failed: " << error.what() << "\n";
         return EXIT_FAILURE;
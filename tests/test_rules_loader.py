@@ -1,17 +1,20 @@
 #!/usr/bin/env python3
 
+import json
 import pathlib
 import subprocess
 import sys
+import tempfile
 
 
 ROOT = pathlib.Path(__file__).resolve().parents[1]
+CLI = pathlib.Path(sys.argv[1]) if len(sys.argv) > 1 else ROOT / "build-local" / "ghostline_cli"
 
 
 def run_rules(path: str, *vars: str) -> list[str]:
-    command = ["python3", str(ROOT / "tools" / "resolve_rules.py"), "--rules", str(ROOT / path)]
+    command = [str(CLI), "--rules", str(ROOT / path), "--rules-print"]
     for item in vars:
-        command.extend(["--var", item])
+        command.extend(["--rules-var", item])
     completed = subprocess.run(command, check=True, capture_output=True, text=True)
     return [line for line in completed.stdout.splitlines() if line]
 
@@ -50,6 +53,19 @@ def main() -> int:
         "hcl rules",
     )
 
+    multi_args = run_rules("examples/rules/multi-rule.json")
+    expect_contains(
+        multi_args,
+        ["--substitute", "hello=patch", "alpha-token=bravo-token", "root=nobody", "--window-rule", "3c3c:3e3e:masked", "5b5b:5d5d"],
+        "multi rules",
+    )
+
+    with tempfile.TemporaryDirectory() as tmp:
+        capture_rules = pathlib.Path(tmp) / "capture.json"
+        capture_rules.write_text(json.dumps({"capture_policies": {"*": "head:64", "mqtt": "hash"}}))
+        capture_args = run_rules(str(capture_rules))
+    expect_contains(capture_args, ["--capture", "head:64", "mqtt=hash"], "capture rules")
+
     print("rules loader tests passed")
     return 0
 